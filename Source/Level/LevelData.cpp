@@ -2,59 +2,372 @@
 
 
 // STL headers.
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <utility>
 
 
+// Application headers.
+#include <Utility/SharedMemory.hpp>
+#include <Utility/TaskGraph.hpp>
+#include <Utility/ThreadPool.hpp>
+
+
+// Prefetching.
+#if defined (_M_IX86) || defined (_M_X64) || defined (__i386__) || defined (__x86_64__)
+    #include <xmmintrin.h>
+    #define GEC_PREFETCH(address) _mm_prefetch ((const char*) (address), _MM_HINT_T0)
+#else
+    #define GEC_PREFETCH(address)
+#endif
+
+
+
+///////////
+// Types //
+///////////
+
+struct LevelData::Products final
+{
+    /// <summary> Creates an empty set of products which will be built on the given pool. </summary>
+    Products (ThreadPool* const pool)
+        : graph (pool)
+    {
+        for (auto& flag : ready)
+        {
+            flag = false;
+        }
+    }
+
+    const LevelData*                                        owner           { nullptr };    //!< The level which the products are derived from.
+    std::array<ProductBuffer, movementClasses>              masks           { };            //!< The traversability bit mask of each movement class.
+    std::array<ProductBuffer, movementClasses>              regions         { };            //!< The region of every tile for each movement class whilst it's being labelled.
+    std::array<LabelBuffer, movementClasses>                labels          { };            //!< The finished region labels of each movement class.
+    std::array<unsigned int, movementClasses>               regionCounts    { };            //!< The number of regions for each movement class.
+    std::array<unsigned int, movementClasses>               labelBytes      { };            //!< The size of each region label for each movement class.
+    std::array<const unsigned int*, movementClasses>        maskData        { };            //!< The masks being read, either the vectors above or a shared segment.
+    std::array<const unsigned char*, movementClasses>       regionData      { };            //!< The labels being read, either the vectors above or a shared segment.
+    
+    std::array<std::atomic<bool>, productTypes>             ready;                          //!< Whether each product has been built.
+    std::array<TaskGraph::Task, productTypes>               tasks           { };            //!< The task which finishes each product.
+    TaskGraph                                               graph;                          //!< Builds each product, this must be destroyed first.
+};
+
+
+/// <summary> 
+/// The start of a published level. Each array follows the header at a cache line boundary, its location is stored
+/// as a section so readers never need to parse anything. Only fixed-size types are used so 32-bit and 64-bit builds 
+/// agree on the layout.
+/// </summary>
+struct LevelData::SharedHeader final
+{
+    /// <summary> The arrays stored in the segment, masks and regions have one section per movement class. </summary>
+    enum Section : unsigned int
+    {
+        File,                                   //!< The file the level was loaded from, not null terminated.
+        Tiles,                                  //!< One byte per tile for TileStorage::Raw.
+        Packed,                                 //!< Two tiles per byte for TileStorage::Packed.
+        Runs,                                   //!< The runs of TileStorage::RunLength.
+        RowRuns,                                //!< The first run of each row for TileStorage::RunLength.
+        Masks,                                  //!< The traversability mask of each movement class.
+        Regions = Masks + movementClasses,      //!< The region label of every tile for each movement class.
+        Count   = Regions + movementClasses     //!< The number of sections.
+    };
+
+    /// <summary> The location of an array relative to the start of the segment. </summary>
+    struct Range final
+    {
+        std::uint64_t   offset  { 0 };  //!< The offset of the first byte.
+        std::uint64_t   bytes   { 0 };  //!< The size of the array.
+    };
+
+    std::atomic<std::uint32_t>  magic           { 0 };  //!< Set to sharedMagic once everything else has been written.
+    std::uint32_t               version         { 0 };  //!< The layout version, sharedVersion.
+    std::uint32_t               headerBytes     { 0 };  //!< The size of the header, a mismatch means the layout differs.
+    std::uint32_t               width           { 0 };  //!< The tile width of the level.
+    std::uint32_t               height          { 0 };  //!< The tile height of the level.
+    std::uint32_t               storage         { 0 };  //!< The TileStorage used by the tile sections.
+    std::uint32_t               regionCounts[movementClasses];  //!< The number of regions for each movement class.
+    std::uint32_t               padding         { 0 };  //!< Keeps the sections 8-byte aligned.
+    Range                       sections[Count];        //!< Where each array is.
+};
+
+
+/////////////
+// Metrics //
+/////////////
+
+const MetricCounter LevelData::rowHitMetric = Metrics::addCounter ("level_row_cache_hits_total", "The number of RunLength rows read from the row cache.");
+
+const MetricCounter LevelData::rowMissMetric = Metrics::addCounter ("level_row_cache_misses_total", "The number of RunLength rows which weren't in the row cache.");
+
+const MetricGauge LevelData::rowHitRatioMetric = Metrics::addGauge ("level_row_cache_hit_ratio", 
+    "The fraction of row cache lookups which hit, since the process started.", "", [] 
+    { 
+        const auto hits    = rowHitMetric.getTotal(),
+                   lookups = hits + rowMissMetric.getTotal();
+
+        return lookups != 0 ? hits / (double) lookups : 0.0;
+    });
+
 
 //////////////////
 // Constructors //
 //////////////////
 
-LevelData::LevelData (const std::string& file)
+LevelData::LevelData (const std::string& file, const TileStorage storage, const std::shared_ptr<ThreadPool>& pool)
+    : m_storage (storage), m_pool (pool)
 {
     loadFromFile (file);
 }
 
 
+LevelData::LevelData (const unsigned int width, const unsigned int height, std::vector<TileType> tiles, 
+                      const TileStorage storage, const std::shared_ptr<ThreadPool>& pool)
+    : m_width (width), m_height (height), m_storage (storage), m_pool (pool)
+{
+    // Ensure the dimensions match the tiles we've been given.
+    if (width == 0 || height == 0 || (unsigned long long) width * height != tiles.size())
+    {
+        throw std::invalid_argument ("LevelData::LevelData(), the tiles given don't match the dimensions " + 
+                                     std::to_string (width) + "x" + std::to_string (height) + ".");
+    }
+
+    // The tiles are copied because our storage follows the page policy.
+    m_tileData.assign (tiles.cbegin(), tiles.cend());
+    tiles = std::vector<TileType>();
+
+    storeTiles();
+}
+
+
+LevelData::LevelData (const std::shared_ptr<const SharedMemory>& segment, const std::shared_ptr<ThreadPool>& pool)
+    : m_shared (segment), m_pool (pool)
+{
+    // Pre-condition: We've been given a segment.
+    assert (segment);
+
+    const auto& header = validateShared (*segment);
+
+    m_width     = header.width;
+    m_height    = header.height;
+    m_storage   = (TileStorage) header.storage;
+
+    const auto file = static_cast<const char*> (findShared (SharedHeader::File));
+    m_mapFile       = file ? std::string (file, (size_t) header.sections[SharedHeader::File].bytes) : std::string();
+
+    updateView();
+    prepareProducts();
+}
+
+
+LevelData::LevelData (const LevelData& copy)
+{
+    *this = copy;
+}
+
+
 LevelData::LevelData (LevelData&& move)
 {
     *this = std::move (move);
 }
 
 
+LevelData& LevelData::operator= (const LevelData& copy)
+{
+    if (this != &copy)
+    {
+        // Nothing can be reading our tiles whilst we change them.
+        finishProducts();
+
+        m_width     = copy.m_width;
+        m_height    = copy.m_height;
+
+        m_mapFile   = copy.m_mapFile;
+        m_storage   = copy.m_storage;
+
+        m_tileData  = copy.m_tileData;
+        m_packed    = copy.m_packed;
+        m_runs      = copy.m_runs;
+        m_rowRuns   = copy.m_rowRuns;
+        m_shared    = copy.m_shared;
+        
+        updateView();
+        resetRowCache();
+
+        // Products are rebuilt on demand, unless they're shared.
+        m_pool = copy.m_pool;
+        prepareProducts();
+    }
+
+    return *this;
+}
+
+
 LevelData& LevelData::operator= (LevelData&& move)
 {
     if (this != &move)
     {
+        // Any products being built are reading the tiles we're about to take.
+        finishProducts();
+        move.finishProducts();
+
         // Move thy data bruv.
         m_width     = move.m_width;
         m_height    = move.m_height;
 
         m_mapFile   = std::move (move.m_mapFile);
+        m_storage   = move.m_storage;
+
         m_tileData  = std::move (move.m_tileData);
+        m_packed    = std::move (move.m_packed);
+        m_runs      = std::move (move.m_runs);
+        m_rowRuns   = std::move (move.m_rowRuns);
+        m_shared    = std::move (move.m_shared);
+
+        m_rowCache  = std::move (move.m_rowCache);
+        m_nextRow   = move.m_nextRow;
+        m_lastMiss  = move.m_lastMiss;
+
+        m_pool      = std::move (move.m_pool);
+        m_products  = std::move (move.m_products);
+
+        updateView();
+
+        // Products find the tiles through their owner.
+        if (m_products)
+        {
+            m_products->owner = this;
+        }
 
         // Reset primitives.
         move.m_width    = 0;
         move.m_height   = 0;
+        move.m_view     = TileView { };
+        move.resetRowCache();
     }
 
     return *this;
 }
 
 
+LevelData::~LevelData()
+{
+    finishProducts();
+}
+
+
 /////////////////////////
 // Getters and setters //
 /////////////////////////
 
+size_t LevelData::getStorageBytes() const
+{
+    return m_tileData.capacity() * sizeof (TileType) + 
+           m_packed.capacity() * sizeof (unsigned char) +
+           m_runs.capacity() * sizeof (unsigned int) + 
+           m_rowRuns.capacity() * sizeof (unsigned int);
+}
+
+
+unsigned long long LevelData::calculateContentHash() const
+{
+    const auto prime = 1099511628211ULL;
+    auto       hash  = 14695981039346656037ULL;
+
+    // Each byte is mixed in separately.
+    const auto mix = [&] (const unsigned int value, const unsigned int bytes)
+    {
+        for (auto i = 0U; i < bytes; ++i)
+        {
+            hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * prime;
+        }
+    };
+
+    mix (m_width, 4);
+    mix (m_height, 4);
+
+    // Decoding rows works for every storage method and is thread-safe.
+    auto row = std::vector<TileType> (m_width);
+
+    for (auto y = 0U; y < m_height; ++y)
+    {
+        decodeRow (y, row.data());
+
+        for (const auto tile : row)
+        {
+            mix ((unsigned int) tile, 1);
+        }
+    }
+
+    return hash;
+}
+
+
+void LevelData::setStorage (const TileStorage storage)
+{
+    if (storage != m_storage)
+    {
+        // The run encoding only has room for 28-bit co-ordinates.
+        if (storage == TileStorage::RunLength && m_width >= (1U << 28))
+        {
+            throw std::runtime_error ("LevelData::setStorage(), the level is too wide to be run-length encoded.");
+        }
+
+        // Products may be reading the current storage.
+        finishProducts();
+
+        // Decode every tile so we can re-encode them in the new format.
+        auto tiles = TileBuffer (getTileCount());
+
+        for (auto y = 0U; y < m_height; ++y)
+        {
+            decodeRow (y, tiles.data() + y * m_width);
+        }
+
+        // A shared level ends up with a private copy of its tiles, the shared products go with the segment.
+        const auto detached = m_shared != nullptr;
+        m_shared.reset();
+
+        m_storage = storage;
+        encodeTiles (std::move (tiles));
+
+        if (detached)
+        {
+            prepareProducts();
+        }
+    }
+}
+
+
+void LevelData::setThreadPool (const std::shared_ptr<ThreadPool>& pool)
+{
+    finishProducts();
+
+    m_pool = pool;
+    prepareProducts();
+}
+
+
 TileType LevelData::getTile (const unsigned int index) const
 {
     // Pre-condition: The index must be valid.
     assert (index < getTileCount());
 
-    return m_tileData[index];
+    // Raw data needs no conversion.
+    if (m_storage == TileStorage::Raw)
+    {
+        return m_view.tiles[index];
+    }
+
+    return getTile (index % m_width, index / m_width);
 }
 
 
@@ -63,7 +376,155 @@ TileType LevelData::getTile (const unsigned int x, const unsigned int y) const
     // Pre-condition: The X and Y don't exceed the width or height.
     assert (x < m_width && y < m_height);
 
-    return m_tileData[x + y * m_width];
+    switch (m_storage)
+    {
+        case TileStorage::Raw:
+            return m_view.tiles[x + y * m_width];
+
+        case TileStorage::Packed:
+        {
+            // Even tiles use the low nibble, odd tiles use the high nibble.
+            const auto index = x + y * m_width;
+            return (TileType) ((m_view.packed[index / 2] >> ((index & 1) * 4)) & 0xF);
+        }
+
+        default:
+        {
+            // Only decode rows which are being used repeatedly, one-off lookups are cheaper as a binary search.
+            const auto row = obtainCachedRow (y);
+            return row ? row[x] : findRunTile (x, y);
+        }
+    }
+}
+
+
+void LevelData::decodeRow (const unsigned int y, TileType* const output) const
+{
+    // Pre-condition: The row exists and we have somewhere to write to.
+    assert (y < m_height && output);
+
+    decodeSpan (0, y, m_width, output);
+}
+
+
+void LevelData::getBlock (const unsigned int x, const unsigned int y, const unsigned int width, const unsigned int height, 
+                          TileType* const output) const
+{
+    // Pre-condition: The block is entirely inside the level.
+    assert (x + width <= m_width && y + height <= m_height && output);
+
+    if (m_storage == TileStorage::Raw)
+    {
+        // Walk down the rows with a pointer, fetching the next row whilst the current one is copied.
+        auto row = m_view.tiles + x + y * m_width;
+        auto out = output;
+
+        for (auto i = 0U; i < height; ++i)
+        {
+            GEC_PREFETCH (row + m_width);
+            
+            std::copy_n (row, width, out);
+            row += m_width;
+            out += width;
+        }
+    }
+
+    else
+    {
+        for (auto i = 0U; i < height; ++i)
+        {
+            decodeSpan (x, y + i, width, output + i * width);
+        }
+    }
+}
+
+
+unsigned int LevelData::getSegment (const unsigned int startX, const unsigned int startY, const unsigned int endX, const unsigned int endY, 
+                                    TileType* const output, const unsigned int capacity) const
+{
+    // Pre-condition: Both points are inside the level.
+    assert (startX < m_width && startY < m_height && endX < m_width && endY < m_height);
+
+    // Bresenham's line algorithm visits one tile per step along the major axis.
+    const auto deltaX = std::abs ((int) endX - (int) startX),
+               deltaY = std::abs ((int) endY - (int) startY),
+               stepX  = startX < endX ? 1 : -1,
+               stepY  = startY < endY ? 1 : -1;
+
+    const auto count = (unsigned int) std::max (deltaX, deltaY) + 1;
+    const auto total = std::min (count, capacity);
+
+    auto x     = (int) startX,
+         y     = (int) startY,
+         error = deltaX - deltaY;
+
+    for (auto i = 0U; i < total; ++i)
+    {
+        // Avoid the row cache so we remain thread-safe.
+        output[i] = m_storage == TileStorage::RunLength ? findRunTile ((unsigned int) x, (unsigned int) y) :
+                                                          getTile ((unsigned int) x, (unsigned int) y);
+
+        const auto doubled = error * 2;
+
+        if (doubled > -deltaY)
+        {
+            error -= deltaY;
+            x     += stepX;
+        }
+
+        if (doubled < deltaX)
+        {
+            error += deltaX;
+            y     += stepY;
+        }
+    }
+
+    return count;
+}
+
+
+unsigned int LevelData::getRegion (const unsigned int index, const MovementClass movement) const
+{
+    // Pre-condition: The index must be valid.
+    assert (index < getTileCount());
+
+    ensureProduct (LevelProduct::Regions);
+
+    return readLabel (m_products->regionData[(size_t) movement], m_products->labelBytes[(size_t) movement], index);
+}
+
+
+unsigned int LevelData::getRegionCount (const MovementClass movement) const
+{
+    ensureProduct (LevelProduct::Regions);
+
+    return m_products->regionCounts[(size_t) movement];
+}
+
+
+bool LevelData::sameRegion (const unsigned int a, const unsigned int b, const MovementClass movement) const
+{
+    // Pre-condition: Both indices must be valid.
+    assert (a < getTileCount() && b < getTileCount());
+
+    ensureProduct (LevelProduct::Regions);
+
+    const auto regions = m_products->regionData[(size_t) movement];
+    const auto bytes   = m_products->labelBytes[(size_t) movement];
+    const auto region  = readLabel (regions, bytes, a);
+    
+    return region != 0 && region == readLabel (regions, bytes, b);
+}
+
+
+const unsigned int* LevelData::getMaskRow (const unsigned int y, const MovementClass movement) const
+{
+    // Pre-condition: The row exists.
+    assert (y < m_height);
+
+    ensureProduct (LevelProduct::Masks);
+
+    return m_products->maskData[(size_t) movement] + y * getMaskStride();
 }
 
 
@@ -81,12 +542,148 @@ void LevelData::loadFromFile (const std::string& file)
     // Keep the file location up to date.
     m_mapFile = file;
 
+    // Products derived from the old tiles must finish before we replace them.
+    finishProducts();
+    m_shared.reset();
+
     // Now read in the header and level data.
     readHeader (stream);
     readLevel (stream);
 
     // Close the stream since we no longer need it.
     stream.close();
+
+    storeTiles();
+}
+
+
+std::shared_ptr<SharedMemory> LevelData::publish (const std::string& name) const
+{
+    // Attached processes should never need to build anything, regions can't be built without the masks.
+    ensureProduct (LevelProduct::Regions);
+
+    // Work out the size of each array from the view so levels which are attached themselves can be published again.
+    const auto tiles     = (std::uint64_t) getTileCount();
+    const auto runLength = m_storage == TileStorage::RunLength;
+    auto       sections  = std::array<SharedHeader::Range, SharedHeader::Count> { };
+
+    sections[SharedHeader::File].bytes      = m_mapFile.size();
+    sections[SharedHeader::Tiles].bytes     = m_storage == TileStorage::Raw ? tiles : 0;
+    sections[SharedHeader::Packed].bytes    = m_storage == TileStorage::Packed ? (tiles + 1) / 2 : 0;
+    sections[SharedHeader::Runs].bytes      = runLength ? m_view.rowRuns[m_height] * sizeof (unsigned int) : 0;
+    sections[SharedHeader::RowRuns].bytes   = runLength ? (m_height + 1) * sizeof (unsigned int) : 0;
+
+    for (auto i = 0U; i < movementClasses; ++i)
+    {
+        sections[SharedHeader::Masks + i].bytes     = (std::uint64_t) getMaskStride() * m_height * sizeof (unsigned int);
+        sections[SharedHeader::Regions + i].bytes   = tiles * m_products->labelBytes[i];
+    }
+
+    // Place every array after the header on its own cache line.
+    const auto align = [] (const std::uint64_t offset) { return (offset + 63) / 64 * 64; };
+    auto       total = align (sizeof (SharedHeader));
+
+    for (auto& section : sections)
+    {
+        section.offset  = total;
+        total           = align (total + section.bytes);
+    }
+
+    if (total > (std::uint64_t) std::numeric_limits<size_t>::max())
+    {
+        throw std::runtime_error ("LevelData::publish(), the level is too large to be shared by this process. \"" + name + "\".");
+    }
+
+    auto       segment = std::make_shared<SharedMemory> (name, (size_t) total);
+    const auto base    = static_cast<unsigned char*> (segment->getData());
+
+    // Products are copied from the arrays being read since they may be in another segment.
+    const void* sources[SharedHeader::Count] = { m_mapFile.data(), m_view.tiles, m_view.packed, m_view.runs, m_view.rowRuns };
+
+    for (auto i = 0U; i < movementClasses; ++i)
+    {
+        sources[SharedHeader::Masks + i]    = m_products->maskData[i];
+        sources[SharedHeader::Regions + i]  = m_products->regionData[i];
+    }
+
+    for (auto i = 0U; i < SharedHeader::Count; ++i)
+    {
+        if (sections[i].bytes != 0)
+        {
+            std::memcpy (base + sections[i].offset, sources[i], (size_t) sections[i].bytes);
+        }
+    }
+
+    // Writing the magic last means a process which attaches too early sees an incomplete segment rather than garbage.
+    const auto published = new (base) SharedHeader();
+    published->version      = sharedVersion;
+    published->headerBytes  = sizeof (SharedHeader);
+    published->width        = m_width;
+    published->height       = m_height;
+    published->storage      = (std::uint32_t) m_storage;
+
+    std::copy_n (m_products->regionCounts.cbegin(), movementClasses, published->regionCounts);
+    std::copy (sections.cbegin(), sections.cend(), published->sections);
+
+    published->magic.store (sharedMagic, std::memory_order_release);
+
+    return segment;
+}
+
+
+//////////////////////
+// Derived products //
+//////////////////////
+
+void LevelData::requestProducts (const std::vector<LevelProduct>& products) const
+{
+    for (const auto product : products)
+    {
+        m_products->graph.schedule (m_products->tasks[(size_t) product]);
+    }
+}
+
+
+void LevelData::awaitProduct (const LevelProduct product) const
+{
+    m_products->graph.await (m_products->tasks[(size_t) product]);
+}
+
+
+///////////////
+// Utilities //
+///////////////
+
+MovementClass LevelData::determineMovementClass (const TileType base)
+{
+    switch (base)
+    {
+        case TileType::OutOfBounds:
+        case TileType::Tree:
+            return MovementClass::Any;
+
+        case TileType::Water:
+            return MovementClass::Water;
+
+        default:
+            return MovementClass::Land;
+    }
+}
+
+
+bool LevelData::isTraversable (const TileType tile, const MovementClass movement)
+{
+    switch (movement)
+    {
+        case MovementClass::Any:
+            return tile != TileType::OutOfBounds && tile != TileType::Tree;
+
+        case MovementClass::Water:
+            return tile == TileType::Water;
+
+        default:
+            return tile == TileType::Terrain || tile == TileType::Swamp;
+    }
 }
 
 
@@ -133,6 +730,11 @@ void LevelData::readHeader (std::ifstream& stream)
     m_tileData.clear();
     m_tileData.shrink_to_fit();
     m_tileData.reserve (m_width * m_height);
+
+    m_packed.clear();
+    m_runs.clear();
+    m_rowRuns.clear();
+    resetRowCache();
 }
 
 
@@ -188,4 +790,625 @@ TileType LevelData::determineTileType (const char tile) const
         default:
             throw std::invalid_argument ("LevelData::determineTileType(), invalid character given. \"" + std::to_string (tile) + "\"");
     }
+}
+
+
+void LevelData::storeTiles()
+{
+    // Compress the tiles if necessary.
+    if (m_storage != TileStorage::Raw)
+    {
+        if (m_storage == TileStorage::RunLength && m_width >= (1U << 28))
+        {
+            m_storage = TileStorage::Packed;
+        }
+
+        // Take the tiles out first because encoding clears the existing storage.
+        auto tiles = std::move (m_tileData);
+        encodeTiles (std::move (tiles));
+    }
+
+    updateView();
+
+    // Finally prepare the products derived from our new tiles.
+    prepareProducts();
+}
+
+
+void LevelData::prepareProducts()
+{
+    // Any previous products are finished with.
+    m_products          = std::make_unique<Products> (m_pool.get());
+    m_products->owner   = this;
+
+    // Shared levels were published with their products.
+    if (m_shared)
+    {
+        attachProducts();
+        return;
+    }
+
+    // Split the level into one strip of rows per thread, each thread needs enough rows to be worth the effort.
+    const auto minimumRows = 64U;
+    const auto threads     = m_pool ? m_pool->getThreadCount() : 1U;
+    const auto strips      = std::max (1U, std::min (threads, m_height / minimumRows));
+    const auto stripRows   = std::max (1U, (m_height + strips - 1) / strips);
+
+    // The tasks capture the products rather than ourselves because we may be moved.
+    const auto  products = m_products.get();
+    auto&       graph    = products->graph;
+
+    // Masks are built for every movement class at once.
+    const auto allocateMasks = graph.addTask ([products] ()
+    {
+        const auto owner = products->owner;
+
+        for (auto& mask : products->masks)
+        {
+            mask.assign (owner->getMaskStride() * owner->m_height, 0);
+        }
+    });
+
+    auto maskStrips = std::vector<TaskGraph::Task> { };
+
+    for (auto first = 0U; first < m_height; first += stripRows)
+    {
+        const auto last = std::min (first + stripRows, m_height);
+        maskStrips.push_back (graph.addTask ([products, first, last] () { products->owner->buildMaskStrip (first, last, *products); }, { allocateMasks }));
+    }
+
+    const auto masks = graph.addTask ([products] () 
+    { 
+        for (auto i = 0U; i < movementClasses; ++i)
+        {
+            products->maskData[i] = products->masks[i].data();
+        }
+
+        products->ready[(size_t) LevelProduct::Masks] = true; 
+    }, maskStrips);
+
+    // Each movement class is labelled separately so they can all be worked on at the same time.
+    auto mergedRegions = std::vector<TaskGraph::Task> { };
+
+    for (auto i = 0U; i < movementClasses; ++i)
+    {
+        const auto movement = (MovementClass) i;
+
+        const auto allocateRegions = graph.addTask ([products, i] ()
+        {
+            products->regions[i].assign (products->owner->getTileCount(), 0);
+        }, { masks });
+
+        auto regionStrips = std::vector<TaskGraph::Task> { };
+
+        for (auto first = 0U; first < m_height; first += stripRows)
+        {
+            const auto last = std::min (first + stripRows, m_height);
+            regionStrips.push_back (graph.addTask ([products, movement, first, last] () { products->owner->labelStrip (movement, first, last, *products); }, { allocateRegions }));
+        }
+
+        mergedRegions.push_back (graph.addTask ([products, movement, stripRows] () { products->owner->mergeStrips (movement, stripRows, *products); }, regionStrips));
+    }
+
+    const auto regions = graph.addTask ([products] () 
+    { 
+        for (auto i = 0U; i < movementClasses; ++i)
+        {
+            products->regionData[i] = products->labels[i].data();
+        }
+
+        products->ready[(size_t) LevelProduct::Regions] = true; 
+    }, mergedRegions);
+
+    products->tasks[(size_t) LevelProduct::Masks]   = masks;
+    products->tasks[(size_t) LevelProduct::Regions] = regions;
+}
+
+
+void LevelData::attachProducts()
+{
+    const auto& header   = *static_cast<const SharedHeader*> (m_shared->getData());
+    auto&       products = *m_products;
+
+    for (auto i = 0U; i < movementClasses; ++i)
+    {
+        products.maskData[i]        = static_cast<const unsigned int*> (findShared (SharedHeader::Masks + i));
+        products.regionData[i]      = static_cast<const unsigned char*> (findShared (SharedHeader::Regions + i));
+        products.regionCounts[i]    = header.regionCounts[i];
+        products.labelBytes[i]      = determineLabelBytes (header.regionCounts[i]);
+    }
+
+    // Empty tasks keep requestProducts() and awaitProduct() working.
+    for (auto i = 0U; i < productTypes; ++i)
+    {
+        products.tasks[i] = products.graph.addTask ([] () { });
+        products.ready[i] = true;
+    }
+}
+
+
+const LevelData::SharedHeader& LevelData::validateShared (const SharedMemory& segment)
+{
+    const auto& name = segment.getName();
+
+    if (segment.getBytes() < sizeof (SharedHeader))
+    {
+        throw std::runtime_error ("LevelData::validateShared(), the segment is too small to contain a level. \"" + name + "\".");
+    }
+
+    const auto& header = *static_cast<const SharedHeader*> (segment.getData());
+
+    if (header.magic.load (std::memory_order_acquire) != sharedMagic)
+    {
+        throw std::runtime_error ("LevelData::validateShared(), the segment doesn't contain a level or is still being published. \"" + name + "\".");
+    }
+
+    if (header.version != sharedVersion || header.headerBytes != sizeof (SharedHeader))
+    {
+        throw std::runtime_error ("LevelData::validateShared(), the segment uses layout version " + std::to_string (header.version) + 
+                                  " but version " + std::to_string (sharedVersion) + " is required. \"" + name + "\".");
+    }
+
+    if (header.width == 0 || header.height == 0 || header.storage > (std::uint32_t) TileStorage::RunLength)
+    {
+        throw std::runtime_error ("LevelData::validateShared(), the segment contains invalid dimensions or storage. \"" + name + "\".");
+    }
+
+    // Each array must be inside the segment and the size we'd expect, anything else would let us read out of bounds.
+    const auto tiles     = (std::uint64_t) header.width * header.height;
+    const auto storage   = (TileStorage) header.storage;
+    const auto runLength = storage == TileStorage::RunLength;
+    const auto masks     = (std::uint64_t) ((header.width + 31) / 32) * header.height * sizeof (unsigned int);
+
+    auto expected = std::array<std::uint64_t, SharedHeader::Count> { };
+    expected[SharedHeader::File]    = header.sections[SharedHeader::File].bytes;
+    expected[SharedHeader::Tiles]   = storage == TileStorage::Raw ? tiles : 0;
+    expected[SharedHeader::Packed]  = storage == TileStorage::Packed ? (tiles + 1) / 2 : 0;
+    expected[SharedHeader::Runs]    = runLength ? header.sections[SharedHeader::Runs].bytes : 0;
+    expected[SharedHeader::RowRuns] = runLength ? ((std::uint64_t) header.height + 1) * sizeof (unsigned int) : 0;
+
+    for (auto i = 0U; i < movementClasses; ++i)
+    {
+        expected[SharedHeader::Masks + i]   = masks;
+        expected[SharedHeader::Regions + i] = tiles * determineLabelBytes (header.regionCounts[i]);
+    }
+
+    for (auto i = 0U; i < SharedHeader::Count; ++i)
+    {
+        const auto& section = header.sections[i];
+
+        if (section.bytes != expected[i] || section.offset % sizeof (unsigned int) != 0 || 
+            section.offset > segment.getBytes() || section.bytes > segment.getBytes() - section.offset)
+        {
+            throw std::runtime_error ("LevelData::validateShared(), section " + std::to_string (i) + " of the segment is invalid. \"" + name + "\".");
+        }
+    }
+
+    // The runs are searched using the row indices so the final index must match the number of runs.
+    if (runLength)
+    {
+        const auto rowRuns = reinterpret_cast<const unsigned int*> (static_cast<const unsigned char*> (segment.getData()) + header.sections[SharedHeader::RowRuns].offset);
+
+        if ((std::uint64_t) rowRuns[header.height] * sizeof (unsigned int) != header.sections[SharedHeader::Runs].bytes)
+        {
+            throw std::runtime_error ("LevelData::validateShared(), the runs of the segment don't match its rows. \"" + name + "\".");
+        }
+    }
+
+    return header;
+}
+
+
+const void* LevelData::findShared (const unsigned int section) const
+{
+    // Pre-condition: We're attached to a validated segment.
+    assert (m_shared && section < SharedHeader::Count);
+
+    const auto& range = static_cast<const SharedHeader*> (m_shared->getData())->sections[section];
+
+    return range.bytes != 0 ? static_cast<const unsigned char*> (m_shared->getData()) + range.offset : nullptr;
+}
+
+
+void LevelData::updateView()
+{
+    if (m_shared)
+    {
+        m_view.tiles    = static_cast<const TileType*> (findShared (SharedHeader::Tiles));
+        m_view.packed   = static_cast<const unsigned char*> (findShared (SharedHeader::Packed));
+        m_view.runs     = static_cast<const unsigned int*> (findShared (SharedHeader::Runs));
+        m_view.rowRuns  = static_cast<const unsigned int*> (findShared (SharedHeader::RowRuns));
+    }
+
+    else
+    {
+        m_view.tiles    = m_tileData.data();
+        m_view.packed   = m_packed.data();
+        m_view.runs     = m_runs.data();
+        m_view.rowRuns  = m_rowRuns.data();
+    }
+}
+
+
+void LevelData::finishProducts() const
+{
+    if (m_products)
+    {
+        m_products->graph.awaitScheduled();
+    }
+}
+
+
+void LevelData::ensureProduct (const LevelProduct product) const
+{
+    // Pre-condition: Products have been prepared.
+    assert (m_products);
+
+    if (!m_products->ready[(size_t) product].load (std::memory_order_acquire))
+    {
+        awaitProduct (product);
+    }
+}
+
+
+void LevelData::buildMaskStrip (const unsigned int first, const unsigned int last, Products& products) const
+{
+    const auto stride = getMaskStride();
+    auto       row    = std::vector<TileType> (m_width);
+
+    for (auto y = first; y < last; ++y)
+    {
+        decodeRow (y, row.data());
+
+        for (auto i = 0U; i < movementClasses; ++i)
+        {
+            const auto movement = (MovementClass) i;
+            const auto words    = products.masks[i].data() + y * stride;
+
+            for (auto x = 0U; x < m_width; ++x)
+            {
+                if (isTraversable (row[x], movement))
+                {
+                    words[x / 32] |= 1U << (x % 32);
+                }
+            }
+        }
+    }
+}
+
+
+void LevelData::labelStrip (const MovementClass movement, const unsigned int first, const unsigned int last, Products& products) const
+{
+    const auto& mask   = products.masks[(size_t) movement];
+    auto&       labels = products.regions[(size_t) movement];
+    const auto  stride = getMaskStride();
+
+    // Checks the mask to see if the given tile is traversable.
+    const auto traversable = [&] (const unsigned int x, const unsigned int y)
+    {
+        return ((mask[y * stride + x / 32] >> (x % 32)) & 1) != 0;
+    };
+
+    for (auto y = first; y < last; ++y)
+    {
+        for (auto x = 0U; x < m_width; ++x)
+        {
+            const auto tile = x + y * m_width;
+
+            if (traversable (x, y))
+            {
+                // Start as our own region then join any traversable neighbours which have already been visited.
+                labels[tile] = tile + 1;
+
+                if (x > 0 && traversable (x - 1, y))
+                {
+                    joinRegions (tile - 1, tile, labels);
+                }
+
+                if (y > first)
+                {
+                    // Movement can be diagonal so check all three tiles above.
+                    const auto left  = x > 0 ? x - 1 : x,
+                               right = std::min (x + 1, m_width - 1);
+
+                    for (auto above = left; above <= right; ++above)
+                    {
+                        if (traversable (above, y - 1))
+                        {
+                            joinRegions (above + (y - 1) * m_width, tile, labels);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+void LevelData::mergeStrips (const MovementClass movement, const unsigned int stripRows, Products& products) const
+{
+    auto& labels = products.regions[(size_t) movement];
+
+    // Join the regions which meet across the boundary at the top of each strip.
+    for (auto row = stripRows; row < m_height; row += stripRows)
+    {
+        for (auto x = 0U; x < m_width; ++x)
+        {
+            const auto tile = x + row * m_width;
+
+            if (labels[tile] != 0)
+            {
+                const auto left  = x > 0 ? x - 1 : x,
+                           right = std::min (x + 1, m_width - 1);
+
+                for (auto above = left; above <= right; ++above)
+                {
+                    const auto neighbour = above + (row - 1) * m_width;
+
+                    if (labels[neighbour] != 0)
+                    {
+                        joinRegions (neighbour, tile, labels);
+                    }
+                }
+            }
+        }
+    }
+
+    // Every tile links to a lower index so a single forward pass flattens the regions into compact labels.
+    auto count = 0U;
+
+    for (auto tile = 0U; tile < labels.size(); ++tile)
+    {
+        if (labels[tile] != 0)
+        {
+            const auto parent = labels[tile] - 1;
+            labels[tile]      = parent == tile ? ++count : labels[parent];
+        }
+    }
+
+    // Store the labels as narrowly as possible, the wide labels were only needed to link tiles whilst labelling.
+    const auto bytes   = determineLabelBytes (count);
+    auto&      compact = products.labels[(size_t) movement];
+
+    compact.resize (labels.size() * bytes);
+
+    switch (bytes)
+    {
+        case 1:
+            std::transform (labels.cbegin(), labels.cend(), reinterpret_cast<std::uint8_t*> (compact.data()), 
+                [] (const unsigned int label) { return (std::uint8_t) label; });
+            break;
+
+        case 2:
+            std::transform (labels.cbegin(), labels.cend(), reinterpret_cast<std::uint16_t*> (compact.data()), 
+                [] (const unsigned int label) { return (std::uint16_t) label; });
+            break;
+
+        default:
+            std::copy (labels.cbegin(), labels.cend(), reinterpret_cast<std::uint32_t*> (compact.data()));
+            break;
+    }
+
+    ProductBuffer().swap (labels);
+
+    products.regionCounts[(size_t) movement] = count;
+    products.labelBytes[(size_t) movement]   = bytes;
+}
+
+
+unsigned int LevelData::determineLabelBytes (const unsigned int regionCount)
+{
+    return regionCount <= std::numeric_limits<std::uint8_t>::max() ? 1U :
+           regionCount <= std::numeric_limits<std::uint16_t>::max() ? 2U : 4U;
+}
+
+
+unsigned int LevelData::readLabel (const unsigned char* const labels, const unsigned int bytes, const unsigned int index)
+{
+    switch (bytes)
+    {
+        case 1:
+            return labels[index];
+
+        case 2:
+            return reinterpret_cast<const std::uint16_t*> (labels)[index];
+
+        default:
+            return reinterpret_cast<const std::uint32_t*> (labels)[index];
+    }
+}
+
+
+unsigned int LevelData::findRoot (unsigned int index, ProductBuffer& labels)
+{
+    // Labels store the parent index plus one, halve the path as we go to keep future searches short.
+    while (labels[index] - 1 != index)
+    {
+        const auto parent = labels[index] - 1;
+
+        labels[index] = labels[parent];
+        index         = parent;
+    }
+
+    return index;
+}
+
+
+void LevelData::joinRegions (const unsigned int a, const unsigned int b, ProductBuffer& labels)
+{
+    const auto rootA = findRoot (a, labels),
+               rootB = findRoot (b, labels);
+
+    // Always link to the lower index so every tile points backwards, this makes flattening trivial.
+    if (rootA < rootB)
+    {
+        labels[rootB] = rootA + 1;
+    }
+
+    else if (rootB < rootA)
+    {
+        labels[rootA] = rootB + 1;
+    }
+}
+
+
+TileType LevelData::findRunTile (const unsigned int x, const unsigned int y) const
+{
+    // Runs are sorted by their end co-ordinate so we can binary search for the first run ending after X.
+    const auto first = m_view.runs + m_view.rowRuns[y],
+               last  = m_view.runs + m_view.rowRuns[y + 1];
+
+    const auto run = std::upper_bound (first, last, (x << 4) | 0xF);
+
+    // Post-condition: Every tile in a row belongs to a run.
+    assert (run != last);
+
+    return (TileType) (*run & 0xF);
+}
+
+
+void LevelData::decodeSpan (const unsigned int x, const unsigned int y, const unsigned int count, TileType* const output) const
+{
+    // Pre-condition: The span is inside the row.
+    assert (x + count <= m_width && y < m_height);
+
+    const auto first = x + y * m_width;
+
+    switch (m_storage)
+    {
+        case TileStorage::Raw:
+            std::copy_n (m_view.tiles + first, count, output);
+            break;
+
+        case TileStorage::Packed:
+            for (auto i = 0U; i < count; ++i)
+            {
+                const auto index = first + i;
+                output[i] = (TileType) ((m_view.packed[index / 2] >> ((index & 1) * 4)) & 0xF);
+            }
+
+            break;
+
+        default:
+        {
+            // Find the run containing the first tile then expand runs until we've filled the span.
+            const auto last = m_view.runs + m_view.rowRuns[y + 1];
+            auto       run  = std::upper_bound (m_view.runs + m_view.rowRuns[y], last, (x << 4) | 0xF);
+            auto       tile = x;
+
+            while (tile < x + count && run != last)
+            {
+                const auto end = std::min (*run >> 4, x + count);
+
+                std::fill (output + (tile - x), output + (end - x), (TileType) (*run & 0xF));
+                tile = end;
+                ++run;
+            }
+        }
+    }
+}
+
+
+const TileType* LevelData::obtainCachedRow (const unsigned int y) const
+{
+    // Check if the row has been decoded recently.
+    for (const auto& cached : m_rowCache)
+    {
+        if (cached.row == y)
+        {
+            rowHitMetric.increment();
+            return cached.tiles.data();
+        }
+    }
+
+    rowMissMetric.increment();
+
+    // Rows are only worth decoding once they've missed the cache twice in a row.
+    if (m_lastMiss != y)
+    {
+        m_lastMiss = y;
+        return nullptr;
+    }
+
+    // Replace the oldest row.
+    auto& cached = m_rowCache[m_nextRow];
+    m_nextRow    = (m_nextRow + 1) % cachedRows;
+
+    cached.tiles.resize (m_width);
+    decodeRow (y, cached.tiles.data());
+    cached.row = y;
+
+    return cached.tiles.data();
+}
+
+
+void LevelData::encodeTiles (TileBuffer&& tiles)
+{
+    // Pre-condition: We have every tile.
+    assert (tiles.size() == getTileCount());
+
+    // Start with a clean slate.
+    m_tileData.clear();
+    m_tileData.shrink_to_fit();
+    m_packed.clear();
+    m_packed.shrink_to_fit();
+    m_runs.clear();
+    m_runs.shrink_to_fit();
+    m_rowRuns.clear();
+    m_rowRuns.shrink_to_fit();
+    resetRowCache();
+
+    switch (m_storage)
+    {
+        case TileStorage::Raw:
+            m_tileData = std::move (tiles);
+            break;
+
+        case TileStorage::Packed:
+            m_packed.resize ((tiles.size() + 1) / 2);
+
+            for (auto i = 0U; i < tiles.size(); ++i)
+            {
+                m_packed[i / 2] |= (unsigned char) ((unsigned char) tiles[i] << ((i & 1) * 4));
+            }
+
+            break;
+
+        default:
+            m_rowRuns.reserve (m_height + 1);
+
+            for (auto y = 0U; y < m_height; ++y)
+            {
+                m_rowRuns.push_back (m_runs.size());
+
+                // Each run ends where the tile type changes.
+                const auto row = tiles.data() + y * m_width;
+
+                for (auto x = 1U; x <= m_width; ++x)
+                {
+                    if (x == m_width || row[x] != row[x - 1])
+                    {
+                        m_runs.push_back ((x << 4) | (unsigned int) row[x - 1]);
+                    }
+                }
+            }
+
+            m_rowRuns.push_back (m_runs.size());
+            m_runs.shrink_to_fit();
+    }
+
+    updateView();
+}
+
+
+void LevelData::resetRowCache() const
+{
+    for (auto& cached : m_rowCache)
+    {
+        cached.row = ~0U;
+        cached.tiles.clear();
+    }
+
+    m_nextRow  = 0;
+    m_lastMiss = ~0U;
 }
\ No newline at end of file
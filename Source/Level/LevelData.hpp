@@ -3,11 +3,24 @@
 
 
 // STL headers.
+#include <array>
 #include <iosfwd>
+#include <memory>
 #include <string>
 #include <vector>
 
 
+// Application headers.
+#include <Utility/HugePages.hpp>
+#include <Utility/MemoryTracker.hpp>
+#include <Utility/Metrics.hpp>
+
+
+// Forward declarations.
+class SharedMemory;
+class ThreadPool;
+
+
 /// <summary>
 /// An enum containing a representation of each tile type.
 /// </summary>
@@ -21,6 +34,40 @@ enum class TileType : char
 };
 
 
+/// <summary>
+/// The different ways of moving across a level, each one can only traverse certain tiles.
+/// </summary>
+enum class MovementClass : char
+{
+    Land,           //!< Can only travel across terrain and swamps.
+    Water,          //!< Can only travel across water.
+    Any             //!< Can travel across anything that isn't out of bounds or a tree.
+};
+
+
+/// <summary>
+/// The different ways a LevelData object can hold its tiles in memory. Compressed modes trade a little access speed
+/// for a much smaller resident size on large maps.
+/// </summary>
+enum class TileStorage : char
+{
+    Raw,            //!< One byte per tile, the fastest to access.
+    Packed,         //!< Two tiles per byte using 4-bit packing.
+    RunLength       //!< Each row is stored as runs of identical tiles, busy rows are kept in a decoded-row cache.
+};
+
+
+/// <summary>
+/// Data derived from the tiles of a level. Each product is built the first time it is used unless it was requested
+/// ahead of time with LevelData::requestProducts(), in which case it is built in the background.
+/// </summary>
+enum class LevelProduct : char
+{
+    Masks,          //!< A traversability bit mask for each movement class.
+    Regions         //!< The connected regions of each movement class, built from the masks.
+};
+
+
 /// <summary>
 /// Represents a loaded level, this contains the dimensions and tiles of a level which can be used for AI algorithms.
 /// </summary>
@@ -34,14 +81,37 @@ class LevelData final
 
         /// <summary> Constructs a LevelData object from the given file containing level information. Exceptions can be thrown. </summary>
         /// <param name="file"> The file to load from. </param>
-        LevelData (const std::string& file);
+        /// <param name="storage"> How the tiles should be stored in memory once loaded. </param>
+        /// <param name="pool"> The thread pool used to build derived products, without one they're built by the thread using them. </param>
+        LevelData (const std::string& file, const TileStorage storage = TileStorage::Raw, const std::shared_ptr<ThreadPool>& pool = nullptr);
+
+        /// <summary> Constructs a LevelData object from tiles which have already been generated. Exceptions can be thrown. </summary>
+        /// <param name="width"> The tile width of the level. </param>
+        /// <param name="height"> The tile height of the level. </param>
+        /// <param name="tiles"> Every tile in the level, row by row. There must be exactly width * height tiles. </param>
+        /// <param name="storage"> How the tiles should be stored in memory. </param>
+        /// <param name="pool"> The thread pool used to build derived products, without one they're built by the thread using them. </param>
+        LevelData (const unsigned int width, const unsigned int height, std::vector<TileType> tiles, 
+                   const TileStorage storage = TileStorage::Raw, const std::shared_ptr<ThreadPool>& pool = nullptr);
+
+        /// <summary> 
+        /// Attaches to a level which another process published with publish(). Nothing is parsed or copied, the tiles and
+        /// derived products are read straight from the segment. Converting the storage method makes a private copy.
+        /// Exceptions are thrown if the segment isn't a complete level with the layout version we understand.
+        /// </summary>
+        /// <param name="segment"> The segment to read from, this is kept open for as long as the level uses it. </param>
+        /// <param name="pool"> The thread pool used to rebuild derived products if the level stops using the segment. </param>
+        LevelData (const std::shared_ptr<const SharedMemory>& segment, const std::shared_ptr<ThreadPool>& pool = nullptr);
         
         LevelData (LevelData&& move);
         LevelData& operator= (LevelData&& move);
 
-        LevelData (const LevelData& copy)               = default;
-        LevelData& operator= (const LevelData& copy)    = default;
-        ~LevelData()                                    = default;
+        /// <summary> Copies the tiles of a level, derived products aren't copied and will be rebuilt when needed. </summary>
+        LevelData (const LevelData& copy);
+        LevelData& operator= (const LevelData& copy);
+
+        /// <summary> Waits for any derived products which are being built before destroying the level. </summary>
+        ~LevelData();
 
 
         /////////////////////////
@@ -55,26 +125,199 @@ class LevelData final
         unsigned int getHeight() const              { return m_height; }
 
         /// <summary> Gets the total number of loaded tiles in the level. </summary>
-        unsigned int getTileCount() const           { return m_tileData.size(); }
+        unsigned int getTileCount() const           { return m_width * m_height; }
 
         /// <summary> Gets the file location of the loaded level data. </summary>
         const std::string& getFileLocation() const  { return m_mapFile; }
 
+        /// <summary> Gets the method currently being used to store tiles in memory. </summary>
+        TileStorage getStorage() const              { return m_storage; }
+
+        /// <summary> Calculates how many bytes are used to store the tiles of the level in memory, tiles in a shared segment aren't counted. </summary>
+        size_t getStorageBytes() const;
+
+        /// <summary> Gets the segment the level is attached to, nullptr if the level owns its tiles. </summary>
+        const std::shared_ptr<const SharedMemory>& getSharedSegment() const { return m_shared; }
+
+        /// <summary> 
+        /// Calculates a 64-bit FNV-1a hash of the dimensions and tiles of the level. This identifies the content of a level
+        /// regardless of where it was loaded from or how its tiles are stored, so data tuned for one map can find it again.
+        /// </summary>
+        unsigned long long calculateContentHash() const;
+
+        /// <summary> Converts the tiles of the level to the given storage method. </summary>
+        /// <param name="storage"> The storage method to use. </param>
+        void setStorage (const TileStorage storage);
+
+        /// <summary> Sets the thread pool used to build derived products. Any products already built will be discarded. </summary>
+        /// <param name="pool"> The pool to use, nullptr builds products on the thread which uses them. </param>
+        void setThreadPool (const std::shared_ptr<ThreadPool>& pool);
+
         /// <summary> Obtains the type for the given tile. </summary>
         /// <param name="index"> The index of the tile. </param>
         TileType getTile (const unsigned int index) const;
 
-        /// <summary> Obtains the type for the tile at the given co-ordinate. </summary>
+        /// <summary> Obtains the type for the tile at the given co-ordinate. RunLength levels update the row cache so this isn't thread-safe for them. </summary>
         /// <param name="x"> The X co-ordinate of the tile. </param>
         /// <param name="y"> The Y co-ordinate of the tile. </param>
         TileType getTile (const unsigned int x, const unsigned int y) const;
 
+        /// <summary> Decodes an entire row of tiles into the given buffer. This doesn't touch the row cache so it is safe to call from multiple threads. </summary>
+        /// <param name="y"> The Y co-ordinate of the row. </param>
+        /// <param name="output"> A buffer with room for at least getWidth() tiles. </param>
+        void decodeRow (const unsigned int y, TileType* const output) const;
+
+        /// <summary> 
+        /// Copies a rectangular block of tiles into the given buffer in a single call. This is much cheaper than calling 
+        /// getTile() for each tile and is safe to call from multiple threads regardless of the storage method.
+        /// </summary>
+        /// <param name="x"> The X co-ordinate of the top-left tile of the block. </param>
+        /// <param name="y"> The Y co-ordinate of the top-left tile of the block. </param>
+        /// <param name="width"> The number of tiles in each row of the block. </param>
+        /// <param name="height"> The number of rows in the block. </param>
+        /// <param name="output"> A buffer with room for width * height tiles, tiles are written row by row. </param>
+        void getBlock (const unsigned int x, const unsigned int y, const unsigned int width, const unsigned int height, 
+                       TileType* const output) const;
+
+        /// <summary> Copies every tile which a straight line between two tiles passes through into the given buffer. This is thread-safe. </summary>
+        /// <param name="startX"> The X co-ordinate of the first tile. </param>
+        /// <param name="startY"> The Y co-ordinate of the first tile. </param>
+        /// <param name="endX"> The X co-ordinate of the last tile. </param>
+        /// <param name="endY"> The Y co-ordinate of the last tile. </param>
+        /// <param name="output"> The buffer to write the tiles to, in order from start to end. </param>
+        /// <param name="capacity"> The maximum number of tiles the buffer can hold. </param>
+        /// <returns> How many tiles are on the line, if this exceeds the capacity then only the capacity was written. </returns>
+        unsigned int getSegment (const unsigned int startX, const unsigned int startY, const unsigned int endX, const unsigned int endY, 
+                                 TileType* const output, const unsigned int capacity) const;
+
+        /// <summary> Gets the connected region that a tile belongs to for the given movement class. </summary>
+        /// <param name="index"> The index of the tile. </param>
+        /// <param name="movement"> The movement class to check. </param>
+        /// <returns> The label of the region, zero if the tile can't be traversed. </returns>
+        unsigned int getRegion (const unsigned int index, const MovementClass movement) const;
+
+        /// <summary> Gets the number of connected regions which exist for the given movement class. </summary>
+        unsigned int getRegionCount (const MovementClass movement) const;
+
+        /// <summary> Checks if one tile can be reached from another using the given movement class. </summary>
+        /// <param name="a"> The index of the first tile. </param>
+        /// <param name="b"> The index of the second tile. </param>
+        /// <param name="movement"> The movement class to check. </param>
+        /// <returns> Whether both tiles are traversable and connected. </returns>
+        bool sameRegion (const unsigned int a, const unsigned int b, const MovementClass movement) const;
+
+        /// <summary> Gets the number of 32-bit words used for each row of a traversability mask. </summary>
+        unsigned int getMaskStride() const          { return (m_width + 31) / 32; }
+
+        /// <summary> Gets a row of the traversability mask for a movement class. Bit (x % 32) of word (x / 32) is set if tile X can be traversed. </summary>
+        /// <param name="y"> The Y co-ordinate of the row. </param>
+        /// <param name="movement"> The movement class to check. </param>
+        /// <returns> A pointer to getMaskStride() words. </returns>
+        const unsigned int* getMaskRow (const unsigned int y, const MovementClass movement) const;
+
+
+        //////////////////////
+        // Derived products //
+        //////////////////////
+
+        /// <summary> Starts building the given products in the background, along with anything they depend on. </summary>
+        /// <param name="products"> The products which will be needed soon. </param>
+        void requestProducts (const std::vector<LevelProduct>& products) const;
+
+        /// <summary> Waits for a product to be built, building it on the calling thread if there's no thread pool. </summary>
+        /// <param name="product"> The product to wait for. </param>
+        void awaitProduct (const LevelProduct product) const;
+
         /// <summary> Load level data from a file at the given location. If an error occurs an exception will be thrown. </summary>
         /// <param name="file"> The file location to load from. </param>
         void loadFromFile (const std::string& file);
 
+        /// <summary> 
+        /// Publishes the tiles and derived products into a named shared memory segment which other processes can attach
+        /// to. The segment is removed when the returned object is destroyed, processes already attached are unaffected.
+        /// Derived products are built first if necessary. If an error occurs an exception will be thrown.
+        /// </summary>
+        /// <param name="name"> The name of the segment, publishing fails if the name is already in use. </param>
+        /// <returns> The segment, this must be kept alive for as long as new processes should be able to attach. </returns>
+        std::shared_ptr<SharedMemory> publish (const std::string& name) const;
+
+
+        ///////////////
+        // Utilities //
+        ///////////////
+
+        /// <summary> Determines the movement class used when travelling from a tile of the given type. </summary>
+        /// <param name="base"> The tile being travelled from. TileType::OutOfBounds and TileType::Tree allow any movement. </param>
+        static MovementClass determineMovementClass (const TileType base);
+
+        /// <summary> Checks if the given tile can be traversed using the given movement class. </summary>
+        /// <param name="tile"> The tile to check. </param>
+        /// <param name="movement"> The movement class being used. </param>
+        static bool isTraversable (const TileType tile, const MovementClass movement);
+
     private:
 
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> Every derived product along with the task graph which builds them. </summary>
+        struct Products;
+
+        /// <summary> Describes where each array of a published level lives in its shared memory segment. </summary>
+        struct SharedHeader;
+
+        /// <summary> Where the current storage method reads tiles from, either our own buffers or a shared segment. </summary>
+        struct TileView final
+        {
+            const TileType*         tiles   { nullptr };    //!< Uncompressed tiles when using TileStorage::Raw.
+            const unsigned char*    packed  { nullptr };    //!< Two tiles per byte when using TileStorage::Packed.
+            const unsigned int*     runs    { nullptr };    //!< Each run when using TileStorage::RunLength.
+            const unsigned int*     rowRuns { nullptr };    //!< The first run of each row when using TileStorage::RunLength.
+        };
+
+        /// <summary> Uncompressed tiles, large levels follow the HugePages policy since they're indexed randomly. </summary>
+        using TileBuffer = std::vector<TileType, HugePageAllocator<TileType, MemorySubsystem::LevelTiles>>;
+
+        /// <summary> Packed tiles, these follow the HugePages policy too. </summary>
+        using PackedBuffer = std::vector<unsigned char, HugePageAllocator<unsigned char, MemorySubsystem::LevelTiles>>;
+
+        /// <summary> The runs of a RunLength level. </summary>
+        using RunBuffer = std::vector<unsigned int, TrackedAllocator<unsigned int, MemorySubsystem::LevelTiles>>;
+
+        /// <summary> A traversability mask of a movement class, or its region labels whilst they're being built. </summary>
+        using ProductBuffer = std::vector<unsigned int, TrackedAllocator<unsigned int, MemorySubsystem::LevelProducts>>;
+
+        /// <summary> The finished region labels of a movement class, each label is as narrow as the number of regions allows. </summary>
+        using LabelBuffer = std::vector<unsigned char, TrackedAllocator<unsigned char, MemorySubsystem::LevelProducts>>;
+
+        /// <summary> A decoded row of tiles kept around to speed up repeated access to compressed levels. </summary>
+        struct CachedRow final
+        {
+            unsigned int            row     { ~0U };    //!< The Y co-ordinate of the cached row, ~0U if unused.
+            std::vector<TileType>   tiles   { };        //!< Each tile in the row.
+        };
+
+        /// <summary> How many rows are kept decoded at once. Paths tend to stay local so a handful is plenty. </summary>
+        static const unsigned int cachedRows = 4;
+
+        /// <summary> The number of movement classes which regions are labelled for. </summary>
+        static const unsigned int movementClasses = 3;
+
+        /// <summary> The number of different derived products. </summary>
+        static const unsigned int productTypes = 2;
+
+        /// <summary> Identifies a segment containing a completely published level, "GECL" in little-endian. </summary>
+        static const unsigned int sharedMagic = 0x4C434547;
+
+        /// <summary> The version of the shared layout, this must be increased whenever SharedHeader or the arrays change. </summary>
+        static const unsigned int sharedVersion = 2;
+
+        static const MetricCounter  rowHitMetric;       //!< Counts reads of RunLength rows which were already decoded.
+        static const MetricCounter  rowMissMetric;      //!< Counts reads of RunLength rows which weren't.
+        static const MetricGauge    rowHitRatioMetric;  //!< The fraction of row cache lookups which hit.
+
+
         ////////////////////
         // Implementation //
         ////////////////////
@@ -92,6 +335,102 @@ class LevelData final
         /// <returns> The correct TileType, throws an exception if the character is invalid. </returns>
         TileType determineTileType (const char tile) const;
 
+        /// <summary> Compresses freshly loaded tiles if necessary and prepares the products derived from them. </summary>
+        void storeTiles();
+
+        /// <summary> 
+        /// Creates the task graph which builds each derived product. Work is split into strips of rows so each product
+        /// can be built in parallel, the regions of each movement class are labelled per strip and then merged.
+        /// </summary>
+        void prepareProducts();
+
+        /// <summary> Marks every product as built using the arrays in the shared segment. </summary>
+        void attachProducts();
+
+        /// <summary> Checks that a segment contains a complete level using a layout we understand, throws an exception otherwise. </summary>
+        /// <param name="segment"> The segment to check. </param>
+        /// <returns> The header at the start of the segment. </returns>
+        static const SharedHeader& validateShared (const SharedMemory& segment);
+
+        /// <summary> Gets the start of an array in the shared segment. </summary>
+        /// <param name="section"> The SharedHeader section containing the array. </param>
+        /// <returns> The start of the array, nullptr if it's empty. </returns>
+        const void* findShared (const unsigned int section) const;
+
+        /// <summary> Points the tile view at the arrays used by the current storage method. </summary>
+        void updateView();
+
+        /// <summary> Waits for any products which are currently being built, this must be done before the tiles change. </summary>
+        void finishProducts() const;
+
+        /// <summary> Makes sure the given product has been built, this is very cheap once it has. </summary>
+        /// <param name="product"> The product which is about to be used. </param>
+        void ensureProduct (const LevelProduct product) const;
+
+        /// <summary> Builds the traversability masks of every movement class for the given rows. </summary>
+        /// <param name="first"> The first row of the strip. </param>
+        /// <param name="last"> One past the last row of the strip. </param>
+        /// <param name="products"> The products to store the masks in. </param>
+        void buildMaskStrip (const unsigned int first, const unsigned int last, Products& products) const;
+
+        /// <summary> Labels the regions of the given rows, linking each tile to the earliest connected tile. </summary>
+        /// <param name="movement"> The movement class being labelled. </param>
+        /// <param name="first"> The first row of the strip. </param>
+        /// <param name="last"> One past the last row of the strip. </param>
+        /// <param name="products"> The products containing the masks and labels. Labels are parent indices plus one until the regions are flattened. </param>
+        void labelStrip (const MovementClass movement, const unsigned int first, const unsigned int last, Products& products) const;
+
+        /// <summary>
+        /// Joins the regions which meet across each strip boundary, flattens them into consecutive labels and then stores
+        /// them as narrowly as the number of regions allows.
+        /// </summary>
+        /// <param name="movement"> The movement class being labelled. </param>
+        /// <param name="stripRows"> The number of rows in each strip. </param>
+        /// <param name="products"> The products containing the labels. </param>
+        void mergeStrips (const MovementClass movement, const unsigned int stripRows, Products& products) const;
+
+        /// <summary> Determines how many bytes each region label needs, most levels have few enough regions for one byte. </summary>
+        /// <param name="regionCount"> The number of regions being labelled. </param>
+        static unsigned int determineLabelBytes (const unsigned int regionCount);
+
+        /// <summary> Reads the label of a tile from labels stored with the given number of bytes each. </summary>
+        static unsigned int readLabel (const unsigned char* const labels, const unsigned int bytes, const unsigned int index);
+
+        /// <summary> Finds the root tile index of the region containing the given tile, compressing the path as it goes. </summary>
+        /// <param name="index"> The tile to start from, this must be traversable. </param>
+        /// <param name="labels"> The labels of each tile. </param>
+        static unsigned int findRoot (unsigned int index, ProductBuffer& labels);
+
+        /// <summary> Joins the regions containing the two given tiles, the root with the lower index is always kept. </summary>
+        /// <param name="a"> A tile in the first region. </param>
+        /// <param name="b"> A tile in the second region. </param>
+        /// <param name="labels"> The labels of each tile. </param>
+        static void joinRegions (const unsigned int a, const unsigned int b, ProductBuffer& labels);
+
+        /// <summary> Obtains a tile from a RunLength encoded level by searching the runs of the given row. </summary>
+        /// <param name="x"> The X co-ordinate of the tile. </param>
+        /// <param name="y"> The Y co-ordinate of the tile. </param>
+        TileType findRunTile (const unsigned int x, const unsigned int y) const;
+
+        /// <summary> Decodes part of a row without touching the row cache. </summary>
+        /// <param name="x"> The X co-ordinate of the first tile to decode. </param>
+        /// <param name="y"> The Y co-ordinate of the row. </param>
+        /// <param name="count"> How many tiles to decode. </param>
+        /// <param name="output"> A buffer with room for at least count tiles. </param>
+        void decodeSpan (const unsigned int x, const unsigned int y, const unsigned int count, TileType* const output) const;
+
+        /// <summary> Obtains a decoded copy of the given row from the row cache, decoding it if it keeps being requested. </summary>
+        /// <param name="y"> The Y co-ordinate of the row. </param>
+        /// <returns> A pointer to getWidth() tiles, nullptr if the row isn't worth caching yet. </returns>
+        const TileType* obtainCachedRow (const unsigned int y) const;
+
+        /// <summary> Encodes the given uncompressed tiles using the current storage method. </summary>
+        /// <param name="tiles"> Every tile in the level, this will be moved from if the storage method is Raw. </param>
+        void encodeTiles (TileBuffer&& tiles);
+
+        /// <summary> Empties the row cache, this must be done whenever the stored tiles change. </summary>
+        void resetRowCache() const;
+
 
         ///////////////////
         // Internal data //
@@ -100,8 +439,23 @@ class LevelData final
         unsigned int            m_width     { 0 };  //!< The number of tiles that make up the level width.
         unsigned int            m_height    { 0 };  //!< The number of tiles that make up the level height.
 
-        std::string             m_mapFile   = "";   //!< The file location where the level data was loaded from.
-        std::vector<TileType>   m_tileData  { };    //!< The type of every tile on the level.
+        std::string                 m_mapFile   = "";                   //!< The file location where the level data was loaded from.
+        TileStorage                 m_storage   { TileStorage::Raw };   //!< How the tiles are currently stored.
+
+        TileBuffer                  m_tileData  { };                    //!< The type of every tile on the level when using TileStorage::Raw.
+        PackedBuffer                m_packed    { };                    //!< Two tiles per byte when using TileStorage::Packed.
+        RunBuffer                   m_runs      { };                    //!< Each run as (end << 4 | type) when using TileStorage::RunLength.
+        RunBuffer                   m_rowRuns   { };                    //!< The index of the first run of each row, plus a final end marker.
+        TileView                    m_view      { };                    //!< The tiles being read, these are only written through the buffers above.
+
+        std::shared_ptr<const SharedMemory> m_shared    { nullptr };    //!< The segment the level is attached to, if any.
+
+        mutable std::array<CachedRow, cachedRows>   m_rowCache  { };        //!< Recently decoded rows of a RunLength encoded level.
+        mutable unsigned int                        m_nextRow   { 0 };      //!< The cache entry to replace next.
+        mutable unsigned int                        m_lastMiss  { ~0U };    //!< The last row which missed the cache.
+
+        std::shared_ptr<ThreadPool>     m_pool      { nullptr };    //!< The thread pool used to build derived products.
+        std::unique_ptr<Products>       m_products  { nullptr };    //!< Data derived from the tiles, this must be destroyed before the tiles.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include "LevelPyramid.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+LevelPyramid::LevelPyramid (const LevelData& data, const unsigned int levels)
+{
+    // Level zero is the tiles themselves so only the dimensions are needed.
+    Level tiles { };
+    tiles.width  = data.getWidth();
+    tiles.height = data.getHeight();
+    m_levels.push_back (std::move (tiles));
+
+    // Stop halving once the level is small enough to search quickly unless a specific number of levels is wanted.
+    const auto smallest = 32U;
+
+    if (levels > 0 || std::max (data.getWidth(), data.getHeight()) > smallest)
+    {
+        buildFirstLevel (data);
+    }
+
+    while (levels > 0 ? m_levels.size() <= levels : std::max (m_levels.back().width, m_levels.back().height) > smallest)
+    {
+        // Nothing can be gained by halving a single cell.
+        if (m_levels.back().width == 1 && m_levels.back().height == 1)
+        {
+            break;
+        }
+
+        buildNextLevel();
+    }
+}
+
+
+LevelPyramid::LevelPyramid (LevelPyramid&& move)
+{
+    *this = std::move (move);
+}
+
+
+LevelPyramid& LevelPyramid::operator= (LevelPyramid&& move)
+{
+    if (this != &move)
+    {
+        m_levels = std::move (move.m_levels);
+    }
+
+    return *this;
+}
+
+
+/////////////
+// Getters //
+/////////////
+
+unsigned int LevelPyramid::getWidth (const unsigned int level) const
+{
+    // Pre-condition: The level exists.
+    assert (level < getLevelCount());
+
+    return m_levels[level].width;
+}
+
+
+unsigned int LevelPyramid::getHeight (const unsigned int level) const
+{
+    // Pre-condition: The level exists.
+    assert (level < getLevelCount());
+
+    return m_levels[level].height;
+}
+
+
+std::size_t LevelPyramid::getStorageBytes() const
+{
+    auto bytes = m_levels.capacity() * sizeof (Level);
+
+    for (const auto& level : m_levels)
+    {
+        for (auto i = 0U; i < movementClasses; ++i)
+        {
+            bytes += (level.anyBlocked[i].capacity() + level.allBlocked[i].capacity()) * sizeof (unsigned int);
+        }
+    }
+
+    return bytes;
+}
+
+
+bool LevelPyramid::isBlocked (const unsigned int level, const unsigned int x, const unsigned int y, const MovementClass movement,
+                              const PyramidMode mode) const
+{
+    // Pre-condition: The cell exists and isn't a tile.
+    assert (level > 0 && level < getLevelCount() && x < m_levels[level].width && y < m_levels[level].height);
+
+    const auto& data  = m_levels[level];
+    const auto& masks = mode == PyramidMode::AnyBlocked ? data.anyBlocked : data.allBlocked;
+
+    return (masks[(size_t) movement][y * data.stride + x / 32] & (1U << (x % 32))) != 0;
+}
+
+
+std::vector<TileType> LevelPyramid::createTiles (const unsigned int level, const MovementClass movement, const PyramidMode mode) const
+{
+    // Pre-condition: The level isn't the tiles themselves.
+    assert (level > 0 && level < getLevelCount());
+
+    const auto& data        = m_levels[level];
+    const auto& mask        = (mode == PyramidMode::AnyBlocked ? data.anyBlocked : data.allBlocked)[(size_t) movement];
+    const auto  traversable = getTraversableTile (movement);
+
+    std::vector<TileType> tiles (data.width * data.height, TileType::OutOfBounds);
+
+    for (auto y = 0U; y < data.height; ++y)
+    {
+        const auto row = &mask[y * data.stride];
+
+        for (auto x = 0U; x < data.width; ++x)
+        {
+            if ((row[x / 32] & (1U << (x % 32))) == 0)
+            {
+                tiles[x + y * data.width] = traversable;
+            }
+        }
+    }
+
+    return tiles;
+}
+
+
+TileType LevelPyramid::getTraversableTile (const MovementClass movement)
+{
+    return movement == MovementClass::Water ? TileType::Water : TileType::Terrain;
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+void LevelPyramid::buildFirstLevel (const LevelData& data)
+{
+    const auto width  = data.getWidth(),
+               height = data.getHeight();
+
+    Level level { };
+    level.width  = (width + 1) / 2;
+    level.height = (height + 1) / 2;
+    level.stride = (level.width + 31) / 32;
+
+    // Checks whether a tile is blocked, anything outside of the level is.
+    const auto blocked = [&] (const unsigned int* const row, const unsigned int x)
+    {
+        return !row || x >= width || (row[x / 32] & (1U << (x % 32))) == 0;
+    };
+
+    for (auto movement = 0U; movement < movementClasses; ++movement)
+    {
+        auto& anyBlocked = level.anyBlocked[movement];
+        auto& allBlocked = level.allBlocked[movement];
+
+        anyBlocked.resize (level.stride * level.height);
+        allBlocked.resize (level.stride * level.height);
+
+        for (auto y = 0U; y < level.height; ++y)
+        {
+            // The masks of LevelData contain traversable tiles rather than blocked ones.
+            const auto top    = data.getMaskRow (y * 2, (MovementClass) movement);
+            const auto bottom = y * 2 + 1 < height ? data.getMaskRow (y * 2 + 1, (MovementClass) movement) : nullptr;
+
+            for (auto x = 0U; x < level.width; ++x)
+            {
+                const auto a = blocked (top, x * 2), b = blocked (top, x * 2 + 1),
+                           c = blocked (bottom, x * 2), d = blocked (bottom, x * 2 + 1);
+
+                const auto bit = 1U << (x % 32);
+
+                if (a || b || c || d)
+                {
+                    anyBlocked[y * level.stride + x / 32] |= bit;
+                }
+
+                if (a && b && c && d)
+                {
+                    allBlocked[y * level.stride + x / 32] |= bit;
+                }
+            }
+        }
+    }
+
+    m_levels.push_back (std::move (level));
+}
+
+
+void LevelPyramid::buildNextLevel()
+{
+    const auto& previous = m_levels.back();
+
+    Level level { };
+    level.width  = (previous.width + 1) / 2;
+    level.height = (previous.height + 1) / 2;
+    level.stride = (level.width + 31) / 32;
+
+    // Checks whether a cell of the previous level is blocked, anything outside of the level is.
+    const auto blocked = [&] (const std::vector<unsigned int>& mask, const unsigned int x, const unsigned int y)
+    {
+        return x >= previous.width || y >= previous.height || (mask[y * previous.stride + x / 32] & (1U << (x % 32))) != 0;
+    };
+
+    for (auto movement = 0U; movement < movementClasses; ++movement)
+    {
+        const auto& previousAny = previous.anyBlocked[movement];
+        const auto& previousAll = previous.allBlocked[movement];
+
+        auto& anyBlocked = level.anyBlocked[movement];
+        auto& allBlocked = level.allBlocked[movement];
+
+        anyBlocked.resize (level.stride * level.height);
+        allBlocked.resize (level.stride * level.height);
+
+        for (auto y = 0U; y < level.height; ++y)
+        {
+            for (auto x = 0U; x < level.width; ++x)
+            {
+                const auto bit = 1U << (x % 32);
+                const auto px  = x * 2, py = y * 2;
+
+                if (blocked (previousAny, px, py) || blocked (previousAny, px + 1, py) ||
+                    blocked (previousAny, px, py + 1) || blocked (previousAny, px + 1, py + 1))
+                {
+                    anyBlocked[y * level.stride + x / 32] |= bit;
+                }
+
+                if (blocked (previousAll, px, py) && blocked (previousAll, px + 1, py) &&
+                    blocked (previousAll, px, py + 1) && blocked (previousAll, px + 1, py + 1))
+                {
+                    allBlocked[y * level.stride + x / 32] |= bit;
+                }
+            }
+        }
+    }
+
+    m_levels.push_back (std::move (level));
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifndef GEC_LEVEL_PYRAMID_HPP
+#define GEC_LEVEL_PYRAMID_HPP
+
+
+// STL headers.
+#include <array>
+#include <cstddef>
+#include <vector>
+
+
+// Forward declarations.
+class LevelData;
+enum class MovementClass : char;
+enum class TileType : char;
+
+
+/// <summary>
+/// How the tiles covered by a coarse cell are combined when deciding whether the cell is blocked.
+/// </summary>
+enum class PyramidMode : char
+{
+    AnyBlocked,     //!< A cell is blocked if any tile it covers is blocked, anything found to be traversable definitely is.
+    AllBlocked      //!< A cell is blocked only if every tile it covers is blocked, anything found to be blocked definitely is.
+};
+
+
+/// <summary>
+/// A mip-style pyramid of the traversability of a level. Each level halves the width and height of the previous one so
+/// each cell of level K covers a square of 2^K tiles, level zero being the tiles themselves. Every level is kept for each
+/// movement class in both a conservative and an optimistic form, allowing planners to search a much smaller space first.
+/// </summary>
+class LevelPyramid final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Builds the pyramid from the traversability masks of the given level. </summary>
+        /// <param name="data"> The level to build from. </param>
+        /// <param name="levels"> The number of levels above the tiles, zero keeps halving until the level is small. </param>
+        LevelPyramid (const LevelData& data, const unsigned int levels = 0U);
+
+        LevelPyramid (LevelPyramid&& move);
+        LevelPyramid& operator= (LevelPyramid&& move);
+
+        LevelPyramid (const LevelPyramid& copy)               = default;
+        LevelPyramid& operator= (const LevelPyramid& copy)    = default;
+        ~LevelPyramid()                                       = default;
+
+
+        /////////////
+        // Getters //
+        /////////////
+
+        /// <summary> Gets the number of levels in the pyramid, including level zero. </summary>
+        unsigned int getLevelCount() const                  { return m_levels.size(); }
+
+        /// <summary> Gets the width of the given level in cells. </summary>
+        unsigned int getWidth (const unsigned int level) const;
+
+        /// <summary> Gets the height of the given level in cells. </summary>
+        unsigned int getHeight (const unsigned int level) const;
+
+        /// <summary> Gets the number of bytes used to store the pyramid. </summary>
+        std::size_t getStorageBytes() const;
+
+        /// <summary> Checks whether a cell of the given level is blocked. </summary>
+        /// <param name="level"> The level to check. </param>
+        /// <param name="x"> The X co-ordinate of the cell. </param>
+        /// <param name="y"> The Y co-ordinate of the cell. </param>
+        /// <param name="movement"> The movement class being used. </param>
+        /// <param name="mode"> Which form of the level to check. </param>
+        bool isBlocked (const unsigned int level, const unsigned int x, const unsigned int y, const MovementClass movement,
+                        const PyramidMode mode) const;
+
+        /// <summary>
+        /// Creates tiles for a level of the pyramid which can be used to construct a LevelData object. Traversable cells
+        /// become a tile which the movement class can traverse and blocked cells become TileType::OutOfBounds.
+        /// </summary>
+        /// <param name="level"> The level to create tiles for, this must be above zero. </param>
+        /// <param name="movement"> The movement class being used. </param>
+        /// <param name="mode"> Which form of the level to use. </param>
+        /// <returns> getWidth (level) * getHeight (level) tiles, row by row. </returns>
+        std::vector<TileType> createTiles (const unsigned int level, const MovementClass movement, const PyramidMode mode) const;
+
+        /// <summary> Gets the tile created by createTiles() for traversable cells of the given movement class. </summary>
+        static TileType getTraversableTile (const MovementClass movement);
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> The number of movement classes each level is built for. </summary>
+        static const unsigned int movementClasses = 3;
+
+        /// <summary> One level of the pyramid, each mask sets bit (x % 32) of word (x / 32) in a row if a cell is blocked. </summary>
+        struct Level final
+        {
+            unsigned int                                            width       { 0 };  //!< The width of the level in cells.
+            unsigned int                                            height      { 0 };  //!< The height of the level in cells.
+            unsigned int                                            stride      { 0 };  //!< The number of words in each row.
+            std::array<std::vector<unsigned int>, movementClasses>  anyBlocked  { };    //!< The conservative form of each movement class.
+            std::array<std::vector<unsigned int>, movementClasses>  allBlocked  { };    //!< The optimistic form of each movement class.
+        };
+
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Builds the first level above the tiles from the traversability masks of the level. </summary>
+        void buildFirstLevel (const LevelData& data);
+
+        /// <summary> Builds the next level from the current top level of the pyramid. </summary>
+        void buildNextLevel();
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::vector<Level>  m_levels    { };    //!< Every level of the pyramid, level zero only stores its dimensions.
+};
+
+#endif
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "LevelViewer.hpp"
 
 
+// STL headers.
+#include <cassert>
+
+
 // Application headers.
 #include <Level/LevelData.hpp>
 
@@ -32,8 +36,14 @@ LevelViewer& LevelViewer::operator= (LevelViewer&& move)
     if (this != &move)
     {
         // Move our data.
-        m_view  = std::move (move.m_view);
-        m_scale = std::move (move.m_scale);
+        m_view          = std::move (move.m_view);
+        m_scale         = std::move (move.m_scale);
+        m_memory        = std::move (move.m_memory);
+        m_overlay       = std::move (move.m_overlay);
+        m_overlayCell   = move.m_overlayCell;
+        m_overlayMemory = std::move (move.m_overlayMemory);
+
+        move.m_overlayCell = 0;
     }
 
     return *this;
@@ -60,8 +70,38 @@ void LevelViewer::createView (const LevelData& data)
         }
     }
 
-    // Update the texture with our new image.
+    // Update the texture with our new image, textures are stored as 32-bit RGBA.
     m_view.loadFromImage (image);
+    m_memory.setBytes ((size_t) m_view.getSize().x * m_view.getSize().y * 4);
+}
+
+
+void LevelViewer::setOverlay (const sf::Image& image, const unsigned int cellSize)
+{
+    // Pre-condition: Each pixel covers at least a tile.
+    assert (cellSize > 0);
+
+    // Reuse the texture when the size is unchanged, overlays are usually refreshed many times.
+    if (m_overlay.getSize() == image.getSize())
+    {
+        m_overlay.update (image);
+    }
+
+    else
+    {
+        m_overlay.loadFromImage (image);
+    }
+
+    m_overlayCell = cellSize;
+    m_overlayMemory.setBytes ((size_t) m_overlay.getSize().x * m_overlay.getSize().y * 4);
+}
+
+
+void LevelViewer::clearOverlay()
+{
+    m_overlay       = sf::Texture();
+    m_overlayCell   = 0;
+    m_overlayMemory.setBytes (0);
 }
 
 
@@ -112,4 +152,13 @@ void LevelViewer::draw (sf::RenderTarget& drawTo)
 
     sprite.setScale (m_scale);
     drawTo.draw (sprite);
+
+    // Each pixel of the overlay covers a whole cell of tiles.
+    if (m_overlayCell != 0)
+    {
+        sf::Sprite overlay { m_overlay };
+
+        overlay.setScale (m_scale * (float) m_overlayCell);
+        drawTo.draw (overlay);
+    }
 }
\ No newline at end of file
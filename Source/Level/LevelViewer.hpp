@@ -2,6 +2,10 @@
 #define GEC_LEVEL_VIEWER_HPP
 
 
+// Application headers.
+#include <Utility/MemoryTracker.hpp>
+
+
 // External headers.
 #include <SFML/Graphics/Texture.hpp>
 
@@ -52,6 +56,17 @@ class LevelViewer final
         /// <param name="data"> The data to create a visualisation for. </param>
         void createView (const LevelData& data);
 
+        /// <summary> Draws an image over the level, such as a heatmap, replacing any previous overlay. </summary>
+        /// <param name="image"> The overlay, each pixel covers a square of tiles starting from the top-left of the level. </param>
+        /// <param name="cellSize"> The width and height in tiles covered by each pixel. </param>
+        void setOverlay (const sf::Image& image, const unsigned int cellSize = 1U);
+
+        /// <summary> Removes the overlay and frees its texture. </summary>
+        void clearOverlay();
+
+        /// <summary> Checks whether an overlay is being drawn. </summary>
+        bool hasOverlay() const                     { return m_overlayCell != 0; }
+
         
         //////////////////////
         // Game integration //
@@ -72,8 +87,13 @@ class LevelViewer final
         // Internal data //
         ///////////////////
 
-        sf::Texture     m_view  { };        //!< The visual representation of the given LevelData object.
-        sf::Vector2f    m_scale { 1, 1 };   //!< The scale to use when displaying the LevelData object.
+        sf::Texture     m_view      { };        //!< The visual representation of the given LevelData object.
+        sf::Vector2f    m_scale     { 1, 1 };   //!< The scale to use when displaying the LevelData object.
+        TrackedMemory   m_memory    { MemorySubsystem::ViewerTextures };  //!< Counts the texture, which lives in video memory.
+
+        sf::Texture     m_overlay           { };    //!< Drawn over the level when there is one.
+        unsigned int    m_overlayCell       { 0 };  //!< The tiles covered by each pixel of the overlay, zero without an overlay.
+        TrackedMemory   m_overlayMemory     { MemorySubsystem::ViewerTextures };  //!< Counts the overlay texture.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "TileHeatmap.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ostream>
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+TileHeatmap::TileHeatmap (const unsigned int width, const unsigned int height, const unsigned int cellShift)
+    : m_width (width), m_height (height), m_cellShift (cellShift)
+{
+    // Pre-condition: The level isn't empty and a cell fits within an int.
+    assert (width > 0 && height > 0 && cellShift < 16);
+
+    const auto cellSize = 1U << cellShift;
+
+    m_columns   = (width + cellSize - 1) / cellSize;
+    m_rows      = (height + cellSize - 1) / cellSize;
+    m_cellCount = (size_t) m_columns * m_rows;
+
+    const auto counters = m_cellCount * (size_t) HeatmapCounter::Count;
+
+    m_cells.reset (new std::atomic<std::uint32_t>[counters]);
+    m_memory.setBytes (counters * sizeof (std::atomic<std::uint32_t>));
+
+    clear();
+}
+
+
+/////////////
+// Getters //
+/////////////
+
+std::uint32_t TileHeatmap::getCount (const HeatmapCounter counter, const unsigned int column, const unsigned int row) const
+{
+    // Pre-condition: The cell exists.
+    assert (counter < HeatmapCounter::Count && column < m_columns && row < m_rows);
+
+    return m_cells[(size_t) counter * m_cellCount + column + row * (size_t) m_columns].load (std::memory_order_relaxed);
+}
+
+
+std::uint32_t TileHeatmap::getMaximum (const HeatmapCounter counter) const
+{
+    const auto first   = (size_t) counter * m_cellCount;
+    auto       maximum = std::uint32_t (0);
+
+    for (auto i = first; i < first + m_cellCount; ++i)
+    {
+        maximum = std::max (maximum, m_cells[i].load (std::memory_order_relaxed));
+    }
+
+    return maximum;
+}
+
+
+std::uint64_t TileHeatmap::getTotal (const HeatmapCounter counter) const
+{
+    const auto first = (size_t) counter * m_cellCount;
+    auto       total = std::uint64_t (0);
+
+    for (auto i = first; i < first + m_cellCount; ++i)
+    {
+        total += m_cells[i].load (std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+
+const char* TileHeatmap::getName (const HeatmapCounter counter)
+{
+    switch (counter)
+    {
+        case HeatmapCounter::Samples:           return "samples";
+        case HeatmapCounter::CollisionChecks:   return "collision_checks";
+        case HeatmapCounter::FailedExtensions:  return "failed_extensions";
+        default:                                return "unknown";
+    }
+}
+
+
+///////////////
+// Recording //
+///////////////
+
+void TileHeatmap::clear()
+{
+    const auto counters = m_cellCount * (size_t) HeatmapCounter::Count;
+
+    for (auto i = size_t (0); i < counters; ++i)
+    {
+        m_cells[i].store (0, std::memory_order_relaxed);
+    }
+}
+
+
+///////////////
+// Exporting //
+///////////////
+
+sf::Image TileHeatmap::createImage (const HeatmapCounter counter) const
+{
+    auto image = sf::Image();
+    image.create (m_columns, m_rows, sf::Color::Transparent);
+
+    // Effort tends to be spread over orders of magnitude so a linear scale would only show the very hottest cells.
+    const auto maximum = getMaximum (counter);
+
+    if (maximum == 0)
+    {
+        return image;
+    }
+
+    const auto scale = 1.f / std::log (1.f + maximum);
+
+    for (auto row = 0U; row < m_rows; ++row)
+    {
+        for (auto column = 0U; column < m_columns; ++column)
+        {
+            const auto count = getCount (counter, column, row);
+
+            if (count == 0)
+            {
+                continue;
+            }
+
+            // Blue to red over the lower half, red to yellow over the upper half, fading in as it gets hotter.
+            const auto heat  = std::log (1.f + count) * scale;
+            const auto lower = std::min (heat * 2.f, 1.f),
+                       upper = std::max (heat * 2.f - 1.f, 0.f);
+
+            const auto colour = sf::Color ((sf::Uint8) (255 * lower), (sf::Uint8) (255 * upper), (sf::Uint8) (255 * (1.f - lower)),
+                                           (sf::Uint8) (96 + 159 * heat));
+
+            image.setPixel (column, row, colour);
+        }
+    }
+
+    return image;
+}
+
+
+void TileHeatmap::writeCsv (std::ostream& stream) const
+{
+    const auto counters = (unsigned int) HeatmapCounter::Count;
+
+    stream << "x,y";
+
+    for (auto counter = 0U; counter < counters; ++counter)
+    {
+        stream << "," << getName ((HeatmapCounter) counter);
+    }
+
+    stream << "\n";
+
+    for (auto row = 0U; row < m_rows; ++row)
+    {
+        for (auto column = 0U; column < m_columns; ++column)
+        {
+            auto counts = std::array<std::uint32_t, (size_t) HeatmapCounter::Count> { };
+            auto any    = false;
+
+            for (auto counter = 0U; counter < counters; ++counter)
+            {
+                counts[counter] = getCount ((HeatmapCounter) counter, column, row);
+                any            |= counts[counter] != 0;
+            }
+
+            if (!any)
+            {
+                continue;
+            }
+
+            stream << (column << m_cellShift) << "," << (row << m_cellShift);
+
+            for (const auto count : counts)
+            {
+                stream << "," << count;
+            }
+
+            stream << "\n";
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef GEC_TILE_HEATMAP_HPP
+#define GEC_TILE_HEATMAP_HPP
+
+
+// STL headers.
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+
+
+// Application headers.
+#include <Utility/MemoryTracker.hpp>
+
+
+// External headers.
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Vector2.hpp>
+
+
+/// <summary>
+/// The kinds of planner effort which are counted per tile.
+/// </summary>
+enum class HeatmapCounter : char
+{
+    Samples,            //!< Random samples drawn, including those rejected before any collision detection.
+    CollisionChecks,    //!< Tiles tested whilst stepping along a branch.
+    FailedExtensions,   //!< Attempts to grow a branch which didn't add a node, counted at the node grown from.
+    Count               //!< The number of counters.
+};
+
+
+/// <summary>
+/// Counts where a planner spends its effort, with a counter of each kind for every cell of a level. A cell is a single
+/// tile by default, huge levels can group tiles into larger square cells to keep the counters small. Counters are
+/// atomic so trees growing in parallel can share a heatmap, each record is a single relaxed increment.
+/// </summary>
+class TileHeatmap final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates an empty heatmap covering a level. </summary>
+        /// <param name="width"> The width of the level in tiles. </param>
+        /// <param name="height"> The height of the level in tiles. </param>
+        /// <param name="cellShift"> Each cell covers (1 << cellShift) tiles in both directions. </param>
+        TileHeatmap (const unsigned int width, const unsigned int height, const unsigned int cellShift = 0U);
+
+        TileHeatmap (TileHeatmap&& move)                    = delete;
+        TileHeatmap& operator= (TileHeatmap&& move)         = delete;
+        TileHeatmap (const TileHeatmap& copy)               = delete;
+        TileHeatmap& operator= (const TileHeatmap& copy)    = delete;
+        ~TileHeatmap()                                      = default;
+
+
+        /////////////
+        // Getters //
+        /////////////
+
+        /// <summary> Gets the width of the level in tiles. </summary>
+        unsigned int getWidth() const       { return m_width; }
+
+        /// <summary> Gets the height of the level in tiles. </summary>
+        unsigned int getHeight() const      { return m_height; }
+
+        /// <summary> Gets the width and height of each cell in tiles. </summary>
+        unsigned int getCellSize() const    { return 1U << m_cellShift; }
+
+        /// <summary> Gets how many cells make up each row. </summary>
+        unsigned int getColumns() const     { return m_columns; }
+
+        /// <summary> Gets how many rows of cells there are. </summary>
+        unsigned int getRows() const        { return m_rows; }
+
+        /// <summary> Gets a counter of the cell at the given column and row. </summary>
+        std::uint32_t getCount (const HeatmapCounter counter, const unsigned int column, const unsigned int row) const;
+
+        /// <summary> Gets the highest value of a counter across every cell. </summary>
+        std::uint32_t getMaximum (const HeatmapCounter counter) const;
+
+        /// <summary> Gets the sum of a counter across every cell. </summary>
+        std::uint64_t getTotal (const HeatmapCounter counter) const;
+
+        /// <summary> Gets the name of a counter as used in exported files. </summary>
+        static const char* getName (const HeatmapCounter counter);
+
+
+        ///////////////
+        // Recording //
+        ///////////////
+
+        /// <summary> Counts effort at the given tile, which must lie on the level. </summary>
+        void record (const HeatmapCounter counter, const sf::Vector2i& position)
+        {
+            obtainCell (counter, position).fetch_add (1, std::memory_order_relaxed);
+        }
+
+        /// <summary> Resets every counter to zero, this isn't safe whilst anything is recording. </summary>
+        void clear();
+
+
+        ///////////////
+        // Exporting //
+        ///////////////
+
+        /// <summary>
+        /// Creates an image with a pixel per cell showing a counter. Counts are shaded on a logarithmic scale from
+        /// transparent blue through red to opaque yellow at the maximum, so the image can be drawn over the level.
+        /// </summary>
+        sf::Image createImage (const HeatmapCounter counter) const;
+
+        /// <summary> Writes every cell with a non-zero counter as CSV, positions are the tile at the top-left of the cell. </summary>
+        void writeCsv (std::ostream& stream) const;
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Gets the counter of the cell containing the given tile. </summary>
+        std::atomic<std::uint32_t>& obtainCell (const HeatmapCounter counter, const sf::Vector2i& position)
+        {
+            // Pre-condition: The tile is on the level.
+            assert (position.x >= 0 && position.x < (int) m_width && position.y >= 0 && position.y < (int) m_height);
+
+            return m_cells[(size_t) counter * m_cellCount + (position.x >> m_cellShift) + (size_t) (position.y >> m_cellShift) * m_columns];
+        }
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int                                    m_width     { 0 };      //!< The width of the level in tiles.
+        unsigned int                                    m_height    { 0 };      //!< The height of the level in tiles.
+        unsigned int                                    m_cellShift { 0 };      //!< The log2 of the cell size.
+        unsigned int                                    m_columns   { 0 };      //!< The number of cells in each row.
+        unsigned int                                    m_rows      { 0 };      //!< The number of rows of cells.
+        size_t                                          m_cellCount { 0 };      //!< The number of cells per counter.
+        std::unique_ptr<std::atomic<std::uint32_t>[]>   m_cells     { };        //!< Every counter of every cell, one array per counter.
+        TrackedMemory                                   m_memory    { MemorySubsystem::Heatmap };   //!< Counts the counters.
+};
+
+#endif
\ No newline at end of file
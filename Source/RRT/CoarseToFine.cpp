@@ -0,0 +1,290 @@
+#include "CoarseToFine.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <utility>
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+#include <RRT/RRT.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+CoarseToFine::CoarseToFine (const std::shared_ptr<LevelData>& data, const unsigned int levels)
+    : m_data (data), m_pyramid (*data, levels)
+{
+}
+
+
+CoarseToFine::CoarseToFine (CoarseToFine&& move)
+    : m_data (std::move (move.m_data)), m_pyramid (std::move (move.m_pyramid)), m_movement (move.m_movement), 
+      m_path (std::move (move.m_path)), m_iterations (move.m_iterations), m_coarseLevel (move.m_coarseLevel), 
+      m_iterationLimit (move.m_iterationLimit), m_stallLimit (move.m_stallLimit), m_corridorMargin (move.m_corridorMargin)
+{
+    // The pyramid has no empty state to start from so every member is moved here rather than through operator=.
+    move.m_iterations  = 0;
+    move.m_coarseLevel = 0;
+}
+
+
+CoarseToFine& CoarseToFine::operator= (CoarseToFine&& move)
+{
+    if (this != &move)
+    {
+        m_data              = std::move (move.m_data);
+        m_pyramid           = std::move (move.m_pyramid);
+        m_movement          = move.m_movement;
+        m_path              = std::move (move.m_path);
+        m_iterations        = move.m_iterations;
+        m_coarseLevel       = move.m_coarseLevel;
+        m_iterationLimit    = move.m_iterationLimit;
+        m_stallLimit        = move.m_stallLimit;
+        m_corridorMargin    = move.m_corridorMargin;
+
+        move.m_iterations   = 0;
+        move.m_coarseLevel  = 0;
+    }
+
+    return *this;
+}
+
+
+//////////////
+// Planning //
+//////////////
+
+bool CoarseToFine::plan (const sf::Vector2i& start, const sf::Vector2i& end)
+{
+    // Pre-condition: This hasn't been moved from.
+    assert (m_data && m_pyramid.getLevelCount() > 0);
+
+    m_path.clear();
+    m_iterations  = 0;
+    m_coarseLevel = 0;
+    m_movement    = LevelData::determineMovementClass (m_data->getTile ((unsigned int) start.x, (unsigned int) start.y));
+
+    // There's no point searching any level if the tiles themselves aren't connected.
+    const auto width = m_data->getWidth();
+
+    if (!m_data->sameRegion (start.x + start.y * width, end.x + end.y * width, m_movement))
+    {
+        return false;
+    }
+
+    // Find a path on the coarsest level we can.
+    auto level = m_pyramid.getLevelCount() - 1;
+    auto path  = std::vector<sf::Vector2i> { };
+
+    for (; level > 0; --level)
+    {
+        path = planCoarse (level, start, end, nullptr);
+
+        if (!path.empty())
+        {
+            break;
+        }
+    }
+
+    m_coarseLevel = level;
+
+    // Refine the path one level at a time, each level only searches around the path of the level above. The corridor
+    // is widened if the path can't be refined inside it.
+    for (; level > 0 && !path.empty(); --level)
+    {
+        auto found = std::vector<sf::Vector2i> { };
+
+        for (auto margin = m_corridorMargin; found.empty() && margin <= m_corridorMargin * 4 + 3; margin = margin * 2 + 1)
+        {
+            const auto corridor = buildCorridor (path, level, margin);
+            found = planCoarse (level - 1, start, end, &corridor);
+        }
+
+        path = std::move (found);
+    }
+
+    // As a last resort plan freely on the level itself.
+    if (path.empty())
+    {
+        path = planLevel (0, PyramidMode::AnyBlocked, start, end, nullptr);
+    }
+
+    m_path = std::move (path);
+
+    return !m_path.empty();
+}
+
+
+std::vector<sf::Vector2i> CoarseToFine::planCoarse (const unsigned int level, const sf::Vector2i& start, const sf::Vector2i& end,
+                                                    const Corridor* const corridor)
+{
+    // The original level only has one form.
+    if (level == 0)
+    {
+        return planLevel (0, PyramidMode::AnyBlocked, start, end, corridor);
+    }
+
+    // The conservative form is tried first because everything it considers traversable really is. It often splits
+    // regions apart on the coarsest levels, that's detected straight away and the optimistic form is used instead.
+    auto path = planLevel (level, PyramidMode::AnyBlocked, start, end, corridor);
+
+    if (path.empty())
+    {
+        path = planLevel (level, PyramidMode::AllBlocked, start, end, corridor);
+    }
+
+    return path;
+}
+
+
+std::shared_ptr<LevelData> CoarseToFine::createLevel (const unsigned int level, const PyramidMode mode, const sf::Vector2i& start,
+                                                      const sf::Vector2i& end) const
+{
+    if (level == 0)
+    {
+        return m_data;
+    }
+
+    const auto width = m_pyramid.getWidth (level);
+    auto       tiles = m_pyramid.createTiles (level, m_movement, mode);
+
+    // The cells containing the start and end must be traversable otherwise the conservative form could never be used.
+    const auto traversable = LevelPyramid::getTraversableTile (m_movement);
+
+    tiles[(start.x >> level) + (start.y >> level) * width] = traversable;
+    tiles[(end.x >> level) + (end.y >> level) * width]     = traversable;
+
+    return std::make_shared<LevelData> (width, m_pyramid.getHeight (level), std::move (tiles));
+}
+
+
+std::vector<sf::Vector2i> CoarseToFine::planLevel (const unsigned int level, const PyramidMode mode, const sf::Vector2i& start,
+                                                   const sf::Vector2i& end, const Corridor* const corridor)
+{
+    const auto data = createLevel (level, mode, start, end);
+
+    RRT rrt { };
+
+    if (corridor)
+    {
+        rrt.setCorridor (corridor->bounds, 2, corridor->cells);
+    }
+
+    rrt.prepareTree (data, sf::Vector2i (start.x >> level, start.y >> level), sf::Vector2i (end.x >> level, end.y >> level));
+
+    // Regions tell us straight away if the path is impossible on this level.
+    if (!rrt.isReachable())
+    {
+        return { };
+    }
+
+    // Corridors and coarse levels can leave the tree boxed in, give up once it stops growing. Only the iteration limit
+    // applies when planning freely on the level itself because there's nothing left to fall back to.
+    const auto patience = corridor || level > 0 ? m_stallLimit : m_iterationLimit;
+
+    auto nodes = rrt.getNodeCount(),
+         stall = 0U;
+
+    for (auto i = 0U; i < m_iterationLimit && stall < patience && !rrt.hasFinished(); ++i)
+    {
+        rrt.generateBranch();
+        ++m_iterations;
+
+        const auto count = rrt.getNodeCount();
+        stall = count == nodes ? stall + 1 : 0;
+        nodes = count;
+    }
+
+    return rrt.getPath();
+}
+
+
+CoarseToFine::Corridor CoarseToFine::buildCorridor (const std::vector<sf::Vector2i>& path, const unsigned int level,
+                                                    const unsigned int margin) const
+{
+    // Pre-condition: There's a level below the path.
+    assert (level > 0 && !path.empty());
+
+    const auto width  = (int) m_pyramid.getWidth (level),
+               height = (int) m_pyramid.getHeight (level),
+               extra  = (int) margin;
+
+    // Find the area covered by the path and its margin.
+    auto minimum = path.front(),
+         maximum = path.front();
+
+    for (const auto& point : path)
+    {
+        minimum = sf::Vector2i (std::min (minimum.x, point.x), std::min (minimum.y, point.y));
+        maximum = sf::Vector2i (std::max (maximum.x, point.x), std::max (maximum.y, point.y));
+    }
+
+    minimum = sf::Vector2i (std::max (0, minimum.x - extra), std::max (0, minimum.y - extra));
+    maximum = sf::Vector2i (std::min (width - 1, maximum.x + extra), std::min (height - 1, maximum.y + extra));
+
+    // Each coarse cell covers two tiles of the finer level in each direction.
+    const auto fineWidth  = (int) m_pyramid.getWidth (level - 1),
+               fineHeight = (int) m_pyramid.getHeight (level - 1);
+    const auto cells      = maximum - minimum + sf::Vector2i (1, 1);
+
+    Corridor corridor { };
+    corridor.bounds = sf::IntRect (minimum.x * 2, minimum.y * 2,
+                                   std::min (fineWidth, (maximum.x + 1) * 2) - minimum.x * 2,
+                                   std::min (fineHeight, (maximum.y + 1) * 2) - minimum.y * 2);
+    corridor.cells.resize (cells.x * cells.y);
+
+    // Marks every cell within the margin of the given cell.
+    const auto mark = [&] (const sf::Vector2i& cell)
+    {
+        const auto left   = std::max (minimum.x, cell.x - extra), right  = std::min (maximum.x, cell.x + extra),
+                   top    = std::max (minimum.y, cell.y - extra), bottom = std::min (maximum.y, cell.y + extra);
+
+        for (auto y = top; y <= bottom; ++y)
+        {
+            for (auto x = left; x <= right; ++x)
+            {
+                corridor.cells[(x - minimum.x) + (y - minimum.y) * cells.x] = true;
+            }
+        }
+    };
+
+    // Walk each segment of the path cell by cell.
+    mark (path.front());
+
+    for (auto i = 1U; i < path.size(); ++i)
+    {
+        auto       current    = path[i - 1];
+        const auto target     = path[i];
+        const auto difference = sf::Vector2i (std::abs (target.x - current.x), -std::abs (target.y - current.y));
+        const auto step       = sf::Vector2i (current.x < target.x ? 1 : -1, current.y < target.y ? 1 : -1);
+        auto       error      = difference.x + difference.y;
+
+        while (current != target)
+        {
+            const auto doubled = error * 2;
+
+            if (doubled >= difference.y)
+            {
+                error     += difference.y;
+                current.x += step.x;
+            }
+
+            if (doubled <= difference.x)
+            {
+                error     += difference.x;
+                current.y += step.y;
+            }
+
+            mark (current);
+        }
+    }
+
+    return corridor;
+}
\ No newline at end of file
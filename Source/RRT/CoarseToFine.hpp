@@ -0,0 +1,144 @@
+#ifndef GEC_COARSE_TO_FINE_HPP
+#define GEC_COARSE_TO_FINE_HPP
+
+
+// STL headers.
+#include <memory>
+#include <vector>
+
+
+// Application headers.
+#include <Level/LevelPyramid.hpp>
+
+
+// External headers.
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+
+// Forward declarations.
+class LevelData;
+class RRT;
+
+
+/// <summary>
+/// A planner which runs RRT on a coarse level of a LevelPyramid first, then refines the path one level at a time with
+/// each RRT only allowed to sample inside the corridor found by the level above it. Each coarse level shrinks the sample
+/// space by a factor of four so long-range queries on large levels become much cheaper.
+/// </summary>
+class CoarseToFine final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Builds the pyramid used for planning across the given level. </summary>
+        /// <param name="data"> The level to plan across. </param>
+        /// <param name="levels"> The number of coarse levels to build, zero picks a number based on the level size. </param>
+        CoarseToFine (const std::shared_ptr<LevelData>& data, const unsigned int levels = 0U);
+
+        CoarseToFine (CoarseToFine&& move);
+        CoarseToFine& operator= (CoarseToFine&& move);
+
+        CoarseToFine (const CoarseToFine& copy)             = default;
+        CoarseToFine& operator= (const CoarseToFine& copy)  = default;
+        ~CoarseToFine()                                     = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the pyramid built over the level. </summary>
+        const LevelPyramid& getPyramid() const              { return m_pyramid; }
+
+        /// <summary> Gets the path found by the last call to plan(), empty if no path was found. </summary>
+        const std::vector<sf::Vector2i>& getPath() const    { return m_path; }
+
+        /// <summary> Gets the total number of RRT iterations used by the last call to plan(). </summary>
+        unsigned int getIterations() const                  { return m_iterations; }
+
+        /// <summary> Gets the pyramid level the last successful coarse search was performed on. </summary>
+        unsigned int getCoarseLevel() const                 { return m_coarseLevel; }
+
+        /// <summary> Sets how many iterations each RRT is allowed before it's considered to have failed. </summary>
+        void setIterationLimit (const unsigned int limit)   { m_iterationLimit = limit; }
+
+        /// <summary> Sets how many iterations in a row an RRT can fail to grow before it's considered to be stuck. </summary>
+        void setStallLimit (const unsigned int limit)       { m_stallLimit = limit; }
+
+        /// <summary> Sets how many coarse cells either side of a path are included in the corridor of the level below. </summary>
+        void setCorridorMargin (const unsigned int margin)  { m_corridorMargin = margin; }
+
+
+        //////////////
+        // Planning //
+        //////////////
+
+        /// <summary> Finds a path between two tiles of the level. </summary>
+        /// <param name="start"> The tile to start from. </param>
+        /// <param name="end"> The tile to finish at. </param>
+        /// <returns> Whether a path was found, it can be obtained with getPath(). </returns>
+        bool plan (const sf::Vector2i& start, const sf::Vector2i& end);
+
+    private:
+
+        /// <summary> A corridor of cells for RRT::setCorridor(). </summary>
+        struct Corridor final
+        {
+            sf::IntRect         bounds  { };    //!< The area covered in tiles of the finer level.
+            std::vector<bool>   cells   { };    //!< Whether each cell is part of the corridor.
+        };
+
+        /// <summary> Creates the level used to plan on the given level of the pyramid. </summary>
+        /// <param name="level"> The pyramid level, zero is the original level. </param>
+        /// <param name="mode"> Which form of the pyramid to use. </param>
+        /// <param name="start"> The original start tile, this is always made traversable. </param>
+        /// <param name="end"> The original end tile, this is always made traversable. </param>
+        std::shared_ptr<LevelData> createLevel (const unsigned int level, const PyramidMode mode, const sf::Vector2i& start,
+                                                const sf::Vector2i& end) const;
+
+        /// <summary> Plans on a level of the pyramid, trying the conservative form before the optimistic form. </summary>
+        /// <param name="level"> The pyramid level to plan on. </param>
+        /// <param name="start"> The original start tile. </param>
+        /// <param name="end"> The original end tile. </param>
+        /// <param name="corridor"> The corridor to stay inside, nullptr to plan freely. </param>
+        /// <returns> The path in cells of the given level, empty if no path was found. </returns>
+        std::vector<sf::Vector2i> planCoarse (const unsigned int level, const sf::Vector2i& start, const sf::Vector2i& end,
+                                              const Corridor* const corridor);
+
+        /// <summary> Runs RRT on a level of the pyramid until it finds a path or runs out of iterations. </summary>
+        /// <param name="level"> The pyramid level to plan on. </param>
+        /// <param name="mode"> Which form of the pyramid to use. </param>
+        /// <param name="start"> The original start tile. </param>
+        /// <param name="end"> The original end tile. </param>
+        /// <param name="corridor"> The corridor to stay inside, nullptr to plan freely. </param>
+        /// <returns> The path in cells of the given level, empty if no path was found. </returns>
+        std::vector<sf::Vector2i> planLevel (const unsigned int level, const PyramidMode mode, const sf::Vector2i& start,
+                                             const sf::Vector2i& end, const Corridor* const corridor);
+
+        /// <summary> Builds the corridor surrounding a path for the level below the path's level. </summary>
+        /// <param name="path"> The path in cells of the coarse level. </param>
+        /// <param name="level"> The level of the path, this must be above zero. </param>
+        /// <param name="margin"> How many cells either side of the path to include. </param>
+        Corridor buildCorridor (const std::vector<sf::Vector2i>& path, const unsigned int level, const unsigned int margin) const;
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::shared_ptr<LevelData>  m_data              { };            //!< The level being planned across.
+        LevelPyramid                m_pyramid;                          //!< The coarse versions of the level.
+        MovementClass               m_movement          { };            //!< The movement class of the current plan.
+        std::vector<sf::Vector2i>   m_path              { };            //!< The last path found.
+        unsigned int                m_iterations        { 0 };          //!< The iterations used by the last plan.
+        unsigned int                m_coarseLevel       { 0 };          //!< The level the last coarse path was found on.
+        unsigned int                m_iterationLimit    { 200000 };     //!< How many iterations each RRT is allowed.
+        unsigned int                m_stallLimit        { 16384 };      //!< How many iterations an RRT can go without growing.
+        unsigned int                m_corridorMargin    { 2 };          //!< How many cells either side of a path form the corridor.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,636 @@
+#include "PartitionedRRT.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+#include <utility>
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+#include <Utility/TaskGraph.hpp>
+#include <Utility/ThreadPool.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+PartitionedRRT::PartitionedRRT (const std::shared_ptr<ThreadPool>& pool, const unsigned int regionSize, const float sampleDistance,
+                                const float branchDistance)
+    : m_pool (pool), m_regionSize (regionSize), m_sampleDistance (sampleDistance), m_branchDistance (branchDistance)
+{
+    // Pre-condition: A region is larger than a branch so bridges only ever join neighbouring regions.
+    assert (branchDistance >= 1.f && regionSize > (unsigned int) branchDistance);
+}
+
+
+PartitionedRRT::PartitionedRRT (PartitionedRRT&& move)
+{
+    *this = std::move (move);
+}
+
+
+PartitionedRRT& PartitionedRRT::operator= (PartitionedRRT&& move)
+{
+    if (this != &move)
+    {
+        m_pool              = std::move (move.m_pool);
+        m_data              = std::move (move.m_data);
+        m_start             = move.m_start;
+        m_end               = move.m_end;
+        m_movement          = move.m_movement;
+        m_regionSize        = move.m_regionSize;
+        m_sampleDistance    = move.m_sampleDistance;
+        m_branchDistance    = move.m_branchDistance;
+        m_roundLength       = move.m_roundLength;
+        m_roundLimit        = move.m_roundLimit;
+        m_seed              = move.m_seed;
+        m_heatmap           = std::move (move.m_heatmap);
+        m_rounds            = move.m_rounds;
+        m_regions           = std::move (move.m_regions);
+        m_regionColumns     = move.m_regionColumns;
+        m_trees             = std::move (move.m_trees);
+        m_sets              = std::move (move.m_sets);
+        m_bridges           = std::move (move.m_bridges);
+        m_startTree         = move.m_startTree;
+        m_endTree           = move.m_endTree;
+        m_reachable         = move.m_reachable;
+        m_path              = std::move (move.m_path);
+
+        move.m_rounds       = 0;
+        move.m_reachable    = false;
+    }
+
+    return *this;
+}
+
+
+/////////////
+// Getters //
+/////////////
+
+unsigned int PartitionedRRT::getNodeCount() const
+{
+    auto count = 0U;
+
+    for (const auto& tree : m_trees)
+    {
+        count += tree.rrt.getNodeCount();
+    }
+
+    return count;
+}
+
+
+//////////////
+// Planning //
+//////////////
+
+void PartitionedRRT::prepareTree (const std::shared_ptr<LevelData>& data, const sf::Vector2i& start, const sf::Vector2i& end)
+{
+    // Pre-condition: The start and end values are valid.
+    assert (start.x >= 0 && start.y >= 0 && start.x < (int) data->getWidth() && start.y < (int) data->getHeight());
+    assert (end.x >= 0 && end.y >= 0 && end.x < (int) data->getWidth() && end.y < (int) data->getHeight());
+
+    m_data   = data;
+    m_start  = start;
+    m_end    = end;
+    m_rounds = 0;
+
+    m_regions.clear();
+    m_trees.clear();
+    m_sets.clear();
+    m_bridges.clear();
+    m_path.clear();
+
+    // Split the level into regions, those on the right and bottom edges may be smaller than the rest.
+    const auto width  = (int) data->getWidth(),
+               height = (int) data->getHeight(),
+               size   = (int) m_regionSize;
+
+    m_regionColumns = (width + size - 1) / size;
+
+    for (auto y = 0; y < height; y += size)
+    {
+        for (auto x = 0; x < width; x += size)
+        {
+            Region region { };
+            region.bounds = sf::IntRect (x, y, std::min (size, width - x), std::min (size, height - y));
+            m_regions.push_back (std::move (region));
+        }
+    }
+
+    // There's nothing to plan if the end can't be reached.
+    const auto startIndex = start.x + start.y * width,
+               endIndex   = end.x + end.y * width;
+
+    m_movement  = LevelData::determineMovementClass (data->getTile (startIndex));
+    m_reachable = data->sameRegion (startIndex, endIndex, m_movement);
+
+    if (!m_reachable)
+    {
+        return;
+    }
+
+    if (start == end)
+    {
+        m_path.push_back (start);
+        return;
+    }
+
+    // Every tree is given a different seed so regions don't grow in lockstep.
+    const auto seed = m_seed != 0 ? m_seed : std::random_device()();
+
+    // The start and end each root their own tree, even when they share a region. Walls can split a region into parts
+    // which only meet outside of it, so every other part of each region gets a tree of its own too.
+    const auto regionOf = [&] (const sf::Vector2i& position)
+    {
+        return (unsigned int) (position.x / size + (position.y / size) * (int) m_regionColumns);
+    };
+
+    const auto startRegion = regionOf (start),
+               endRegion   = regionOf (end);
+
+    m_trees.reserve (m_regions.size() + 1);
+
+    m_startTree = m_trees.size();
+    addTree (startRegion, start, seed);
+
+    m_endTree = m_trees.size();
+    addTree (endRegion, end, seed);
+
+    for (auto i = 0U; i < m_regions.size(); ++i)
+    {
+        auto planted = std::vector<sf::Vector2i> { };
+
+        if (i == startRegion)
+        {
+            planted.push_back (start);
+        }
+
+        if (i == endRegion)
+        {
+            planted.push_back (end);
+        }
+
+        for (const auto& root : findSeeds (m_regions[i].bounds, planted))
+        {
+            addTree (i, root, seed);
+        }
+    }
+
+    m_sets.resize (m_trees.size());
+
+    for (auto i = 0U; i < m_sets.size(); ++i)
+    {
+        m_sets[i] = i;
+    }
+}
+
+
+void PartitionedRRT::generateRound()
+{
+    if (hasFinished() || isExhausted() || !m_reachable)
+    {
+        return;
+    }
+
+    // Each region only touches its own trees so they can all be grown at once. Every task is added before any are
+    // scheduled because the graph can't grow whilst tasks are running.
+    {
+        TaskGraph                       graph { m_pool.get() };
+        std::vector<TaskGraph::Task>    tasks { };
+
+        for (const auto& region : m_regions)
+        {
+            if (!region.trees.empty())
+            {
+                const auto regionPtr = &region;
+
+                tasks.push_back (graph.addTask ([this, regionPtr] ()
+                {
+                    for (const auto tree : regionPtr->trees)
+                    {
+                        auto& rrt = m_trees[tree].rrt;
+
+                        for (auto i = 0U; i < m_roundLength; ++i)
+                        {
+                            rrt.generateBranch();
+                        }
+                    }
+
+                    gatherCandidates (*regionPtr);
+                }));
+            }
+        }
+
+        for (const auto task : tasks)
+        {
+            graph.schedule (task);
+        }
+
+        graph.awaitScheduled();
+    }
+
+    ++m_rounds;
+
+    // Merge whatever trees can now be joined, once the start and end are in the same set a path exists.
+    exchange();
+
+    if (find (m_startTree) == find (m_endTree))
+    {
+        stitch();
+    }
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+std::vector<sf::Vector2i> PartitionedRRT::findSeeds (const sf::IntRect& bounds, const std::vector<sf::Vector2i>& planted) const
+{
+    const auto width  = (int) m_data->getWidth();
+    const auto region = m_data->getRegion (m_start.x + m_start.y * width, m_movement);
+    const auto centre = sf::Vector2i (bounds.left + bounds.width / 2, bounds.top + bounds.height / 2);
+
+    // Only tiles which are connected to the start are any use.
+    const auto useful = [&] (const int x, const int y)
+    {
+        return m_data->getRegion (x + y * width, m_movement) == region;
+    };
+
+    // Flood each part of the region in turn, tiles are marked as they're queued so each is only visited once.
+    std::vector<bool>         visited ((size_t) (bounds.width * bounds.height), false);
+    std::vector<sf::Vector2i> seeds { };
+    std::queue<sf::Vector2i>  open { };
+
+    const auto visit = [&] (const int x, const int y)
+    {
+        auto&& mark = visited[(x - bounds.left) + (y - bounds.top) * bounds.width];
+
+        if (!mark && useful (x, y))
+        {
+            mark = true;
+            open.emplace (x, y);
+        }
+    };
+
+    for (auto y = bounds.top; y < bounds.top + bounds.height; ++y)
+    {
+        for (auto x = bounds.left; x < bounds.left + bounds.width; ++x)
+        {
+            if (visited[(x - bounds.left) + (y - bounds.top) * bounds.width] || !useful (x, y))
+            {
+                continue;
+            }
+
+            auto seed    = sf::Vector2i (x, y);
+            auto nearest = std::numeric_limits<int>::max();
+            auto rooted  = false;
+
+            visit (x, y);
+
+            while (!open.empty())
+            {
+                const auto tile = open.front();
+                open.pop();
+
+                const auto offset   = tile - centre;
+                const auto distance = offset.x * offset.x + offset.y * offset.y;
+
+                if (distance < nearest)
+                {
+                    seed    = tile;
+                    nearest = distance;
+                }
+
+                rooted = rooted || std::find (planted.cbegin(), planted.cend(), tile) != planted.cend();
+
+                // Movement can be diagonal, the same as when the level labels its regions.
+                for (auto dy = -1; dy <= 1; ++dy)
+                {
+                    for (auto dx = -1; dx <= 1; ++dx)
+                    {
+                        if (bounds.contains (tile.x + dx, tile.y + dy))
+                        {
+                            visit (tile.x + dx, tile.y + dy);
+                        }
+                    }
+                }
+            }
+
+            // Parts containing the start or end already have a tree.
+            if (!rooted)
+            {
+                seeds.push_back (seed);
+            }
+        }
+    }
+
+    return seeds;
+}
+
+
+void PartitionedRRT::addTree (const unsigned int region, const sf::Vector2i& root, const unsigned int seed)
+{
+    const auto index  = (unsigned int) m_trees.size();
+    const auto bounds = m_regions[region].bounds;
+
+    m_trees.emplace_back();
+
+    auto& tree  = m_trees.back();
+    tree.region = region;
+    tree.rrt    = RRT (m_sampleDistance, m_branchDistance);
+
+    // The region is a corridor made of a single cell so the tree never leaves it, and it has no goal of its own.
+    tree.rrt.setCorridor (bounds, (unsigned int) std::max (bounds.width, bounds.height), std::vector<bool> (1, true));
+    tree.rrt.setExploring (true);
+    tree.rrt.setSeed (std::max (1U, seed + index * 7919U));
+    tree.rrt.setHeatmap (m_heatmap);
+    tree.rrt.prepareTree (m_data, root, root);
+
+    m_regions[region].trees.push_back (index);
+}
+
+
+void PartitionedRRT::gatherCandidates (const Region& region)
+{
+    // Only nodes close enough to the edge of a region can be bridged to a neighbour, when the start and end share a
+    // region their trees need every node to be considered.
+    const auto margin = (int) std::ceil (m_branchDistance);
+    const auto inner  = sf::IntRect (region.bounds.left + margin, region.bounds.top + margin,
+                                     region.bounds.width - margin * 2, region.bounds.height - margin * 2);
+    const auto shared = region.trees.size() > 1;
+
+    for (const auto index : region.trees)
+    {
+        auto& tree = m_trees[index];
+        tree.candidates.clear();
+
+        for (const auto branch : tree.rrt.getRoot()->depthFirst())
+        {
+            const auto& position = branch->getData().position;
+
+            if (shared || !inner.contains (position))
+            {
+                tree.candidates.push_back (position);
+            }
+        }
+
+        // Sorting by row lets connect() only look at candidates within a branch of each other vertically.
+        std::sort (tree.candidates.begin(), tree.candidates.end(), [] (const sf::Vector2i& lhs, const sf::Vector2i& rhs)
+        {
+            return lhs.y < rhs.y || (lhs.y == rhs.y && lhs.x < rhs.x);
+        });
+    }
+}
+
+
+void PartitionedRRT::exchange()
+{
+    const auto rows = (unsigned int) m_regions.size() / m_regionColumns;
+
+    // Offsets to the neighbours which haven't been visited yet, so each pair of regions is only checked once.
+    const int offsets[][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+    for (auto i = 0U; i < m_regions.size(); ++i)
+    {
+        const auto& trees  = m_regions[i].trees;
+        const auto  column = (int) (i % m_regionColumns),
+                    row    = (int) (i / m_regionColumns);
+
+        // Trees sharing a region.
+        for (auto a = 0U; a < trees.size(); ++a)
+        {
+            for (auto b = a + 1; b < trees.size(); ++b)
+            {
+                connect (trees[a], trees[b]);
+            }
+        }
+
+        // Trees in neighbouring regions.
+        for (const auto& offset : offsets)
+        {
+            const auto x = column + offset[0],
+                       y = row + offset[1];
+
+            if (x >= 0 && x < (int) m_regionColumns && y < (int) rows)
+            {
+                for (const auto a : trees)
+                {
+                    for (const auto b : m_regions[x + y * m_regionColumns].trees)
+                    {
+                        connect (a, b);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+bool PartitionedRRT::connect (const unsigned int a, const unsigned int b)
+{
+    const auto setA = find (a),
+               setB = find (b);
+
+    // Trees which are already merged don't need another bridge.
+    if (setA == setB)
+    {
+        return false;
+    }
+
+    const auto& from     = m_trees[a].candidates;
+    const auto& to       = m_trees[b].candidates;
+    const auto  distance = m_branchDistance * m_branchDistance;
+    const auto  reach    = (int) m_branchDistance;
+
+    for (const auto& position : from)
+    {
+        // Candidates are sorted by row so skip straight to the first one within reach.
+        auto other = std::lower_bound (to.cbegin(), to.cend(), sf::Vector2i (std::numeric_limits<int>::min(), position.y - reach),
+            [] (const sf::Vector2i& lhs, const sf::Vector2i& rhs)
+            {
+                return lhs.y < rhs.y || (lhs.y == rhs.y && lhs.x < rhs.x);
+            });
+
+        for (; other != to.cend() && other->y <= position.y + reach; ++other)
+        {
+            const auto difference = sf::Vector2f (*other - position);
+
+            if (difference.x * difference.x + difference.y * difference.y <= distance && m_trees[a].rrt.isClear (position, *other))
+            {
+                Bridge bridge { };
+                bridge.from         = a;
+                bridge.to           = b;
+                bridge.fromPosition = position;
+                bridge.toPosition   = *other;
+
+                m_bridges.push_back (bridge);
+                m_sets[setA] = setB;
+
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+unsigned int PartitionedRRT::find (const unsigned int tree)
+{
+    auto root = tree;
+
+    while (m_sets[root] != root)
+    {
+        root = m_sets[root];
+    }
+
+    // Point everything on the way straight at the root.
+    for (auto current = tree; m_sets[current] != root && current != root;)
+    {
+        const auto next = m_sets[current];
+        m_sets[current] = root;
+        current         = next;
+    }
+
+    return root;
+}
+
+
+void PartitionedRRT::stitch()
+{
+    // The bridges form a forest so a breadth-first search finds the only route between the two trees.
+    const auto none = std::numeric_limits<unsigned int>::max();
+
+    std::vector<std::vector<unsigned int>> adjacent (m_trees.size());
+
+    for (auto i = 0U; i < m_bridges.size(); ++i)
+    {
+        adjacent[m_bridges[i].from].push_back (i);
+        adjacent[m_bridges[i].to].push_back (i);
+    }
+
+    std::vector<unsigned int> via (m_trees.size(), none);
+    std::queue<unsigned int>  open { };
+
+    open.push (m_startTree);
+    via[m_startTree] = m_bridges.size();
+
+    while (!open.empty() && via[m_endTree] == none)
+    {
+        const auto tree = open.front();
+        open.pop();
+
+        for (const auto index : adjacent[tree])
+        {
+            const auto& bridge = m_bridges[index];
+            const auto  next   = bridge.from == tree ? bridge.to : bridge.from;
+
+            if (via[next] == none)
+            {
+                via[next] = index;
+                open.push (next);
+            }
+        }
+    }
+
+    // Pre-condition: The trees are connected.
+    assert (via[m_endTree] != none);
+
+    // Walk back from the end to find the bridges in order.
+    std::vector<unsigned int> route { };
+
+    for (auto tree = m_endTree; tree != m_startTree;)
+    {
+        const auto& bridge = m_bridges[via[tree]];
+
+        route.push_back (via[tree]);
+        tree = bridge.from == tree ? bridge.to : bridge.from;
+    }
+
+    std::reverse (route.begin(), route.end());
+
+    // Follow each tree from where we entered it to the bridge leading out of it.
+    m_path.clear();
+
+    auto tree     = m_startTree;
+    auto position = m_start;
+
+    for (const auto index : route)
+    {
+        const auto& bridge  = m_bridges[index];
+        const auto  forward = bridge.from == tree;
+
+        appendTreePath (tree, position, forward ? bridge.fromPosition : bridge.toPosition);
+
+        position = forward ? bridge.toPosition : bridge.fromPosition;
+        tree     = forward ? bridge.to : bridge.from;
+    }
+
+    appendTreePath (tree, position, m_end);
+}
+
+
+void PartitionedRRT::appendTreePath (const unsigned int tree, const sf::Vector2i& from, const sf::Vector2i& to)
+{
+    const auto& rrt = m_trees[tree].rrt;
+
+    // Collect the ancestors of both ends, ordered from the root.
+    const auto ancestors = [&] (const sf::Vector2i& position)
+    {
+        std::vector<RRTTree::Branch> chain { };
+
+        for (auto branch = rrt.getBranch (position); branch; branch = branch->getParent())
+        {
+            chain.push_back (branch);
+        }
+
+        std::reverse (chain.begin(), chain.end());
+
+        return chain;
+    };
+
+    const auto up   = ancestors (from),
+               down = ancestors (to);
+
+    // Pre-condition: Both positions are nodes of the tree.
+    assert (!up.empty() && !down.empty());
+
+    // The last shared ancestor is where the path turns around.
+    auto common = 0U;
+
+    while (common + 1 < up.size() && common + 1 < down.size() && up[common + 1] == down[common + 1])
+    {
+        ++common;
+    }
+
+    const auto append = [&] (const RRTTree::Branch branch)
+    {
+        const auto& position = branch->getData().position;
+
+        if (m_path.empty() || m_path.back() != position)
+        {
+            m_path.push_back (position);
+        }
+    };
+
+    for (auto i = up.size(); i-- > common;)
+    {
+        append (up[i]);
+    }
+
+    for (auto i = common + 1; i < down.size(); ++i)
+    {
+        append (down[i]);
+    }
+}
\ No newline at end of file
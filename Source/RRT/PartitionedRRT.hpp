@@ -0,0 +1,219 @@
+#ifndef GEC_PARTITIONED_RRT_HPP
+#define GEC_PARTITIONED_RRT_HPP
+
+
+// STL headers.
+#include <memory>
+#include <vector>
+
+
+// Application headers.
+#include <RRT/RRT.hpp>
+
+
+// External headers.
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+
+// Forward declarations.
+class LevelData;
+class ThreadPool;
+class TileHeatmap;
+
+
+/// <summary>
+/// A parallel planner which splits the level into square regions, each growing its own local trees. Every round each
+/// region is grown on a worker thread for a number of iterations without touching any other region, so the node index
+/// and nearest neighbour searches of a tree only ever cover its own region. Between rounds the nodes near the edge of
+/// each region are exchanged with its neighbours and any which can be joined by a straight branch merge their trees in
+/// a union-find structure. Once the tree containing the start is merged with the tree containing the end the path is
+/// stitched together through the trees and the bridges between them.
+/// </summary>
+class PartitionedRRT final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Constructs the planner with the parameters used for every local tree. </summary>
+        /// <param name="pool"> The threads to grow regions on, without one the regions are grown by the calling thread. </param>
+        /// <param name="regionSize"> The width and height of each region in tiles. </param>
+        /// <param name="sampleDistance"> The incrementation to use when sampling between branches during collision detection. </param>
+        /// <param name="branchDistance"> The maximum distance of a branch, bridges between trees are limited to this too. </param>
+        PartitionedRRT (const std::shared_ptr<ThreadPool>& pool = nullptr, const unsigned int regionSize = 128U,
+                        const float sampleDistance = 0.25f, const float branchDistance = 15.f);
+
+        PartitionedRRT (PartitionedRRT&& move);
+        PartitionedRRT& operator= (PartitionedRRT&& move);
+
+        PartitionedRRT (const PartitionedRRT& copy)             = delete;
+        PartitionedRRT& operator= (const PartitionedRRT& copy)  = delete;
+        ~PartitionedRRT()                                       = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Checks whether the start and end have been joined. </summary>
+        bool hasFinished() const                            { return !m_path.empty(); }
+
+        /// <summary> Gets the path from the start to the end, empty until the planner has finished. </summary>
+        const std::vector<sf::Vector2i>& getPath() const    { return m_path; }
+
+        /// <summary> Checks whether the end can be reached from the start, there's no point generating rounds otherwise. </summary>
+        bool isReachable() const                            { return m_reachable; }
+
+        /// <summary> Checks whether the round limit was reached without the start and end being joined. </summary>
+        bool isExhausted() const                            { return !hasFinished() && m_roundLimit != 0 && m_rounds >= m_roundLimit; }
+
+        /// <summary> Gets the number of regions the level has been split into. </summary>
+        unsigned int getRegionCount() const                 { return m_regions.size(); }
+
+        /// <summary> Gets the number of local trees across every region. </summary>
+        unsigned int getTreeCount() const                   { return m_trees.size(); }
+
+        /// <summary> Gets the number of bridges which have merged trees. </summary>
+        unsigned int getBridgeCount() const                 { return m_bridges.size(); }
+
+        /// <summary> Gets the number of rounds performed since the planner was prepared. </summary>
+        unsigned int getRounds() const                      { return m_rounds; }
+
+        /// <summary> Gets the total number of nodes across every local tree. </summary>
+        unsigned int getNodeCount() const;
+
+        /// <summary> Sets how many iterations each local tree is grown by every round. </summary>
+        void setRoundLength (const unsigned int iterations) { m_roundLength = iterations; }
+
+        /// <summary> Sets how many rounds may be performed before the planner gives up, zero is unlimited. </summary>
+        void setRoundLimit (const unsigned int rounds)      { m_roundLimit = rounds; }
+
+        /// <summary> Sets the seed for the local trees, each tree is given its own seed derived from it. Zero uses the clock. </summary>
+        void setSeed (const unsigned int seed)              { m_seed = seed; }
+
+        /// <summary> Shares a heatmap between every local tree planted from now on, nullptr stops recording. </summary>
+        void setHeatmap (const std::shared_ptr<TileHeatmap>& heatmap)   { m_heatmap = heatmap; }
+
+
+        //////////////
+        // Planning //
+        //////////////
+
+        /// <summary> Splits the level into regions and plants the local trees ready for planning. </summary>
+        /// <param name="data"> The level to plan across. </param>
+        /// <param name="start"> The start point of the path. </param>
+        /// <param name="end"> The end point of the path. </param>
+        void prepareTree (const std::shared_ptr<LevelData>& data, const sf::Vector2i& start, const sf::Vector2i& end);
+
+        /// <summary>
+        /// Grows every region in parallel for one round then exchanges boundary nodes between them. Nothing happens once
+        /// the planner has finished or is exhausted.
+        /// </summary>
+        void generateRound();
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> A tree grown inside a single region. </summary>
+        struct LocalTree final
+        {
+            unsigned int                region      { 0 };  //!< The region the tree is confined to.
+            RRT                         rrt;                //!< The tree itself.
+            std::vector<sf::Vector2i>   candidates  { };    //!< The nodes offered to other trees during the last exchange.
+        };
+
+        /// <summary> A square area of the level. </summary>
+        struct Region final
+        {
+            sf::IntRect                 bounds      { };    //!< The tiles covered by the region.
+            std::vector<unsigned int>   trees       { };    //!< The local trees growing in the region.
+        };
+
+        /// <summary> A straight branch joining the nodes of two local trees. </summary>
+        struct Bridge final
+        {
+            unsigned int    from            { 0 };  //!< The first tree.
+            unsigned int    to              { 0 };  //!< The second tree.
+            sf::Vector2i    fromPosition    { };    //!< The node in the first tree.
+            sf::Vector2i    toPosition      { };    //!< The node in the second tree.
+        };
+
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary>
+        /// Finds a root for each connected part of a region which can be reached from the start, choosing the tile of each
+        /// part nearest the centre of the region. A wall can split a region into parts which are only joined outside of
+        /// it, a single tree would never grow into the other parts.
+        /// </summary>
+        /// <param name="bounds"> The region to search. </param>
+        /// <param name="planted"> The roots already planted in the region, their parts are skipped. </param>
+        /// <returns> The root of every part which still needs a tree. </returns>
+        std::vector<sf::Vector2i> findSeeds (const sf::IntRect& bounds, const std::vector<sf::Vector2i>& planted) const;
+
+        /// <summary> Adds a local tree to a region. </summary>
+        /// <param name="region"> The region to confine the tree to. </param>
+        /// <param name="root"> The root of the tree. </param>
+        /// <param name="seed"> The seed shared by every tree, the index of the tree is mixed in. </param>
+        void addTree (const unsigned int region, const sf::Vector2i& root, const unsigned int seed);
+
+        /// <summary> Gathers the nodes of each tree in a region which could be joined to another tree. </summary>
+        void gatherCandidates (const Region& region);
+
+        /// <summary> Tries to join every pair of neighbouring trees which haven't already been merged. </summary>
+        void exchange();
+
+        /// <summary> Tries to find a bridge between two trees using their candidate nodes. </summary>
+        /// <returns> Whether a bridge was found and the trees were merged. </returns>
+        bool connect (const unsigned int a, const unsigned int b);
+
+        /// <summary> Finds the representative of the set containing the given tree, compressing the path as it goes. </summary>
+        unsigned int find (const unsigned int tree);
+
+        /// <summary> Builds the path through the bridges from the tree containing the start to the tree containing the end. </summary>
+        void stitch();
+
+        /// <summary> Appends the path through a tree between two of its nodes. </summary>
+        void appendTreePath (const unsigned int tree, const sf::Vector2i& from, const sf::Vector2i& to);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::shared_ptr<ThreadPool>     m_pool              { };            //!< The threads regions are grown on.
+        std::shared_ptr<LevelData>      m_data              { };            //!< The level being planned across.
+        sf::Vector2i                    m_start             { };            //!< The start point of the path.
+        sf::Vector2i                    m_end               { };            //!< The end point of the path.
+        MovementClass                   m_movement          { };            //!< The movement class of the start.
+
+        unsigned int                    m_regionSize        { 128 };        //!< The width and height of each region.
+        float                           m_sampleDistance    { 0.25f };      //!< The sample distance of each local tree.
+        float                           m_branchDistance    { 15.f };       //!< The branch distance of each local tree.
+        unsigned int                    m_roundLength       { 256 };        //!< How many iterations each tree grows by per round.
+        unsigned int                    m_roundLimit        { 0 };          //!< How many rounds may be performed, zero if unlimited.
+        unsigned int                    m_seed              { 0 };          //!< The seed local tree seeds are derived from.
+        std::shared_ptr<TileHeatmap>    m_heatmap           { };            //!< Where the local trees record their effort, if anywhere.
+        unsigned int                    m_rounds            { 0 };          //!< How many rounds have been performed.
+
+        std::vector<Region>             m_regions           { };            //!< Every region, row by row.
+        unsigned int                    m_regionColumns     { 0 };          //!< How many regions make up each row.
+        std::vector<LocalTree>          m_trees             { };            //!< Every local tree.
+        std::vector<unsigned int>       m_sets              { };            //!< The union-find parent of each tree.
+        std::vector<Bridge>             m_bridges           { };            //!< The bridges which merged trees, these form a forest.
+        unsigned int                    m_startTree         { 0 };          //!< The tree rooted at the start.
+        unsigned int                    m_endTree           { 0 };          //!< The tree rooted at the end.
+        bool                            m_reachable         { false };      //!< Whether the end can be reached from the start.
+
+        std::vector<sf::Vector2i>       m_path              { };            //!< The stitched path.
+};
+
+#endif
\ No newline at end of file
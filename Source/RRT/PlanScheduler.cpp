@@ -0,0 +1,182 @@
+#include "PlanScheduler.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+
+
+//////////////
+// PlanTask //
+//////////////
+
+PlanTask::PlanTask (const unsigned int id, RRT rrt, const std::shared_ptr<LevelData>& level, const sf::Vector2i& start,
+                    const sf::Vector2i& end, const unsigned int iterationLimit, Callback onFinished)
+    : m_id (id), m_rrt (std::move (rrt)), m_level (level), m_start (start), m_end (end), m_iterationLimit (iterationLimit),
+      m_onFinished (std::move (onFinished))
+{
+    // Pre-condition: There's something to plan on.
+    assert (level);
+}
+
+
+bool PlanTask::resume (const unsigned int iterations)
+{
+    if (m_status == PlanStatus::Waiting)
+    {
+        // Preparing indexes the planning window, leaving it until now keeps submitting cheap and puts it within a budget.
+        m_rrt.prepareTree (m_level, m_start, m_end);
+        m_status = m_rrt.isReachable() ? PlanStatus::Running : PlanStatus::Unreachable;
+    }
+
+    if (m_status != PlanStatus::Running)
+    {
+        return true;
+    }
+
+    ++m_slices;
+
+    for (auto i = 0U; i < iterations; ++i)
+    {
+        if (updateStatus())
+        {
+            return true;
+        }
+
+        m_rrt.generateBranch();
+        ++m_iterations;
+    }
+
+    // A plan which finished on its last iteration is reported now rather than taking up another turn.
+    return updateStatus();
+}
+
+
+void PlanTask::cancel()
+{
+    if (!isFinished())
+    {
+        m_status = PlanStatus::Cancelled;
+    }
+}
+
+
+void PlanTask::notify() const
+{
+    // Pre-condition: Only finished plans are reported.
+    assert (isFinished());
+
+    if (m_onFinished)
+    {
+        m_onFinished (*this);
+    }
+}
+
+
+bool PlanTask::updateStatus()
+{
+    if (m_rrt.hasFinished())
+    {
+        m_status = PlanStatus::Solved;
+    }
+
+    else if (m_iterationLimit != 0 && m_iterations >= m_iterationLimit)
+    {
+        m_status = PlanStatus::Exhausted;
+    }
+
+    return isFinished();
+}
+
+
+///////////////////
+// PlanScheduler //
+///////////////////
+
+PlanScheduler::PlanScheduler (const unsigned int sliceIterations)
+{
+    setSliceIterations (sliceIterations);
+}
+
+
+void PlanScheduler::setSliceIterations (const unsigned int iterations)
+{
+    // Pre-condition: Plans must make progress when resumed.
+    assert (iterations > 0);
+
+    m_sliceIterations = iterations;
+}
+
+
+PlanScheduler::Plan PlanScheduler::submit (RRT rrt, const std::shared_ptr<LevelData>& level, const sf::Vector2i& start,
+                                           const sf::Vector2i& end, const unsigned int iterationLimit, PlanTask::Callback onFinished)
+{
+    const auto plan = m_nextPlan++;
+
+    m_plans.push_back (std::make_unique<PlanTask> (plan, std::move (rrt), level, start, end, iterationLimit, std::move (onFinished)));
+
+    return plan;
+}
+
+
+bool PlanScheduler::cancel (const Plan plan)
+{
+    const auto match = std::find_if (m_plans.begin(), m_plans.end(), [=] (const std::unique_ptr<PlanTask>& task)
+    {
+        return task->getId() == plan;
+    });
+
+    if (match == m_plans.end())
+    {
+        return false;
+    }
+
+    // The plan leaves the queue before the callback so the callback is free to change the queue.
+    auto task = std::move (*match);
+    m_plans.erase (match);
+
+    task->cancel();
+    task->notify();
+
+    return true;
+}
+
+
+unsigned int PlanScheduler::tick (const double seconds)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    const auto start  = Clock::now();
+    auto       slices = 0U;
+
+    // The plan being resumed is taken off the front of the queue so callbacks can submit and cancel freely, it goes to
+    // the back if it hasn't finished which is all the state a round-robin needs between ticks.
+    while (!m_plans.empty())
+    {
+        auto task = std::move (m_plans.front());
+        m_plans.pop_front();
+
+        const auto finished = task->resume (m_sliceIterations);
+        ++slices;
+
+        if (finished)
+        {
+            task->notify();
+        }
+
+        else
+        {
+            m_plans.push_back (std::move (task));
+        }
+
+        if (std::chrono::duration<double> (Clock::now() - start).count() >= seconds)
+        {
+            break;
+        }
+    }
+
+    return slices;
+}
\ No newline at end of file
@@ -0,0 +1,225 @@
+#ifndef GEC_PLAN_SCHEDULER_HPP
+#define GEC_PLAN_SCHEDULER_HPP
+
+
+// STL headers.
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+
+// Application headers.
+#include <RRT/RRT.hpp>
+
+
+// External headers.
+#include <SFML/System/Vector2.hpp>
+
+
+// Forward declarations.
+class LevelData;
+
+
+/// <summary>
+/// The progress of a plan being multiplexed by a PlanScheduler.
+/// </summary>
+enum class PlanStatus : char
+{
+    Waiting,        //!< The plan hasn't been given any time yet.
+    Running,        //!< The plan is suspended part way through.
+    Solved,         //!< The tree reached the end.
+    Unreachable,    //!< The end lies in a different region to the start so can never be reached.
+    Exhausted,      //!< The plan used up its iterations without reaching the end.
+    Cancelled       //!< The plan was cancelled before it finished.
+};
+
+
+/// <summary>
+/// A single plan which can be suspended between any two iterations and resumed later. An RRT already keeps its whole
+/// search in the object rather than on the stack, so a suspended plan is just the RRT along with its query and limits.
+/// </summary>
+class PlanTask final
+{
+    public:
+
+        /// <summary> Called once a plan has finished, for whatever reason. </summary>
+        using Callback = std::function<void (const PlanTask&)>;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a plan which won't do anything until it's first resumed. </summary>
+        /// <param name="id"> The identifier given by the scheduler. </param>
+        /// <param name="rrt"> The planner to use, configured however the plan requires. </param>
+        /// <param name="level"> The level to plan on. </param>
+        /// <param name="start"> The start point of the plan. </param>
+        /// <param name="end"> The end point of the plan. </param>
+        /// <param name="iterationLimit"> How many iterations the plan may use before giving up, zero is unlimited. </param>
+        /// <param name="onFinished"> Called once the plan has finished, this may be empty. </param>
+        PlanTask (const unsigned int id, RRT rrt, const std::shared_ptr<LevelData>& level, const sf::Vector2i& start,
+                  const sf::Vector2i& end, const unsigned int iterationLimit, Callback onFinished);
+
+        PlanTask (PlanTask&& move)                  = delete;
+        PlanTask& operator= (PlanTask&& move)       = delete;
+        PlanTask (const PlanTask& copy)             = delete;
+        PlanTask& operator= (const PlanTask& copy)  = delete;
+        ~PlanTask()                                 = default;
+
+
+        /////////////
+        // Getters //
+        /////////////
+
+        /// <summary> Gets the identifier given by the scheduler. </summary>
+        unsigned int getId() const                  { return m_id; }
+
+        /// <summary> Gets the progress of the plan. </summary>
+        PlanStatus getStatus() const                { return m_status; }
+
+        /// <summary> Checks whether the plan has finished, successfully or not. </summary>
+        bool isFinished() const                     { return m_status != PlanStatus::Waiting && m_status != PlanStatus::Running; }
+
+        /// <summary> Gets how many iterations the plan has used. </summary>
+        unsigned int getIterations() const          { return m_iterations; }
+
+        /// <summary> Gets how many times the plan has been resumed. </summary>
+        unsigned int getSlices() const              { return m_slices; }
+
+        /// <summary> Gets the planner, which holds the tree grown so far. </summary>
+        const RRT& getRRT() const                   { return m_rrt; }
+
+        /// <summary> Gets the path from the start to the end, empty unless the plan was solved. </summary>
+        std::vector<sf::Vector2i> getPath() const   { return m_rrt.getPath(); }
+
+
+        ///////////////
+        // Execution //
+        ///////////////
+
+        /// <summary> Runs the plan for up to the given number of iterations, preparing the tree the first time. </summary>
+        /// <returns> Whether the plan has now finished. </returns>
+        bool resume (const unsigned int iterations);
+
+        /// <summary> Stops the plan, it won't be resumed again. </summary>
+        void cancel();
+
+        /// <summary> Calls the callback of a finished plan, if it has one. </summary>
+        void notify() const;
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Moves the plan to a finished status if it has reached the end or its iteration limit. </summary>
+        /// <returns> Whether the plan has finished. </returns>
+        bool updateStatus();
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int                m_id                { 0 };                      //!< The identifier given by the scheduler.
+        RRT                         m_rrt               { };                        //!< The suspended search.
+        std::shared_ptr<LevelData>  m_level             { };                        //!< The level being planned on.
+        sf::Vector2i                m_start             { };                        //!< The start point of the plan.
+        sf::Vector2i                m_end               { };                        //!< The end point of the plan.
+        unsigned int                m_iterationLimit    { 0 };                      //!< The most iterations allowed, zero if unlimited.
+        unsigned int                m_iterations        { 0 };                      //!< The iterations used so far.
+        unsigned int                m_slices            { 0 };                      //!< How many times the plan has been resumed.
+        PlanStatus                  m_status            { PlanStatus::Waiting };    //!< The progress of the plan.
+        Callback                    m_onFinished        { };                        //!< Called once the plan has finished.
+};
+
+
+/// <summary>
+/// Multiplexes many plans on a single thread, such as a simulation thread which has other work to do each tick. Plans
+/// are resumed in turn for a slice of iterations each until the time budget of the tick runs out, and the next tick
+/// carries on with whichever plan was next in line so every plan gets a fair share however small the budget. Nothing
+/// is run on other threads and a suspended plan costs no more than its tree.
+/// </summary>
+class PlanScheduler final
+{
+    public:
+
+        /////////////
+        // Aliases //
+        /////////////
+
+        /// <summary> An identifier for a plan given to the scheduler. </summary>
+        using Plan = unsigned int;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a scheduler without any plans. </summary>
+        /// <param name="sliceIterations"> How many iterations each plan runs for before the next plan is resumed. </param>
+        PlanScheduler (const unsigned int sliceIterations = 64U);
+
+        PlanScheduler (PlanScheduler&& move)                    = delete;
+        PlanScheduler& operator= (PlanScheduler&& move)         = delete;
+        PlanScheduler (const PlanScheduler& copy)               = delete;
+        PlanScheduler& operator= (const PlanScheduler& copy)    = delete;
+        ~PlanScheduler()                                        = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets how many plans haven't finished yet. </summary>
+        unsigned int getPlanCount() const               { return (unsigned int) m_plans.size(); }
+
+        /// <summary> Gets how many iterations each plan runs for at a time. </summary>
+        unsigned int getSliceIterations() const         { return m_sliceIterations; }
+
+        /// <summary> Sets how many iterations each plan runs for at a time, smaller slices keep closer to the budget. </summary>
+        void setSliceIterations (const unsigned int iterations);
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Adds a plan to the back of the queue, the tree isn't prepared until the plan is first resumed. </summary>
+        /// <param name="rrt"> The planner to use, configured however the plan requires. </param>
+        /// <param name="level"> The level to plan on. </param>
+        /// <param name="start"> The start point of the plan. </param>
+        /// <param name="end"> The end point of the plan. </param>
+        /// <param name="iterationLimit"> How many iterations the plan may use before giving up, zero is unlimited. </param>
+        /// <param name="onFinished"> Called by tick() or cancel() once the plan has finished, the plan is removed afterwards. </param>
+        /// <returns> The identifier of the plan. </returns>
+        Plan submit (RRT rrt, const std::shared_ptr<LevelData>& level, const sf::Vector2i& start, const sf::Vector2i& end,
+                     const unsigned int iterationLimit = 0U, PlanTask::Callback onFinished = nullptr);
+
+        /// <summary> Cancels a plan which hasn't finished, its callback is called straight away. </summary>
+        /// <returns> Whether the plan was found. </returns>
+        bool cancel (const Plan plan);
+
+        /// <summary>
+        /// Resumes plans in turn until the time budget is used up or every plan has finished. At least one slice is always
+        /// ran so plans progress even when the budget is tiny. Plans may be submitted or cancelled from the callbacks.
+        /// </summary>
+        /// <param name="seconds"> The time budget of the tick. </param>
+        /// <returns> The number of slices ran. </returns>
+        unsigned int tick (const double seconds);
+
+    private:
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::deque<std::unique_ptr<PlanTask>>   m_plans             { };    //!< Every unfinished plan, in the order they'll be resumed.
+        Plan                                    m_nextPlan          { 1 };  //!< The identifier given to the next plan submitted.
+        unsigned int                            m_sliceIterations   { 64 }; //!< How many iterations each plan runs for at a time.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "PlanTrace.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+
+
+
+// Records are written and read as raw memory so their layout mustn't change between builds.
+static_assert (sizeof (TraceRecord) == 24, "TraceRecord must be 24 bytes to match the trace file format.");
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+PlanTrace::PlanTrace (const std::string& file, const LevelData& level, const unsigned int capacity)
+    : m_width (level.getWidth()), m_height (level.getHeight()), m_capacity (capacity)
+{
+    // Pre-condition: Positions in the ring buffer can be found with a mask.
+    assert (capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+    m_stream.open (file, std::ios::binary | std::ios::trunc);
+
+    if (!m_stream)
+    {
+        throw std::runtime_error ("PlanTrace::PlanTrace(), unable to create the trace file. \"" + file + "\".");
+    }
+
+    // The header identifies the file and the level, the record size catches a build with a different layout.
+    const auto hash        = (std::uint64_t) level.calculateContentHash();
+    const auto fileMagic   = magic,
+               fileVersion = version,
+               width       = (std::uint32_t) m_width,
+               height      = (std::uint32_t) m_height,
+               recordSize  = (std::uint32_t) sizeof (TraceRecord);
+
+    m_stream.write (reinterpret_cast<const char*> (&fileMagic), sizeof (fileMagic));
+    m_stream.write (reinterpret_cast<const char*> (&fileVersion), sizeof (fileVersion));
+    m_stream.write (reinterpret_cast<const char*> (&width), sizeof (width));
+    m_stream.write (reinterpret_cast<const char*> (&height), sizeof (height));
+    m_stream.write (reinterpret_cast<const char*> (&hash), sizeof (hash));
+    m_stream.write (reinterpret_cast<const char*> (&recordSize), sizeof (recordSize));
+
+    m_records.reset (new TraceRecord[capacity]);
+    m_memory.setBytes (capacity * sizeof (TraceRecord));
+
+    m_writer = std::thread (&PlanTrace::drain, this);
+}
+
+
+PlanTrace::~PlanTrace()
+{
+    // The writer empties the buffer before it exits.
+    m_stopping = true;
+    m_writer.join();
+    m_stream.close();
+}
+
+
+///////////////
+// Replaying //
+///////////////
+
+TraceFile PlanTrace::load (const std::string& file)
+{
+    auto stream = std::ifstream (file, std::ios::binary);
+
+    if (!stream)
+    {
+        throw std::runtime_error ("PlanTrace::load(), unable to open the trace file. \"" + file + "\".");
+    }
+
+    auto fileMagic   = std::uint32_t (0),
+         fileVersion = std::uint32_t (0),
+         width       = std::uint32_t (0),
+         height      = std::uint32_t (0),
+         recordSize  = std::uint32_t (0);
+    auto hash        = std::uint64_t (0);
+
+    stream.read (reinterpret_cast<char*> (&fileMagic), sizeof (fileMagic));
+    stream.read (reinterpret_cast<char*> (&fileVersion), sizeof (fileVersion));
+    stream.read (reinterpret_cast<char*> (&width), sizeof (width));
+    stream.read (reinterpret_cast<char*> (&height), sizeof (height));
+    stream.read (reinterpret_cast<char*> (&hash), sizeof (hash));
+    stream.read (reinterpret_cast<char*> (&recordSize), sizeof (recordSize));
+
+    if (!stream || fileMagic != magic)
+    {
+        throw std::runtime_error ("PlanTrace::load(), the file isn't a trace. \"" + file + "\".");
+    }
+
+    if (fileVersion != version || recordSize != sizeof (TraceRecord))
+    {
+        throw std::runtime_error ("PlanTrace::load(), the trace was written in an unsupported format. \"" + file + "\".");
+    }
+
+    auto trace      = TraceFile { };
+    trace.width     = width;
+    trace.height    = height;
+    trace.levelHash = hash;
+
+    // A trace which was cut short, by a crash for instance, may end with part of a record which is ignored.
+    auto record = TraceRecord { };
+
+    while (stream.read (reinterpret_cast<char*> (&record), sizeof (record)))
+    {
+        if ((record.kind != TraceKind::Branch && record.kind != TraceKind::Query) ||
+            record.result < BranchResult::Idle || record.result >= BranchResult::Count)
+        {
+            throw std::runtime_error ("PlanTrace::load(), the trace contains an invalid record. \"" + file + "\".");
+        }
+
+        trace.records.push_back (record);
+    }
+
+    return trace;
+}
+
+
+TraceReplay PlanTrace::replay (const TraceFile& trace, RRT& rrt, const std::shared_ptr<LevelData>& level)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    if (level->getWidth() != trace.width || level->getHeight() != trace.height || level->calculateContentHash() != trace.levelHash)
+    {
+        throw std::invalid_argument ("PlanTrace::replay(), the trace was recorded on a different level. \"" +
+                                     std::to_string (trace.width) + "x" + std::to_string (trace.height) + "\".");
+    }
+
+    auto replay   = TraceReplay { };
+    auto prepared = false;
+
+    for (const auto& record : trace.records)
+    {
+        if (record.kind == TraceKind::Query)
+        {
+            // Every sample is given so the seed only matters to anything else which draws random numbers.
+            rrt.setSeed (record.value);
+            rrt.prepareTree (level, record.sample, record.nearest);
+
+            prepared = true;
+            ++replay.queries;
+        }
+
+        // Recording may have started part way through a query, those samples have nothing to grow from.
+        else if (prepared)
+        {
+            const auto started = Clock::now();
+            const auto result  = rrt.generateBranch (record.sample);
+
+            replay.replayedSeconds += std::chrono::duration<double> (Clock::now() - started).count();
+            replay.recordedSeconds += record.value * 1e-9;
+
+            ++replay.iterations;
+            ++replay.recorded[(size_t) record.result];
+            ++replay.replayed[(size_t) result];
+
+            if (result != record.result)
+            {
+                ++replay.mismatches;
+            }
+        }
+    }
+
+    return replay;
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+void PlanTrace::waitForRoom (const size_t head)
+{
+    m_cachedTail = m_tail.load (std::memory_order_acquire);
+
+    if (head - m_cachedTail >= m_capacity)
+    {
+        m_stalls.fetch_add (1, std::memory_order_relaxed);
+
+        do
+        {
+            std::this_thread::yield();
+            m_cachedTail = m_tail.load (std::memory_order_acquire);
+        }
+        while (head - m_cachedTail >= m_capacity);
+    }
+}
+
+
+void PlanTrace::drain()
+{
+    while (true)
+    {
+        // Stopping is checked before the head so every record made before the destructor ran gets written.
+        const auto stopping = m_stopping.load();
+        const auto tail     = m_tail.load (std::memory_order_relaxed);
+        const auto head     = m_head.load (std::memory_order_acquire);
+
+        if (head == tail)
+        {
+            if (stopping)
+            {
+                break;
+            }
+
+            std::this_thread::sleep_for (std::chrono::milliseconds (1));
+            continue;
+        }
+
+        // The waiting records may wrap around the end of the buffer, the rest are written next time around.
+        const auto first = tail & (m_capacity - 1);
+        const auto count = std::min (head - tail, m_capacity - first);
+
+        m_stream.write (reinterpret_cast<const char*> (&m_records[first]), count * sizeof (TraceRecord));
+        m_tail.store (tail + count, std::memory_order_release);
+    }
+
+    m_stream.flush();
+}
\ No newline at end of file
@@ -0,0 +1,203 @@
+#ifndef GEC_PLAN_TRACE_HPP
+#define GEC_PLAN_TRACE_HPP
+
+
+// STL headers.
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+// Application headers.
+#include <RRT/RRT.hpp>
+#include <Utility/MemoryTracker.hpp>
+
+
+// External headers.
+#include <SFML/System/Vector2.hpp>
+
+
+/// <summary>
+/// The kinds of record stored in a trace.
+/// </summary>
+enum class TraceKind : char
+{
+    Branch, //!< A single iteration of the planner.
+    Query   //!< The tree being prepared for a new query.
+};
+
+
+/// <summary>
+/// A single entry of a trace. Records are written to file exactly as they're laid out in memory, positions are pairs of
+/// 32-bit integers on every platform the planner is built for.
+/// </summary>
+struct TraceRecord final
+{
+    sf::Vector2i    sample      { };                    //!< The sample grown towards, or the start of a query.
+    sf::Vector2i    nearest     { };                    //!< The node grown from, the sample if none was found, or the end of a query.
+    std::uint32_t   value       { 0 };                  //!< How many nanoseconds the iteration took, or the seed of a query.
+    TraceKind       kind        { TraceKind::Branch };  //!< Whether this is an iteration or a new query.
+    BranchResult    result      { BranchResult::Idle }; //!< What happened to the sample, Idle for a query.
+    std::uint16_t   reserved    { 0 };                  //!< Pads the record to a multiple of four bytes.
+};
+
+
+/// <summary>
+/// The contents of a trace file.
+/// </summary>
+struct TraceFile final
+{
+    unsigned int                width       { 0 };  //!< The width of the level the trace was recorded on.
+    unsigned int                height      { 0 };  //!< The height of the level the trace was recorded on.
+    unsigned long long          levelHash   { 0 };  //!< The content hash of the level the trace was recorded on.
+    std::vector<TraceRecord>    records     { };    //!< Every record in the order they were made.
+};
+
+
+/// <summary>
+/// A comparison between a trace and the same workload being executed again.
+/// </summary>
+struct TraceReplay final
+{
+    using ResultCounts = std::array<unsigned long long, (size_t) BranchResult::Count>;
+
+    unsigned int        queries         { 0 };      //!< How many queries were replayed.
+    unsigned long long  iterations      { 0 };      //!< How many samples were replayed.
+    unsigned long long  mismatches      { 0 };      //!< How many samples had a different result when replayed.
+    double              recordedSeconds { 0.0 };    //!< The total time the recorded iterations took.
+    double              replayedSeconds { 0.0 };    //!< The total time the replayed iterations took.
+    ResultCounts        recorded        { };        //!< How many recorded samples had each result.
+    ResultCounts        replayed        { };        //!< How many replayed samples had each result.
+};
+
+
+/// <summary>
+/// Records the exact workload of a planner to a compact binary file so that a slow plan can be reproduced and executed
+/// again, on a different storage method or page policy for instance. Records are pushed into a lock-free ring buffer by
+/// the planning thread and a writer thread drains the buffer to the file, so recording costs a copy of the record. If
+/// the writer falls behind, the planner waits for room rather than dropping records, as a gap would ruin the replay.
+/// </summary>
+class PlanTrace final
+{
+    public:
+
+        /// <summary> Identifies trace files, this reads "RTRC" in little-endian files. </summary>
+        static const std::uint32_t magic = 0x43525452;
+
+        /// <summary> The version of the file format written. </summary>
+        static const std::uint32_t version = 1;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a trace file for a level and starts the writer thread. </summary>
+        /// <param name="file"> The file to write, it's replaced if it exists. </param>
+        /// <param name="level"> The level which will be planned on. </param>
+        /// <param name="capacity"> How many records the ring buffer holds, this must be a power of two. </param>
+        PlanTrace (const std::string& file, const LevelData& level, const unsigned int capacity = 1U << 16);
+
+        /// <summary> Writes any records still in the ring buffer and closes the file. </summary>
+        ~PlanTrace();
+
+        PlanTrace (PlanTrace&& move)                    = delete;
+        PlanTrace& operator= (PlanTrace&& move)         = delete;
+        PlanTrace (const PlanTrace& copy)               = delete;
+        PlanTrace& operator= (const PlanTrace& copy)    = delete;
+
+
+        /////////////
+        // Getters //
+        /////////////
+
+        /// <summary> Gets the width of the level being traced. </summary>
+        unsigned int getWidth() const                   { return m_width; }
+
+        /// <summary> Gets the height of the level being traced. </summary>
+        unsigned int getHeight() const                  { return m_height; }
+
+        /// <summary> Gets how many records have been made so far. </summary>
+        unsigned long long getRecordCount() const       { return m_head.load (std::memory_order_relaxed); }
+
+        /// <summary> Gets how many times recording had to wait for the writer to make room. </summary>
+        unsigned long long getStallCount() const        { return m_stalls.load (std::memory_order_relaxed); }
+
+
+        ///////////////
+        // Recording //
+        ///////////////
+
+        /// <summary> Adds a record to the trace, this must only be called from one thread at a time. </summary>
+        void record (const TraceRecord& record)
+        {
+            const auto head = m_head.load (std::memory_order_relaxed);
+
+            // The tail is only read again once the buffer looks full, that keeps the writer's cache line where it is.
+            if (head - m_cachedTail >= m_capacity)
+            {
+                waitForRoom (head);
+            }
+
+            m_records[head & (m_capacity - 1)] = record;
+            m_head.store (head + 1, std::memory_order_release);
+        }
+
+
+        ///////////////
+        // Replaying //
+        ///////////////
+
+        /// <summary> Reads every record of a trace file. </summary>
+        static TraceFile load (const std::string& file);
+
+        /// <summary>
+        /// Executes a trace again, each query is prepared with its recorded seed and each sample is grown towards with
+        /// RRT::generateBranch(), timing every iteration in the same way as when it was recorded.
+        /// </summary>
+        /// <param name="trace"> The trace to replay. </param>
+        /// <param name="rrt"> The planner to replay on, configured however is being compared. </param>
+        /// <param name="level"> The level the trace was recorded on, although it may use any storage method. </param>
+        static TraceReplay replay (const TraceFile& trace, RRT& rrt, const std::shared_ptr<LevelData>& level);
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Waits until the writer has made room for the record at the given position. </summary>
+        void waitForRoom (const size_t head);
+
+        /// <summary> Writes records to the file as they arrive until the trace is destroyed. </summary>
+        void drain();
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::ofstream                   m_stream        { };        //!< The trace file.
+        unsigned int                    m_width         { 0 };      //!< The width of the level.
+        unsigned int                    m_height        { 0 };      //!< The height of the level.
+        size_t                          m_capacity      { 0 };      //!< The number of records the ring buffer holds.
+        std::unique_ptr<TraceRecord[]>  m_records       { };        //!< The ring buffer.
+        TrackedMemory                   m_memory        { MemorySubsystem::Traces };    //!< Counts the ring buffer.
+        std::atomic<bool>               m_stopping      { false };  //!< Whether the writer should finish once the buffer is empty.
+        std::thread                     m_writer        { };        //!< Runs drain().
+
+        std::array<std::uint64_t, 8>    m_before;                   //!< Keeps the producer's counters off the line of the data above.
+        std::atomic<size_t>             m_head          { 0 };      //!< How many records have been made, written by the producer.
+        size_t                          m_cachedTail    { 0 };      //!< The tail as last seen by the producer.
+        std::atomic<unsigned long long> m_stalls        { 0 };      //!< How many times the producer waited.
+        std::array<std::uint64_t, 8>    m_between;                  //!< Keeps the producer and writer counters apart.
+        std::atomic<size_t>             m_tail          { 0 };      //!< How many records have been written, written by the writer.
+        std::array<std::uint64_t, 8>    m_after;                    //!< Keeps the writer's counter off the line of anything after.
+};
+
+#endif
\ No newline at end of file
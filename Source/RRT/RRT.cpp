@@ -2,29 +2,59 @@
 
 
 // STL headers.
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <ctime>
-#include <functional>
+#include <limits>
 #include <random>
 #include <utility>
 
 
 // Application headers.
 #include <Level/LevelData.hpp>
+#include <Level/TileHeatmap.hpp>
+#include <RRT/PlanTrace.hpp>
 
 
 
+const MetricCounter RRT::queryMetric = Metrics::addCounter ("rrt_queries_total", "The number of queries prepared.");
+
+const MetricCounter RRT::solvedMetric = Metrics::addCounter ("rrt_queries_solved_total", "The number of queries whose tree reached the end.");
+
+const MetricHistogram RRT::latencyMetric = Metrics::addHistogram ("rrt_query_duration_seconds", 
+    "The time from preparing a query until its tree reached the end.", 
+    { 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 });
+
+const MetricCounter RRT::iterationMetric = Metrics::addCounter ("rrt_iterations_total", "The number of iterations which drew a sample.");
+
+const MetricCounter RRT::extensionMetric = Metrics::addCounter ("rrt_extensions_total", "The number of attempts to grow a branch towards a sample.");
+
+const MetricCounter RRT::failureMetric = Metrics::addCounter ("rrt_extensions_failed_total", "The number of attempts which didn't add a branch.");
+
+const MetricGauge RRT::failureRatioMetric = Metrics::addGauge ("rrt_extension_failure_ratio", 
+    "The fraction of attempts to grow a branch which failed, since the process started.", "", [] 
+    { 
+        const auto extensions = extensionMetric.getTotal();
+        return extensions != 0 ? failureMetric.getTotal() / (double) extensions : 0.0;
+    });
+
+
 //////////////////
 // Constructors //
 //////////////////
 
 RRT::RRT (const float sampleDistance, const float branchDistance)
-    : m_sampleDistance (sampleDistance), m_branchDistance (branchDistance)
+    : m_sampleDistance (sampleDistance), m_branchDistance (branchDistance), m_domainRadius (branchDistance * 2.f)
 {
     // Ensure we have valid values.
     assert (sampleDistance > 0.f && branchDistance >= 1.f);
 
-    m_tree = std::make_shared<RRTTree>();
+    m_defaults.sampleDistance = sampleDistance;
+    m_defaults.branchDistance = branchDistance;
+
+    m_pool = std::make_shared<RRTPool>();
+    m_tree = m_pool->create();
 }
 
 
@@ -45,62 +75,237 @@ RRT& RRT::operator= (RRT&& move)
 
         m_sampleDistance    = move.m_sampleDistance;
         m_branchDistance    = move.m_branchDistance;
+        m_defaults          = move.m_defaults;
+        m_tuning            = std::move (move.m_tuning);
+        m_tunedLevel        = std::move (move.m_tunedLevel);
+        m_heatmap           = std::move (move.m_heatmap);
+        m_trace             = std::move (move.m_trace);
+
+        m_movement          = move.m_movement;
+        m_startRegion       = move.m_startRegion;
+        m_reachable         = move.m_reachable;
+        m_exploring         = move.m_exploring;
+        m_seed              = move.m_seed;
+        m_random            = move.m_random;
+        m_queryStart        = move.m_queryStart;
+        m_solved            = move.m_solved;
 
         m_nodes             = std::move (move.m_nodes);
-        m_tree              = std::move (move.m_tree);
+        m_nodeCount         = move.m_nodeCount;
+        m_nodeBudget        = move.m_nodeBudget;
+        m_memoryBudget      = move.m_memoryBudget;
+        m_branchBytes       = move.m_branchBytes;
+        m_prunedCount       = move.m_prunedCount;
+        m_window            = move.m_window;
+        m_windowMargin      = move.m_windowMargin;
+        m_windowPatience    = move.m_windowPatience;
+        m_windowGrowth      = move.m_windowGrowth;
+        m_stalled           = move.m_stalled;
+        m_corridorBounds    = move.m_corridorBounds;
+        m_corridorCell      = move.m_corridorCell;
+        m_corridorWidth     = move.m_corridorWidth;
+        m_corridor          = std::move (move.m_corridor);
+        m_coverageCell      = move.m_coverageCell;
+        m_coverageLimit     = move.m_coverageLimit;
+        m_coverageWidth     = move.m_coverageWidth;
+        m_coverage          = std::move (move.m_coverage);
+        m_domainRadius      = move.m_domainRadius;
+        m_domainRate        = move.m_domainRate;
+        m_domainExplicit    = move.m_domainExplicit;
+        m_failedCount       = move.m_failedCount;
+        m_rejectedCount     = move.m_rejectedCount;
+        m_forestLimit       = move.m_forestLimit;
+        m_spawnFailures     = move.m_spawnFailures;
+        m_localCount        = move.m_localCount;
+        m_mergedCount       = move.m_mergedCount;
+        m_localTrees        = std::move (move.m_localTrees);
+        m_lines             = std::move (move.m_lines);
+        m_pool              = std::move (move.m_pool);
+        m_tree              = move.m_tree;
 
         // Reset primitives.
         move.m_sampleDistance = 0.f;
         move.m_branchDistance = 0.f;
+        move.m_nodeCount      = 0;
+        move.m_prunedCount    = 0;
+        move.m_failedCount    = 0;
+        move.m_rejectedCount  = 0;
+        move.m_localCount     = 0;
+        move.m_mergedCount    = 0;
+        move.m_tree           = nullptr;
     }
 
     return *this;
 }
 
 
+/////////////
+// Getters //
+/////////////
+
+RRTTree::Branch RRT::getBranch (const sf::Vector2i& position) const
+{
+    // Pre-condition: The position is within the level.
+    assert (position.x >= 0 && position.x < (int) m_data->getWidth() && position.y >= 0 && position.y < (int) m_data->getHeight());
+
+    return m_window.contains (position) ? m_nodes[toWindowIndex (position)] : nullptr;
+}
+
+
 ///////////////
 // Rendering //
 ///////////////
 
 void RRT::draw (sf::RenderTarget& drawTo, const sf::Vector2f& scale)
 {
-    // We need a draw function for each part of the tree.
-    const std::function<void (const RRTTree::Branch)> draw = [&] (const RRTTree::Branch branch)
-    {
-        // Cache the branch count.
-        const auto branches = branch->getBranchCount();
+    // Every branch other than the root is joined to its parent by a line, batch them all into a single draw call.
+    m_lines.clear();
 
-        for (auto i = 0U; i < branches; ++i)
+    for (const auto root : getRoots())
+    {
+        for (const auto branch : root->depthFirst())
         {
-            // Perform a depth-first draw algorithm.
-            const auto child = branch->getBranch(i);
-
-            if (child)
-            {
-                draw (child);
-            }
-            
             // Only draw if we aren't a root.
             if (!branch->isRoot())
             {
                 // Obtain each position.
-                const auto& position = branch->getData();
-                const auto& parent   = branch->getParent()->getData();
+                const auto& position = branch->getData().position;
+                const auto& parent   = branch->getParent()->getData().position;
 
                 // Create the vertices to connect the line.
-                sf::Vertex line[] = 
-                {  
-                    { sf::Vector2f (position.x * scale.x, position.y * scale.y) },
-                    { sf::Vector2f (parent.x * scale.x, parent.y * scale.y) }
-                };
-
-                // Finally draw the line.
-                drawTo.draw (line, 2, sf::Lines);
+                m_lines.emplace_back (sf::Vector2f (position.x * scale.x, position.y * scale.y));
+                m_lines.emplace_back (sf::Vector2f (parent.x * scale.x, parent.y * scale.y));
             }
         }
-    };
+    }
+
+    // Finally draw the lines.
+    if (!m_lines.empty())
+    {
+        drawTo.draw (m_lines.data(), m_lines.size(), sf::Lines);
+    }
+}
+
+
+std::vector<sf::Vector2i> RRT::getPath() const
+{
+    std::vector<sf::Vector2i> path { };
+
+    if (hasFinished())
+    {
+        // Follow the parents back from the end then flip the path around.
+        for (auto node = m_nodes[toWindowIndex (m_end)]; node; node = node->getParent())
+        {
+            path.push_back (node->getData().position);
+        }
+
+        std::reverse (path.begin(), path.end());
+    }
 
-    draw (m_tree.get());
+    return path;
+}
+
+
+/////////////
+// Setters //
+/////////////
+
+void RRT::setNodeBudget (const unsigned int budget)
+{
+    // Pre-condition: There's room for the root and at least one branch.
+    assert (budget == 0 || budget >= 2);
+
+    m_nodeBudget   = budget;
+    m_memoryBudget = 0;
+}
+
+
+void RRT::setDynamicDomain (const float radius, const float rate)
+{
+    // Pre-condition: The values are sensible.
+    assert (radius >= 0.f && rate >= 0.f && rate < 1.f);
+
+    m_domainRadius   = radius;
+    m_domainRate     = rate;
+    m_domainExplicit = true;
+}
+
+
+void RRT::setCoverage (const unsigned int cellSize, const unsigned int limit)
+{
+    // Pre-condition: A cell can hold at least one node.
+    assert (cellSize == 0 || limit > 0);
+
+    m_coverageCell  = cellSize;
+    m_coverageLimit = limit;
+}
+
+
+void RRT::setWindow (const unsigned int margin, const unsigned int patience, const float growth)
+{
+    // Pre-condition: The window can actually grow.
+    assert (growth > 1.f);
+
+    m_windowMargin   = margin;
+    m_windowPatience = patience;
+    m_windowGrowth   = growth;
+}
+
+
+void RRT::setCorridor (const sf::IntRect& bounds, const unsigned int cellSize, std::vector<bool> cells)
+{
+    // Pre-condition: There's a cell for every part of the bounds.
+    assert (cellSize > 0 && bounds.width > 0 && bounds.height > 0);
+    assert (cells.size() == ((bounds.width + cellSize - 1) / cellSize) * ((bounds.height + cellSize - 1) / cellSize));
+
+    m_corridorBounds = bounds;
+    m_corridorCell   = cellSize;
+    m_corridorWidth  = (bounds.width + cellSize - 1) / cellSize;
+    m_corridor       = std::move (cells);
+}
+
+
+void RRT::clearCorridor()
+{
+    m_corridorBounds = sf::IntRect();
+    m_corridorCell   = 0;
+    m_corridorWidth  = 0;
+    m_corridor.clear();
+}
+
+
+void RRT::setForest (const unsigned int limit, const unsigned int failures)
+{
+    // Pre-condition: Spawning needs at least one failure.
+    assert (failures > 0);
+
+    m_forestLimit   = limit;
+    m_spawnFailures = failures;
+}
+
+
+void RRT::setTuning (const std::shared_ptr<const RRTTuning>& tuning)
+{
+    m_tuning = tuning;
+
+    // Choose the distances again when the tree is next prepared.
+    m_tunedLevel.reset();
+    m_sampleDistance = m_defaults.sampleDistance;
+    m_branchDistance = m_defaults.branchDistance;
+
+    if (!m_domainExplicit)
+    {
+        m_domainRadius = m_branchDistance * 2.f;
+    }
+}
+
+
+void RRT::setMemoryBudget (const size_t bytes)
+{
+    m_nodeBudget   = 0;
+    m_memoryBudget = bytes;
+
+    applyMemoryBudget();
 }
 
 
@@ -110,15 +315,11 @@ void RRT::draw (sf::RenderTarget& drawTo, const sf::Vector2f& scale)
 
 bool RRT::hasFinished() const
 {
-    // Obtain the width.
-    const auto width = m_data->getWidth();
+    // Ensure that both values have a valid pointer, if so then we have finished. The end may belong to a local tree which
+    // hasn't been merged with the start yet.
+    const auto end = m_nodes[toWindowIndex (m_end)];
 
-    // Determine the start and end nodes.
-    const auto start = m_start.x + m_start.y * width,
-               end   = m_end.x + m_end.y * width;
-
-    // Ensure that both values have a valid pointer, if so then we have finished.
-    return m_nodes[start] && m_nodes[end];
+    return m_nodes[toWindowIndex (m_start)] && end && end->getData().tree == 0;
 }
 
 
@@ -126,69 +327,187 @@ void RRT::prepareTree (const std::shared_ptr<LevelData>& data, const sf::Vector2
 {
     // Pre-condition: The start and end values are valid.
     assert (start.x >= 0 && start.x < (int) data->getWidth() && end.x >= 0 && end.y < (int) data->getHeight());
+
+    // Pre-condition: Any heatmap covers the level.
+    assert (!m_heatmap || (m_heatmap->getWidth() == data->getWidth() && m_heatmap->getHeight() == data->getHeight()));
+
+    // Pre-condition: Any trace was created for the level.
+    assert (!m_trace || (m_trace->getWidth() == data->getWidth() && m_trace->getHeight() == data->getHeight()));
     
-    // Reset the node pointers and the tree itself.
-    m_nodes.clear();
-    m_tree->clear();
-    
-    m_data = data;
-    m_nodes.resize (m_data->getTileCount());
-    m_nodes.shrink_to_fit();
-    
-    // Assign the new start and end point.
+    // Hashing the level is only worth doing when it changes.
+    applyTuning (data);
+
+    // Time the query from here so the latency includes indexing the window.
+    queryMetric.increment();
+    m_queryStart = Clock::now();
+    m_solved     = false;
+
+    // Assign the new level, start and end point.
+    m_data  = data;
     m_start = start;
     m_end   = end;
-    m_tree.reset (new RRTTree ());
-    m_tree->setData (m_start);
-    m_nodes[start.x + start.y * data->getWidth()] = m_tree.get();
 
-    // Reseed rand().
-    srand ((unsigned int) time (0));
+    // Copies of the RRT share the same pool so only reuse it if we're the sole owner.
+    if (m_pool.unique())
+    {
+        m_pool->clear();
+    }
+
+    else
+    {
+        m_pool = std::make_shared<RRTPool>();
+    }
+
+    // Reset the tree itself.
+    RRTNode root { };
+    root.position = m_start;
+
+    m_tree          = m_pool->create (root);
+    m_nodeCount     = 1;
+    m_prunedCount   = 0;
+    m_failedCount   = 0;
+    m_rejectedCount = 0;
+    m_stalled       = 0;
+    m_localCount    = 0;
+    m_mergedCount   = 0;
+    m_localTrees.clear();
+
+    // Planning starts in a window surrounding the start and end, this will grow if the tree gets stuck.
+    const auto width  = (int) data->getWidth(),
+               height = (int) data->getHeight();
+
+    if (!m_corridor.empty())
+    {
+        // Pre-condition: The corridor contains both ends of the path.
+        assert (m_corridorBounds.contains (start) && m_corridorBounds.contains (end));
+
+        m_window = m_corridorBounds;
+    }
+
+    else if (m_windowMargin != 0)
+    {
+        const auto margin = (int) m_windowMargin;
+        const auto left   = std::max (0, std::min (start.x, end.x) - margin),
+                   top    = std::max (0, std::min (start.y, end.y) - margin),
+                   right  = std::min (width, std::max (start.x, end.x) + margin + 1),
+                   bottom = std::min (height, std::max (start.y, end.y) + margin + 1);
+
+        m_window = sf::IntRect (left, top, right - left, bottom - top);
+    }
+
+    else
+    {
+        m_window = sf::IntRect (0, 0, width, height);
+    }
+
+    indexWindow();
+
+    // Use the connected regions of the level to find out whether the end can ever be reached. If the start can't be
+    // traversed by its own movement class then we can't rely on the regions.
+    const auto startIndex = start.x + start.y * width,
+               endIndex   = end.x + end.y * width;
+
+    m_movement    = LevelData::determineMovementClass (data->getTile (startIndex));
+    m_startRegion = data->getRegion (startIndex, m_movement);
+    m_reachable   = m_startRegion == 0 || data->getRegion (endIndex, m_movement) == m_startRegion;
+
+    // Reseed the sample generator, a trace keeps the seed actually used so even clock seeded queries can be reproduced.
+    const auto seed = m_seed != 0 ? m_seed : (unsigned int) time (0);
+    m_random.seed (seed);
+
+    if (m_trace)
+    {
+        auto record    = TraceRecord { };
+        record.kind    = TraceKind::Query;
+        record.sample  = start;
+        record.nearest = end;
+        record.value   = seed;
+
+        m_trace->record (record);
+    }
 }
 
 
 void RRT::generateBranch()
 {
-    // Don't bother if we've already finished.
-    if (!hasFinished() && m_start != m_end)
-    {
-        // Cache the width and height values of the level data.
-        const auto width  = m_data->getWidth(),
-                   height = m_data->getHeight();
+    // Reading the clock is only worth it when the time is being recorded.
+    const auto started = m_trace ? Clock::now() : Clock::time_point { };
 
+    if (beginIteration())
+    {
         // Calculate the nearest node to a generated random point if the random point is valid.
-        const auto random  = sf::Vector2i (rand() % width, rand() % height);
+        const auto x       = m_window.left + (int) (m_random() % m_window.width),
+                   y       = m_window.top + (int) (m_random() % m_window.height);
+        const auto sample  = sf::Vector2i (x, y);
+        auto       nearest = sample;
+
+        const auto result = extendTowards (sample, nearest);
+        traceBranch (sample, nearest, result, started);
+    }
+}
+
+
+BranchResult RRT::generateBranch (const sf::Vector2i& sample)
+{
+    const auto started = m_trace ? Clock::now() : Clock::time_point { };
+
+    if (!beginIteration())
+    {
+        return BranchResult::Idle;
+    }
+
+    // A replayed sample may come from a run whose window grew differently.
+    auto nearest = sample;
+    auto result  = BranchResult::Skipped;
+
+    if (m_window.contains (sample))
+    {
+        result = extendTowards (sample, nearest);
+    }
+
+    traceBranch (sample, nearest, result, started);
+
+    return result;
+}
+
+
+unsigned int RRT::prune (const std::vector<RRTTree::Branch>& branches, const bool compact)
+{
+    // Pre-condition: The root is staying.
+    assert (std::find (branches.cbegin(), branches.cend(), m_tree) == branches.cend());
+
+    const auto removed = m_pool->prune (branches, [&] (const RRTTree& node)
+    {
+        const auto& data = node.getData();
+        m_nodes[toWindowIndex (data.position)] = nullptr;
+        updateCoverage (data.position, -1);
 
-        if (!m_nodes[random.x + random.y * width])
+        // Removing the root of a local tree removes the whole tree. Pruned branches are detached before we're told about
+        // them so isRoot() can't be trusted here.
+        if (data.tree != 0 && m_localTrees[data.tree - 1] == &node)
         {
-            const auto nearest = determineNearest (random);
-        
-            // Obtain the data of the nearest branch and calculate new branch.
-            const auto& nearData = nearest->getData();
-            const auto  branch   = calculateBranch (nearData, random);
+            m_localTrees[data.tree - 1] = nullptr;
+            --m_localCount;
+        }
+    });
 
-            // An invalid branch will be returned in a new branch couldn't be generated.
-            if (branch)
-            {
-                // Cache the new data.
-                const auto& newData  = branch->getData();
-                const auto  index    = newData.x + newData.y * width;
+    m_nodeCount -= removed;
 
-                // Don't overwrite any nodes.
-                if (!m_nodes[index])
-                {
-                    // Add it to the tree.
-                    nearest->addBranch (branch);
-                    m_nodes[index] = branch;
-                }
+    if (compact)
+    {
+        m_pool->compact ([&] (RRTTree& node)
+        {
+            const auto& data = node.getData();
+            m_nodes[toWindowIndex (data.position)] = &node;
 
-                else
-                {
-                    delete branch;
-                }
+            if (node.isRoot())
+            {
+                (data.tree == 0 ? m_tree : m_localTrees[data.tree - 1]) = &node;
             }
-        }
+        });
     }
+
+    return removed;
 }
 
 
@@ -197,25 +516,50 @@ bool RRT::isValidTile (const sf::Vector2i& position, const TileType base) const
     // Obtain the type of the given tile.
     const auto type = m_data->getTile ((unsigned int) position.x, (unsigned int) position.y);
 
-    switch (base)
+    return LevelData::isTraversable (type, LevelData::determineMovementClass (base));
+}
+
+
+bool RRT::isClear (const sf::Vector2i& start, const sf::Vector2i& end) const
+{
+    // Fetch every tile the line could touch in one go, getBlock() is safe regardless of the storage method.
+    const auto minimum = sf::Vector2i (std::min (start.x, end.x), std::min (start.y, end.y));
+    const auto size    = sf::Vector2i (std::abs (end.x - start.x) + 1, std::abs (end.y - start.y) + 1);
+
+    std::vector<TileType> block (size.x * size.y);
+    m_data->getBlock (minimum.x, minimum.y, size.x, size.y, block.data());
+
+    const auto tile       = [&] (const sf::Vector2i& position) { return block[(position.x - minimum.x) + (position.y - minimum.y) * size.x]; };
+    const auto movement   = LevelData::determineMovementClass (tile (start));
+    const auto difference = sf::Vector2f (end - start);
+    const auto magnitude  = std::sqrt (difference.x * difference.x + difference.y * difference.y);
+
+    // Sample exactly as calculateBranch() does so the result always agrees with the branches of the tree.
+    for (auto current = 0.f; current < magnitude;)
     {
-        case TileType::OutOfBounds:
-        case TileType::Tree:
-            return type != TileType::OutOfBounds && type != TileType::Tree;
+        current = std::fmin (current + m_sampleDistance, magnitude);
 
-        case TileType::Water:
-            return type == TileType::Water;
+        const auto position = sf::Vector2i ((sf::Vector2f) start + difference * (current / magnitude));
 
-        default:
-            return type == TileType::Terrain || type == TileType::Swamp;
+        if (m_heatmap)
+        {
+            m_heatmap->record (HeatmapCounter::CollisionChecks, position);
+        }
+
+        if (!LevelData::isTraversable (tile (position), movement))
+        {
+            return false;
+        }
     }
+
+    return true;
 }
 
 
 RRTTree::Branch RRT::determineNearest (const sf::Vector2i& position) const
 {
     // Set some unlikely values as the starting points.
-    auto closest      = m_tree.get();
+    auto closest      = m_tree;
     auto nearDistance = std::numeric_limits<int>::max();
 
     for (const auto branch : m_nodes)
@@ -224,8 +568,7 @@ RRTTree::Branch RRT::determineNearest (const sf::Vector2i& position) const
         if (branch)
         {
             // Cache the data of the current branch.
-            const auto data       = branch->getData(),
-                       difference = data - position;
+            const auto difference = branch->getData().position - position;
 
             // Treat each value as an entire tile to traverse.
             const auto distance = (std::abs (difference.x) + std::abs (difference.y));
@@ -250,17 +593,38 @@ RRTTree::Branch RRT::calculateBranch (const sf::Vector2i& start, const sf::Vecto
         return sf::Vector2i ((sf::Vector2f) start + (sf::Vector2f) (end - start) * delta);
     };
 
-    // Firstly we need to type of the current terrain to test where we can go.
-    const auto startType = m_data->getTile ((unsigned int) start.x, (unsigned int) start.y);
-
     // We need the magnitude between the vectors so we can start sampling the distance.
     const auto difference = end - start;
     const auto magnitude  = std::sqrt ((float) (difference.x * difference.x + difference.y * difference.y));
 
+    // Nothing can be calculated if the points are the same.
+    if (magnitude == 0.f)
+    {
+        return nullptr;
+    }
+
+    // Every sample lies between the start and the furthest sample so fetch that block of tiles in one go.
+    const auto furthest = lerp (start, end, std::fmin (magnitude, m_branchDistance) / magnitude);
+    const auto minimum  = sf::Vector2i (std::min (start.x, furthest.x), std::min (start.y, furthest.y));
+    const auto size     = sf::Vector2i (std::abs (furthest.x - start.x) + 1, std::abs (furthest.y - start.y) + 1);
+    
+    // The block lives on the stack so branches can be calculated by several threads at once, only branches much longer
+    // than usual need the heap.
+    const auto tiles = (size_t) (size.x * size.y);
+
+    TileType              stackBlock[stackBlockTiles];
+    std::vector<TileType> heapBlock (tiles > stackBlockTiles ? tiles : 0);
+
+    const auto block = tiles > stackBlockTiles ? heapBlock.data() : stackBlock;
+    m_data->getBlock (minimum.x, minimum.y, size.x, size.y, block);
+
+    // The type of the current terrain determines where we can go, the block is used so trees can grow in parallel.
+    const auto startLocal = start - minimum;
+    const auto movement   = LevelData::determineMovementClass (block[startLocal.x + startLocal.y * size.x]);
+
     // We're going to sample at different points to test we can move to the desired end point.
     RRTTree::Branch branch  = nullptr;
     auto            current = 0.f;
-    auto            valid   = start;
 
     while (current < magnitude && current < m_branchDistance)
     {
@@ -272,16 +636,25 @@ RRTTree::Branch RRT::calculateBranch (const sf::Vector2i& start, const sf::Vecto
 
         if (inc != start)
         {
+            // Find the tile in the local block.
+            const auto local = inc - minimum;
+            assert (local.x >= 0 && local.x < size.x && local.y >= 0 && local.y < size.y);
+
+            if (m_heatmap)
+            {
+                m_heatmap->record (HeatmapCounter::CollisionChecks, inc);
+            }
+
             // We can break early if we've hit an unpassable bit of terrain.
-            if (isValidTile (inc, startType))
+            if (LevelData::isTraversable (block[local.x + local.y * size.x], movement))
             {
                 // Ensure we allocate some memory to store the crap.
                 if (!branch)
                 {
-                    branch = new RRTTree();
+                    branch = m_pool->create();
                 }
             
-                branch->setData (inc);        
+                branch->getData().position = inc;
             }
 
             else
@@ -293,4 +666,525 @@ RRTTree::Branch RRT::calculateBranch (const sf::Vector2i& start, const sf::Vecto
 
     // Return the calculated branch.
     return branch;
+}
+
+
+void RRT::growWindow()
+{
+    const auto width  = (int) m_data->getWidth(),
+               height = (int) m_data->getHeight();
+
+    // Expand each side by half of the extra size so the window grows around its centre.
+    const auto extraX = std::max (1, (int) (m_window.width * (m_windowGrowth - 1.f) / 2.f)),
+               extraY = std::max (1, (int) (m_window.height * (m_windowGrowth - 1.f) / 2.f));
+
+    const auto left   = std::max (0, m_window.left - extraX),
+               top    = std::max (0, m_window.top - extraY),
+               right  = std::min (width, m_window.left + m_window.width + extraX),
+               bottom = std::min (height, m_window.top + m_window.height + extraY);
+
+    m_window  = sf::IntRect (left, top, right - left, bottom - top);
+    m_stalled = 0;
+
+    indexWindow();
+}
+
+
+void RRT::indexWindow()
+{
+    // The node index and coverage grid only cover the window.
+    m_nodes.clear();
+    m_nodes.resize (m_window.width * m_window.height);
+    m_nodes.shrink_to_fit();
+
+    m_coverage.clear();
+
+    if (m_coverageCell != 0)
+    {
+        m_coverageWidth = (m_window.width + m_coverageCell - 1) / m_coverageCell;
+        m_coverage.resize (m_coverageWidth * ((m_window.height + m_coverageCell - 1) / m_coverageCell));
+        m_coverage.shrink_to_fit();
+    }
+
+    // Every node lies within the window so they can all be placed straight into the new index.
+    m_branchBytes = 0;
+
+    for (const auto root : getRoots())
+    {
+        for (const auto branch : root->depthFirst())
+        {
+            const auto& position = branch->getData().position;
+
+            m_nodes[toWindowIndex (position)] = branch;
+            m_branchBytes += branch->getBranches().capacity() * sizeof (RRTTree::Branch);
+            updateCoverage (position, 1);
+        }
+    }
+
+    // A larger index leaves less of any memory budget for nodes.
+    applyMemoryBudget();
+}
+
+
+void RRT::applyMemoryBudget()
+{
+    if (m_memoryBudget == 0)
+    {
+        return;
+    }
+
+    // The window is paid for first, whatever is left goes to nodes.
+    const auto windowBytes = m_nodes.capacity() * sizeof (RRTTree::Branch) + m_coverage.capacity() * sizeof (unsigned int);
+    const auto available   = m_memoryBudget > windowBytes ? m_memoryBudget - windowBytes : 0;
+
+    // Each node but a root sits in the branches of its parent, until the tree has some shape assume a little slack.
+    const auto branchBytes = m_nodeCount > 1 ? m_branchBytes / m_nodeCount : 2 * sizeof (RRTTree::Branch);
+    const auto nodeBytes   = RRTPool::getSlotBytes() + branchBytes;
+    const auto chunkSize   = (size_t) m_pool->getChunkSize();
+
+    // The pool allocates whole chunks so a budget part way through one would still pay for all of it.
+    auto nodes = available / nodeBytes;
+
+    if (nodes >= chunkSize)
+    {
+        nodes = nodes / chunkSize * chunkSize;
+    }
+
+    m_nodeBudget = (unsigned int) std::max<size_t> (2, std::min<size_t> (nodes, std::numeric_limits<unsigned int>::max()));
+}
+
+
+bool RRT::isUncovered (const sf::Vector2i& position) const
+{
+    if (m_coverage.empty())
+    {
+        return true;
+    }
+
+    // The goal must always be reachable.
+    const auto origin = sf::Vector2i (m_window.left, m_window.top);
+    const auto cell   = (position - origin) / (int) m_coverageCell;
+
+    return m_coverage[cell.x + cell.y * m_coverageWidth] < m_coverageLimit || cell == (m_end - origin) / (int) m_coverageCell;
+}
+
+
+bool RRT::isInCorridor (const sf::Vector2i& position) const
+{
+    if (m_corridor.empty())
+    {
+        return true;
+    }
+
+    const auto cell = (position - sf::Vector2i (m_corridorBounds.left, m_corridorBounds.top)) / (int) m_corridorCell;
+
+    return m_corridor[cell.x + cell.y * m_corridorWidth];
+}
+
+
+void RRT::updateCoverage (const sf::Vector2i& position, const int change)
+{
+    if (!m_coverage.empty())
+    {
+        const auto cell = (position - sf::Vector2i (m_window.left, m_window.top)) / (int) m_coverageCell;
+        m_coverage[cell.x + cell.y * m_coverageWidth] += change;
+    }
+}
+
+
+void RRT::updateDomain (RRTNode& node, const bool extended)
+{
+    if (extended)
+    {
+        node.failures = 0;
+
+        // Successful nodes slowly open their domain back up.
+        if (node.radius != std::numeric_limits<float>::infinity())
+        {
+            node.radius *= 1.f + m_domainRate;
+        }
+    }
+
+    else
+    {
+        ++node.failures;
+        ++m_failedCount;
+        failureMetric.increment();
+
+        if (m_heatmap)
+        {
+            m_heatmap->record (HeatmapCounter::FailedExtensions, node.position);
+        }
+
+        // The first failure marks the node as being on a blocked frontier, further failures shrink it towards a tile.
+        if (m_domainRadius > 0.f)
+        {
+            node.radius = node.radius == std::numeric_limits<float>::infinity() ? m_domainRadius : 
+                std::max (1.f, node.radius * (1.f - m_domainRate));
+        }
+    }
+}
+
+
+void RRT::recordSolved()
+{
+    m_solved = true;
+    solvedMetric.increment();
+    latencyMetric.observe (std::chrono::duration<double> (Clock::now() - m_queryStart).count());
+}
+
+
+bool RRT::beginIteration()
+{
+    // Don't bother if we've already finished or can never finish, exploring trees grow regardless of the end.
+    if (!(m_exploring || (!hasFinished() && m_start != m_end)) || !m_reachable)
+    {
+        return false;
+    }
+
+    // Widen the search if the tree has stopped growing inside the current window.
+    if (++m_stalled > m_windowPatience && m_corridor.empty() && 
+        m_window != sf::IntRect (0, 0, m_data->getWidth(), m_data->getHeight()))
+    {
+        growWindow();
+    }
+
+    iterationMetric.increment();
+
+    return true;
+}
+
+
+BranchResult RRT::extendTowards (const sf::Vector2i& sample, sf::Vector2i& nearest)
+{
+    const auto index = sample.x + sample.y * m_data->getWidth();
+
+    if (m_heatmap)
+    {
+        m_heatmap->record (HeatmapCounter::Samples, sample);
+    }
+
+    // Samples outside of the region of the start can never be reached so they're skipped, as are samples in areas
+    // which are already well covered by the tree.
+    if (m_nodes[toWindowIndex (sample)] || 
+        (m_startRegion != 0 && m_data->getRegion (index, m_movement) != m_startRegion) || 
+        !isUncovered (sample) || !isInCorridor (sample))
+    {
+        return BranchResult::Skipped;
+    }
+
+    // Make room for the new branch if we've ran out.
+    if (m_nodeBudget != 0 && m_nodeCount >= m_nodeBudget)
+    {
+        pruneLeaves();
+    }
+
+    const auto nearestBranch = determineNearest (sample);
+
+    // Obtain the data of the nearest branch, samples outside of its domain would most likely fail so reject them
+    // before spending any time on collision detection.
+    auto&      nearData = nearestBranch->getData();
+    const auto offset   = sf::Vector2f (sample - nearData.position);
+
+    nearest = nearData.position;
+
+    if (offset.x * offset.x + offset.y * offset.y > nearData.radius * nearData.radius)
+    {
+        ++m_rejectedCount;
+        return BranchResult::Rejected;
+    }
+
+    // Calculate the new branch.
+    const auto branch = calculateBranch (nearData.position, sample);
+    auto       result = BranchResult::Failed;
+    extensionMetric.increment();
+
+    // An invalid branch will be returned in a new branch couldn't be generated.
+    if (branch)
+    {
+        // Cache the new data.
+        auto&      newData  = branch->getData();
+        const auto newIndex = toWindowIndex (newData.position);
+
+        // A valid branch which would crowd a covered area or leave the corridor isn't the node's fault, so it doesn't
+        // count against its domain or make it look like a dead end.
+        if (!m_nodes[newIndex] && (!isUncovered (newData.position) || !isInCorridor (newData.position)))
+        {
+            m_pool->destroy (branch);
+            return BranchResult::Rejected;
+        }
+
+        // Don't overwrite any nodes.
+        if (!m_nodes[newIndex])
+        {
+            // Keep track of how far the new branch is from the root.
+            const auto difference = sf::Vector2f (newData.position - nearData.position);
+            newData.cost          = nearData.cost + std::sqrt (difference.x * difference.x + difference.y * difference.y);
+            newData.tree          = nearData.tree;
+            updateDomain (nearData, true);
+
+            // Add it to the tree.
+            nearestBranch->addBranch (branch);
+            m_nodes[newIndex] = branch;
+            m_stalled         = 0;
+            ++m_nodeCount;
+            updateCoverage (newData.position, 1);
+            result = BranchResult::Extended;
+
+            if (m_localCount > 0)
+            {
+                connectTrees (branch);
+            }
+
+            if (!m_solved && hasFinished())
+            {
+                recordSolved();
+            }
+        }
+
+        else
+        {
+            m_pool->destroy (branch);
+            updateDomain (nearData, false);
+        }
+    }
+
+    else
+    {
+        updateDomain (nearData, false);
+    }
+
+    // A node which keeps failing is probably facing a narrow passage, try growing from the other side of it.
+    if (nearData.failures == m_spawnFailures)
+    {
+        spawnTree (sample);
+    }
+
+    return result;
+}
+
+
+void RRT::traceBranch (const sf::Vector2i& sample, const sf::Vector2i& nearest, const BranchResult result, const Clock::time_point started)
+{
+    if (m_trace)
+    {
+        // The record holds 32-bit nanoseconds so iterations over about 4.29 seconds saturate.
+        const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds> (Clock::now() - started).count();
+
+        auto record    = TraceRecord { };
+        record.sample  = sample;
+        record.nearest = nearest;
+        record.result  = result;
+        record.value   = (std::uint32_t) std::min<long long> (nanoseconds, std::numeric_limits<std::uint32_t>::max());
+
+        m_trace->record (record);
+    }
+}
+
+
+void RRT::pruneLeaves()
+{
+    // Leaves which have failed to grow this many times in a row are considered dead ends.
+    const auto deadEnd = 3U;
+
+    // Score every leaf, dead ends always rank above the rest and otherwise the estimated cost through the leaf is used.
+    std::vector<std::pair<float, RRTTree::Branch>> leaves { };
+    m_branchBytes = 0;
+
+    for (const auto root : getRoots())
+    {
+        for (const auto branch : root->depthFirst())
+        {
+            m_branchBytes += branch->getBranches().capacity() * sizeof (RRTTree::Branch);
+
+            if (branch->isTip() && !branch->isRoot())
+            {
+                const auto& data      = branch->getData();
+                const auto  remaining = sf::Vector2f (m_end - data.position);
+                const auto  estimate  = data.cost + std::sqrt (remaining.x * remaining.x + remaining.y * remaining.y);
+
+                leaves.emplace_back (data.failures >= deadEnd ? std::numeric_limits<float>::max() : estimate, branch);
+            }
+        }
+    }
+
+    // The scan measured what branches really cost, a memory budget may now allow a different number of nodes.
+    applyMemoryBudget();
+
+    if (m_nodeCount < m_nodeBudget)
+    {
+        return;
+    }
+
+    // Prune an eighth of the budget at a time so the cost of scanning the tree is spread over many branches.
+    const auto count = std::max (1U, m_nodeBudget / 8);
+
+    // Keep only the worst leaves.
+    if (leaves.size() > count)
+    {
+        std::nth_element (leaves.begin(), leaves.begin() + count, leaves.end(), 
+            [] (const std::pair<float, RRTTree::Branch>& lhs, const std::pair<float, RRTTree::Branch>& rhs)
+            {
+                return lhs.first > rhs.first;
+            });
+
+        leaves.resize (count);
+    }
+
+    std::vector<RRTTree::Branch> branches { };
+    branches.reserve (leaves.size());
+
+    for (const auto& leaf : leaves)
+    {
+        branches.push_back (leaf.second);
+    }
+
+    // Chunks left over from a larger budget are only given back by packing the nodes together.
+    m_prunedCount += prune (branches, m_memoryBudget != 0 && m_pool->getCapacity() > m_nodeBudget);
+}
+
+
+void RRT::applyTuning (const std::shared_ptr<LevelData>& data)
+{
+    if (!m_tuning || m_tunedLevel.lock() == data)
+    {
+        return;
+    }
+
+    auto parameters = m_defaults;
+    m_tuning->find (data->calculateContentHash(), parameters);
+
+    m_sampleDistance = parameters.sampleDistance;
+    m_branchDistance = parameters.branchDistance;
+    m_tunedLevel     = data;
+
+    // The default domain is relative to the branch distance so it follows the tuning, a chosen radius is kept.
+    if (!m_domainExplicit)
+    {
+        m_domainRadius = m_branchDistance * 2.f;
+    }
+}
+
+
+std::vector<RRTTree::Branch> RRT::getRoots() const
+{
+    std::vector<RRTTree::Branch> roots { m_tree };
+
+    for (const auto root : m_localTrees)
+    {
+        if (root)
+        {
+            roots.push_back (root);
+        }
+    }
+
+    return roots;
+}
+
+
+void RRT::spawnTree (const sf::Vector2i& position)
+{
+    // The sample has already been checked against the index, coverage and corridor, but without a known region we can't
+    // tell whether it's traversable.
+    if (m_localCount >= m_forestLimit || m_startRegion == 0 || m_nodes[toWindowIndex (position)])
+    {
+        return;
+    }
+
+    RRTNode root { };
+    root.position = position;
+    root.tree     = m_localTrees.size() + 1;
+
+    const auto branch = m_pool->create (root);
+
+    m_localTrees.push_back (branch);
+    m_nodes[toWindowIndex (position)] = branch;
+    ++m_localCount;
+    ++m_nodeCount;
+    updateCoverage (position, 1);
+}
+
+
+void RRT::connectTrees (const RRTTree::Branch branch)
+{
+    const auto& data  = branch->getData();
+    const auto  reach = (int) m_branchDistance;
+
+    // Find the nearest node of any other tree within the reach of a branch.
+    const auto left   = std::max (m_window.left, data.position.x - reach),
+               top    = std::max (m_window.top, data.position.y - reach),
+               right  = std::min (m_window.left + m_window.width - 1, data.position.x + reach),
+               bottom = std::min (m_window.top + m_window.height - 1, data.position.y + reach);
+
+    auto nearest  = RRTTree::Branch { nullptr };
+    auto distance = m_branchDistance * m_branchDistance;
+
+    for (auto y = top; y <= bottom; ++y)
+    {
+        for (auto x = left; x <= right; ++x)
+        {
+            const auto other = m_nodes[toWindowIndex (sf::Vector2i (x, y))];
+
+            if (other && other->getData().tree != data.tree)
+            {
+                const auto difference = sf::Vector2f (sf::Vector2i (x, y) - data.position);
+                const auto squared    = difference.x * difference.x + difference.y * difference.y;
+
+                if (squared <= distance)
+                {
+                    nearest  = other;
+                    distance = squared;
+                }
+            }
+        }
+    }
+
+    if (!nearest)
+    {
+        return;
+    }
+
+    // Validate the connection with the same collision detection as every other branch, it must reach the node exactly.
+    const auto link  = calculateBranch (data.position, nearest->getData().position);
+    const auto clear = link && link->getData().position == nearest->getData().position;
+
+    if (link)
+    {
+        m_pool->destroy (link);
+    }
+
+    if (clear)
+    {
+        mergeTrees (branch, nearest);
+    }
+}
+
+
+void RRT::mergeTrees (const RRTTree::Branch a, const RRTTree::Branch b)
+{
+    // The tree rooted at the start must keep its root so the lower label always absorbs the other.
+    const auto keep   = a->getData().tree < b->getData().tree ? a : b,
+               absorb = keep == a ? b : a;
+    const auto label  = absorb->getData().tree;
+
+    // Hang the absorbed tree from the connecting node.
+    absorb->reroot();
+    keep->splice (absorb);
+
+    m_localTrees[label - 1] = nullptr;
+    --m_localCount;
+    ++m_mergedCount;
+
+    // Parents are visited before their branches so each cost can be built from the one above it.
+    const auto tree = keep->getData().tree;
+
+    for (const auto node : absorb->breadthFirst())
+    {
+        auto&       data       = node->getData();
+        const auto& parent     = node->getParent()->getData();
+        const auto  difference = sf::Vector2f (data.position - parent.position);
+
+        data.tree = tree;
+        data.cost = parent.cost + std::sqrt (difference.x * difference.x + difference.y * difference.y);
+    }
 }
\ No newline at end of file
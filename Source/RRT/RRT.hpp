@@ -3,22 +3,65 @@
 
 
 // STL headers.
+#include <chrono>
+#include <limits>
 #include <memory>
+#include <random>
+#include <vector>
 
 
 // Application headers.
+#include <RRT/RRTTuning.hpp>
 #include <RRT/Tree.hpp>
+#include <RRT/TreePool.hpp>
+#include <Utility/HugePages.hpp>
+#include <Utility/MemoryTracker.hpp>
+#include <Utility/Metrics.hpp>
 
 
 // External headers.
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Vertex.hpp>
 #include <SFML/System/Vector2.hpp>
 
 
 // Forward declarations and aliases.
 class LevelData;
+class PlanTrace;
+class TileHeatmap;
+enum class MovementClass : char;
 enum class TileType : char;
-using RRTTree = Tree<sf::Vector2i>;
+
+
+/// <summary>
+/// The data stored in each node of an RRT tree.
+/// </summary>
+struct RRTNode final
+{
+    sf::Vector2i    position    { };    //!< The tile the node lies on.
+    float           cost        { 0 };  //!< The length of the path from the root to the node.
+    unsigned int    failures    { 0 };  //!< How many times in a row growing a branch from the node has failed.
+    float           radius      { std::numeric_limits<float>::infinity() }; //!< Samples further than this from the node are rejected.
+    unsigned int    tree        { 0 };  //!< The tree the node belongs to, zero for the tree rooted at the start.
+};
+
+/// <summary>
+/// What happened to a single sample whilst growing the tree.
+/// </summary>
+enum class BranchResult : char
+{
+    Idle,       //!< Nothing was sampled because the tree has finished or can't ever finish.
+    Skipped,    //!< The sample was filtered out before its nearest node was found.
+    Rejected,   //!< The sample lay outside the domain of its nearest node, or its branch was covered or outside the corridor.
+    Failed,     //!< No branch could be added towards the sample.
+    Extended,   //!< A new branch was added towards the sample.
+    Count       //!< The number of results.
+};
+
+
+using RRTTree = Tree<RRTNode>;
+using RRTPool = TreePool<RRTNode>;
 
 
 /// <summary>
@@ -55,6 +98,163 @@ class RRT final
         /// <summary> Obtains the end point of the RRT algorithm. </summary>
         const sf::Vector2i& getEnd() const      { return m_end; }
 
+        /// <summary> Checks whether the end point is in the same connected region as the start point. </summary>
+        bool isReachable() const                { return m_reachable; }
+
+        /// <summary> Gets the number of nodes in the tree, including the root. </summary>
+        unsigned int getNodeCount() const       { return m_nodeCount; }
+
+        /// <summary> Gets the sample distance currently in use, this may have been tuned for the level. </summary>
+        float getSampleDistance() const         { return m_sampleDistance; }
+
+        /// <summary> Gets the branch distance currently in use, this may have been tuned for the level. </summary>
+        float getBranchDistance() const         { return m_branchDistance; }
+
+        /// <summary> Gets the root of the tree, this is positioned at the start. </summary>
+        RRTTree::Branch getRoot() const         { return m_tree; }
+
+        /// <summary> Gets the branch at the given position. </summary>
+        /// <returns> The branch, nullptr if the tree doesn't reach the position. </returns>
+        RRTTree::Branch getBranch (const sf::Vector2i& position) const;
+
+        /// <summary> Gets the path from the start to the end through the tree. </summary>
+        /// <returns> The position of every node along the path, empty if the tree hasn't reached the end. </returns>
+        std::vector<sf::Vector2i> getPath() const;
+
+        /// <summary> Gets the area of the level currently being sampled, in tiles. </summary>
+        const sf::IntRect& getWindow() const    { return m_window; }
+
+        /// <summary> Gets the number of bytes allocated for the nodes of the tree. </summary>
+        size_t getStorageBytes() const          { return m_pool->getStorageBytes(); }
+
+        /// <summary> Gets the maximum number of nodes the tree may contain, zero means unlimited. </summary>
+        unsigned int getNodeBudget() const      { return m_nodeBudget; }
+
+        /// <summary> Gets the total number of leaves which have been pruned to keep within the node budget. </summary>
+        unsigned int getPrunedCount() const     { return m_prunedCount; }
+
+        /// <summary> Gets how many times a branch couldn't be grown towards a sample since the tree was prepared. </summary>
+        unsigned int getFailedCount() const     { return m_failedCount; }
+
+        /// <summary> Gets how many samples were rejected for lying outside the domain of their nearest node. </summary>
+        unsigned int getRejectedCount() const   { return m_rejectedCount; }
+
+        /// <summary> Gets how many local trees are growing separately from the tree rooted at the start. </summary>
+        unsigned int getLocalTreeCount() const  { return m_localCount; }
+
+        /// <summary> Gets how many local trees have been merged into another tree since the tree was prepared. </summary>
+        unsigned int getMergedCount() const     { return m_mergedCount; }
+
+
+        /////////////
+        // Setters //
+        /////////////
+
+        /// <summary> 
+        /// Limits the number of nodes in the tree. Once the budget is reached the least valuable leaves are pruned and
+        /// their storage reused, so planning can continue indefinitely in a fixed amount of memory.
+        /// </summary>
+        /// <param name="budget"> The maximum number of nodes, zero removes the limit. </param>
+        void setNodeBudget (const unsigned int budget);
+
+        /// <summary> 
+        /// Configures dynamic-domain sampling. Nodes start with an unlimited domain, the first failure to grow from a node
+        /// limits its domain to the given radius and further failures shrink it, whilst each success grows it again.
+        /// Samples outside the domain of their nearest node are rejected before any collision detection is performed.
+        /// Until this is called the radius is twice the branch distance, including any distance tuned for the level.
+        /// </summary>
+        /// <param name="radius"> The domain given to a node after it first fails, zero disables dynamic domains. </param>
+        /// <param name="rate"> The fraction the domain shrinks by on failure and grows by on success. </param>
+        void setDynamicDomain (const float radius, const float rate = 0.1f);
+
+        /// <summary> 
+        /// Configures coverage rejection. The level is split into square cells and once a cell holds enough nodes any
+        /// sample or new branch landing in it is rejected, this stops well explored areas filling up with redundant nodes.
+        /// </summary>
+        /// <param name="cellSize"> The width and height of each cell in tiles, zero disables coverage rejection. </param>
+        /// <param name="limit"> The number of nodes a cell can hold before it's considered covered. </param>
+        void setCoverage (const unsigned int cellSize, const unsigned int limit);
+
+        /// <summary>
+        /// Configures the planning window. Rather than sampling the whole level, planning starts in a box surrounding the
+        /// start and end and only nodes inside the box are indexed. If no branch is added for a number of iterations the
+        /// box grows around its centre, eventually covering the whole level, so short queries on huge levels stay cheap.
+        /// </summary>
+        /// <param name="margin"> The number of tiles around the start and end to include, zero samples the whole level. </param>
+        /// <param name="patience"> How many iterations without a new branch are allowed before the window grows. </param>
+        /// <param name="growth"> How much the width and height of the window are multiplied by each time it grows. </param>
+        void setWindow (const unsigned int margin, const unsigned int patience = 256U, const float growth = 2.f);
+
+        /// <summary>
+        /// Restricts planning to a corridor, usually one found by planning on a coarser version of the level. The corridor is
+        /// a grid of square cells covering the given bounds and any sample or new branch landing in a cell which isn't part
+        /// of the corridor is rejected. The bounds become the planning window so the window setting is ignored.
+        /// </summary>
+        /// <param name="bounds"> The area of the level the corridor covers in tiles, the start and end must be inside it. </param>
+        /// <param name="cellSize"> The width and height of each corridor cell in tiles. </param>
+        /// <param name="cells"> Whether each cell is part of the corridor, row by row. </param>
+        void setCorridor (const sf::IntRect& bounds, const unsigned int cellSize, std::vector<bool> cells);
+
+        /// <summary> Removes the corridor so the whole level can be planned in again. </summary>
+        void clearCorridor();
+
+        /// <summary> Sets the seed used to generate samples, zero seeds from the clock each time the tree is prepared. </summary>
+        void setSeed (const unsigned int seed)  { m_seed = seed; }
+
+        /// <summary>
+        /// Keeps the tree growing after the end has been reached, for trees which are only one part of a larger search.
+        /// An exploring tree may be prepared with the same start and end to grow without any goal at all.
+        /// </summary>
+        void setExploring (const bool exploring)    { m_exploring = exploring; }
+
+        /// <summary>
+        /// Limits the planner to roughly the given amount of memory, this is converted to a node budget. The node index
+        /// and coverage grid of the window are taken off first and the rest is split between node storage, rounded down
+        /// to whole chunks of the pool, and the branches each node holds. The budget is derived again whenever the window
+        /// grows or leaves are pruned, so it follows the measured cost of the tree. At least one chunk of storage is
+        /// always used however small the budget.
+        /// </summary>
+        /// <param name="bytes"> The maximum number of bytes, zero removes the limit. </param>
+        void setMemoryBudget (const size_t bytes);
+
+        /// <summary>
+        /// Configures forest mode. When growing from a node fails repeatedly the area around it is considered hard, such as
+        /// a narrow passage, and a local tree is rooted at the sample which couldn't be reached. Every tree grows from the
+        /// same samples and whenever a new branch lands within reach of another tree, a connecting branch is calculated
+        /// and if it's clear the trees are merged. The tree rooted at the start always absorbs the others.
+        /// </summary>
+        /// <param name="limit"> The most local trees which may grow at once, zero disables forest mode. </param>
+        /// <param name="failures"> How many failures in a row from a node cause a local tree to be spawned. </param>
+        void setForest (const unsigned int limit, const unsigned int failures = 3U);
+
+        /// <summary>
+        /// Sets the parameters tuned for individual maps. Whenever the tree is prepared on a different level its content
+        /// hash is looked up and the tuned sample and branch distances are used, levels which haven't been tuned use the
+        /// distances given to the constructor.
+        /// </summary>
+        /// <param name="tuning"> The tuned parameters, nullptr always uses the constructor's distances. </param>
+        void setTuning (const std::shared_ptr<const RRTTuning>& tuning);
+
+        /// <summary>
+        /// Records where effort is spent into a heatmap covering the level: every sample drawn, every tile tested for
+        /// collision and every node which failed to grow. A heatmap can be shared between trees growing in parallel.
+        /// </summary>
+        /// <param name="heatmap"> The heatmap to record into, it must match the size of the level. nullptr stops recording. </param>
+        void setHeatmap (const std::shared_ptr<TileHeatmap>& heatmap)   { m_heatmap = heatmap; }
+
+        /// <summary> Gets the heatmap being recorded into, if any. </summary>
+        const std::shared_ptr<TileHeatmap>& getHeatmap() const          { return m_heatmap; }
+
+        /// <summary>
+        /// Records every query and every sample into a trace, along with the node grown from, the result and how long it
+        /// took, so the exact workload can be replayed later. Only one tree may record into a trace at a time.
+        /// </summary>
+        /// <param name="trace"> The trace to record into, it must have been created for the level. nullptr stops recording. </param>
+        void setTrace (const std::shared_ptr<PlanTrace>& trace)         { m_trace = trace; }
+
+        /// <summary> Gets the trace being recorded into, if any. </summary>
+        const std::shared_ptr<PlanTrace>& getTrace() const              { return m_trace; }
+
 
         ///////////////
         // Rendering //
@@ -79,17 +279,70 @@ class RRT final
         /// <param name="end"> The end point of the RRT algorithm. </param>
         void prepareTree (const std::shared_ptr<LevelData>& data, const sf::Vector2i& start, const sf::Vector2i& end);
 
-        /// <summary> Causes the algorithm to produce an extra branch if it hasn't already reached the goal. </summary>
+        /// <summary> Causes the algorithm to produce an extra branch if it hasn't already reached the goal or is exploring. </summary>
         void generateBranch();
 
+        /// <summary>
+        /// Grows the tree towards the given sample instead of a random one, this is how a trace is replayed. The iteration
+        /// is otherwise identical so the planning window still grows when the tree stalls.
+        /// </summary>
+        /// <param name="sample"> The position to grow towards, samples outside of the planning window are skipped. </param>
+        /// <returns> What happened to the sample. </returns>
+        BranchResult generateBranch (const sf::Vector2i& sample);
+
+        /// <summary> 
+        /// Removes every given branch along with everything below them in a single pass over the node storage. The
+        /// removed positions become free so new branches can be grown there again.
+        /// </summary>
+        /// <param name="branches"> The branches to remove, the root can't be removed. </param>
+        /// <param name="compact"> Whether the remaining nodes should be packed together to give memory back. </param>
+        /// <returns> The number of nodes removed. </returns>
+        unsigned int prune (const std::vector<RRTTree::Branch>& branches, const bool compact = false);
+
         /// <summary> Checks if the tile at the given position is valid according to the base type. </summary>
         /// <param name="position"> The position to check. </param>
         /// <param name="base"> The base tile, this impacts whether the tile is valid. TileType::OutOfBounds allows any tile. </param>
         /// <returns> A TileType::Water base can only travel on water, the rest can travel on land only. </returns>
         bool isValidTile (const sf::Vector2i& position, const TileType base) const;
 
+        /// <summary> 
+        /// Checks whether a straight line between two positions can be travelled, sampling it in the same way as the
+        /// branches of the tree. This doesn't touch the scratch space of the tree so it can be called from any thread.
+        /// </summary>
+        /// <param name="start"> The position to start from, its tile determines the movement class. </param>
+        /// <param name="end"> The position to finish at, this can be further away than a branch. </param>
+        bool isClear (const sf::Vector2i& start, const sf::Vector2i& end) const;
+
     private:
 
+        /// <summary> Compares the nearest neighbour search and branch stepping against their references. </summary>
+        friend class DifferentialTester;
+
+        /// <summary> The node index is randomly accessed across the whole window so it follows the HugePages policy. </summary>
+        using NodeIndex = std::vector<RRTTree::Branch, HugePageAllocator<RRTTree::Branch, MemorySubsystem::RRTIndex>>;
+
+        /// <summary> The node count of each coverage cell, this is accounted for alongside the node index. </summary>
+        using CoverageGrid = std::vector<unsigned int, TrackedAllocator<unsigned int, MemorySubsystem::RRTIndex>>;
+
+        /// <summary> The clock used to time queries for the metrics. </summary>
+        using Clock = std::chrono::high_resolution_clock;
+
+        /// <summary> Records that the query has been solved the first time the end joins the tree rooted at the start. </summary>
+        void recordSolved();
+
+        /// <summary> Starts an iteration by growing the window if the tree has stalled. </summary>
+        /// <returns> Whether the tree can grow at all, false if it has finished or can never finish. </returns>
+        bool beginIteration();
+
+        /// <summary> Tries to add a branch from the nearest node towards a sample within the planning window. </summary>
+        /// <param name="sample"> The position to grow towards. </param>
+        /// <param name="nearest"> Is set to the position of the node grown from, if one was found. </param>
+        /// <returns> What happened to the sample. </returns>
+        BranchResult extendTowards (const sf::Vector2i& sample, sf::Vector2i& nearest);
+
+        /// <summary> Adds an iteration to the trace, if one is being recorded. </summary>
+        void traceBranch (const sf::Vector2i& sample, const sf::Vector2i& nearest, const BranchResult result, const Clock::time_point started);
+
         /// <summary> Determines the Branch closest to the given position. </summary>
         /// <param name="position"> The position to check for. </param>
         /// <returns> The closest Branch. </returns>
@@ -100,21 +353,133 @@ class RRT final
         /// <param name="end"> The target position. </param>
         /// <returns> A new branch, this will be a nullptr if a branch couldn't be generated. </returns>
         RRTTree::Branch calculateBranch (const sf::Vector2i& start, const sf::Vector2i& end) const;
+
+        /// <summary> 
+        /// Prunes a portion of the leaves to bring the tree back under its node budget. Dead ends which have repeatedly
+        /// failed to grow go first, then the leaves with the highest estimated cost of a path through them to the goal.
+        /// </summary>
+        void pruneLeaves();
+
+        /// <summary> Converts a position in the level to an index into the node index of the window. </summary>
+        unsigned int toWindowIndex (const sf::Vector2i& position) const 
+        { 
+            return (position.x - m_window.left) + (position.y - m_window.top) * m_window.width; 
+        }
+
+        /// <summary> Grows the planning window and indexes the nodes again. </summary>
+        void growWindow();
+
+        /// <summary> Rebuilds the node index and coverage grid to cover the current window. </summary>
+        void indexWindow();
+
+        /// <summary> Checks whether the coverage cell containing the given position has room for another node. </summary>
+        bool isUncovered (const sf::Vector2i& position) const;
+
+        /// <summary> Converts the memory budget into a node budget using the current window and the measured branch bytes. </summary>
+        void applyMemoryBudget();
+
+        /// <summary> Checks whether the given position lies within the corridor, always true without a corridor. </summary>
+        bool isInCorridor (const sf::Vector2i& position) const;
+
+        /// <summary> Adjusts the node count of the coverage cell containing the given position. </summary>
+        void updateCoverage (const sf::Vector2i& position, const int change);
+
+        /// <summary> Updates the failure count and sampling domain of a node after trying to grow a branch from it. </summary>
+        /// <param name="node"> The node which was grown from. </param>
+        /// <param name="extended"> Whether a new branch was added. </param>
+        void updateDomain (RRTNode& node, const bool extended);
+
+        /// <summary> Switches to the parameters tuned for the given level if it differs from the last level tuned for. </summary>
+        void applyTuning (const std::shared_ptr<LevelData>& data);
+
+        /// <summary> Gets the root of every tree in the forest, starting with the tree rooted at the start. </summary>
+        std::vector<RRTTree::Branch> getRoots() const;
+
+        /// <summary> Roots a new local tree at the given sample if forest mode allows another tree. </summary>
+        void spawnTree (const sf::Vector2i& position);
+
+        /// <summary> Looks for a node of another tree within reach of a new branch and merges the trees if it can be reached. </summary>
+        void connectTrees (const RRTTree::Branch branch);
+
+        /// <summary> Merges the trees of two nodes joined by a clear branch, the tree with the lower label absorbs the other. </summary>
+        void mergeTrees (const RRTTree::Branch a, const RRTTree::Branch b);
         
 
+        /////////////
+        // Metrics //
+        /////////////
+
+        static const MetricCounter      queryMetric;        //!< Counts the queries prepared.
+        static const MetricCounter      solvedMetric;       //!< Counts the queries which reached the end.
+        static const MetricHistogram    latencyMetric;      //!< The time taken to solve each query.
+        static const MetricCounter      iterationMetric;    //!< Counts the iterations which drew a sample.
+        static const MetricCounter      extensionMetric;    //!< Counts the attempts to grow a branch towards a sample.
+        static const MetricCounter      failureMetric;      //!< Counts the attempts which didn't add a branch.
+        static const MetricGauge        failureRatioMetric; //!< The fraction of attempts which failed.
+
+
         ///////////////////
         // Internal data //
         ///////////////////
 
+        /// <summary> How many tiles calculateBranch() keeps on the stack, enough for a branch distance of 31 tiles. </summary>
+        static const unsigned int stackBlockTiles = 1024;
+
         std::shared_ptr<LevelData>      m_data              { };    //!< A pointer to the LevelData which the Tree will be generated with.
         sf::Vector2i                    m_start             { };    //!< The start point of the RRT algorithm.
         sf::Vector2i                    m_end               { };    //!< The end point of the RRT algorithm.
 
         float                           m_sampleDistance    { 0 };  //!< How much to increment by when sampling the distance.
         float                           m_branchDistance    { 0 };  //!< The maximum distance of a branch.
-
-        std::vector<RRTTree::Branch>    m_nodes             { };    //!< A collection of pointers to each branch in tile order.
-        std::shared_ptr<RRTTree>        m_tree              { };    //!< The tree containing each node and its branches.
+        RRTParameters                   m_defaults          { };    //!< The distances given to the constructor, used by levels without tuning.
+        std::shared_ptr<const RRTTuning> m_tuning           { };    //!< The parameters tuned for each map, if any.
+        std::weak_ptr<const LevelData>  m_tunedLevel        { };    //!< The level the current distances were chosen for.
+        std::shared_ptr<TileHeatmap>    m_heatmap           { };    //!< Where effort is recorded, nullptr if it isn't.
+        std::shared_ptr<PlanTrace>      m_trace             { };    //!< Where every sample is recorded, nullptr if they aren't.
+        unsigned int                    m_coverageCell      { 4 };  //!< The size of each coverage cell in tiles, zero if disabled.
+        unsigned int                    m_coverageLimit     { 4 };  //!< How many nodes a coverage cell can hold.
+        unsigned int                    m_coverageWidth     { 0 };  //!< How many coverage cells make up each row.
+        CoverageGrid                    m_coverage          { };    //!< The number of nodes in each coverage cell.
+        float                           m_domainRadius      { 0 };  //!< The domain given to nodes after their first failure, zero if disabled.
+        float                           m_domainRate        { 0.1f };   //!< How quickly domains shrink and grow.
+        bool                            m_domainExplicit    { false };  //!< Whether the domain radius was chosen rather than derived from the branch distance.
+
+        MovementClass                   m_movement          { };        //!< The movement class of the start point.
+        unsigned int                    m_startRegion       { 0 };      //!< The connected region containing the start point, zero if unknown.
+        bool                            m_reachable         { false };  //!< Whether the end point can be reached from the start point.
+        bool                            m_exploring         { false };  //!< Whether the tree keeps growing once the end is reached.
+        unsigned int                    m_seed              { 0 };      //!< The seed used when preparing the tree, zero uses the clock.
+        Clock::time_point               m_queryStart        { };        //!< When the tree was last prepared.
+        bool                            m_solved            { false };  //!< Whether the current query has been recorded as solved.
+        std::mt19937                    m_random            { };        //!< Generates samples, each tree has its own so they can grow in parallel.
+
+        sf::IntRect                     m_window            { };    //!< The area of the level being sampled.
+        unsigned int                    m_windowMargin      { 32 }; //!< How many tiles the initial window extends past the start and end, zero if disabled.
+        unsigned int                    m_windowPatience    { 256 };    //!< How many iterations without a new branch cause the window to grow.
+        float                           m_windowGrowth      { 2.f };    //!< How much the window grows by.
+        unsigned int                    m_stalled           { 0 };  //!< How many iterations have passed without a new branch.
+
+        sf::IntRect                     m_corridorBounds    { };    //!< The area covered by the corridor, empty if there isn't one.
+        unsigned int                    m_corridorCell      { 0 };  //!< The size of each corridor cell in tiles.
+        unsigned int                    m_corridorWidth     { 0 };  //!< How many corridor cells make up each row.
+        std::vector<bool>               m_corridor          { };    //!< Whether each cell is part of the corridor.
+
+        NodeIndex                       m_nodes             { };    //!< A collection of pointers to each branch in tile order, covering the window.
+        unsigned int                    m_nodeCount         { 0 };  //!< The number of nodes in the tree.
+        unsigned int                    m_nodeBudget        { 0 };  //!< The maximum number of nodes in the tree, zero if unlimited.
+        size_t                          m_memoryBudget      { 0 };  //!< The memory the node budget is derived from, zero if it was set directly.
+        size_t                          m_branchBytes       { 0 };  //!< The bytes held by the branches of every node when the tree was last walked.
+        unsigned int                    m_prunedCount       { 0 };  //!< How many leaves have been pruned to stay within budget.
+        unsigned int                    m_failedCount       { 0 };  //!< How many times growing a branch has failed.
+        unsigned int                    m_rejectedCount     { 0 };  //!< How many samples fell outside of their nearest domain.
+        unsigned int                    m_forestLimit       { 0 };  //!< The most local trees which can grow at once, zero if forest mode is disabled.
+        unsigned int                    m_spawnFailures     { 3 };  //!< How many failures in a row from a node spawn a local tree.
+        unsigned int                    m_localCount        { 0 };  //!< How many local trees are still separate.
+        unsigned int                    m_mergedCount       { 0 };  //!< How many local trees have been merged.
+        std::vector<RRTTree::Branch>    m_localTrees        { };    //!< The root of each local tree by label minus one, nullptr once merged.
+        std::vector<sf::Vertex>         m_lines             { };    //!< The vertices of every line drawn by RRT::draw().
+        std::shared_ptr<RRTPool>        m_pool              { };    //!< The storage for every node in the tree.
+        RRTTree::Branch                 m_tree              { };    //!< The root of the tree containing each node and its branches.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "RRTTuning.hpp"
+
+
+// STL headers.
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+
+
+const char* const RRTTuning::defaultFile = "rrt.tuning";
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+RRTTuning::RRTTuning (const std::string& file)
+{
+    loadFromFile (file);
+}
+
+
+RRTTuning::RRTTuning (RRTTuning&& move)
+{
+    *this = std::move (move);
+}
+
+
+RRTTuning& RRTTuning::operator= (RRTTuning&& move)
+{
+    if (this != &move)
+    {
+        m_parameters = std::move (move.m_parameters);
+    }
+
+    return *this;
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+bool RRTTuning::find (const unsigned long long hash, RRTParameters& parameters) const
+{
+    const auto match = m_parameters.find (hash);
+
+    if (match == m_parameters.cend())
+    {
+        return false;
+    }
+
+    parameters = match->second;
+    return true;
+}
+
+
+void RRTTuning::set (const unsigned long long hash, const RRTParameters& parameters)
+{
+    // Pre-condition: The parameters are valid for RRT.
+    assert (parameters.sampleDistance > 0.f && parameters.branchDistance >= 1.f);
+
+    m_parameters[hash] = parameters;
+}
+
+
+/////////////
+// Loading //
+/////////////
+
+void RRTTuning::loadFromFile (const std::string& file)
+{
+    auto stream = std::ifstream (file);
+
+    if (!stream)
+    {
+        throw std::invalid_argument ("RRTTuning::loadFromFile(), file location given is invalid. \"" + file + "\".");
+    }
+
+    auto line   = std::string { };
+    auto number = 0U;
+
+    while (std::getline (stream, line))
+    {
+        ++number;
+
+        // Skip blank lines and comments.
+        const auto first = line.find_first_not_of (" \t\r");
+
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        auto input      = std::istringstream (line);
+        auto hash       = 0ULL;
+        auto parameters = RRTParameters { };
+
+        if (!(input >> std::hex >> hash >> std::dec >> parameters.sampleDistance >> parameters.branchDistance) ||
+            parameters.sampleDistance <= 0.f || parameters.branchDistance < 1.f)
+        {
+            throw std::runtime_error ("RRTTuning::loadFromFile(), line " + std::to_string (number) + " is invalid. \"" + file + "\".");
+        }
+
+        m_parameters[hash] = parameters;
+    }
+}
+
+
+std::shared_ptr<const RRTTuning> RRTTuning::loadDefault()
+{
+    if (!std::ifstream (defaultFile))
+    {
+        return nullptr;
+    }
+
+    return std::make_shared<RRTTuning> (defaultFile);
+}
+
+
+void RRTTuning::saveToFile (const std::string& file) const
+{
+    auto stream = std::ofstream (file);
+
+    if (!stream)
+    {
+        throw std::invalid_argument ("RRTTuning::saveToFile(), unable to write to the file location given. \"" + file + "\".");
+    }
+
+    stream << "# content hash, sample distance, branch distance" << std::endl;
+
+    for (const auto& map : m_parameters)
+    {
+        stream  << std::hex << std::setw (16) << std::setfill ('0') << map.first << std::dec << std::setfill (' ') << " "
+                << map.second.sampleDistance << " " << map.second.branchDistance << std::endl;
+    }
+
+    if (!stream)
+    {
+        throw std::runtime_error ("RRTTuning::saveToFile(), an error occurred whilst writing. \"" + file + "\".");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef GEC_RRT_TUNING_HPP
+#define GEC_RRT_TUNING_HPP
+
+
+// STL headers.
+#include <map>
+#include <memory>
+#include <string>
+
+
+/// <summary>
+/// The RRT parameters which are worth tuning per map.
+/// </summary>
+struct RRTParameters final
+{
+    float   sampleDistance  { 0.25f };  //!< The incrementation to use when sampling between branches during collision detection.
+    float   branchDistance  { 15.f };   //!< The maximum distance of a branch.
+};
+
+
+/// <summary>
+/// A collection of RRT parameters tuned for individual maps, keyed by LevelData::calculateContentHash() so a map keeps its
+/// parameters wherever it's loaded from. Each line of a tuning file holds the hash in hexadecimal followed by the sample
+/// distance and branch distance, lines starting with '#' are comments.
+/// </summary>
+class RRTTuning final
+{
+    public:
+
+        /// <summary> The tuning file which the tools write to and the demo loads from by default. </summary>
+        static const char* const defaultFile;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        RRTTuning()                                     = default;
+
+        /// <summary> Constructs the tuning from the given file. Exceptions can be thrown. </summary>
+        /// <param name="file"> The file to load from. </param>
+        RRTTuning (const std::string& file);
+
+        RRTTuning (RRTTuning&& move);
+        RRTTuning& operator= (RRTTuning&& move);
+
+        RRTTuning (const RRTTuning& copy)               = default;
+        RRTTuning& operator= (const RRTTuning& copy)    = default;
+        ~RRTTuning()                                    = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the number of maps which have been tuned. </summary>
+        unsigned int getMapCount() const    { return m_parameters.size(); }
+
+        /// <summary> Finds the parameters tuned for a map. </summary>
+        /// <param name="hash"> The content hash of the map. </param>
+        /// <param name="parameters"> Set to the tuned parameters if there are any. </param>
+        /// <returns> Whether the map has been tuned. </returns>
+        bool find (const unsigned long long hash, RRTParameters& parameters) const;
+
+        /// <summary> Sets the parameters of a map, replacing any it already had. </summary>
+        /// <param name="hash"> The content hash of the map. </param>
+        /// <param name="parameters"> The tuned parameters, the sample distance must be positive and the branch distance at least one. </param>
+        void set (const unsigned long long hash, const RRTParameters& parameters);
+
+
+        /////////////
+        // Loading //
+        /////////////
+
+        /// <summary> Adds the parameters in a tuning file, replacing any maps already tuned. If an error occurs an exception will be thrown. </summary>
+        /// <param name="file"> The file location to load from. </param>
+        void loadFromFile (const std::string& file);
+
+        /// <summary> Loads the default tuning file if it exists. If the file can't be parsed an exception will be thrown. </summary>
+        /// <returns> The tuning in the default file, nullptr if there isn't one. </returns>
+        static std::shared_ptr<const RRTTuning> loadDefault();
+
+        /// <summary> Writes every map to a tuning file. If an error occurs an exception will be thrown. </summary>
+        /// <param name="file"> The file location to write to. </param>
+        void saveToFile (const std::string& file) const;
+
+    private:
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::map<unsigned long long, RRTParameters> m_parameters    { };    //!< The parameters of each map by content hash.
+};
+
+#endif
\ No newline at end of file
@@ -5,9 +5,19 @@
 // STL headers.
 #include <cassert>
 #include <memory>
+#include <utility>
 #include <vector>
 
 
+// Application headers.
+#include <RRT/TreeIterator.hpp>
+#include <Utility/MemoryTracker.hpp>
+
+
+// Forward declarations.
+template <typename T> class TreePool;
+
+
 /// <summary>
 /// A tree data structure containing a parent and an unlimited number of children.
 /// </summary>
@@ -25,8 +35,16 @@ template <typename T> class Tree final
         /// <summary> A child branch of a Tree object. </summary>
         using Branch = Tree<T>*;
 
-        /// <summary> A collection of Branch objects which branch off from the Tree object. </summary>
-        using Branches = std::vector<Branch>;
+        /// <summary> A collection of Branch objects which branch off from the Tree object, counted as MemorySubsystem::TreeBranches. </summary>
+        using Branches = std::vector<Branch, TrackedAllocator<Branch, MemorySubsystem::TreeBranches>>;
+
+        /// <summary> A range which visits the Tree and every Branch below it depth-first. </summary>
+        using DepthFirstRange = TreeRange<Tree<T>, TreeOrder::DepthFirst>;
+        using ConstDepthFirstRange = TreeRange<const Tree<T>, TreeOrder::DepthFirst>;
+
+        /// <summary> A range which visits the Tree and every Branch below it breadth-first. </summary>
+        using BreadthFirstRange = TreeRange<Tree<T>, TreeOrder::BreadthFirst>;
+        using ConstBreadthFirstRange = TreeRange<const Tree<T>, TreeOrder::BreadthFirst>;
 
 
         /////////////////////////////////
@@ -44,11 +62,34 @@ template <typename T> class Tree final
         Tree (const Tree<T>& copy);
         Tree& operator= (const Tree<T>& copy);
 
+        /// <summary>
+        /// Moves the data and branches of a Tree without copying. The Tree keeps its own place in its parent so only the
+        /// immediate branches need re-parenting, the moved Tree is left as an empty tip. Branches can't move between pools.
+        /// </summary>
         Tree (Tree<T>&& move);
         Tree& operator= (Tree<T>&& move);
+
+        /// <summary> Deletes every Branch below the Tree without recursion so deep trees can't overflow the stack. </summary>
         ~Tree();
 
 
+        ////////////////
+        // Allocation //
+        ////////////////
+
+        /// <summary> Allocates a node on the heap, counting it as MemorySubsystem::TreeNodes. Pooled nodes are counted by their chunk instead. </summary>
+        static void* operator new (const size_t bytes);
+
+        /// <summary> Constructs a node in existing storage, used by TreePool. </summary>
+        static void* operator new (const size_t, void* const place)            { return place; }
+
+        /// <summary> Frees a node allocated on the heap. </summary>
+        static void operator delete (void* const memory, const size_t bytes);
+
+        /// <summary> Matches the placement form of operator new, nothing needs freeing. </summary>
+        static void operator delete (void* const, void* const)                 { }
+
+
         /////////////////////////
         // Getters and setters //
         /////////////////////////
@@ -76,14 +117,13 @@ template <typename T> class Tree final
         /// <summary> Gets the parent of the current Tree branch. </summary>
         const Parent& getParent() const                             { return m_parent; }
 
+        /// <summary> Gets the index of the Tree in the branches of its parent, this is zero for a root. </summary>
+        unsigned int getIndex() const                               { return m_index; }
+
         /// <summary> Gets the collection of Branch objects tracked by the Tree. </summary>
         /// <returns> A read-only reference. </returns>
         const Branches& getBranches() const                         { return m_branches; }
 
-        /// <summary> Gets the collection of Branch objects tracked by the Tree. </summary>
-        /// <returns> A modifiable reference. </returns>
-        Branches& getBranches()                                     { return m_branches; }
-
         /// <summary> Gets the branch at the current index. </summary>
         Branch getBranch (const unsigned int index) const;
 
@@ -91,7 +131,7 @@ template <typename T> class Tree final
         void setData (const T& data)                                { m_data = data; }
 
         /// <summary> Sets the data associated with this node using move semantics. </summary>
-        void setData (T&& move)                                     { m_data = std::move (data); }
+        void setData (T&& move)                                     { m_data = std::move (move); }
 
         /// <summary> Sets the Branch at the desired index. </summary>
         /// <param name="index"> The index to set the Branch to. </param>
@@ -103,8 +143,8 @@ template <typename T> class Tree final
         // Addition and removal //
         //////////////////////////
 
-        /// <summary> Clears the Branches object of all data. </summary>
-        void clear()    { m_branches.clear(); }
+        /// <summary> Deletes every Branch below the Tree, leaving the Tree as a tip. </summary>
+        void clear();
 
         /// <summary> Adds a Branch to the end of the collection of Branch objects. </summary>
         /// <param name="branch"> The Branch object to add. </param>
@@ -131,26 +171,94 @@ template <typename T> class Tree final
         /// <param name="branch"> The Branch to remove. </param>
         void removeBranchOrdered (const Branch branch);
 
+        /// <summary> Removes a Branch without deleting it, this is fast but changes the order. </summary>
+        /// <param name="index"> The index of the Branch to detach. </param>
+        /// <returns> The detached Branch, it is now a root and the caller takes ownership of it. </returns>
+        Branch detachBranch (const unsigned int index);
+
+        /// <summary> Removes a Branch without deleting it, this is fast but changes the order. </summary>
+        /// <param name="branch"> The Branch to detach. </param>
+        /// <returns> The detached Branch, it is now a root and the caller takes ownership of it. </returns>
+        Branch detachBranch (const Branch branch);
+
+        /// <summary> 
+        /// Moves a Branch and everything below it from wherever it currently is to the end of the Tree's branches. Nothing
+        /// is copied and the cost doesn't depend on the size of the subtree. A root Branch will be owned by the Tree.
+        /// </summary>
+        /// <param name="branch"> The Branch to move, this must not be the Tree itself or one of its ancestors. </param>
+        void splice (const Branch branch);
+
+        /// <summary> Swaps the data and branches of two Tree objects from the same pool, each keeps its own place in its parent. </summary>
+        /// <param name="other"> The Tree to swap with. </param>
+        void swap (Tree<T>& other);
+
+        /// <summary>
+        /// Makes the Tree the root of the tree it belongs to by reversing every parent link between it and the old root,
+        /// which becomes one of its descendants. Nothing is copied and only the nodes on that path are touched.
+        /// </summary>
+        void reroot();
+
 
         ///////////////
         // Utilities //
         ///////////////
 
-        /// <summary> Finds the index of the given branch. </summary>
+        /// <summary> Finds the index of the given branch, this is constant time as each branch knows its own index. </summary>
         /// <param name="branch"> The branch to look for. </param>
         /// <returns> The index, Tree::getBranchCount() if it does not exist. </returns>
         unsigned int findIndex (const Branch branch) const;
 
+        /// <summary> Counts the Tree and every Branch below it. </summary>
+        unsigned int getSize() const;
+
+        /// <summary> Checks whether the Tree is the given branch or lies anywhere below it. </summary>
+        /// <param name="ancestor"> The potential ancestor. </param>
+        bool isDescendantOf (const Tree<T>* const ancestor) const;
+
+
+        ///////////////
+        // Traversal //
+        ///////////////
+
+        /// <summary> Visits the Tree and then every Branch below it in depth-first pre-order. </summary>
+        DepthFirstRange depthFirst()                                { return DepthFirstRange (this); }
+        ConstDepthFirstRange depthFirst() const                     { return ConstDepthFirstRange (this); }
+
+        /// <summary> Visits the Tree and then every Branch below it one depth at a time. </summary>
+        BreadthFirstRange breadthFirst()                            { return BreadthFirstRange (this); }
+        ConstBreadthFirstRange breadthFirst() const                 { return ConstBreadthFirstRange (this); }
+
     private:
 
+        friend class TreePool<T>;
+
+        /// <summary> Creates an empty branch in the same storage as the Tree. </summary>
+        Branch createBranch() const;
+
+        /// <summary> Deletes the given branches and everything below them using an explicit stack. </summary>
+        /// <param name="branches"> The branches to delete, this will be empty afterwards. </param>
+        static void deleteBranches (Branches& branches);
+
+        /// <summary> Deletes a single branch and everything below it. </summary>
+        static void deleteBranch (const Branch branch);
+
+        /// <summary> Re-indexes the branches from the given index onwards after they've been shifted. </summary>
+        void updateIndices (const unsigned int from);
+
+        /// <summary> Points each branch back at the Tree, used after the branches change owner. </summary>
+        void adoptBranches();
+
 
         ///////////////////
         // Internal data //
         ///////////////////
 
-        T           m_data      { };    //!< The data of the node.
-        Parent      m_parent    { };    //!< The parent of the current branch of a Tree.
-        Branches    m_branches  { };    //!< The child branches of the current branch of a Tree.
+        T               m_data      { };    //!< The data of the node.
+        Parent          m_parent    { };    //!< The parent of the current branch of a Tree.
+        unsigned int    m_index     { 0 };  //!< The index of the current branch in the branches of its parent.
+        Branches        m_branches  { };    //!< The child branches of the current branch of a Tree.
+        TreePool<T>*    m_pool      { };    //!< The pool the node was created by, nullptr if it was created with new.
+        unsigned int    m_slot      { 0 };  //!< The slot the node occupies in its pool.
 };
 
 
@@ -184,7 +292,32 @@ Tree<T>& Tree<T>::operator= (const Tree<T>& copy)
 {
     if (this != &copy)
     {
-        branches = copy.m_branches;        
+        // Pre-condition: Clearing the Tree won't delete the copy.
+        assert (!copy.isDescendantOf (this));
+
+        clear();
+        m_data = copy.m_data;
+
+        // Copy each level of the tree without recursion by pairing every source branch with its new copy.
+        std::vector<std::pair<const Tree<T>*, Tree<T>*>> pending { std::make_pair (&copy, this) };
+
+        while (!pending.empty())
+        {
+            const auto source      = pending.back().first;
+            const auto destination = pending.back().second;
+            pending.pop_back();
+
+            destination->m_branches.reserve (source->m_branches.size());
+
+            for (const auto branch : source->m_branches)
+            {
+                const auto duplicate = createBranch();
+                duplicate->m_data    = branch->m_data;
+
+                destination->addBranch (duplicate);
+                pending.emplace_back (branch, duplicate);
+            }
+        }
     }
 
     return *this;
@@ -196,11 +329,19 @@ Tree<T>& Tree<T>::operator= (Tree<T>&& move)
 {
     if (this != &move)
     {
-        m_parent   = move.m_parent;
-        m_branches = move.m_branches;
+        // Pre-condition: Clearing the Tree won't delete the moved Tree.
+        assert (!move.isDescendantOf (this));
+
+        // Pre-condition: Any branches being adopted come from our pool.
+        assert (move.m_branches.empty() || m_pool == move.m_pool);
+
+        clear();
+
+        m_data     = std::move (move.m_data);
+        m_branches = std::move (move.m_branches);
+        adoptBranches();
 
-        move.m_parent   = nullptr;
-        move.m_branches = nullptr;
+        move.m_branches.clear();
     }
 
     return *this;
@@ -210,15 +351,29 @@ Tree<T>& Tree<T>::operator= (Tree<T>&& move)
 template <typename T>
 Tree<T>::~Tree()
 {
-    for (auto& branch : m_branches)
-    {
-        if (branch)
-        {
-            delete branch;
-        }
+    deleteBranches (m_branches);
+}
 
-        branch = nullptr;
-    }
+
+////////////////
+// Allocation //
+////////////////
+
+template <typename T>
+void* Tree<T>::operator new (const size_t bytes)
+{
+    const auto memory = ::operator new (bytes);
+    MemoryTracker::allocate (MemorySubsystem::TreeNodes, bytes);
+
+    return memory;
+}
+
+
+template <typename T>
+void Tree<T>::operator delete (void* const memory, const size_t bytes)
+{
+    MemoryTracker::deallocate (MemorySubsystem::TreeNodes, bytes);
+    ::operator delete (memory);
 }
 
 
@@ -242,7 +397,13 @@ void Tree<T>::setBranch (const unsigned int index, const Branch branch)
     // Pre-condition: Index is in range.
     assert (index < getBranchCount());
 
-    return m_branches[index] = branch;
+    m_branches[index] = branch;
+
+    if (branch)
+    {
+        branch->m_parent = this;
+        branch->m_index  = index;
+    }
 }
 
 
@@ -253,18 +414,25 @@ void Tree<T>::setBranch (const unsigned int index, const Branch branch)
 template <typename T>
 void Tree<T>::addBranch (const Branch branch)
 {
+    // Pre-condition: Nodes only hang beneath nodes from the same pool, pools assume every ancestor is their own.
+    assert (branch && branch->m_pool == m_pool);
+
     m_branches.push_back (branch);
-    m_branches.back()->m_parent = this;
+    branch->m_parent = this;
+    branch->m_index  = m_branches.size() - 1;
 }
 
+
 template <typename T>
 void Tree<T>::addBranch (const unsigned int index, const Branch branch)
 {
-    // Pre-condition: Index is in range of the new size.
+    // Pre-condition: Index is in range of the new size and the branch is from the same pool.
     assert (index <= getBranchCount());
+    assert (branch && branch->m_pool == m_pool);
 
     m_branches.insert (m_branches.cbegin() + index, branch);
-    m_branches[index]->m_parent = this;
+    branch->m_parent = this;
+    updateIndices (index);
 }
 
 
@@ -274,11 +442,7 @@ void Tree<T>::removeBranch (const unsigned int index)
     // Pre-condition: Index is in range.
     assert (index < getBranchCount());
 
-    // Swap and pop!
-    std::swap (m_branches[index], m_branches.back());
-
-    delete m_branches.back();
-    m_branches.pop_back();
+    deleteBranch (detachBranch (index));
 }
 
 
@@ -295,8 +459,10 @@ void Tree<T>::removeBranchOrdered (const unsigned int index)
     // Pre-condition: Index is in range.
     assert (index < getBranchCount());
 
-    delete m_branches[index];
+    const auto branch = m_branches[index];
     m_branches.erase (m_branches.cbegin() + index);
+    deleteBranch (branch);
+    updateIndices (index);
 }
 
 
@@ -307,6 +473,85 @@ void Tree<T>::removeBranchOrdered (const Branch branch)
 }
 
 
+template <typename T>
+typename Tree<T>::Branch Tree<T>::detachBranch (const unsigned int index)
+{
+    // Pre-condition: Index is in range.
+    assert (index < getBranchCount());
+
+    // Swap and pop!
+    const auto branch = m_branches[index];
+    m_branches[index] = m_branches.back();
+    m_branches[index]->m_index = index;
+    m_branches.pop_back();
+
+    branch->m_parent = nullptr;
+    branch->m_index  = 0;
+
+    return branch;
+}
+
+
+template <typename T>
+typename Tree<T>::Branch Tree<T>::detachBranch (const Branch branch)
+{
+    return detachBranch (findIndex (branch));
+}
+
+
+template <typename T>
+void Tree<T>::splice (const Branch branch)
+{
+    // Pre-condition: We're not moving a Tree beneath itself, that would create a cycle, nor between pools.
+    assert (branch && !isDescendantOf (branch));
+    assert (branch->m_pool == m_pool);
+
+    if (branch->m_parent)
+    {
+        branch->m_parent->detachBranch (branch->m_index);
+    }
+
+    addBranch (branch);
+}
+
+
+template <typename T>
+void Tree<T>::swap (Tree<T>& other)
+{
+    // Pre-condition: Each node adopts the other's branches so they must share a pool.
+    assert (m_pool == other.m_pool);
+
+    std::swap (m_data, other.m_data);
+    m_branches.swap (other.m_branches);
+
+    adoptBranches();
+    other.adoptBranches();
+}
+
+
+template <typename T>
+void Tree<T>::reroot()
+{
+    // Gather the path up to the current root.
+    std::vector<Branch> path { };
+
+    for (auto node = this; node; node = node->m_parent)
+    {
+        path.push_back (node);
+    }
+
+    // Working down from the old root, detach each node from its parent then hang the parent beneath it.
+    for (auto i = path.size() - 1; i > 0; --i)
+    {
+        const auto parent = path[i],
+                   child  = path[i - 1];
+
+        parent->detachBranch (child->m_index);
+        child->addBranch (parent);
+    }
+}
+
+
 /////////////
 // Utility //
 /////////////
@@ -314,20 +559,114 @@ void Tree<T>::removeBranchOrdered (const Branch branch)
 template <typename T>
 unsigned int Tree<T>::findIndex (const Branch branch) const
 {
-    // Keep track of this baby.
-    auto i = 0U;
+    return branch && branch->m_parent == this ? branch->m_index : getBranchCount();
+}
+
+
+template <typename T>
+unsigned int Tree<T>::getSize() const
+{
+    const auto range = depthFirst();
+    auto       size  = 0U;
 
-    // Loop through the branches to find the correct index.
-    for (; i < m_branches.size(); ++i)
+    for (auto node = range.begin(); node != range.end(); ++node)
     {
-        if (m_branches[i] == branch)
+        ++size;
+    }
+
+    return size;
+}
+
+
+template <typename T>
+bool Tree<T>::isDescendantOf (const Tree<T>* const ancestor) const
+{
+    for (auto node = this; node; node = node->m_parent)
+    {
+        if (node == ancestor)
         {
-            break;
+            return true;
         }
     }
 
-    return i;
+    return false;
+}
+
+
+template <typename T>
+void Tree<T>::clear()
+{
+    deleteBranches (m_branches);
+}
+
+
+template <typename T>
+void Tree<T>::deleteBranches (Branches& branches)
+{
+    // Take ownership of the branches so that each deletion only ever sees a tip and never recurses.
+    Branches pending { };
+    pending.swap (branches);
+
+    while (!pending.empty())
+    {
+        const auto branch = pending.back();
+        pending.pop_back();
+
+        if (branch)
+        {
+            pending.insert (pending.end(), branch->m_branches.cbegin(), branch->m_branches.cend());
+            branch->m_branches.clear();
+
+            if (branch->m_pool)
+            {
+                branch->m_pool->release (branch);
+            }
+
+            else
+            {
+                delete branch;
+            }
+        }
+    }
 }
 
 
+template <typename T>
+void Tree<T>::deleteBranch (const Branch branch)
+{
+    Branches branches { branch };
+    deleteBranches (branches);
+}
+
+
+template <typename T>
+typename Tree<T>::Branch Tree<T>::createBranch() const
+{
+    return m_pool ? m_pool->create() : new Tree<T>();
+}
+
+
+template <typename T>
+void Tree<T>::updateIndices (const unsigned int from)
+{
+    for (auto i = from; i < m_branches.size(); ++i)
+    {
+        m_branches[i]->m_index = i;
+    }
+}
+
+
+template <typename T>
+void Tree<T>::adoptBranches()
+{
+    for (const auto branch : m_branches)
+    {
+        branch->m_parent = this;
+    }
+}
+
+
+// Nodes created by a pool are released through it.
+#include <RRT/TreePool.hpp>
+
 #endif
\ No newline at end of file
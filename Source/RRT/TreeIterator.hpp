@@ -0,0 +1,241 @@
+#ifndef GEC_TREE_ITERATOR_HPP
+#define GEC_TREE_ITERATOR_HPP
+
+
+// STL headers.
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+
+/// <summary>
+/// The order in which a TreeIterator visits each node of a tree.
+/// </summary>
+enum class TreeOrder : char
+{
+    DepthFirst      = 0,    //!< Pre-order, a node is visited before its children and children are visited in order.
+    BreadthFirst    = 1     //!< Level-order, every node at one depth is visited before the next depth.
+};
+
+
+/// <summary>
+/// A forward iterator which walks an entire tree without recursion. Nodes waiting to be visited are kept on an
+/// explicit stack or queue so the depth of the tree has no effect on the call stack. The iterator owns its pending
+/// nodes so copying it is as expensive as copying a vector, prefer using it directly in a range-based for loop.
+/// </summary>
+template <typename Node, TreeOrder Order> class TreeIterator final
+{
+    public:
+
+        /////////////
+        // Aliases //
+        /////////////
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = Node*;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = Node* const*;
+        using reference         = Node* const&;
+
+
+        //////////////////
+        // Constructors //
+        //////////////////
+
+        /// <summary> Constructs an end iterator. </summary>
+        TreeIterator()                                              = default;
+
+        /// <summary> Constructs an iterator which starts at the given node. </summary>
+        /// <param name="root"> The node to start at, a nullptr will create an end iterator. </param>
+        explicit TreeIterator (Node* const root);
+
+        TreeIterator (const TreeIterator& copy)                     = default;
+        TreeIterator& operator= (const TreeIterator& copy)          = default;
+        TreeIterator (TreeIterator&& move);
+        TreeIterator& operator= (TreeIterator&& move);
+
+
+        ///////////////
+        // Iteration //
+        ///////////////
+
+        /// <summary> Gets the node currently being visited, this will be a nullptr at the end of the tree. </summary>
+        Node* operator*() const                                     { return getNode(); }
+
+        /// <summary> Accesses the node currently being visited. </summary>
+        Node* operator->() const                                    { return getNode(); }
+
+        /// <summary> Moves on to the next node in the tree. </summary>
+        TreeIterator& operator++();
+
+        /// <summary> Moves on to the next node without visiting the children of the current node. </summary>
+        TreeIterator& skipBranches();
+
+        /// <summary> Iterators are equal when they're currently visiting the same node. </summary>
+        bool operator== (const TreeIterator& other) const           { return getNode() == other.getNode(); }
+        bool operator!= (const TreeIterator& other) const           { return getNode() != other.getNode(); }
+
+    private:
+
+        /// <summary> Gets the node currently being visited. </summary>
+        Node* getNode() const;
+
+        /// <summary> Removes the current node from the pending nodes, optionally adding its children. </summary>
+        /// <param name="visitBranches"> Whether the branches of the current node should be visited. </param>
+        void advance (const bool visitBranches);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::vector<Node*>  m_pending   { };    //!< The nodes waiting to be visited, a stack when depth-first and a queue when breadth-first.
+        size_t              m_front     { 0 };  //!< The front of the queue when breadth-first.
+};
+
+
+/// <summary>
+/// A pair of TreeIterator objects allowing a tree to be traversed with a range-based for loop.
+/// </summary>
+template <typename Node, TreeOrder Order> class TreeRange final
+{
+    public:
+
+        /// <summary> The type of iterator used to traverse the tree. </summary>
+        using Iterator = TreeIterator<Node, Order>;
+
+        /// <summary> Constructs a range which covers the given node and every node below it. </summary>
+        explicit TreeRange (Node* const root) : m_root (root)       { }
+
+        /// <summary> Gets an iterator at the root of the range. </summary>
+        Iterator begin() const                                      { return Iterator (m_root); }
+
+        /// <summary> Gets the end iterator. </summary>
+        Iterator end() const                                        { return Iterator(); }
+
+    private:
+
+        Node* m_root { nullptr };   //!< The node the range starts at.
+};
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+template <typename Node, TreeOrder Order>
+TreeIterator<Node, Order>::TreeIterator (Node* const root)
+{
+    if (root)
+    {
+        m_pending.push_back (root);
+    }
+}
+
+
+template <typename Node, TreeOrder Order>
+TreeIterator<Node, Order>::TreeIterator (TreeIterator&& move)
+    : m_pending (std::move (move.m_pending)), m_front (move.m_front)
+{
+    move.m_pending.clear();
+    move.m_front = 0;
+}
+
+
+template <typename Node, TreeOrder Order>
+TreeIterator<Node, Order>& TreeIterator<Node, Order>::operator= (TreeIterator&& move)
+{
+    if (this != &move)
+    {
+        m_pending = std::move (move.m_pending);
+        m_front   = move.m_front;
+
+        move.m_pending.clear();
+        move.m_front = 0;
+    }
+
+    return *this;
+}
+
+
+///////////////
+// Iteration //
+///////////////
+
+template <typename Node, TreeOrder Order>
+TreeIterator<Node, Order>& TreeIterator<Node, Order>::operator++()
+{
+    advance (true);
+    return *this;
+}
+
+
+template <typename Node, TreeOrder Order>
+TreeIterator<Node, Order>& TreeIterator<Node, Order>::skipBranches()
+{
+    advance (false);
+    return *this;
+}
+
+
+template <typename Node, TreeOrder Order>
+Node* TreeIterator<Node, Order>::getNode() const
+{
+    if (Order == TreeOrder::DepthFirst)
+    {
+        return m_pending.empty() ? nullptr : m_pending.back();
+    }
+
+    return m_front < m_pending.size() ? m_pending[m_front] : nullptr;
+}
+
+
+template <typename Node, TreeOrder Order>
+void TreeIterator<Node, Order>::advance (const bool visitBranches)
+{
+    // Pre-condition: We aren't at the end of the tree.
+    const auto node = getNode();
+    assert (node);
+
+    const auto& branches = node->getBranches();
+
+    if (Order == TreeOrder::DepthFirst)
+    {
+        m_pending.pop_back();
+
+        if (visitBranches)
+        {
+            // Push the branches in reverse so the first branch is visited first.
+            for (auto branch = branches.crbegin(); branch != branches.crend(); ++branch)
+            {
+                m_pending.push_back (*branch);
+            }
+        }
+    }
+
+    else
+    {
+        ++m_front;
+
+        if (visitBranches)
+        {
+            m_pending.insert (m_pending.end(), branches.cbegin(), branches.cend());
+        }
+
+        // Reclaim the visited half of the queue rather than letting it grow with the size of the tree.
+        if (m_front == m_pending.size())
+        {
+            m_pending.clear();
+            m_front = 0;
+        }
+
+        else if (m_front >= 1024 && m_front * 2 >= m_pending.size())
+        {
+            m_pending.erase (m_pending.begin(), m_pending.begin() + m_front);
+            m_front = 0;
+        }
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,485 @@
+#ifndef GEC_TREE_POOL_HPP
+#define GEC_TREE_POOL_HPP
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+// Application headers.
+#include <RRT/Tree.hpp>
+#include <Utility/HugePages.hpp>
+#include <Utility/MemoryTracker.hpp>
+
+
+/// <summary>
+/// Chunked storage for the nodes of Tree objects. Released slots are kept on a free list and reused before the storage
+/// grows, whole subtrees can be pruned in a single pass over the storage and live nodes can be compacted towards the
+/// front so that unused chunks can be given back. Nodes created by a pool are released back to it when deleted by their
+/// parent, they must never be deleted manually. Chunks are allocated according to the HugePages policy.
+/// </summary>
+template <typename T> class TreePool final
+{
+    public:
+
+        /////////////
+        // Aliases //
+        /////////////
+
+        /// <summary> The type of node managed by the pool. </summary>
+        using Node = Tree<T>;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Constructs an empty pool, no memory is allocated until the first node is created. </summary>
+        /// <param name="chunkSize"> How many nodes each chunk of storage can hold, zero fills a huge page under PagePolicy::Huge or holds 4096 otherwise. </param>
+        TreePool (const unsigned int chunkSize = 0U);
+
+        /// <summary> Destroys every node which is still alive. </summary>
+        ~TreePool();
+
+        TreePool (TreePool&& move)                  = delete;
+        TreePool& operator= (TreePool&& move)       = delete;
+        TreePool (const TreePool& copy)             = delete;
+        TreePool& operator= (const TreePool& copy)  = delete;
+
+
+        /////////////
+        // Getters //
+        /////////////
+
+        /// <summary> Gets the number of nodes which are currently alive. </summary>
+        unsigned int getSize() const                { return m_size; }
+
+        /// <summary> Gets the number of nodes the allocated chunks can hold. </summary>
+        unsigned int getCapacity() const            { return m_chunks.size() * m_chunkSize; }
+
+        /// <summary> Gets the number of nodes each chunk of storage holds. </summary>
+        unsigned int getChunkSize() const           { return m_chunkSize; }
+
+        /// <summary> Gets the number of bytes allocated by the pool. </summary>
+        size_t getStorageBytes() const;
+
+        /// <summary> Gets the most bytes each slot can cost, including the bookkeeping the pool keeps per slot. </summary>
+        static size_t getSlotBytes()                { return sizeof (Slot) + 2 * sizeof (char) + sizeof (unsigned int); }
+
+
+        //////////////////////////
+        // Creation and removal //
+        //////////////////////////
+
+        /// <summary> Creates a new root node, reusing a released slot where possible. </summary>
+        Node* create();
+
+        /// <summary> Creates a new root node containing the given data. </summary>
+        Node* create (const T& data);
+
+        /// <summary> Detaches the given node from its parent and releases it along with everything below it. </summary>
+        void destroy (Node* const node);
+
+        /// <summary> Destroys every node but keeps the allocated chunks for reuse. </summary>
+        void clear();
+
+        /// <summary>
+        /// Removes every given node and everything below them. Each node is detached from its parent, then one pass over
+        /// the storage marks every live node by following its parents until a node with a known fate is found, the result
+        /// is remembered so each node is only ever visited a constant number of times. A final pass releases every marked
+        /// slot to the free list.
+        /// </summary>
+        /// <param name="roots"> The subtrees to remove. </param>
+        /// <param name="onRemove"> Called with each node before it is released, used to clear any external indices. </param>
+        /// <returns> The number of nodes removed. </returns>
+        template <typename Function> unsigned int prune (const std::vector<Node*>& roots, Function&& onRemove);
+
+        /// <summary>
+        /// Moves every live node into the lowest slots then releases any chunks which are no longer needed. Node addresses
+        /// change so every external pointer must be updated through the callback.
+        /// </summary>
+        /// <param name="onMove"> Called with each node after it has been moved to its new address. </param>
+        template <typename Function> void compact (Function&& onMove);
+
+    private:
+
+        /////////////
+        // Aliases //
+        /////////////
+
+        /// <summary> Raw memory large enough for a single node. </summary>
+        using Slot = typename std::aligned_storage<sizeof (Node), std::alignment_of<Node>::value>::type;
+
+        /// <summary> Returns a chunk to HugePages, chunks are counted as MemorySubsystem::TreeNodes. </summary>
+        struct ChunkDeleter final
+        {
+            size_t  bytes   { 0 };  //!< The size of the chunk.
+
+            void operator() (Slot* const slots) const
+            {
+                MemoryTracker::deallocate (MemorySubsystem::TreeNodes, bytes);
+                HugePages::deallocate (slots);
+            }
+        };
+
+        /// <summary> A fixed-size allocation of slots. </summary>
+        using Chunk = std::unique_ptr<Slot[], ChunkDeleter>;
+
+
+        ///////////////////
+        // Node handling //
+        ///////////////////
+
+        friend class Tree<T>;
+
+        /// <summary> Gets the node stored in the given slot. </summary>
+        Node* getNode (const unsigned int slot) const;
+
+        /// <summary> Obtains a free slot, allocating a new chunk if necessary. </summary>
+        unsigned int acquireSlot();
+
+        /// <summary> Destroys a node which has no branches and returns its slot to the free list. </summary>
+        void release (Node* const node);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int                m_chunkSize { 0 };  //!< How many slots are in each chunk.
+        unsigned int                m_used      { 0 };  //!< The number of slots which have ever been handed out, free slots below this are on the free list.
+        unsigned int                m_size      { 0 };  //!< The number of live nodes.
+        std::vector<Chunk>          m_chunks    { };    //!< The storage for every node.
+        std::vector<char>           m_live      { };    //!< Whether each slot below m_used contains a live node.
+        std::vector<unsigned int>   m_free      { };    //!< Released slots below m_used, the lowest slot is at the back.
+        std::vector<char>           m_marks     { };    //!< Scratch space used when pruning.
+};
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+template <typename T>
+TreePool<T>::TreePool (const unsigned int chunkSize)
+    : m_chunkSize (chunkSize)
+{
+    // Smaller chunks than a huge page wouldn't be given one.
+    if (m_chunkSize == 0)
+    {
+        const auto fill = (unsigned int) (HugePages::getPageCapacity() / sizeof (Slot));
+        m_chunkSize     = HugePages::getPolicy() == PagePolicy::Huge ? std::max (4096U, fill) : 4096U;
+    }
+}
+
+
+template <typename T>
+TreePool<T>::~TreePool()
+{
+    clear();
+}
+
+
+/////////////
+// Getters //
+/////////////
+
+template <typename T>
+size_t TreePool<T>::getStorageBytes() const
+{
+    return m_chunks.size() * m_chunkSize * sizeof (Slot) + m_live.capacity() + m_marks.capacity() +
+           m_free.capacity() * sizeof (unsigned int);
+}
+
+
+//////////////////////////
+// Creation and removal //
+//////////////////////////
+
+template <typename T>
+typename TreePool<T>::Node* TreePool<T>::create()
+{
+    const auto slot = acquireSlot();
+    const auto node = new (&m_chunks[slot / m_chunkSize][slot % m_chunkSize]) Node();
+
+    node->m_pool = this;
+    node->m_slot = slot;
+    m_live[slot] = true;
+    ++m_size;
+
+    return node;
+}
+
+
+template <typename T>
+typename TreePool<T>::Node* TreePool<T>::create (const T& data)
+{
+    const auto node = create();
+    node->setData (data);
+
+    return node;
+}
+
+
+template <typename T>
+void TreePool<T>::destroy (Node* const node)
+{
+    // Pre-condition: The node belongs to the pool.
+    assert (node && node->m_pool == this);
+
+    if (node->m_parent)
+    {
+        node->m_parent->removeBranch (node->m_index);
+    }
+
+    else
+    {
+        Node::deleteBranch (node);
+    }
+}
+
+
+template <typename T>
+void TreePool<T>::clear()
+{
+    // A node hanging beneath a node from elsewhere must be detached, otherwise that parent is left pointing at it.
+    for (auto slot = 0U; slot < m_used; ++slot)
+    {
+        if (m_live[slot])
+        {
+            const auto node = getNode (slot);
+
+            if (node->m_parent && node->m_parent->m_pool != this)
+            {
+                node->m_parent->detachBranch (node->m_index);
+            }
+        }
+    }
+
+    // Every node is going so there's no need to follow any branches.
+    for (auto slot = 0U; slot < m_used; ++slot)
+    {
+        if (m_live[slot])
+        {
+            const auto node = getNode (slot);
+            node->m_branches.clear();
+            node->~Node();
+        }
+    }
+
+    m_used = 0;
+    m_size = 0;
+    m_live.clear();
+    m_free.clear();
+}
+
+
+template <typename T>
+template <typename Function>
+unsigned int TreePool<T>::prune (const std::vector<Node*>& roots, Function&& onRemove)
+{
+    // Marks for each slot, nodes are kept until we find out otherwise.
+    const char unknown = 0, keep = 1, remove = 2;
+    m_marks.assign (m_used, unknown);
+
+    for (const auto root : roots)
+    {
+        // Pre-condition: The node belongs to the pool.
+        assert (root && root->m_pool == this);
+
+        if (root->m_parent)
+        {
+            root->m_parent->detachBranch (root->m_index);
+        }
+
+        m_marks[root->m_slot] = remove;
+    }
+
+    // Resolve every node by walking up until we find an ancestor with a known fate, then give the whole path that fate.
+    std::vector<unsigned int> path { };
+
+    for (auto slot = 0U; slot < m_used; ++slot)
+    {
+        if (m_live[slot] && m_marks[slot] == unknown)
+        {
+            auto node = getNode (slot);
+            auto fate = keep;
+
+            while (node)
+            {
+                // Pre-condition: Every ancestor belongs to the pool. A foreign node has no mark to read, so without
+                // assertions the walk stops there and the path is kept rather than reading another pool's slot.
+                assert (node->m_pool == this);
+
+                if (node->m_pool != this)
+                {
+                    break;
+                }
+
+                const auto mark = m_marks[node->m_slot];
+
+                if (mark != unknown)
+                {
+                    fate = mark;
+                    break;
+                }
+
+                path.push_back (node->m_slot);
+                node = node->m_parent;
+            }
+
+            for (const auto visited : path)
+            {
+                m_marks[visited] = fate;
+            }
+
+            path.clear();
+        }
+    }
+
+    // Release from the top down so the lowest slots end up at the back of the free list and get reused first.
+    auto removed = 0U;
+
+    for (auto slot = m_used; slot-- > 0;)
+    {
+        if (m_live[slot] && m_marks[slot] == remove)
+        {
+            const auto node = getNode (slot);
+            onRemove (*node);
+
+            // Everything below the node is also being removed so the branches can simply be forgotten.
+            node->m_branches.clear();
+            release (node);
+            ++removed;
+        }
+    }
+
+    return removed;
+}
+
+
+template <typename T>
+template <typename Function>
+void TreePool<T>::compact (Function&& onMove)
+{
+    auto low  = 0U,
+         high = m_used;
+
+    while (true)
+    {
+        // Find the lowest free slot and the highest live slot.
+        while (low < high && m_live[low])
+        {
+            ++low;
+        }
+
+        while (high > low && !m_live[high - 1])
+        {
+            --high;
+        }
+
+        if (high <= low)
+        {
+            break;
+        }
+
+        // Move the node down, everything pointing at it needs to point to its new address.
+        const auto from = getNode (--high);
+        const auto to   = new (&m_chunks[low / m_chunkSize][low % m_chunkSize]) Node();
+
+        to->m_data     = std::move (from->m_data);
+        to->m_parent   = from->m_parent;
+        to->m_index    = from->m_index;
+        to->m_branches = std::move (from->m_branches);
+        to->m_pool     = this;
+        to->m_slot     = low;
+
+        if (to->m_parent)
+        {
+            to->m_parent->m_branches[to->m_index] = to;
+        }
+
+        to->adoptBranches();
+
+        from->m_branches.clear();
+        from->~Node();
+
+        m_live[low]  = true;
+        m_live[high] = false;
+        onMove (*to);
+    }
+
+    // Everything is now packed at the front so the free list and unused chunks can go.
+    const auto chunks = (m_size + m_chunkSize - 1) / m_chunkSize;
+
+    m_used = m_size;
+    m_live.resize (m_used);
+    m_live.shrink_to_fit();
+    m_free.clear();
+    m_free.shrink_to_fit();
+    m_marks.clear();
+    m_marks.shrink_to_fit();
+    m_chunks.resize (chunks);
+    m_chunks.shrink_to_fit();
+}
+
+
+///////////////////
+// Node handling //
+///////////////////
+
+template <typename T>
+typename TreePool<T>::Node* TreePool<T>::getNode (const unsigned int slot) const
+{
+    return reinterpret_cast<Node*> (&m_chunks[slot / m_chunkSize][slot % m_chunkSize]);
+}
+
+
+template <typename T>
+unsigned int TreePool<T>::acquireSlot()
+{
+    if (!m_free.empty())
+    {
+        const auto slot = m_free.back();
+        m_free.pop_back();
+
+        return slot;
+    }
+
+    // Grow the storage if every chunk is full.
+    if (m_used == getCapacity())
+    {
+        auto deleter  = ChunkDeleter { };
+        deleter.bytes = m_chunkSize * sizeof (Slot);
+
+        m_chunks.emplace_back (static_cast<Slot*> (HugePages::allocate (deleter.bytes)), deleter);
+        MemoryTracker::allocate (MemorySubsystem::TreeNodes, deleter.bytes);
+    }
+
+    m_live.push_back (false);
+
+    return m_used++;
+}
+
+
+template <typename T>
+void TreePool<T>::release (Node* const node)
+{
+    // Pre-condition: The node has already let go of its branches.
+    assert (node->m_branches.empty());
+
+    const auto slot = node->m_slot;
+    node->~Node();
+
+    m_live[slot] = false;
+    m_free.push_back (slot);
+    --m_size;
+}
+
+#endif
\ No newline at end of file
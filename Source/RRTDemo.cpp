@@ -2,16 +2,26 @@
 
 
 // STL headers.
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 #include <utility>
 
 
 // Application headers.
 #include <Level/LevelData.hpp>
 #include <Level/LevelViewer.hpp>
+#include <Level/TileHeatmap.hpp>
+#include <RRT/PlanTrace.hpp>
 #include <RRT/RRT.hpp>
+#include <RRT/RRTTuning.hpp>
+#include <Utility/MemoryTracker.hpp>
+#include <Utility/MetricsServer.hpp>
+#include <Utility/ThreadPool.hpp>
 
 
 // External headers.
+#include <SFML/Graphics/RectangleShape.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Window/Event.hpp>
 
@@ -32,10 +42,16 @@ RRTDemo& RRTDemo::operator= (RRTDemo&& move)
     if (this != &move)
     {
         // Move thy data captain!
-        m_data   = std::move (move.m_data);
-        m_viewer = std::move (move.m_viewer);
-        m_window = std::move (move.m_window);
-        m_rrt    = std::move (move.m_rrt);
+        m_pool      = std::move (move.m_pool);
+        m_data      = std::move (move.m_data);
+        m_viewer    = std::move (move.m_viewer);
+        m_window    = std::move (move.m_window);
+        m_rrt       = std::move (move.m_rrt);
+        m_metrics   = std::move (move.m_metrics);
+        m_heatmap   = std::move (move.m_heatmap);
+        m_trace     = std::move (move.m_trace);
+        m_heatShown = move.m_heatShown;
+        m_heatOn    = move.m_heatOn;
     }
 
     return *this;
@@ -52,11 +68,29 @@ int RRTDemo::run()
     {
         // We need to load the desired level data.
         const auto file = obtainDataFile();
-        m_data = std::make_shared<LevelData> (file);
+        m_pool = std::make_shared<ThreadPool>();
+        m_data = std::make_shared<LevelData> (file, TileStorage::Raw, m_pool);
 
-        // Prepare the RRT object.
+        // The RRT needs the connected regions straight away so build them whilst the rest of the demo is prepared.
+        m_data->requestProducts ({ LevelProduct::Regions });
+
+        // Prepare the RRT object, using any parameters which have been tuned for the level.
         m_rrt = std::make_unique<RRT>();
 
+        m_rrt->setTuning (RRTTuning::loadDefault());
+
+        // Record where the RRT spends its effort, huge levels group tiles into cells to keep the overlay a sensible size.
+        const auto overlaySize = 2048U;
+        auto       cellShift   = 0U;
+
+        while ((std::max (m_data->getWidth(), m_data->getHeight()) >> cellShift) > overlaySize)
+        {
+            ++cellShift;
+        }
+
+        m_heatmap = std::make_shared<TileHeatmap> (m_data->getWidth(), m_data->getHeight(), cellShift);
+        m_rrt->setHeatmap (m_heatmap);
+
         // Create a visual representation of the loaded level data.
         m_viewer = std::make_unique<LevelViewer> (*m_data);
         
@@ -127,7 +161,7 @@ void RRTDemo::scaleView()
     }
     
     // Resize the window and set the correct scale on the LevelViewer.
-    m_window->create (sf::VideoMode (width, height), "N3053620 AI", sf::Style::Titlebar | sf::Style::Close);
+    m_window->create (sf::VideoMode (width, height), m_title, sf::Style::Titlebar | sf::Style::Close);
     m_viewer->setScale ({ scale, scale });
 }
 
@@ -150,14 +184,20 @@ void RRTDemo::gameLoop()
         m_rrt->generateBranch();        
 
         // Draw all objects.
+        updateHeatmap();
         m_viewer->draw (*m_window);
         m_rrt->draw (*m_window, m_viewer->getScale());
+        drawHud();
 
         // Display it on the screen.
         m_window->display();
     }
 
     m_window->close();
+
+    // Leave the final breakdown on the console for capacity planning.
+    std::cout << std::endl;
+    MemoryTracker::writeReport (std::cout);
 }
 
 
@@ -169,11 +209,33 @@ bool RRTDemo::pollEvents()
 
     while (m_window->pollEvent (event))
     {
-        // We only care about the close event.
+        // We only care about the close event, the heatmap keys, the trace key and the metrics key.
         if (event.type == sf::Event::Closed)
         {
             close = true;
         }
+
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::H)
+        {
+            m_heatOn = !m_heatOn;
+            updateHeatmap (true);
+        }
+
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::C)
+        {
+            m_heatShown = (HeatmapCounter) (((int) m_heatShown + 1) % (int) HeatmapCounter::Count);
+            updateHeatmap (true);
+        }
+
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::T)
+        {
+            toggleTrace();
+        }
+
+        else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::M)
+        {
+            toggleMetrics();
+        }
     }
 
     // Determine if we should close.
@@ -213,8 +275,155 @@ void RRTDemo::handleInput()
             // Reset the RRT.
             if (m_start != m_rrt->getStart() || m_end != m_rrt->getEnd())
             {
+                m_heatmap->clear();
                 m_rrt->prepareTree (m_data, m_start, m_end);
             }
         }
     }
+}
+
+
+void RRTDemo::drawHud()
+{
+    const auto subsystems = (unsigned int) MemorySubsystem::Count;
+    const auto megabytes  = 1024.0 * 1024.0;
+
+    // There's no font to draw text with so the figures go in the title, which only changes twice a second to stay readable.
+    if (m_hudClock.getElapsedTime().asSeconds() >= 0.5f)
+    {
+        m_hudClock.restart();
+
+        auto title = std::ostringstream { };
+        title << m_title << " - " << m_rrt->getNodeCount() << " nodes" << std::fixed << std::setprecision (1);
+
+        for (auto i = 0U; i < subsystems; ++i)
+        {
+            const auto usage = MemoryTracker::getUsage ((MemorySubsystem) i);
+            title << ", " << MemoryTracker::getName ((MemorySubsystem) i) << " " << usage.current / megabytes << " MB";
+        }
+
+        if (m_heatOn)
+        {
+            title << " - heatmap of " << TileHeatmap::getName (m_heatShown) << " (H hides, C cycles)";
+        }
+
+        if (m_trace)
+        {
+            title << " - tracing " << m_trace->getRecordCount() << " records (T stops)";
+        }
+
+        m_window->setTitle (title.str());
+    }
+
+    // A bar along the top of the window is split between the subsystems by their share of the memory.
+    const auto total = MemoryTracker::getTotal().current;
+
+    if (total == 0)
+    {
+        return;
+    }
+
+    const sf::Color colours[subsystems] = 
+    {
+        { 230, 230, 230 },  // Level tiles.
+        { 160, 160, 230 },  // Level products.
+        { 230, 160, 60 },   // RRT index.
+        { 230, 60, 60 },    // Tree nodes.
+        { 230, 120, 200 },  // Tree branches.
+        { 60, 200, 230 },   // Viewer textures.
+        { 240, 220, 60 },   // Heatmap.
+        { 140, 230, 120 }   // Plan traces.
+    };
+
+    const auto width = (float) m_window->getSize().x;
+    auto       x     = 0.f;
+
+    for (auto i = 0U; i < subsystems; ++i)
+    {
+        const auto share = width * MemoryTracker::getUsage ((MemorySubsystem) i).current / total;
+
+        sf::RectangleShape bar { { share, 6.f } };
+        bar.setPosition (x, 0.f);
+        bar.setFillColor (colours[i]);
+        m_window->draw (bar);
+
+        x += share;
+    }
+}
+
+
+void RRTDemo::updateHeatmap (const bool force)
+{
+    if (!m_heatOn)
+    {
+        if (m_viewer->hasOverlay())
+        {
+            m_viewer->clearOverlay();
+        }
+
+        return;
+    }
+
+    // Shading every cell each frame would slow the planner down more than the overlay is worth.
+    if (force || m_heatClock.getElapsedTime().asSeconds() >= 0.25f)
+    {
+        m_heatClock.restart();
+        m_viewer->setOverlay (m_heatmap->createImage (m_heatShown), m_heatmap->getCellSize());
+    }
+}
+
+
+void RRTDemo::toggleTrace()
+{
+    const auto file = std::string ("RRTDemo.trace");
+
+    if (m_trace)
+    {
+        // Releasing the trace writes whatever is still buffered.
+        const auto records = m_trace->getRecordCount();
+
+        m_rrt->setTrace (nullptr);
+        m_trace.reset();
+
+        std::cout << "Traced " << records << " records to " << file << "." << std::endl;
+        return;
+    }
+
+    try
+    {
+        m_trace = std::make_shared<PlanTrace> (file, *m_data);
+        m_rrt->setTrace (m_trace);
+
+        // A trace can only be replayed from the start of a query.
+        m_heatmap->clear();
+        m_rrt->prepareTree (m_data, m_start, m_end);
+    }
+
+    catch (const std::exception& error)
+    {
+        std::cerr << "Unable to start tracing: " << error.what() << std::endl;
+    }
+}
+
+
+void RRTDemo::toggleMetrics()
+{
+    if (m_metrics)
+    {
+        m_metrics.reset();
+        std::cout << "Stopped serving metrics." << std::endl;
+        return;
+    }
+
+    // The demo works just as well without metrics so a port which is already taken isn't fatal.
+    try
+    {
+        m_metrics = std::make_unique<MetricsServer>();
+        std::cout << "Serving metrics at http://localhost:" << m_metrics->getPort() << "/metrics" << std::endl;
+    }
+
+    catch (const std::exception& error)
+    {
+        std::cerr << "Unable to serve metrics: " << error.what() << std::endl;
+    }
 }
\ No newline at end of file
@@ -15,14 +15,20 @@
 
 
 // External headers.
+#include <SFML/System/Clock.hpp>
 #include <SFML/System/Vector2.hpp>
 
 
 // Forward declarations.
 namespace sf { class RenderWindow; }
+enum class HeatmapCounter : char;
 class LevelData;
 class LevelViewer;
+class MetricsServer;
+class PlanTrace;
 class RRT;
+class ThreadPool;
+class TileHeatmap;
 
 
 
@@ -79,18 +85,40 @@ class RRTDemo final
         /// <summary> Handles mouse input. </summary>
         void handleInput();
 
+        /// <summary> Shows how much memory each subsystem is using, as a bar along the top and in the window title. </summary>
+        void drawHud();
+
+        /// <summary> Refreshes the heatmap overlay a few times a second whilst it's shown. </summary>
+        /// <param name="force"> Whether to refresh straight away, such as when a different counter is chosen. </param>
+        void updateHeatmap (const bool force = false);
+
+        /// <summary> Starts recording the planner to a trace file, restarting the query, or finishes the current trace. </summary>
+        void toggleTrace();
+
+        /// <summary> Starts serving the metrics of the planner for monitoring, or stops the server if it's running. </summary>
+        void toggleMetrics();
+
 
         ///////////////////
         // Internal data //
         ///////////////////
 
+        std::shared_ptr<ThreadPool>         m_pool      { nullptr };    //!< Worker threads used to build data derived from the level.
         std::shared_ptr<LevelData>          m_data      { nullptr };    //!< The level data.
         std::unique_ptr<LevelViewer>        m_viewer    { nullptr };    //!< The visual representation of the data.
         std::unique_ptr<sf::RenderWindow>   m_window    { nullptr };    //!< The window displaying the GUI of the application.
         std::unique_ptr<RRT>                m_rrt       { };            //!< An RRT object which will create a Tree based on the LevelData.
+        std::unique_ptr<MetricsServer>      m_metrics   { nullptr };    //!< Serves the metrics of the planner whilst toggled on with M.
+        std::shared_ptr<TileHeatmap>        m_heatmap   { nullptr };    //!< Where the RRT spends its effort in the current query.
+        std::shared_ptr<PlanTrace>          m_trace     { nullptr };    //!< Records every sample whilst tracing is toggled on with T.
 
         const unsigned int                  m_width     { 1600 };       //!< The maximum number of pixels wide the window can be.
         const unsigned int                  m_height    { 900 };        //!< The maximum number of pixels tall the window can be.
+        const std::string                   m_title     { "N3053620 AI" };  //!< The title of the window, the HUD follows it.
+        sf::Clock                           m_hudClock  { };            //!< The time since the title was last updated.
+        sf::Clock                           m_heatClock { };            //!< The time since the heatmap overlay was last refreshed.
+        HeatmapCounter                      m_heatShown { };            //!< The counter shown by the overlay.
+        bool                                m_heatOn    { false };      //!< Whether the heatmap overlay is shown, toggled with H.
 
         sf::Vector2i                        m_start     { };            //!< The start point of the RRT.
         sf::Vector2i                        m_end       { };            //!< The end point for the RRT.
@@ -0,0 +1,256 @@
+#include "AutoTuner.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+#include <RRT/RRT.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+AutoTuner::AutoTuner (const unsigned int queries, const double querySeconds, const unsigned int seed)
+    : m_queries (queries), m_querySeconds (querySeconds), m_seed (seed)
+{
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+void AutoTuner::loadQueries (const std::string& file)
+{
+    auto stream = std::ifstream (file);
+
+    if (!stream)
+    {
+        throw std::invalid_argument ("AutoTuner::loadQueries(), file location given is invalid. \"" + file + "\".");
+    }
+
+    auto queries = std::vector<Query> { };
+    auto query   = Query { };
+
+    while (stream >> query.start.x >> query.start.y >> query.end.x >> query.end.y)
+    {
+        queries.push_back (query);
+    }
+
+    if (!stream.eof() || queries.empty())
+    {
+        throw std::runtime_error ("AutoTuner::loadQueries(), the file doesn't contain a valid list of queries. \"" + file + "\".");
+    }
+
+    m_loaded = std::move (queries);
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+RRTParameters AutoTuner::tune (const std::shared_ptr<LevelData>& data, std::ostream& log)
+{
+    auto queries = m_loaded.empty() ? generateQueries (*data) : m_loaded;
+
+    // Queries outside of the map would trip the assertions of RRT.
+    const auto width  = (int) data->getWidth(),
+               height = (int) data->getHeight();
+
+    queries.erase (std::remove_if (queries.begin(), queries.end(), [&] (const Query& query)
+    {
+        return query.start.x < 0 || query.start.y < 0 || query.start.x >= width || query.start.y >= height ||
+               query.end.x < 0 || query.end.y < 0 || query.end.x >= width || query.end.y >= height;
+    }), queries.end());
+
+    if (queries.empty())
+    {
+        throw std::runtime_error ("AutoTuner::tune(), there are no queries on the map to tune for.");
+    }
+
+    // Remember every evaluation so the pattern search never repeats one.
+    auto costs = std::map<std::pair<float, float>, double> { };
+    auto best  = RRTParameters { };
+    auto score = std::numeric_limits<double>::max();
+
+    const auto measure = [&] (const RRTParameters& candidate)
+    {
+        const auto parameters = clamp (candidate);
+        const auto key        = std::make_pair (parameters.sampleDistance, parameters.branchDistance);
+        const auto existing   = costs.find (key);
+
+        if (existing != costs.cend())
+        {
+            return existing->second;
+        }
+
+        const auto cost = evaluate (data, queries, parameters);
+        costs[key]      = cost;
+
+        log << "sample " << parameters.sampleDistance << " branch " << parameters.branchDistance << ": " << cost * 1000.0 << " ms" << std::endl;
+
+        if (cost < score)
+        {
+            best  = parameters;
+            score = cost;
+        }
+
+        return cost;
+    };
+
+    // Cover the useful range of each parameter coarsely.
+    for (const auto sample : { 0.125f, 0.25f, 0.5f, 1.f })
+    {
+        for (const auto branch : { 5.f, 10.f, 15.f, 25.f, 40.f })
+        {
+            auto parameters           = RRTParameters { };
+            parameters.sampleDistance = sample;
+            parameters.branchDistance = branch;
+
+            measure (parameters);
+        }
+    }
+
+    // Refine the best point, parameters are stepped by a factor since their effect is roughly logarithmic.
+    auto sampleStep = 2.f,
+         branchStep = 1.5f;
+
+    for (auto halvings = 0U, moves = 0U; halvings < m_refinements && moves < m_refinements * 4; ++moves)
+    {
+        const auto centre = best;
+        auto       steps  = std::vector<RRTParameters> (4, centre);
+
+        steps[0].sampleDistance *= sampleStep;
+        steps[1].sampleDistance /= sampleStep;
+        steps[2].branchDistance *= branchStep;
+        steps[3].branchDistance /= branchStep;
+
+        for (const auto& step : steps)
+        {
+            measure (step);
+        }
+
+        // Only narrow the search once the best point stops moving.
+        if (best.sampleDistance == centre.sampleDistance && best.branchDistance == centre.branchDistance)
+        {
+            sampleStep = std::sqrt (sampleStep);
+            branchStep = std::sqrt (branchStep);
+            ++halvings;
+        }
+    }
+
+    log << "best sample " << best.sampleDistance << " branch " << best.branchDistance << ": " << score * 1000.0 << " ms" << std::endl;
+
+    return best;
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+std::vector<AutoTuner::Query> AutoTuner::generateQueries (const LevelData& data) const
+{
+    auto random = std::mt19937 (m_seed);
+    auto pickX  = std::uniform_int_distribution<int> (0, (int) data.getWidth() - 1),
+         pickY  = std::uniform_int_distribution<int> (0, (int) data.getHeight() - 1);
+
+    auto queries = std::vector<Query> { };
+
+    for (auto query = 0U; query < m_queries; ++query)
+    {
+        const auto attempts = 1000U;
+
+        for (auto attempt = 0U; attempt < attempts; ++attempt)
+        {
+            const auto start = sf::Vector2i (pickX (random), pickY (random)),
+                       end   = sf::Vector2i (pickX (random), pickY (random));
+
+            const auto startIndex = start.x + start.y * data.getWidth(),
+                       endIndex   = end.x + end.y * data.getWidth();
+
+            if (start != end && data.sameRegion (startIndex, endIndex, MovementClass::Land))
+            {
+                queries.push_back ({ start, end });
+                break;
+            }
+        }
+    }
+
+    return queries;
+}
+
+
+double AutoTuner::evaluate (const std::shared_ptr<LevelData>& data, const std::vector<Query>& queries, const RRTParameters& parameters) const
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    auto rrt   = RRT (parameters.sampleDistance, parameters.branchDistance);
+    auto total = 0.0;
+
+    for (auto i = 0U; i < queries.size(); ++i)
+    {
+        // Each query gets its own seed but it's the same for every set of parameters, so repeats only differ in timing.
+        rrt.setSeed (m_seed + i + 1);
+
+        auto fastest = m_querySeconds * 2.0;
+
+        for (auto repeat = 0U; repeat < std::max (1U, m_repeats); ++repeat)
+        {
+            const auto planStart = Clock::now();
+            rrt.prepareTree (data, queries[i].start, queries[i].end);
+
+            auto elapsed    = 0.0;
+            auto iterations = 0U;
+
+            while (!rrt.hasFinished() && rrt.isReachable() && elapsed < m_querySeconds)
+            {
+                rrt.generateBranch();
+
+                // Checking the clock every iteration would skew the results.
+                if ((++iterations & 63) == 0)
+                {
+                    elapsed = std::chrono::duration<double> (Clock::now() - planStart).count();
+                }
+            }
+
+            // An unsolved query will be unsolved every time.
+            if (!rrt.hasFinished())
+            {
+                break;
+            }
+
+            fastest = std::min (fastest, std::chrono::duration<double> (Clock::now() - planStart).count());
+        }
+
+        total += fastest;
+    }
+
+    return total / queries.size();
+}
+
+
+RRTParameters AutoTuner::clamp (const RRTParameters& parameters)
+{
+    // Sampling further apart than a tile could step over the corner of an obstacle.
+    auto clamped           = parameters;
+    clamped.sampleDistance = std::min (1.f, std::max (0.0625f, parameters.sampleDistance));
+    clamped.branchDistance = std::min (64.f, std::max (2.f, parameters.branchDistance));
+
+    return clamped;
+}
\ No newline at end of file
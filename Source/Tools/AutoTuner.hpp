@@ -0,0 +1,120 @@
+#ifndef GEC_AUTO_TUNER_HPP
+#define GEC_AUTO_TUNER_HPP
+
+
+// STL headers.
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+// Application headers.
+#include <RRT/RRTTuning.hpp>
+
+
+// External headers.
+#include <SFML/System/Vector2.hpp>
+
+
+// Forward declarations.
+class LevelData;
+
+
+/// <summary>
+/// Searches for the RRT parameters which solve a set of queries on a map the quickest. A coarse grid covering the useful
+/// range of each parameter is benchmarked first, then the best point is refined with a pattern search which steps each
+/// parameter up and down, halving the step whenever no neighbour improves. Every query is planned with a fixed seed so
+/// each set of parameters faces exactly the same samples.
+/// </summary>
+class AutoTuner final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a tuner with the given workload per evaluation. </summary>
+        /// <param name="queries"> The number of random start and end points to generate when no queries are given. </param>
+        /// <param name="querySeconds"> The maximum time to spend on each query, unsolved queries cost double this. </param>
+        /// <param name="seed"> The seed used to choose the start and end points and to plan each query. </param>
+        AutoTuner (const unsigned int queries = 8U, const double querySeconds = 0.25, const unsigned int seed = 0U);
+
+        AutoTuner (AutoTuner&& move)                    = default;
+        AutoTuner& operator= (AutoTuner&& move)         = default;
+        AutoTuner (const AutoTuner& copy)               = default;
+        AutoTuner& operator= (const AutoTuner& copy)    = default;
+        ~AutoTuner()                                    = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Sets how many times the pattern search may halve its step before it stops. </summary>
+        void setRefinements (const unsigned int refinements)    { m_refinements = refinements; }
+
+        /// <summary> Sets how many times each query is planned per evaluation, the fastest time is kept to filter out noise. </summary>
+        void setRepeats (const unsigned int repeats)            { m_repeats = repeats; }
+
+        /// <summary>
+        /// Loads the queries to tune for from a file, replacing the random queries. Each line holds the X and Y of the start
+        /// followed by the X and Y of the end. If an error occurs an exception will be thrown.
+        /// </summary>
+        /// <param name="file"> The file location to load from. </param>
+        void loadQueries (const std::string& file);
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Finds the best parameters for the given map. </summary>
+        /// <param name="data"> The map to tune for. </param>
+        /// <param name="log"> Each evaluation is written here. </param>
+        /// <returns> The parameters with the lowest cost. </returns>
+        RRTParameters tune (const std::shared_ptr<LevelData>& data, std::ostream& log);
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> A start and end point to plan between. </summary>
+        struct Query final
+        {
+            sf::Vector2i    start   { };    //!< The start point.
+            sf::Vector2i    end     { };    //!< The end point.
+        };
+
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Chooses random queries which can be solved, otherwise we'd only be measuring how quickly unreachable goals are rejected. </summary>
+        std::vector<Query> generateQueries (const LevelData& data) const;
+
+        /// <summary> Plans every query with the given parameters. </summary>
+        /// <returns> The mean of the fastest time each query took, counting unsolved queries as twice the time limit. </returns>
+        double evaluate (const std::shared_ptr<LevelData>& data, const std::vector<Query>& queries, const RRTParameters& parameters) const;
+
+        /// <summary> Clamps parameters to the range which keeps collision detection exact. </summary>
+        static RRTParameters clamp (const RRTParameters& parameters);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int        m_queries       { 8 };      //!< The number of random queries to generate.
+        double              m_querySeconds  { 0.25 };   //!< The maximum time to spend on each query.
+        unsigned int        m_seed          { 0 };      //!< The seed used to choose and plan queries.
+        unsigned int        m_refinements   { 4 };      //!< How many times the pattern search step may be halved.
+        unsigned int        m_repeats       { 3 };      //!< How many times each query is planned per evaluation.
+        std::vector<Query>  m_loaded        { };        //!< Queries loaded from a file, these replace the random queries.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,868 @@
+#include "Benchmark.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+
+// Platform headers.
+#if defined (_MSC_VER)
+    #include <intrin.h>
+#elif defined (__i386__) || defined (__x86_64__)
+    #include <cpuid.h>
+#endif
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+#include <RRT/RRT.hpp>
+#include <Tools/JsonValue.hpp>
+#include <Tools/ProcessMemory.hpp>
+#include <Tools/TlbCounter.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+Benchmark::Benchmark (const unsigned int queries, const double querySeconds, const unsigned int seed)
+    : m_queries (queries), m_querySeconds (querySeconds), m_seed (seed)
+{
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+BenchmarkResult Benchmark::run (const std::string& file) const
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    auto       result = BenchmarkResult { };
+    TlbCounter counter  { };
+
+    result.pages      = HugePages::getPolicy();
+    result.tlbCounted = counter.isAvailable();
+
+    // Maps are named "size_group.map" by MapCorpus.
+    const auto slash = file.find_last_of ("/\\");
+    result.map       = slash == std::string::npos ? file : file.substr (slash + 1);
+
+    const auto underscore = result.map.find ('_'),
+               extension  = result.map.rfind ('.');
+
+    if (underscore != std::string::npos && extension != std::string::npos && underscore < extension)
+    {
+        result.group = result.map.substr (underscore + 1, extension - underscore - 1);
+    }
+
+    // Allocations are counted from here so only this map's are reported.
+    auto allocations = std::array<unsigned long long, (size_t) MemorySubsystem::Count> { };
+
+    for (auto i = 0U; i < allocations.size(); ++i)
+    {
+        allocations[i] = MemoryTracker::getUsage ((MemorySubsystem) i).allocations;
+    }
+
+    try
+    {
+        ProcessMemory::resetPeak();
+        MemoryTracker::resetPeaks();
+
+        // Time the load on its own.
+        const auto loadStart = Clock::now();
+        const auto data      = std::make_shared<LevelData> (file);
+        result.loadSeconds   = std::chrono::duration<double> (Clock::now() - loadStart).count();
+
+        result.loaded    = true;
+        result.width     = data->getWidth();
+        result.height    = data->getHeight();
+        result.tileBytes = data->getStorageBytes();
+
+        // Samples of each kernel are kept whole so runs can be compared statistically.
+        const auto scenario = describeScenario (result.map);
+
+        result.series.push_back (createSeries ("LevelData", "load", scenario, "seconds", false));
+        result.series.back().samples.push_back (result.loadSeconds);
+        result.series.push_back (sampleReads (*data, scenario));
+
+        auto throughput = createSeries ("RRT", "plan_throughput", scenario, "iterations/s", true),
+             latency    = createSeries ("RRT", "solve_latency", scenario, "seconds", false);
+
+        // Choose queries which can be solved, otherwise we'd only be measuring how quickly unreachable goals are rejected.
+        auto random = std::mt19937 (m_seed);
+        auto pickX  = std::uniform_int_distribution<int> (0, (int) data->getWidth() - 1),
+             pickY  = std::uniform_int_distribution<int> (0, (int) data->getHeight() - 1);
+
+        auto rrt = RRT();
+
+        // The memory the planner itself allocates, the level's products are counted separately.
+        const auto plannerBytes = [] ()
+        {
+            return MemoryTracker::getUsage (MemorySubsystem::TreeNodes).current + 
+                   MemoryTracker::getUsage (MemorySubsystem::TreeBranches).current + 
+                   MemoryTracker::getUsage (MemorySubsystem::RRTIndex).current;
+        };
+
+        for (auto query = 0U; query < m_queries; ++query)
+        {
+            const auto attempts = 1000U;
+
+            for (auto attempt = 0U; attempt < attempts; ++attempt)
+            {
+                const auto start = sf::Vector2i (pickX (random), pickY (random)),
+                           end   = sf::Vector2i (pickX (random), pickY (random));
+
+                const auto startIndex = start.x + start.y * data->getWidth(),
+                           endIndex   = end.x + end.y * data->getWidth();
+
+                if (start != end && data->sameRegion (startIndex, endIndex, MovementClass::Land))
+                {
+                    // Each query gets a fresh planner so the nodes it allocates belong to this query alone, a reused
+                    // pool would hand back the chunks of the previous tree without allocating anything.
+                    rrt = RRT();
+
+                    // Measure the memory the planner adds as well as its throughput.
+                    const auto bytesStart = plannerBytes();
+                    const auto planStart  = Clock::now();
+                    counter.start();
+                    
+                    rrt.prepareTree (data, start, end);
+
+                    auto elapsed    = 0.0;
+                    auto iterations = 0ULL;
+
+                    while (!rrt.hasFinished() && elapsed < m_querySeconds)
+                    {
+                        rrt.generateBranch();
+
+                        // Checking the clock every iteration would skew the results.
+                        if ((++iterations & 63) == 0)
+                        {
+                            elapsed = std::chrono::duration<double> (Clock::now() - planStart).count();
+                        }
+                    }
+
+                    counter.stop();
+                    elapsed = std::chrono::duration<double> (Clock::now() - planStart).count();
+
+                    const auto bytesEnd = plannerBytes();
+
+                    // Accumulate the average memory per node across queries.
+                    const auto added    = bytesEnd > bytesStart ? bytesEnd - bytesStart : 0;
+                    const auto nodes    = rrt.getNodeCount();
+                    
+                    result.bytesPerNode = (result.bytesPerNode * result.queries + (double) added / nodes) / (result.queries + 1);
+                    result.queries     += 1;
+                    result.solved      += rrt.hasFinished() ? 1 : 0;
+                    result.iterations  += iterations;
+                    result.nodes       += nodes;
+                    result.planSeconds += elapsed;
+
+                    // Unsolved queries only tell us the time limit so they're left out of the latency.
+                    throughput.samples.push_back (elapsed > 0.0 ? iterations / elapsed : 0.0);
+
+                    if (rrt.hasFinished())
+                    {
+                        latency.samples.push_back (elapsed);
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        // Release the last tree so it isn't reported as still in use.
+        rrt = RRT();
+
+        result.series.push_back (std::move (throughput));
+        result.series.push_back (std::move (latency));
+    }
+
+    catch (const std::exception& error)
+    {
+        result.error = error.what();
+    }
+
+    result.peakBytes  = ProcessMemory::getPeakBytes();
+    result.dtlbMisses = counter.getMisses();
+
+    for (auto i = 0U; i < result.memory.size(); ++i)
+    {
+        result.memory[i]              = MemoryTracker::getUsage ((MemorySubsystem) i);
+        result.memory[i].allocations -= allocations[i];
+    }
+
+    // Repeated loads would inflate the peak memory so they're taken once everything else has been measured.
+    if (result.loaded && result.error.empty())
+    {
+        sampleLoads (file, result.series.front());
+    }
+
+    return result;
+}
+
+
+bool Benchmark::runMalformed (const std::string& file, std::string& error) const
+{
+    try
+    {
+        LevelData data { file };
+        error = "loaded successfully";
+
+        return false;
+    }
+
+    catch (const std::exception& exception)
+    {
+        error = exception.what();
+        return true;
+    }
+}
+
+
+std::vector<BenchmarkResult> Benchmark::runManifest (const std::string& manifest, std::ostream& log) const
+{
+    auto stream = std::ifstream (manifest);
+
+    if (!stream)
+    {
+        throw std::invalid_argument ("Benchmark::runManifest(), manifest location given is invalid. \"" + manifest + "\".");
+    }
+
+    // Maps are listed relative to the manifest.
+    const auto slash     = manifest.find_last_of ("/\\");
+    const auto directory = slash == std::string::npos ? std::string() : manifest.substr (0, slash + 1);
+
+    auto results = std::vector<BenchmarkResult> { };
+    auto kind    = std::string { },
+         name    = std::string { };
+
+    while (stream >> kind >> name)
+    {
+        const auto file = directory + name;
+
+        if (kind == "malformed")
+        {
+            auto error = std::string { };
+            log << (runMalformed (file, error) ? "rejected " : "FAILED   ") << name << ": " << error << std::endl;
+        }
+
+        else
+        {
+            // Each policy only affects the allocations made whilst it's set.
+            const auto previous = HugePages::getPolicy();
+
+            for (const auto policy : m_policies)
+            {
+                HugePages::setPolicy (policy);
+                results.push_back (run (file));
+            
+                const auto& result = results.back();
+                log << "benchmarked " << name << (policy == PagePolicy::Huge ? " with huge pages" : "") 
+                    << (result.error.empty() ? "" : ": " + result.error) << std::endl;
+            }
+
+            HugePages::setPolicy (previous);
+        }
+    }
+
+    return results;
+}
+
+
+std::vector<BenchmarkSeries> Benchmark::runTree (const unsigned int nodes) const
+{
+    using Clock = std::chrono::high_resolution_clock;
+    using Node  = TreePool<unsigned int>::Node;
+
+    // Pre-condition: The tree needs a root and at least one node to prune.
+    assert (nodes > 1);
+
+    // Choose the shape up front so only the tree is timed. Random parents give the shallow, bushy trees that RRT grows.
+    auto random  = std::mt19937 (m_seed);
+    auto parents = std::vector<unsigned int> (nodes, 0);
+
+    for (auto i = 1U; i < nodes; ++i)
+    {
+        parents[i] = std::uniform_int_distribution<unsigned int> (0, i - 1) (random);
+    }
+
+    const auto seconds = [] (const Clock::time_point start) { return std::chrono::duration<double> (Clock::now() - start).count(); };
+    const auto rate    = [] (const unsigned int count, const double elapsed) { return elapsed > 0.0 ? count / elapsed : 0.0; };
+
+    auto       series   = std::vector<BenchmarkSeries> { };
+    const auto previous = HugePages::getPolicy();
+
+    for (const auto policy : m_policies)
+    {
+        HugePages::setPolicy (policy);
+
+        const auto scenario = describeScenario (std::to_string (nodes) + " nodes");
+        auto       build    = createSeries ("Tree", "build", scenario, "nodes/s", true),
+                   traverse = createSeries ("Tree", "traverse", scenario, "nodes/s", true),
+                   prune    = createSeries ("Tree", "prune", scenario, "nodes/s", true);
+
+        auto tree    = std::vector<Node*> (nodes, nullptr);
+        auto visited = 0U;
+
+        for (auto sample = 0U; sample < m_samples; ++sample)
+        {
+            // A fresh pool each time so every sample starts from the same state.
+            TreePool<unsigned int> pool { };
+
+            auto start = Clock::now();
+            tree[0]    = pool.create (0);
+
+            for (auto i = 1U; i < nodes; ++i)
+            {
+                tree[i] = pool.create (i);
+                tree[parents[i]]->addBranch (tree[i]);
+            }
+
+            build.samples.push_back (rate (nodes, seconds (start)));
+
+            start = Clock::now();
+
+            for (const auto node : tree[0]->depthFirst())
+            {
+                visited += node->getData();
+            }
+
+            traverse.samples.push_back (rate (nodes, seconds (start)));
+
+            // Prune a sixteenth of the nodes, their subtrees make up a much larger share of the tree.
+            auto roots = std::vector<Node*> { };
+
+            for (auto i = 15U; i < nodes; i += 16)
+            {
+                roots.push_back (tree[i]);
+            }
+
+            start = Clock::now();
+            const auto removed = pool.prune (roots, [] (Node&) { });
+            prune.samples.push_back (rate (removed, seconds (start)));
+        }
+
+        // Stop the traversal from being optimised away.
+        volatile auto sink = visited;
+        (void) sink;
+
+        series.push_back (std::move (build));
+        series.push_back (std::move (traverse));
+        series.push_back (std::move (prune));
+    }
+
+    HugePages::setPolicy (previous);
+
+    return series;
+}
+
+
+BenchmarkEnvironment Benchmark::describeEnvironment()
+{
+    auto environment     = BenchmarkEnvironment { };
+    environment.revision = determineRevision();
+    environment.cpu      = determineCpu();
+    environment.threads  = std::thread::hardware_concurrency();
+    environment.flags    = determineFlags();
+
+    #if defined (__clang__)
+        environment.compiler = "Clang " __clang_version__;
+    #elif defined (__GNUC__)
+        environment.compiler = "GCC " __VERSION__;
+    #elif defined (_MSC_VER)
+        environment.compiler = "MSVC " + std::to_string (_MSC_FULL_VER);
+    #else
+        environment.compiler = "unknown";
+    #endif
+
+    const auto now  = std::time (nullptr);
+    auto       time = std::tm { };
+    char       text[32] { };
+
+    #if defined (_WIN32)
+        gmtime_s (&time, &now);
+    #else
+        gmtime_r (&now, &time);
+    #endif
+
+    std::strftime (text, sizeof (text), "%Y-%m-%dT%H:%M:%SZ", &time);
+    environment.time = text;
+
+    return environment;
+}
+
+
+///////////////
+// Reporting //
+///////////////
+
+void Benchmark::writeCsv (std::ostream& stream, const std::vector<BenchmarkResult>& results)
+{
+    stream << "map,group,width,height,huge_pages,loaded,load_seconds,peak_bytes,tile_bytes,queries,solved,iterations,nodes,plan_seconds,iterations_per_second,bytes_per_node,dtlb_misses,";
+
+    // Each subsystem gets a peak and an allocation count column.
+    for (auto i = 0U; i < (unsigned int) MemorySubsystem::Count; ++i)
+    {
+        const auto name = MemoryTracker::getName ((MemorySubsystem) i);
+        stream << name << "_peak_bytes," << name << "_allocations,";
+    }
+
+    stream << "error" << std::endl;
+
+    for (const auto& result : results)
+    {
+        stream  << result.map << "," << result.group << "," << result.width << "," << result.height << "," 
+                << (result.pages == PagePolicy::Huge ? 1 : 0) << "," << (result.loaded ? 1 : 0) << "," 
+                << result.loadSeconds << "," << result.peakBytes << "," << result.tileBytes << "," << result.queries << "," 
+                << result.solved << "," << result.iterations << "," << result.nodes << "," << result.planSeconds << "," 
+                << result.getIterationsPerSecond() << "," << result.bytesPerNode << "," 
+                << (result.tlbCounted ? std::to_string (result.dtlbMisses) : "") << ",";
+
+        for (const auto& usage : result.memory)
+        {
+            stream << usage.peak << "," << usage.allocations << ",";
+        }
+
+        stream << "\"" << result.error << "\"" << std::endl;
+    }
+}
+
+
+void Benchmark::writeReport (std::ostream& stream, const std::vector<BenchmarkResult>& results)
+{
+    // Group the results so each table only varies in size, the page policies are kept apart so they can be compared.
+    auto groups = std::map<std::string, std::vector<const BenchmarkResult*>> { };
+
+    for (const auto& result : results)
+    {
+        if (result.loaded)
+        {
+            groups[result.group + (result.pages == PagePolicy::Huge ? "\" with huge pages" : "\"")].push_back (&result);
+        }
+    }
+
+    for (auto& group : groups)
+    {
+        auto& members = group.second;
+        std::sort (members.begin(), members.end(), [] (const BenchmarkResult* a, const BenchmarkResult* b) { return a->getTiles() < b->getTiles(); });
+
+        stream  << std::endl << "Group \"" << group.first << ", slopes are log-log against the tile count (1.0 = linear)." << std::endl
+                << std::setw (12) << "size" 
+                << std::setw (12) << "load ms"  << std::setw (8) << "slope"
+                << std::setw (12) << "peak MB"  << std::setw (8) << "slope"
+                << std::setw (12) << "iter/s"   << std::setw (8) << "slope"
+                << std::setw (12) << "B/node"   << std::setw (8) << "slope"
+                << std::setw (12) << "dTLB/iter" << std::endl;
+
+        const BenchmarkResult* previous = nullptr;
+
+        for (const auto result : members)
+        {
+            // Slopes compare against the previous size.
+            const auto slope = [&] (const double value, const double previousValue)
+            {
+                return previous ? calculateSlope (result->getTiles(), previous->getTiles(), value, previousValue) : 0.0;
+            };
+
+            const auto peakMB = result->peakBytes / (1024.0 * 1024.0);
+
+            stream  << std::fixed << std::setprecision (2)
+                    << std::setw (12) << (std::to_string (result->width) + "x" + std::to_string (result->height))
+                    << std::setw (12) << result->loadSeconds * 1000.0
+                    << std::setw (8)  << slope (result->loadSeconds, previous ? previous->loadSeconds : 0.0)
+                    << std::setw (12) << peakMB
+                    << std::setw (8)  << slope (peakMB, previous ? previous->peakBytes / (1024.0 * 1024.0) : 0.0)
+                    << std::setw (12) << result->getIterationsPerSecond()
+                    << std::setw (8)  << slope (result->getIterationsPerSecond(), previous ? previous->getIterationsPerSecond() : 0.0)
+                    << std::setw (12) << result->bytesPerNode
+                    << std::setw (8)  << slope (result->bytesPerNode, previous ? previous->bytesPerNode : 0.0)
+                    << std::setw (12) << (result->tlbCounted ? std::to_string (result->getMissesPerIteration()) : "n/a")
+                    << std::endl;
+
+            previous = result;
+        }
+
+        // Break the memory down by subsystem so the cost of each map size can be planned for.
+        stream << "Peak MB by subsystem:" << std::endl << std::setw (12) << "size";
+
+        for (auto i = 0U; i < (unsigned int) MemorySubsystem::Count; ++i)
+        {
+            stream << std::setw (17) << MemoryTracker::getName ((MemorySubsystem) i);
+        }
+
+        stream << std::endl;
+
+        for (const auto result : members)
+        {
+            stream << std::setw (12) << (std::to_string (result->width) + "x" + std::to_string (result->height));
+
+            for (const auto& usage : result->memory)
+            {
+                stream << std::setw (17) << usage.peak / (1024.0 * 1024.0);
+            }
+
+            stream << std::endl;
+        }
+    }
+}
+
+
+void Benchmark::writeJson (std::ostream& stream, const BenchmarkRun& run)
+{
+    const auto& environment = run.environment;
+
+    // Strings need escaping, everything else is written as it is.
+    const auto field = [&] (const char* const indent, const char* const name, const std::string& value)
+    {
+        stream << indent << "\"" << name << "\": ";
+        JsonValue::writeString (stream, value);
+        stream << "," << std::endl;
+    };
+
+    stream  << std::setprecision (9) << "{" << std::endl
+            << "    \"format\": 1," << std::endl
+            << "    \"environment\":" << std::endl 
+            << "    {" << std::endl;
+
+    field ("        ", "revision", environment.revision);
+    field ("        ", "cpu", environment.cpu);
+    field ("        ", "compiler", environment.compiler);
+    field ("        ", "flags", environment.flags);
+    field ("        ", "time", environment.time);
+
+    stream  << "        \"threads\": " << environment.threads << std::endl
+            << "    }," << std::endl
+            << "    \"series\":" << std::endl 
+            << "    [";
+
+    for (auto i = 0U; i < run.series.size(); ++i)
+    {
+        const auto& series = run.series[i];
+
+        stream << (i > 0 ? "," : "") << std::endl << "        {" << std::endl;
+
+        field ("            ", "suite", series.suite);
+        field ("            ", "kernel", series.kernel);
+        field ("            ", "scenario", series.scenario);
+        field ("            ", "unit", series.unit);
+
+        stream  << "            \"higher_is_better\": " << (series.higherIsBetter ? "true" : "false") << "," << std::endl
+                << "            \"samples\": [";
+
+        for (auto j = 0U; j < series.samples.size(); ++j)
+        {
+            // JSON has no infinities, which only come from a broken clock.
+            const auto sample = series.samples[j];
+            stream << (j > 0 ? ", " : " ") << (std::isfinite (sample) ? sample : 0.0);
+        }
+
+        stream << " ]" << std::endl << "        }";
+    }
+
+    stream << std::endl << "    ]" << std::endl << "}" << std::endl;
+}
+
+
+BenchmarkRun Benchmark::readJson (const std::string& file)
+{
+    auto stream = std::ifstream (file, std::ios::binary);
+
+    if (!stream)
+    {
+        throw std::invalid_argument ("Benchmark::readJson(), file location given is invalid. \"" + file + "\".");
+    }
+
+    auto text = std::ostringstream { };
+    text << stream.rdbuf();
+
+    auto run = BenchmarkRun { };
+
+    try
+    {
+        const auto document = JsonValue::parse (text.str());
+
+        if (document.getMember ("format").getNumber() != 1.0)
+        {
+            throw std::runtime_error ("Benchmark::readJson(), unsupported format.");
+        }
+
+        const auto& environment = document.getMember ("environment");
+
+        run.environment.revision = environment.getMember ("revision").getString();
+        run.environment.cpu      = environment.getMember ("cpu").getString();
+        run.environment.threads  = (unsigned int) environment.getMember ("threads").getNumber();
+        run.environment.compiler = environment.getMember ("compiler").getString();
+        run.environment.flags    = environment.getMember ("flags").getString();
+        run.environment.time     = environment.getMember ("time").getString();
+
+        for (const auto& element : document.getMember ("series").getElements())
+        {
+            auto series = createSeries (element.getMember ("suite").getString(), element.getMember ("kernel").getString(), 
+                                        element.getMember ("scenario").getString(), element.getMember ("unit").getString(), 
+                                        element.getMember ("higher_is_better").getBoolean());
+
+            for (const auto& sample : element.getMember ("samples").getElements())
+            {
+                series.samples.push_back (sample.getNumber());
+            }
+
+            run.series.push_back (std::move (series));
+        }
+    }
+
+    catch (const std::exception& error)
+    {
+        throw std::runtime_error (std::string (error.what()) + " \"" + file + "\".");
+    }
+
+    return run;
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+double Benchmark::calculateSlope (const double tiles, const double previousTiles, const double value, const double previousValue)
+{
+    // Logarithms need positive values.
+    if (tiles <= previousTiles || value <= 0.0 || previousValue <= 0.0)
+    {
+        return 0.0;
+    }
+
+    return std::log (value / previousValue) / std::log (tiles / previousTiles);
+}
+
+
+void Benchmark::sampleLoads (const std::string& file, BenchmarkSeries& series) const
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    // The largest maps take seconds to load so they're given the same budget as planning.
+    const auto budget = m_querySeconds * m_queries;
+    auto       spent  = series.samples.front();
+
+    while (series.samples.size() < m_samples && spent < budget)
+    {
+        const auto start = Clock::now();
+        LevelData data { file };
+        const auto elapsed = std::chrono::duration<double> (Clock::now() - start).count();
+
+        series.samples.push_back (elapsed);
+        spent += elapsed;
+    }
+}
+
+
+BenchmarkSeries Benchmark::sampleReads (const LevelData& data, const std::string& scenario) const
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    // Random reads defeat the caches the same way nearest neighbour samples do, the indices are chosen up front.
+    const auto reads   = 1U << 16;
+    auto       random  = std::mt19937 (m_seed);
+    auto       pick    = std::uniform_int_distribution<unsigned int> (0, data.getTileCount() - 1);
+    auto       indices = std::vector<unsigned int> (reads);
+
+    for (auto& index : indices)
+    {
+        index = pick (random);
+    }
+
+    auto series = createSeries ("LevelData", "tile_reads", scenario, "reads/s", true);
+    auto total  = 0U;
+
+    for (auto sample = 0U; sample < m_samples; ++sample)
+    {
+        const auto start = Clock::now();
+
+        for (const auto index : indices)
+        {
+            total += (unsigned int) data.getTile (index);
+        }
+
+        const auto elapsed = std::chrono::duration<double> (Clock::now() - start).count();
+        series.samples.push_back (elapsed > 0.0 ? reads / elapsed : 0.0);
+    }
+
+    // Stop the reads from being optimised away.
+    volatile auto sink = total;
+    (void) sink;
+
+    return series;
+}
+
+
+BenchmarkSeries Benchmark::createSeries (const std::string& suite, const std::string& kernel, const std::string& scenario, 
+                                         const std::string& unit, const bool higherIsBetter)
+{
+    auto series           = BenchmarkSeries { };
+    series.suite          = suite;
+    series.kernel         = kernel;
+    series.scenario       = scenario;
+    series.unit           = unit;
+    series.higherIsBetter = higherIsBetter;
+
+    return series;
+}
+
+
+std::string Benchmark::describeScenario (const std::string& workload)
+{
+    return HugePages::getPolicy() == PagePolicy::Huge ? workload + " with huge pages" : workload;
+}
+
+
+std::string Benchmark::determineRevision()
+{
+    // Builds can bake the revision in, otherwise ask git about the working directory.
+    #if defined (GEC_GIT_REVISION)
+        return GEC_GIT_REVISION;
+    #else
+        #if defined (_WIN32)
+            const auto pipe = _popen ("git describe --always --dirty 2>nul", "r");
+        #else
+            const auto pipe = popen ("git describe --always --dirty 2>/dev/null", "r");
+        #endif
+
+        auto revision = std::string { };
+
+        if (pipe)
+        {
+            char buffer[128] { };
+
+            while (std::fgets (buffer, sizeof (buffer), pipe))
+            {
+                revision += buffer;
+            }
+
+            #if defined (_WIN32)
+                _pclose (pipe);
+            #else
+                pclose (pipe);
+            #endif
+        }
+
+        while (!revision.empty() && std::isspace ((unsigned char) revision.back()))
+        {
+            revision.pop_back();
+        }
+
+        return revision.empty() ? "unknown" : revision;
+    #endif
+}
+
+
+std::string Benchmark::determineCpu()
+{
+    auto cpu = std::string { };
+
+    // The brand string is spread over three extended CPUID leaves.
+    #if defined (_MSC_VER) && (defined (_M_IX86) || defined (_M_X64))
+        int registers[4] { };
+        __cpuid (registers, 0x80000000);
+
+        if ((unsigned int) registers[0] >= 0x80000004)
+        {
+            for (auto leaf = 0x80000002; leaf <= 0x80000004; ++leaf)
+            {
+                __cpuid (registers, leaf);
+                cpu.append (reinterpret_cast<const char*> (registers), sizeof (registers));
+            }
+        }
+    #elif defined (__i386__) || defined (__x86_64__)
+        unsigned int registers[4] { };
+
+        if (__get_cpuid (0x80000000, &registers[0], &registers[1], &registers[2], &registers[3]) && registers[0] >= 0x80000004)
+        {
+            for (auto leaf = 0x80000002U; leaf <= 0x80000004U; ++leaf)
+            {
+                __get_cpuid (leaf, &registers[0], &registers[1], &registers[2], &registers[3]);
+                cpu.append (reinterpret_cast<const char*> (registers), sizeof (registers));
+            }
+        }
+    #else
+        // Other architectures can only be identified through the operating system.
+        auto stream = std::ifstream ("/proc/cpuinfo");
+        auto line   = std::string { };
+
+        while (cpu.empty() && std::getline (stream, line))
+        {
+            const auto colon = line.find (':');
+
+            if (colon != std::string::npos && (line.compare (0, 10, "model name") == 0 || line.compare (0, 9, "Processor") == 0))
+            {
+                cpu = line.substr (colon + 1);
+            }
+        }
+    #endif
+
+    // Brand strings are padded with nulls and spaces.
+    cpu = cpu.substr (0, cpu.find ('\0'));
+    const auto first = cpu.find_first_not_of (' '),
+               last  = cpu.find_last_not_of (' ');
+
+    return first == std::string::npos ? "unknown" : cpu.substr (first, last - first + 1);
+}
+
+
+std::string Benchmark::determineFlags()
+{
+    // Builds can describe their own flags, otherwise use what the compiler tells us.
+    #if defined (GEC_BUILD_FLAGS)
+        return GEC_BUILD_FLAGS;
+    #else
+        auto flags = std::string { };
+
+        #if defined (NDEBUG)
+            flags += "release";
+        #else
+            flags += "debug";
+        #endif
+
+        #if defined (__OPTIMIZE__)
+            flags += " optimised";
+        #endif
+
+        #if defined (_M_X64) || defined (__x86_64__)
+            flags += " x64";
+        #elif defined (_M_IX86) || defined (__i386__)
+            flags += " x86";
+        #elif defined (_M_ARM64) || defined (__aarch64__)
+            flags += " arm64";
+        #endif
+
+        #if defined (__AVX512F__)
+            flags += " avx512";
+        #elif defined (__AVX2__)
+            flags += " avx2";
+        #elif defined (__AVX__)
+            flags += " avx";
+        #elif defined (__SSE4_2__)
+            flags += " sse4.2";
+        #endif
+
+        return flags;
+    #endif
+}
\ No newline at end of file
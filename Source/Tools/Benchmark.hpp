@@ -0,0 +1,226 @@
+#ifndef GEC_BENCHMARK_HPP
+#define GEC_BENCHMARK_HPP
+
+
+// STL headers.
+#include <array>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+// Application headers.
+#include <Utility/HugePages.hpp>
+#include <Utility/MemoryTracker.hpp>
+
+
+// Forward declarations.
+class LevelData;
+
+
+/// <summary>
+/// Repeated measurements of a single kernel under a single scenario, kept whole so that two runs can be compared with
+/// statistical tests rather than by eye.
+/// </summary>
+struct BenchmarkSeries final
+{
+    std::string         suite           { };        //!< The part of the project being measured: "RRT", "Tree" or "LevelData".
+    std::string         kernel          { };        //!< What was measured, e.g. "plan_throughput".
+    std::string         scenario        { };        //!< The workload it was measured under, e.g. the map and page policy.
+    std::string         unit            { };        //!< The unit of each sample.
+    bool                higherIsBetter  { true };   //!< Whether larger samples are an improvement, false for latencies.
+    std::vector<double> samples         { };        //!< Every measurement in the order they were taken.
+
+    /// <summary> Gets the name which identifies the series across runs. </summary>
+    std::string getKey() const  { return suite + "/" + kernel + "/" + scenario; }
+};
+
+
+/// <summary>
+/// Describes where a set of results came from, results from different machines or builds can't be compared fairly.
+/// </summary>
+struct BenchmarkEnvironment final
+{
+    std::string     revision    { };    //!< The git revision of the source, suffixed with "-dirty" when there were local changes.
+    std::string     cpu         { };    //!< The model name of the processor.
+    unsigned int    threads     { 0 };  //!< The number of hardware threads.
+    std::string     compiler    { };    //!< The compiler and its version.
+    std::string     flags       { };    //!< The build configuration, e.g. release or debug and the instruction sets enabled.
+    std::string     time        { };    //!< When the benchmark was ran, as UTC in ISO 8601 format.
+};
+
+
+/// <summary>
+/// Every series measured by a single run of the benchmark along with the environment it ran in.
+/// </summary>
+struct BenchmarkRun final
+{
+    BenchmarkEnvironment            environment { };    //!< Where the results came from.
+    std::vector<BenchmarkSeries>    series      { };    //!< Every kernel and scenario measured.
+};
+
+
+/// <summary>
+/// The measurements taken whilst benchmarking a single map.
+/// </summary>
+struct BenchmarkResult final
+{
+    std::string     map                 { };        //!< The file name of the map.
+    std::string     group               { };        //!< Maps in the same group only differ in size, e.g. the obstacle density.
+    unsigned int    width               { 0 };      //!< The width of the map in tiles.
+    unsigned int    height              { 0 };      //!< The height of the map in tiles.
+    PagePolicy      pages               { PagePolicy::Standard };  //!< How the tiles and nodes were allocated.
+    bool            loaded              { false };  //!< Whether the map loaded successfully.
+    std::string     error               { };        //!< Why the map failed to load or plan.
+
+    double          loadSeconds         { 0.0 };    //!< How long LevelData::loadFromFile() took.
+    size_t          peakBytes           { 0 };      //!< The peak resident memory of the process whilst benchmarking the map.
+    size_t          tileBytes           { 0 };      //!< The memory used to store the tiles of the map.
+
+    unsigned int    queries             { 0 };      //!< The number of start and end points planned between.
+    unsigned int    solved              { 0 };      //!< The number of queries which reached the end point.
+    unsigned long long iterations       { 0 };      //!< The total number of calls to RRT::generateBranch().
+    unsigned long long nodes            { 0 };      //!< The total number of nodes created.
+    double          planSeconds         { 0.0 };    //!< The total time spent planning.
+    double          bytesPerNode        { 0.0 };    //!< The tracked tree and index memory added by planning divided by the nodes created.
+    bool            tlbCounted          { false };  //!< Whether data TLB misses could be counted on this machine.
+    unsigned long long dtlbMisses       { 0 };      //!< The data TLB misses whilst planning.
+    std::vector<BenchmarkSeries> series { };        //!< The samples of each LevelData and RRT kernel measured on the map.
+    std::array<MemoryUsage, (size_t) MemorySubsystem::Count> memory { };   //!< The peak bytes and allocations of each subsystem whilst loading and planning.
+
+    /// <summary> Gets the number of tiles in the map. </summary>
+    double getTiles() const                 { return (double) width * height; }
+
+    /// <summary> Gets the planning throughput. </summary>
+    double getIterationsPerSecond() const   { return planSeconds > 0.0 ? iterations / planSeconds : 0.0; }
+
+    /// <summary> Gets the average data TLB misses of each planning iteration. </summary>
+    double getMissesPerIteration() const    { return iterations > 0 ? (double) dtlbMisses / iterations : 0.0; }
+};
+
+
+/// <summary>
+/// Benchmarks loading and planning on each map of a corpus, reporting how each measurement scales with the size of the
+/// map. Scaling is reported as the slope of each measurement against the tile count on a log-log scale, so a slope of
+/// one is linear and a sudden change in slope between sizes points to a regression. Each kernel is also sampled several
+/// times so runs can be stored as JSON and compared against each other by BenchmarkComparator.
+/// </summary>
+class Benchmark final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a benchmark with the given workload per map. </summary>
+        /// <param name="queries"> The number of random start and end points to plan between on each map. </param>
+        /// <param name="querySeconds"> The maximum time to spend on each query. </param>
+        /// <param name="seed"> The seed used to choose the start and end points. </param>
+        Benchmark (const unsigned int queries = 8U, const double querySeconds = 0.5, const unsigned int seed = 0U);
+
+        Benchmark (Benchmark&& move)                    = default;
+        Benchmark& operator= (Benchmark&& move)         = default;
+        Benchmark (const Benchmark& copy)               = default;
+        Benchmark& operator= (const Benchmark& copy)    = default;
+        ~Benchmark()                                    = default;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Sets the page policies each map is benchmarked with, every map is ran once per policy. </summary>
+        void setPagePolicies (const std::vector<PagePolicy>& policies)  { m_policies = policies; }
+
+        /// <summary> Sets how many samples are taken of each kernel, loads are also limited by the planning time of a map. </summary>
+        void setSamples (const unsigned int samples)                    { m_samples = samples; }
+
+        /// <summary> Benchmarks a single map using the current HugePages policy. Errors are recorded in the result rather than thrown. </summary>
+        /// <param name="file"> The location of the map. </param>
+        BenchmarkResult run (const std::string& file) const;
+
+        /// <summary> Checks that a malformed map fails to load with an exception rather than loading or crashing. </summary>
+        /// <param name="file"> The location of the map. </param>
+        /// <param name="error"> Set to the message of the exception which was thrown. </param>
+        /// <returns> Whether the map was correctly rejected. </returns>
+        bool runMalformed (const std::string& file, std::string& error) const;
+
+        /// <summary> Benchmarks every map listed in a manifest written by MapCorpus. </summary>
+        /// <param name="manifest"> The location of the manifest. </param>
+        /// <param name="log"> Progress is written here as each map is completed. </param>
+        /// <returns> The result of each map, malformed maps are logged but not returned. </returns>
+        std::vector<BenchmarkResult> runManifest (const std::string& manifest, std::ostream& log) const;
+
+        /// <summary> Benchmarks building, traversing and pruning a pooled tree of random shape under each page policy. </summary>
+        /// <param name="nodes"> The number of nodes in the tree. </param>
+        /// <returns> The samples of each Tree kernel. </returns>
+        std::vector<BenchmarkSeries> runTree (const unsigned int nodes) const;
+
+        /// <summary> Describes the machine and build the benchmark is running on. </summary>
+        static BenchmarkEnvironment describeEnvironment();
+
+
+        ///////////////
+        // Reporting //
+        ///////////////
+
+        /// <summary> Writes every result as comma-separated values, suitable for charting elsewhere. </summary>
+        static void writeCsv (std::ostream& stream, const std::vector<BenchmarkResult>& results);
+
+        /// <summary> Writes a table of each group of results against map size, with the log-log slope between sizes. </summary>
+        static void writeReport (std::ostream& stream, const std::vector<BenchmarkResult>& results);
+
+        /// <summary> Writes a run as JSON, every sample is kept so runs can be compared statistically. </summary>
+        static void writeJson (std::ostream& stream, const BenchmarkRun& run);
+
+        /// <summary> Reads a run written by writeJson(). Throws an exception if the file can't be read or is malformed. </summary>
+        /// <param name="file"> The location of the JSON file. </param>
+        static BenchmarkRun readJson (const std::string& file);
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Calculates the log-log slope between two measurements, zero if either is unusable. </summary>
+        static double calculateSlope (const double tiles, const double previousTiles, const double value, const double previousValue);
+
+        /// <summary> Repeatedly loads a map to sample LevelData::loadFromFile(), stopping early once the time budget is spent. </summary>
+        /// <param name="file"> The location of the map. </param>
+        /// <param name="series"> The series to add samples to, this already holds the first load. </param>
+        void sampleLoads (const std::string& file, BenchmarkSeries& series) const;
+
+        /// <summary> Samples how quickly random tiles can be read from a level. </summary>
+        BenchmarkSeries sampleReads (const LevelData& data, const std::string& scenario) const;
+
+        /// <summary> Creates a series without any samples. </summary>
+        static BenchmarkSeries createSeries (const std::string& suite, const std::string& kernel, const std::string& scenario, 
+                                             const std::string& unit, const bool higherIsBetter);
+
+        /// <summary> Names a scenario after the workload and the page policy in use. </summary>
+        static std::string describeScenario (const std::string& workload);
+
+        /// <summary> Gets the git revision of the source, "unknown" if git isn't available. </summary>
+        static std::string determineRevision();
+
+        /// <summary> Gets the model name of the processor, "unknown" if it can't be found. </summary>
+        static std::string determineCpu();
+
+        /// <summary> Gets the build configuration from the compiler's predefined macros. </summary>
+        static std::string determineFlags();
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int    m_queries       { 8 };      //!< The number of queries to plan on each map.
+        double          m_querySeconds  { 0.5 };    //!< The maximum time to spend on each query.
+        unsigned int    m_seed          { 0 };      //!< The seed used to choose start and end points.
+        unsigned int    m_samples       { 8 };      //!< The number of samples to take of each kernel.
+        std::vector<PagePolicy> m_policies  { PagePolicy::Standard };   //!< The page policies to benchmark each map with.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,425 @@
+#include "BenchmarkComparator.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <ostream>
+#include <random>
+#include <sstream>
+
+
+// Application headers.
+#include <Tools/Benchmark.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+BenchmarkComparator::BenchmarkComparator (const double threshold, const double significance, const unsigned int resamples)
+    : m_threshold (threshold), m_significance (significance), m_resamples (resamples)
+{
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+std::vector<BenchmarkComparison> BenchmarkComparator::compare (const BenchmarkRun& baseline, const BenchmarkRun& candidate) const
+{
+    // Pair up the series by key, a key appearing more than once in a run has its samples pooled.
+    struct Pair final
+    {
+        const BenchmarkSeries*  description { nullptr };
+        std::vector<double>     baseline    { };
+        std::vector<double>     candidate   { };
+        bool                    inBaseline  { false };
+        bool                    inCandidate { false };
+    };
+
+    auto pairs = std::map<std::string, Pair> { };
+
+    for (const auto& series : baseline.series)
+    {
+        auto& pair       = pairs[series.getKey()];
+        pair.description = &series;
+        pair.inBaseline  = true;
+        pair.baseline.insert (pair.baseline.end(), series.samples.cbegin(), series.samples.cend());
+    }
+
+    for (const auto& series : candidate.series)
+    {
+        auto& pair       = pairs[series.getKey()];
+        pair.description = &series;
+        pair.inCandidate = true;
+        pair.candidate.insert (pair.candidate.end(), series.samples.cbegin(), series.samples.cend());
+    }
+
+    auto comparisons = std::vector<BenchmarkComparison> { };
+
+    for (auto& pair : pairs)
+    {
+        auto comparison           = BenchmarkComparison { };
+        comparison.key            = pair.first;
+        comparison.unit           = pair.second.description->unit;
+        comparison.higherIsBetter = pair.second.description->higherIsBetter;
+        comparison.baselineCount  = pair.second.baseline.size();
+        comparison.candidateCount = pair.second.candidate.size();
+
+        if (!pair.second.inCandidate)
+        {
+            comparison.verdict        = BenchmarkComparison::Verdict::Missing;
+            comparison.baselineMedian = calculateMedian (pair.second.baseline);
+        }
+
+        else if (!pair.second.inBaseline)
+        {
+            comparison.verdict         = BenchmarkComparison::Verdict::Added;
+            comparison.candidateMedian = calculateMedian (pair.second.candidate);
+        }
+
+        else
+        {
+            compareSamples (pair.second.baseline, pair.second.candidate, comparison);
+        }
+
+        comparisons.push_back (std::move (comparison));
+    }
+
+    // Testing many series at once would flag some by chance alone so the p-values are adjusted for the false discovery
+    // rate. Only changes which are significant, large enough to matter and clear of zero in the interval are flagged.
+    adjustPValues (comparisons);
+
+    for (auto& comparison : comparisons)
+    {
+        const auto worse   = comparison.higherIsBetter ? -comparison.change : comparison.change;
+        const auto clear   = comparison.lower > 0.0 || comparison.upper < 0.0;
+        const auto flagged = comparison.verdict == BenchmarkComparison::Verdict::Unchanged && comparison.qValue <= m_significance && 
+                             std::abs (comparison.change) > m_threshold && clear;
+
+        if (flagged)
+        {
+            comparison.verdict = worse > 0.0 ? BenchmarkComparison::Verdict::Regressed : BenchmarkComparison::Verdict::Improved;
+        }
+    }
+
+    return comparisons;
+}
+
+
+void BenchmarkComparator::writeReport (std::ostream& stream, const BenchmarkRun& baseline, const BenchmarkRun& candidate,
+                                       const std::vector<BenchmarkComparison>& comparisons)
+{
+    const auto& before = baseline.environment;
+    const auto& after  = candidate.environment;
+
+    stream  << "Baseline:  " << before.revision << " at " << before.time << std::endl
+            << "Candidate: " << after.revision << " at " << after.time << std::endl;
+
+    // Results from different machines or builds differ for reasons which have nothing to do with the code.
+    const auto warn = [&] (const char* const name, const std::string& first, const std::string& second)
+    {
+        if (first != second)
+        {
+            stream << "Warning: the runs used a different " << name << ", \"" << first << "\" against \"" << second << "\"." << std::endl;
+        }
+    };
+
+    warn ("cpu", before.cpu, after.cpu);
+    warn ("thread count", std::to_string (before.threads), std::to_string (after.threads));
+    warn ("compiler", before.compiler, after.compiler);
+    warn ("build", before.flags, after.flags);
+
+    stream  << std::endl
+            << std::left << std::setw (14) << "verdict" << std::right
+            << std::setw (10) << "change"
+            << std::setw (22) << "95% interval"
+            << std::setw (10) << "p"
+            << std::setw (10) << "q"
+            << std::setw (14) << "baseline"
+            << std::setw (14) << "candidate"
+            << "  " << std::left << std::setw (14) << "unit" << "series" << std::right << std::endl;
+
+    auto counts = std::map<BenchmarkComparison::Verdict, unsigned int> { };
+
+    for (const auto& comparison : comparisons)
+    {
+        const auto percent = [] (const double value)
+        {
+            auto text = std::ostringstream { };
+            text << std::showpos << std::fixed << std::setprecision (1) << value * 100.0 << "%";
+            return text.str();
+        };
+
+        const auto compared = comparison.verdict != BenchmarkComparison::Verdict::Missing &&
+                              comparison.verdict != BenchmarkComparison::Verdict::Added;
+
+        stream  << std::left << std::setw (14) << getVerdictName (comparison.verdict) << std::right
+                << std::setw (10) << (compared ? percent (comparison.change) : "")
+                << std::setw (22) << (compared ? "[" + percent (comparison.lower) + ", " + percent (comparison.upper) + "]" : "")
+                << std::setw (10) << std::setprecision (4) << comparison.pValue
+                << std::setw (10) << comparison.qValue
+                << std::setw (14) << std::setprecision (6) << comparison.baselineMedian
+                << std::setw (14) << comparison.candidateMedian
+                << "  " << std::left << std::setw (14) << comparison.unit << comparison.key << std::right << std::endl;
+
+        ++counts[comparison.verdict];
+    }
+
+    stream  << std::endl
+            << counts[BenchmarkComparison::Verdict::Regressed] << " regressed, "
+            << counts[BenchmarkComparison::Verdict::Improved] << " improved, "
+            << counts[BenchmarkComparison::Verdict::Unchanged] << " unchanged, "
+            << counts[BenchmarkComparison::Verdict::Inconclusive] << " inconclusive, "
+            << counts[BenchmarkComparison::Verdict::Missing] << " missing and "
+            << counts[BenchmarkComparison::Verdict::Added] << " added." << std::endl;
+}
+
+
+double BenchmarkComparator::calculateMannWhitney (const std::vector<double>& a, const std::vector<double>& b)
+{
+    if (a.empty() || b.empty())
+    {
+        return 1.0;
+    }
+
+    // Rank every sample together, tied samples share the average of their ranks.
+    auto combined = std::vector<std::pair<double, bool>> { };
+
+    for (const auto sample : a)
+    {
+        combined.emplace_back (sample, true);
+    }
+
+    for (const auto sample : b)
+    {
+        combined.emplace_back (sample, false);
+    }
+
+    std::sort (combined.begin(), combined.end());
+
+    const auto first  = (double) a.size(),
+               second = (double) b.size(),
+               total  = first + second;
+
+    auto rankSum = 0.0,
+         ties    = 0.0;
+
+    for (auto i = 0U; i < combined.size();)
+    {
+        auto end = i + 1;
+
+        while (end < combined.size() && combined[end].first == combined[i].first)
+        {
+            ++end;
+        }
+
+        const auto rank  = (i + 1 + end) / 2.0,
+                   count = (double) (end - i);
+
+        for (auto j = i; j < end; ++j)
+        {
+            rankSum += combined[j].second ? rank : 0.0;
+        }
+
+        ties += count * count * count - count;
+        i     = end;
+    }
+
+    const auto u      = rankSum - first * (first + 1.0) / 2.0,
+               mean   = first * second / 2.0;
+
+    // Small samples without ties use the exact distribution of U, the normal approximation is poor at the tails.
+    const auto exactLimit = 20U;
+
+    if (ties == 0.0 && a.size() <= exactLimit && b.size() <= exactLimit)
+    {
+        const auto counts  = countArrangements (a.size(), b.size());
+        const auto extreme = (unsigned int) std::lround (std::min (u, first * second - u));
+
+        auto tail = 0.0,
+             all  = 0.0;
+
+        for (auto i = 0U; i < counts.size(); ++i)
+        {
+            tail += i <= extreme ? counts[i] : 0.0;
+            all  += counts[i];
+        }
+
+        return std::min (1.0, 2.0 * tail / all);
+    }
+
+    // Otherwise use the normal approximation with corrections for ties and continuity.
+    const auto variance = first * second / 12.0 * ((total + 1.0) - ties / (total * (total - 1.0)));
+
+    if (variance <= 0.0)
+    {
+        return 1.0;
+    }
+
+    const auto z = std::max (0.0, std::abs (u - mean) - 0.5) / std::sqrt (variance);
+
+    return std::min (1.0, std::erfc (z / std::sqrt (2.0)));
+}
+
+
+const char* BenchmarkComparator::getVerdictName (const BenchmarkComparison::Verdict verdict)
+{
+    switch (verdict)
+    {
+        case BenchmarkComparison::Verdict::Unchanged:       return "unchanged";
+        case BenchmarkComparison::Verdict::Improved:        return "improved";
+        case BenchmarkComparison::Verdict::Regressed:       return "REGRESSED";
+        case BenchmarkComparison::Verdict::Inconclusive:    return "inconclusive";
+        case BenchmarkComparison::Verdict::Missing:         return "missing";
+        case BenchmarkComparison::Verdict::Added:           return "added";
+        default:                                            return "unknown";
+    }
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+void BenchmarkComparator::compareSamples (const std::vector<double>& baseline, const std::vector<double>& candidate, BenchmarkComparison& comparison) const
+{
+    auto before = baseline,
+         after  = candidate;
+
+    comparison.baselineMedian  = calculateMedian (before);
+    comparison.candidateMedian = calculateMedian (after);
+
+    // With very few samples even completely separate results aren't significant, the smallest p-value possible is 2 / C(n + m, n).
+    auto combinations = 1.0;
+
+    for (auto i = 1U; i <= before.size(); ++i)
+    {
+        combinations = combinations * (after.size() + i) / i;
+    }
+
+    if (before.empty() || after.empty() || 2.0 / combinations > m_significance)
+    {
+        comparison.verdict = BenchmarkComparison::Verdict::Inconclusive;
+        return;
+    }
+
+    const auto relative = [] (const double from, const double to) { return from != 0.0 ? to / from - 1.0 : 0.0; };
+
+    comparison.change = relative (comparison.baselineMedian, comparison.candidateMedian);
+    comparison.pValue = calculateMannWhitney (before, after);
+
+    // Bootstrap the change in the median, the same seed keeps reports reproducible.
+    auto random   = std::mt19937 (0);
+    auto pickA    = std::uniform_int_distribution<size_t> (0, before.size() - 1),
+         pickB    = std::uniform_int_distribution<size_t> (0, after.size() - 1);
+    auto changes  = std::vector<double> (m_resamples);
+    auto resample = std::vector<double> { };
+
+    for (auto& change : changes)
+    {
+        resample.resize (before.size());
+        std::generate (resample.begin(), resample.end(), [&] { return baseline[pickA (random)]; });
+        const auto from = calculateMedian (resample);
+
+        resample.resize (after.size());
+        std::generate (resample.begin(), resample.end(), [&] { return candidate[pickB (random)]; });
+        const auto to = calculateMedian (resample);
+
+        change = relative (from, to);
+    }
+
+    if (!changes.empty())
+    {
+        std::sort (changes.begin(), changes.end());
+        comparison.lower = changes[(size_t) (changes.size() * 0.025)];
+        comparison.upper = changes[std::min (changes.size() - 1, (size_t) (changes.size() * 0.975))];
+    }
+
+}
+
+
+void BenchmarkComparator::adjustPValues (std::vector<BenchmarkComparison>& comparisons)
+{
+    // Only series which were actually tested count towards the number of tests.
+    auto tested = std::vector<BenchmarkComparison*> { };
+
+    for (auto& comparison : comparisons)
+    {
+        if (comparison.verdict == BenchmarkComparison::Verdict::Unchanged)
+        {
+            tested.push_back (&comparison);
+        }
+    }
+
+    std::sort (tested.begin(), tested.end(), [] (const BenchmarkComparison* a, const BenchmarkComparison* b) { return a->pValue < b->pValue; });
+
+    // Benjamini-Hochberg: scale each p-value by the tests over its rank, then keep the adjusted values in order.
+    auto smallest = 1.0;
+
+    for (auto rank = tested.size(); rank > 0; --rank)
+    {
+        auto& comparison  = *tested[rank - 1];
+        smallest          = std::min (smallest, comparison.pValue * tested.size() / rank);
+        comparison.qValue = smallest;
+    }
+}
+
+
+double BenchmarkComparator::calculateMedian (std::vector<double>& samples)
+{
+    if (samples.empty())
+    {
+        return 0.0;
+    }
+
+    const auto middle = samples.begin() + samples.size() / 2;
+    std::nth_element (samples.begin(), middle, samples.end());
+
+    if (samples.size() % 2 == 1)
+    {
+        return *middle;
+    }
+
+    // Even counts average the two middle samples, the lower one is the largest of the first half.
+    return (*middle + *std::max_element (samples.begin(), middle)) / 2.0;
+}
+
+
+std::vector<double> BenchmarkComparator::countArrangements (const unsigned int first, const unsigned int second)
+{
+    // counts[i][j][u] is the number of orderings of i and j samples giving U = u. Placing the largest sample last, it
+    // either comes from the first set and beats all j of the second, or from the second and adds nothing.
+    auto counts = std::vector<std::vector<std::vector<double>>> (first + 1, std::vector<std::vector<double>> (second + 1));
+
+    for (auto i = 0U; i <= first; ++i)
+    {
+        for (auto j = 0U; j <= second; ++j)
+        {
+            auto& current = counts[i][j];
+            current.assign (i * j + 1, 0.0);
+
+            if (i == 0 || j == 0)
+            {
+                current[0] = 1.0;
+                continue;
+            }
+
+            for (auto u = 0U; u <= i * j; ++u)
+            {
+                const auto& withFirst  = counts[i - 1][j];
+                const auto& withSecond = counts[i][j - 1];
+
+                current[u] = (u >= j && u - j < withFirst.size() ? withFirst[u - j] : 0.0) +
+                             (u < withSecond.size() ? withSecond[u] : 0.0);
+            }
+        }
+    }
+
+    return counts[first][second];
+}
\ No newline at end of file
@@ -0,0 +1,124 @@
+#ifndef GEC_BENCHMARK_COMPARATOR_HPP
+#define GEC_BENCHMARK_COMPARATOR_HPP
+
+
+// STL headers.
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+// Forward declarations.
+struct BenchmarkRun;
+
+
+/// <summary>
+/// How a single series changed between a baseline run and a candidate run.
+/// </summary>
+struct BenchmarkComparison final
+{
+    /// <summary> The outcome of the comparison. </summary>
+    enum class Verdict : char
+    {
+        Unchanged,      //!< No significant change beyond the threshold.
+        Improved,       //!< Significantly better by more than the threshold.
+        Regressed,      //!< Significantly worse by more than the threshold.
+        Inconclusive,   //!< Too few samples on one side to test.
+        Missing,        //!< Only the baseline measured the series.
+        Added           //!< Only the candidate measured the series.
+    };
+
+    std::string     key             { };        //!< The suite, kernel and scenario of the series.
+    std::string     unit            { };        //!< The unit of each sample.
+    bool            higherIsBetter  { true };   //!< Whether larger samples are an improvement.
+    unsigned int    baselineCount   { 0 };      //!< The number of baseline samples.
+    unsigned int    candidateCount  { 0 };      //!< The number of candidate samples.
+    double          baselineMedian  { 0.0 };    //!< The median of the baseline samples.
+    double          candidateMedian { 0.0 };    //!< The median of the candidate samples.
+    double          change          { 0.0 };    //!< The relative change in the median, positive when the candidate is larger.
+    double          lower           { 0.0 };    //!< The lower bound of the bootstrap confidence interval of the change.
+    double          upper           { 0.0 };    //!< The upper bound of the bootstrap confidence interval of the change.
+    double          pValue          { 1.0 };    //!< The two-sided p-value of the Mann-Whitney U test.
+    double          qValue          { 1.0 };    //!< The p-value adjusted for the number of series tested.
+    Verdict         verdict         { Verdict::Unchanged };   //!< The outcome of the comparison.
+};
+
+
+/// <summary>
+/// Compares two benchmark runs series by series. A Mann-Whitney U test decides whether the samples differ at all, it
+/// makes no assumption about their distribution which suits timings with long tails. A bootstrap confidence interval
+/// of the relative change in the median shows how large the change is likely to be. The p-values are adjusted with the
+/// Benjamini-Hochberg procedure since a run holds many series and some would look significant by chance. A series is
+/// only flagged when the adjusted difference is significant, the interval excludes zero and the median moved further
+/// than the threshold, so noise in a large sample can't flag a change nobody would care about.
+/// </summary>
+class BenchmarkComparator final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a comparator with the given sensitivity. </summary>
+        /// <param name="threshold"> The smallest relative change in the median which is flagged, 0.05 is five percent. </param>
+        /// <param name="significance"> The largest p-value which counts as a significant difference. </param>
+        /// <param name="resamples"> The number of bootstrap resamples used for the confidence intervals. </param>
+        BenchmarkComparator (const double threshold = 0.05, const double significance = 0.05, const unsigned int resamples = 2000U);
+
+        BenchmarkComparator (BenchmarkComparator&& move)                    = default;
+        BenchmarkComparator& operator= (BenchmarkComparator&& move)         = default;
+        BenchmarkComparator (const BenchmarkComparator& copy)               = default;
+        BenchmarkComparator& operator= (const BenchmarkComparator& copy)    = default;
+        ~BenchmarkComparator()                                              = default;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Compares every series found in either run, matching them by their key. </summary>
+        /// <returns> A comparison of each series, ordered by key. </returns>
+        std::vector<BenchmarkComparison> compare (const BenchmarkRun& baseline, const BenchmarkRun& candidate) const;
+
+        /// <summary> Writes a table of the comparisons, preceded by any differences between the environments of the runs. </summary>
+        static void writeReport (std::ostream& stream, const BenchmarkRun& baseline, const BenchmarkRun& candidate,
+                                 const std::vector<BenchmarkComparison>& comparisons);
+
+        /// <summary> Calculates the two-sided p-value of a Mann-Whitney U test between two samples. </summary>
+        /// <returns> The p-value, one if either sample is empty. </returns>
+        static double calculateMannWhitney (const std::vector<double>& a, const std::vector<double>& b);
+
+        /// <summary> Gets the name of a verdict as shown in reports. </summary>
+        static const char* getVerdictName (const BenchmarkComparison::Verdict verdict);
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Tests the samples of a single series, the verdict is only set when the samples can't be tested. </summary>
+        void compareSamples (const std::vector<double>& baseline, const std::vector<double>& candidate, BenchmarkComparison& comparison) const;
+
+        /// <summary> Sets the q-value of every tested comparison by adjusting its p-value for the false discovery rate. </summary>
+        static void adjustPValues (std::vector<BenchmarkComparison>& comparisons);
+
+        /// <summary> Calculates the median of some samples, the samples are reordered. </summary>
+        static double calculateMedian (std::vector<double>& samples);
+
+        /// <summary> Counts how many ways every value of U can occur without ties, used for an exact p-value on small samples. </summary>
+        /// <returns> The number of arrangements giving each value of U, from zero to the product of the sample sizes. </returns>
+        static std::vector<double> countArrangements (const unsigned int first, const unsigned int second);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        double          m_threshold     { 0.05 };   //!< The smallest relative change which is flagged.
+        double          m_significance  { 0.05 };   //!< The largest p-value which counts as significant.
+        unsigned int    m_resamples     { 2000 };   //!< The number of bootstrap resamples.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,859 @@
+#include "DifferentialTester.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+#include <RRT/RRT.hpp>
+#include <Utility/SharedMemory.hpp>
+#include <Utility/ThreadPool.hpp>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+DifferentialTester::DifferentialTester (const unsigned int seed)
+    : m_random (seed)
+{
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+void DifferentialTester::setSizes (const unsigned int minimum, const unsigned int maximum)
+{
+    // Every check needs at least one tile.
+    m_minimum = std::max (1U, minimum);
+    m_maximum = std::max (m_minimum, maximum);
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+unsigned int DifferentialTester::run (const unsigned int cases, const std::string& directory, std::ostream& log)
+{
+    auto failures = 0U;
+
+    for (auto i = 0U; i < cases; ++i)
+    {
+        const auto test = generateCase();
+
+        for (auto check = 0U; check < (unsigned int) Check::Count; ++check)
+        {
+            const auto failure = runCheck ((Check) check, test);
+
+            if (!failure.empty())
+            {
+                ++failures;
+                log << "case " << i << " failed " << getCheckName ((Check) check) << ": " << failure << std::endl;
+
+                // Small repros are much quicker to debug, the failure may change slightly as the map shrinks.
+                const auto minimised = minimise ((Check) check, test);
+                log << "  minimised from " << test.width << "x" << test.height << " to " << minimised.width << "x" << minimised.height
+                    << ": " << runCheck ((Check) check, minimised) << std::endl;
+
+                if (!directory.empty())
+                {
+                    const auto file = directory + "/" + getCheckName ((Check) check) + "_" + std::to_string (i);
+                    writeCase (file, (Check) check, runCheck ((Check) check, minimised), minimised);
+
+                    log << "  written to " << file << ".case" << std::endl;
+                }
+            }
+        }
+
+        if ((i + 1) % 100 == 0)
+        {
+            log << (i + 1) << " cases checked, " << failures << " failures." << std::endl;
+        }
+    }
+
+    log << cases << " cases checked, " << failures << " failures." << std::endl;
+
+    return failures;
+}
+
+
+unsigned int DifferentialTester::replay (const std::string& file, std::ostream& log) const
+{
+    auto stream = std::ifstream (file);
+
+    if (!stream)
+    {
+        throw std::invalid_argument ("DifferentialTester::replay(), file location given is invalid. \"" + file + "\".");
+    }
+
+    // Each line is a key followed by its value, the check and failure are only there for people to read.
+    auto test = Case { };
+    auto map  = std::string { };
+    auto line = std::string { };
+
+    while (std::getline (stream, line))
+    {
+        auto values = std::istringstream (line);
+        auto key    = std::string { };
+        values >> key;
+
+        if (key == "map")           values >> map;
+        else if (key == "seed")     values >> test.seed;
+        else if (key == "start")    values >> test.start.x >> test.start.y;
+        else if (key == "end")      values >> test.end.x >> test.end.y;
+    }
+
+    if (map.empty())
+    {
+        throw std::runtime_error ("DifferentialTester::replay(), the case doesn't name a map. \"" + file + "\".");
+    }
+
+    // Maps are written next to their case.
+    const auto slash = file.find_last_of ("/\\");
+    const auto data  = LevelData ((slash == std::string::npos ? std::string() : file.substr (0, slash + 1)) + map);
+
+    test.width  = data.getWidth();
+    test.height = data.getHeight();
+    test.tiles.resize (data.getTileCount());
+
+    for (auto y = 0U; y < test.height; ++y)
+    {
+        data.decodeRow (y, test.tiles.data() + y * test.width);
+    }
+
+    if (test.start.x < 0 || test.start.y < 0 || test.start.x >= (int) test.width || test.start.y >= (int) test.height ||
+        test.end.x < 0 || test.end.y < 0 || test.end.x >= (int) test.width || test.end.y >= (int) test.height)
+    {
+        throw std::runtime_error ("DifferentialTester::replay(), the query lies outside of the map. \"" + file + "\".");
+    }
+
+    auto failures = 0U;
+
+    for (auto check = 0U; check < (unsigned int) Check::Count; ++check)
+    {
+        const auto failure = runCheck ((Check) check, test);
+
+        if (!failure.empty())
+        {
+            ++failures;
+            log << "failed " << getCheckName ((Check) check) << ": " << failure << std::endl;
+        }
+    }
+
+    return failures;
+}
+
+
+const char* DifferentialTester::getCheckName (const Check check)
+{
+    switch (check)
+    {
+        case Check::Nearest:    return "nearest";
+        case Check::Branch:     return "branch";
+        case Check::Storage:    return "storage";
+        case Check::Masks:      return "masks";
+        case Check::Regions:    return "regions";
+        case Check::Shared:     return "shared";
+        default:                return "unknown";
+    }
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+DifferentialTester::Case DifferentialTester::generateCase()
+{
+    auto pickSize = std::uniform_int_distribution<unsigned int> (m_minimum, m_maximum);
+
+    auto test   = Case { };
+    test.width  = pickSize (m_random);
+    test.height = pickSize (m_random);
+    test.seed   = (unsigned int) m_random() | 1;
+    test.tiles.assign (test.width * test.height, TileType::Terrain);
+
+    // Rectangles of one type make walls, forests and lakes, scattered tiles make the fine detail that breaks runs up.
+    const auto types   = std::vector<TileType> { TileType::OutOfBounds, TileType::Tree, TileType::Swamp, TileType::Water };
+    const auto density = std::uniform_real_distribution<float> (0.f, 0.5f) (m_random);
+    const auto area    = test.width * test.height;
+
+    const auto features = (unsigned int) (area * density / 16.f) + 1,
+               scatter  = (unsigned int) (area * density / 4.f);
+
+    for (auto i = 0U; i < features; ++i)
+    {
+        const auto type   = types[m_random() % types.size()];
+        const auto width  = (unsigned int) m_random() % std::max (1U, test.width / 3) + 1,
+                   height = (unsigned int) m_random() % std::max (1U, test.height / 3) + 1,
+                   left   = (unsigned int) m_random() % test.width,
+                   top    = (unsigned int) m_random() % test.height;
+
+        for (auto y = top; y < std::min (top + height, test.height); ++y)
+        {
+            std::fill_n (test.tiles.begin() + y * test.width + left, std::min (width, test.width - left), type);
+        }
+    }
+
+    for (auto i = 0U; i < scatter; ++i)
+    {
+        test.tiles[m_random() % area] = types[m_random() % types.size()];
+    }
+
+    // Starting on land is the common case but the planner has to cope with anything.
+    const auto pickPosition = [&] ()
+    {
+        return sf::Vector2i ((int) (m_random() % test.width), (int) (m_random() % test.height));
+    };
+
+    test.start = pickPosition();
+    test.end   = pickPosition();
+
+    for (auto attempt = 0U; attempt < 100U && !LevelData::isTraversable (test.tiles[test.start.x + test.start.y * test.width], MovementClass::Land); ++attempt)
+    {
+        test.start = pickPosition();
+    }
+
+    return test;
+}
+
+
+std::string DifferentialTester::runCheck (const Check check, const Case& test)
+{
+    try
+    {
+        switch (check)
+        {
+            case Check::Nearest:    return checkNearest (test);
+            case Check::Branch:     return checkBranch (test);
+            case Check::Storage:    return checkStorage (test);
+            case Check::Masks:      return checkMasks (test);
+            case Check::Regions:    return checkRegions (test);
+            case Check::Shared:     return checkShared (test);
+            default:                return "unknown check";
+        }
+    }
+
+    catch (const std::exception& error)
+    {
+        return std::string ("an exception was thrown: ") + error.what();
+    }
+}
+
+
+std::string DifferentialTester::checkNearest (const Case& test)
+{
+    const auto data = std::make_shared<LevelData> (test.width, test.height, test.tiles);
+
+    // Forests and node budgets both change the node index behind the back of the tree so exercise them too.
+    auto rrt = RRT();
+    rrt.setSeed (test.seed);
+
+    if (test.seed & 2)
+    {
+        rrt.setForest (4);
+    }
+
+    if (test.seed & 4)
+    {
+        rrt.setNodeBudget (48);
+    }
+
+    rrt.prepareTree (data, test.start, test.end);
+
+    for (auto i = 0U; i < 400 && !rrt.hasFinished(); ++i)
+    {
+        rrt.generateBranch();
+    }
+
+    // The reference walks every tree rather than trusting the node index.
+    auto positions = std::vector<sf::Vector2i> { };
+
+    for (const auto root : rrt.getRoots())
+    {
+        for (const auto branch : root->depthFirst())
+        {
+            positions.push_back (branch->getData().position);
+        }
+    }
+
+    const auto distance = [] (const sf::Vector2i& a, const sf::Vector2i& b) { return std::abs (a.x - b.x) + std::abs (a.y - b.y); };
+
+    // Probe every node plus random positions in the window, ties may be broken differently so only distances are compared.
+    const auto& window = rrt.getWindow();
+    auto        random = std::mt19937 (test.seed);
+    auto        probes = positions;
+
+    for (auto i = 0U; i < 256U; ++i)
+    {
+        probes.emplace_back (window.left + (int) (random() % window.width), window.top + (int) (random() % window.height));
+    }
+
+    for (const auto& probe : probes)
+    {
+        auto expected = std::numeric_limits<int>::max();
+
+        for (const auto& position : positions)
+        {
+            expected = std::min (expected, distance (probe, position));
+        }
+
+        const auto found  = rrt.determineNearest (probe)->getData().position;
+        const auto actual = distance (probe, found);
+
+        if (actual != expected || std::find (positions.cbegin(), positions.cend(), found) == positions.cend())
+        {
+            std::ostringstream failure;
+            failure << "the nearest node to (" << probe.x << ", " << probe.y << ") is " << expected << " tiles away but determineNearest() found ("
+                    << found.x << ", " << found.y << ") " << actual << " tiles away out of " << positions.size() << " nodes";
+
+            return failure.str();
+        }
+    }
+
+    return { };
+}
+
+
+std::string DifferentialTester::checkBranch (const Case& test)
+{
+    // Branch from the start to the end and to random points around the start, the offsets keep their meaning when cropped.
+    auto random  = std::mt19937 (test.seed);
+    auto targets = std::vector<sf::Vector2i> { test.end };
+
+    for (auto i = 0U; i < 64U; ++i)
+    {
+        const auto target = test.start + sf::Vector2i ((int) (random() % 41) - 20, (int) (random() % 41) - 20);
+
+        if (target.x >= 0 && target.y >= 0 && target.x < (int) test.width && target.y < (int) test.height)
+        {
+            targets.push_back (target);
+        }
+    }
+
+    // Where each branch ends for each storage method, (-1, -1) when no branch could be grown.
+    auto ends = std::vector<std::vector<sf::Vector2i>> { };
+
+    for (const auto storage : { TileStorage::Raw, TileStorage::Packed, TileStorage::RunLength })
+    {
+        const auto data = std::make_shared<LevelData> (test.width, test.height, test.tiles, storage);
+
+        auto rrt = RRT();
+        rrt.setSeed (test.seed);
+        rrt.prepareTree (data, test.start, test.end);
+
+        ends.emplace_back();
+
+        for (const auto& target : targets)
+        {
+            const auto branch = rrt.calculateBranch (test.start, target);
+            ends.back().push_back (branch ? branch->getData().position : sf::Vector2i (-1, -1));
+
+            // Targets within reach of a single branch can be compared with a line check which samples the same points.
+            const auto difference = sf::Vector2f (target - test.start);
+            const auto reachable  = std::sqrt (difference.x * difference.x + difference.y * difference.y) <= rrt.getBranchDistance();
+
+            if (reachable && target != test.start && rrt.isClear (test.start, target) != (branch && branch->getData().position == target))
+            {
+                std::ostringstream failure;
+                failure << "calculateBranch() and isClear() disagree on (" << test.start.x << ", " << test.start.y << ") to ("
+                        << target.x << ", " << target.y << ") with storage " << (int) storage;
+
+                return failure.str();
+            }
+
+            if (branch)
+            {
+                rrt.m_pool->destroy (branch);
+            }
+        }
+    }
+
+    for (auto storage = 1U; storage < ends.size(); ++storage)
+    {
+        for (auto i = 0U; i < targets.size(); ++i)
+        {
+            if (ends[storage][i] != ends[0][i])
+            {
+                std::ostringstream failure;
+                failure << "the branch from (" << test.start.x << ", " << test.start.y << ") to (" << targets[i].x << ", " << targets[i].y
+                        << ") ends at (" << ends[0][i].x << ", " << ends[0][i].y << ") with raw tiles but (" << ends[storage][i].x << ", "
+                        << ends[storage][i].y << ") with storage " << storage;
+
+                return failure.str();
+            }
+        }
+    }
+
+    return { };
+}
+
+
+std::string DifferentialTester::checkStorage (const Case& test)
+{
+    const auto width  = test.width,
+               height = test.height;
+
+    // The reference line is Bresenham's algorithm reading straight from the tiles of the case.
+    const auto line = [&] (const sf::Vector2i& start, const sf::Vector2i& end)
+    {
+        const auto deltaX = std::abs (end.x - start.x),
+                   deltaY = std::abs (end.y - start.y),
+                   stepX  = start.x < end.x ? 1 : -1,
+                   stepY  = start.y < end.y ? 1 : -1;
+
+        auto tiles = std::vector<TileType> { };
+        auto point = start;
+        auto error = deltaX - deltaY;
+
+        for (auto i = 0; i <= std::max (deltaX, deltaY); ++i)
+        {
+            tiles.push_back (test.tiles[point.x + point.y * width]);
+
+            const auto doubled = error * 2;
+
+            if (doubled > -deltaY)
+            {
+                error   -= deltaY;
+                point.x += stepX;
+            }
+
+            if (doubled < deltaX)
+            {
+                error   += deltaX;
+                point.y += stepY;
+            }
+        }
+
+        return tiles;
+    };
+
+    // The block between both ends of the query.
+    const auto left   = (unsigned int) std::min (test.start.x, test.end.x),
+               top    = (unsigned int) std::min (test.start.y, test.end.y),
+               across = (unsigned int) std::abs (test.end.x - test.start.x) + 1,
+               down   = (unsigned int) std::abs (test.end.y - test.start.y) + 1;
+
+    const auto reference = line (test.start, test.end);
+
+    for (const auto storage : { TileStorage::Raw, TileStorage::Packed, TileStorage::RunLength })
+    {
+        auto       data = LevelData (width, height, test.tiles, storage);
+        const auto name = " with storage " + std::to_string ((int) storage);
+
+        // Row by row hits the row cache of run-length levels, column by column misses it.
+        for (auto y = 0U; y < height; ++y)
+        {
+            for (auto x = 0U; x < width; ++x)
+            {
+                if (data.getTile (x, y) != test.tiles[x + y * width] || data.getTile (x + y * width) != test.tiles[x + y * width])
+                {
+                    return "getTile() differs at (" + std::to_string (x) + ", " + std::to_string (y) + ")" + name;
+                }
+            }
+        }
+
+        for (auto x = 0U; x < width; ++x)
+        {
+            for (auto y = 0U; y < height; ++y)
+            {
+                if (data.getTile (x, y) != test.tiles[x + y * width])
+                {
+                    return "getTile() differs by column at (" + std::to_string (x) + ", " + std::to_string (y) + ")" + name;
+                }
+            }
+        }
+
+        auto row = std::vector<TileType> (width);
+
+        for (auto y = 0U; y < height; ++y)
+        {
+            data.decodeRow (y, row.data());
+
+            if (!std::equal (row.cbegin(), row.cend(), test.tiles.cbegin() + y * width))
+            {
+                return "decodeRow() differs on row " + std::to_string (y) + name;
+            }
+        }
+
+        auto block = std::vector<TileType> (across * down);
+        data.getBlock (left, top, across, down, block.data());
+
+        for (auto y = 0U; y < down; ++y)
+        {
+            if (!std::equal (block.cbegin() + y * across, block.cbegin() + (y + 1) * across, test.tiles.cbegin() + left + (top + y) * width))
+            {
+                return "getBlock() differs on row " + std::to_string (top + y) + name;
+            }
+        }
+
+        auto segment = std::vector<TileType> (reference.size());
+        const auto count = data.getSegment (test.start.x, test.start.y, test.end.x, test.end.y, segment.data(), (unsigned int) segment.size());
+
+        if (count != reference.size() || segment != reference)
+        {
+            return "getSegment() differs from the reference line" + name;
+        }
+
+        // Converting between every storage method must keep the same tiles.
+        const auto hash = LevelData (width, height, test.tiles).calculateContentHash();
+
+        for (const auto converted : { TileStorage::RunLength, TileStorage::Packed, TileStorage::Raw })
+        {
+            data.setStorage (converted);
+
+            if (data.calculateContentHash() != hash)
+            {
+                return "converting to storage " + std::to_string ((int) converted) + " changed the tiles" + name;
+            }
+        }
+    }
+
+    return { };
+}
+
+
+std::string DifferentialTester::checkMasks (const Case& test)
+{
+    // Without a pool the masks are built in one strip, with one they're built in parallel strips.
+    const auto pool = std::make_shared<ThreadPool> (3);
+
+    for (const auto& strips : { std::shared_ptr<ThreadPool>(), pool })
+    {
+        const auto data = LevelData (test.width, test.height, test.tiles, (TileStorage) (test.seed % 3), strips);
+
+        for (auto y = 0U; y < test.height; ++y)
+        {
+            for (auto movement = 0U; movement < 3; ++movement)
+            {
+                const auto mask = data.getMaskRow (y, (MovementClass) movement);
+
+                for (auto x = 0U; x < test.width; ++x)
+                {
+                    const auto expected = LevelData::isTraversable (test.tiles[x + y * test.width], (MovementClass) movement);
+                    const auto actual   = ((mask[x / 32] >> (x % 32)) & 1) != 0;
+
+                    if (expected != actual)
+                    {
+                        return "the mask of movement class " + std::to_string (movement) + " differs at (" + std::to_string (x) + ", " +
+                               std::to_string (y) + ")" + (strips ? " when built in strips" : "");
+                    }
+                }
+            }
+        }
+    }
+
+    return { };
+}
+
+
+std::string DifferentialTester::checkRegions (const Case& test)
+{
+    const auto pool  = std::make_shared<ThreadPool> (3);
+    const auto tiles = test.width * test.height;
+
+    for (auto movement = 0U; movement < 3; ++movement)
+    {
+        // The reference flood fills each region, movement is allowed diagonally just like the planner.
+        auto labels = std::vector<unsigned int> (tiles, 0);
+        auto count  = 0U;
+        auto queue  = std::deque<unsigned int> { };
+
+        for (auto first = 0U; first < tiles; ++first)
+        {
+            if (labels[first] != 0 || !LevelData::isTraversable (test.tiles[first], (MovementClass) movement))
+            {
+                continue;
+            }
+
+            labels[first] = ++count;
+            queue.push_back (first);
+
+            while (!queue.empty())
+            {
+                const auto tile = queue.front();
+                const auto x    = (int) (tile % test.width),
+                           y    = (int) (tile / test.width);
+
+                queue.pop_front();
+
+                for (auto offsetY = -1; offsetY <= 1; ++offsetY)
+                {
+                    for (auto offsetX = -1; offsetX <= 1; ++offsetX)
+                    {
+                        const auto nextX = x + offsetX,
+                                   nextY = y + offsetY;
+
+                        if (nextX >= 0 && nextY >= 0 && nextX < (int) test.width && nextY < (int) test.height)
+                        {
+                            const auto next = (unsigned int) (nextX + nextY * test.width);
+
+                            if (labels[next] == 0 && LevelData::isTraversable (test.tiles[next], (MovementClass) movement))
+                            {
+                                labels[next] = count;
+                                queue.push_back (next);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        for (const auto& strips : { std::shared_ptr<ThreadPool>(), pool })
+        {
+            const auto data   = LevelData (test.width, test.height, test.tiles, TileStorage::Raw, strips);
+            const auto suffix = " for movement class " + std::to_string (movement) + (strips ? " when built in strips" : "");
+
+            if (data.getRegionCount ((MovementClass) movement) != count)
+            {
+                return "there are " + std::to_string (data.getRegionCount ((MovementClass) movement)) + " regions instead of " +
+                       std::to_string (count) + suffix;
+            }
+
+            // Labels may be numbered differently so check both labellings map onto each other one to one.
+            auto forward  = std::vector<unsigned int> (count + 1, 0),
+                 backward = std::vector<unsigned int> (count + 1, 0);
+
+            for (auto tile = 0U; tile < tiles; ++tile)
+            {
+                const auto expected = labels[tile],
+                           actual   = data.getRegion (tile, (MovementClass) movement);
+
+                if ((expected == 0) != (actual == 0) || actual > count)
+                {
+                    return "tile " + std::to_string (tile) + " has region " + std::to_string (actual) + " instead of " + std::to_string (expected) + suffix;
+                }
+
+                if (expected != 0)
+                {
+                    if ((forward[expected] != 0 && forward[expected] != actual) || (backward[actual] != 0 && backward[actual] != expected))
+                    {
+                        return "tile " + std::to_string (tile) + " joins regions which the flood fill keeps apart, or splits one" + suffix;
+                    }
+
+                    forward[expected] = actual;
+                    backward[actual]  = expected;
+                }
+            }
+        }
+    }
+
+    return { };
+}
+
+
+std::string DifferentialTester::checkShared (const Case& test)
+{
+    const auto data = LevelData (test.width, test.height, test.tiles, (TileStorage) (test.seed % 3));
+
+    // Several testers may run at once so the name needs to be unique.
+    const auto name    = "gec_differential_" + std::to_string (test.seed) + "_" +
+                         std::to_string (std::chrono::steady_clock::now().time_since_epoch().count());
+    const auto segment = data.publish (name);
+
+    return compareLevels (data, LevelData (std::make_shared<const SharedMemory> (name)));
+}
+
+
+DifferentialTester::Case DifferentialTester::minimise (const Check check, const Case& test) const
+{
+    auto best     = test;
+    auto attempts = 0U;
+
+    const auto fails = [&] (const Case& candidate)
+    {
+        return attempts++ < m_minimiseBudget && !runCheck (check, candidate).empty();
+    };
+
+    // Removes the given number of columns or rows from one side, the query is pulled back onto the map if it falls off.
+    const auto crop = [] (const Case& from, const unsigned int side, const unsigned int amount, Case& to)
+    {
+        const auto horizontal = side < 2;
+        const auto offset     = sf::Vector2i (side == 0 ? amount : 0, side == 2 ? amount : 0);
+
+        to        = from;
+        to.width  = from.width - (horizontal ? amount : 0);
+        to.height = from.height - (horizontal ? 0 : amount);
+
+        const auto clamp = [&] (const sf::Vector2i& point)
+        {
+            return sf::Vector2i (std::min (std::max (point.x - offset.x, 0), (int) to.width - 1), 
+                                 std::min (std::max (point.y - offset.y, 0), (int) to.height - 1));
+        };
+
+        to.start = clamp (from.start);
+        to.end   = clamp (from.end);
+        to.tiles.resize (to.width * to.height);
+
+        for (auto y = 0U; y < to.height; ++y)
+        {
+            std::copy_n (from.tiles.cbegin() + (y + offset.y) * from.width + offset.x, to.width, to.tiles.begin() + y * to.width);
+        }
+    };
+
+    // Cropping first makes every later attempt cheaper.
+    auto candidate = Case { };
+
+    for (auto shrunk = true; shrunk && attempts < m_minimiseBudget;)
+    {
+        shrunk = false;
+
+        for (auto side = 0U; side < 4; ++side)
+        {
+            for (auto amount = (side < 2 ? best.width : best.height) / 2; amount > 0; amount /= 2)
+            {
+                crop (best, side, amount, candidate);
+
+                if (fails (candidate))
+                {
+                    best   = std::move (candidate);
+                    shrunk = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Then clear ever smaller runs of tiles to plain terrain so only the tiles which matter remain.
+    for (auto run = std::max (1U, (unsigned int) best.tiles.size() / 2); run > 0 && attempts < m_minimiseBudget; run /= 2)
+    {
+        for (auto first = 0U; first < best.tiles.size(); first += run)
+        {
+            const auto last = std::min (first + run, (unsigned int) best.tiles.size());
+
+            if (std::any_of (best.tiles.cbegin() + first, best.tiles.cbegin() + last, [] (const TileType tile) { return tile != TileType::Terrain; }))
+            {
+                candidate = best;
+                std::fill (candidate.tiles.begin() + first, candidate.tiles.begin() + last, TileType::Terrain);
+
+                if (fails (candidate))
+                {
+                    best = std::move (candidate);
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+
+void DifferentialTester::writeCase (const std::string& file, const Check check, const std::string& failure, const Case& test)
+{
+    const auto mapFile = file + ".map";
+    auto       map     = std::ofstream (mapFile, std::ios::binary);
+    auto       info    = std::ofstream (file + ".case");
+
+    if (!map || !info)
+    {
+        throw std::invalid_argument ("DifferentialTester::writeCase(), file location given is invalid. \"" + file + "\".");
+    }
+
+    // Same header as the maps the demo loads.
+    map << "type octile\nheight " << test.height << "\nwidth " << test.width << "\nmap\n";
+
+    for (auto y = 0U; y < test.height; ++y)
+    {
+        for (auto x = 0U; x < test.width; ++x)
+        {
+            map.put (getTileCharacter (test.tiles[x + y * test.width]));
+        }
+
+        map.put ('\n');
+    }
+
+    const auto slash = mapFile.find_last_of ("/\\");
+
+    info    << "check " << getCheckName (check) << std::endl
+            << "failure " << failure << std::endl
+            << "map " << (slash == std::string::npos ? mapFile : mapFile.substr (slash + 1)) << std::endl
+            << "seed " << test.seed << std::endl
+            << "start " << test.start.x << " " << test.start.y << std::endl
+            << "end " << test.end.x << " " << test.end.y << std::endl;
+
+    if (!map || !info)
+    {
+        throw std::runtime_error ("DifferentialTester::writeCase(), an error occurred whilst writing. \"" + file + "\".");
+    }
+}
+
+
+std::string DifferentialTester::compareLevels (const LevelData& expected, const LevelData& actual)
+{
+    if (expected.getWidth() != actual.getWidth() || expected.getHeight() != actual.getHeight())
+    {
+        return "the dimensions differ";
+    }
+
+    const auto width = expected.getWidth();
+    auto       rowA  = std::vector<TileType> (width),
+               rowB  = std::vector<TileType> (width);
+
+    for (auto y = 0U; y < expected.getHeight(); ++y)
+    {
+        expected.decodeRow (y, rowA.data());
+        actual.decodeRow (y, rowB.data());
+
+        if (rowA != rowB)
+        {
+            return "the tiles differ on row " + std::to_string (y);
+        }
+
+        for (auto movement = 0U; movement < 3; ++movement)
+        {
+            const auto maskA = expected.getMaskRow (y, (MovementClass) movement),
+                       maskB = actual.getMaskRow (y, (MovementClass) movement);
+
+            if (!std::equal (maskA, maskA + expected.getMaskStride(), maskB))
+            {
+                return "the masks of movement class " + std::to_string (movement) + " differ on row " + std::to_string (y);
+            }
+        }
+    }
+
+    for (auto movement = 0U; movement < 3; ++movement)
+    {
+        if (expected.getRegionCount ((MovementClass) movement) != actual.getRegionCount ((MovementClass) movement))
+        {
+            return "the region counts of movement class " + std::to_string (movement) + " differ";
+        }
+
+        for (auto tile = 0U; tile < expected.getTileCount(); ++tile)
+        {
+            if (expected.getRegion (tile, (MovementClass) movement) != actual.getRegion (tile, (MovementClass) movement))
+            {
+                return "the regions of movement class " + std::to_string (movement) + " differ at tile " + std::to_string (tile);
+            }
+        }
+    }
+
+    return { };
+}
+
+
+char DifferentialTester::getTileCharacter (const TileType tile)
+{
+    switch (tile)
+    {
+        case TileType::OutOfBounds: return '@';
+        case TileType::Tree:        return 'T';
+        case TileType::Swamp:       return 'S';
+        case TileType::Water:       return 'W';
+        default:                    return '.';
+    }
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#ifndef GEC_DIFFERENTIAL_TESTER_HPP
+#define GEC_DIFFERENTIAL_TESTER_HPP
+
+
+// STL headers.
+#include <iosfwd>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// External headers.
+#include <SFML/System/Vector2.hpp>
+
+
+// Forward declarations.
+class LevelData;
+enum class TileType : char;
+
+
+/// <summary>
+/// Compares every optimised part of the planner against a simple reference on the same randomised maps and queries.
+/// Nearest neighbour searches through the node index are compared against a walk of every tree, branches grown by the
+/// float stepper are compared against line checks and against each other for every storage method, compressed and
+/// shared tiles are compared against raw tiles, and the masks and regions built in parallel strips are compared
+/// against a flood fill. Any case which disagrees is shrunk to the smallest map which still disagrees and written
+/// out so it can be replayed.
+/// </summary>
+class DifferentialTester final
+{
+    public:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> Each part of the planner which can be checked. </summary>
+        enum class Check : char
+        {
+            Nearest,        //!< RRT::determineNearest() against every node of every tree.
+            Branch,         //!< RRT::calculateBranch() against RRT::isClear() and across storage methods.
+            Storage,        //!< Packed and RunLength tile access against raw tiles.
+            Masks,          //!< Traversability masks against the tiles they were built from.
+            Regions,        //!< Region labels against a flood fill.
+            Shared,         //!< A level attached from shared memory against the level which published it.
+            Count           //!< The number of checks.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a tester, the same seed always generates the same cases. </summary>
+        DifferentialTester (const unsigned int seed = 0U);
+
+        DifferentialTester (DifferentialTester&& move)                  = default;
+        DifferentialTester& operator= (DifferentialTester&& move)       = default;
+        DifferentialTester (const DifferentialTester& copy)             = default;
+        DifferentialTester& operator= (const DifferentialTester& copy)  = default;
+        ~DifferentialTester()                                           = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Sets the range of map sizes to generate, larger maps are needed to exercise the parallel strips. </summary>
+        void setSizes (const unsigned int minimum, const unsigned int maximum);
+
+        /// <summary> Sets how many times a failing case may be checked whilst it's being minimised. </summary>
+        void setMinimiseBudget (const unsigned int attempts)    { m_minimiseBudget = attempts; }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Runs every check on randomly generated cases, minimising and writing out any which fail. </summary>
+        /// <param name="cases"> The number of cases to generate. </param>
+        /// <param name="directory"> Where to write the repro of each failure, an empty string doesn't write them. </param>
+        /// <param name="log"> Progress and failures are written here. </param>
+        /// <returns> The number of failures. </returns>
+        unsigned int run (const unsigned int cases, const std::string& directory, std::ostream& log);
+
+        /// <summary> Runs every check on a repro which was written out by run(). Throws an exception if it can't be loaded. </summary>
+        /// <param name="file"> The case file, the map is expected next to it with the same name. </param>
+        /// <param name="log"> Failures are written here. </param>
+        /// <returns> The number of failures. </returns>
+        unsigned int replay (const std::string& file, std::ostream& log) const;
+
+        /// <summary> Gets the name of a check as used in repro files. </summary>
+        static const char* getCheckName (const Check check);
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> A map along with the query and seed that every check uses. </summary>
+        struct Case final
+        {
+            unsigned int            width   { 0 };  //!< The tile width of the map.
+            unsigned int            height  { 0 };  //!< The tile height of the map.
+            std::vector<TileType>   tiles   { };    //!< Every tile of the map, row by row.
+            sf::Vector2i            start   { };    //!< The start of the query.
+            sf::Vector2i            end     { };    //!< The end of the query.
+            unsigned int            seed    { 1 };  //!< The seed used to grow trees.
+        };
+
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Generates a random map with random features along with a query on it. </summary>
+        Case generateCase();
+
+        /// <summary> Runs a check on a case. </summary>
+        /// <returns> A description of the first disagreement, empty if everything agreed. </returns>
+        static std::string runCheck (const Check check, const Case& test);
+
+        /// <summary> Compares the nearest node found through the node index with the nearest node of every tree. </summary>
+        static std::string checkNearest (const Case& test);
+
+        /// <summary> Compares a branch from the start towards the end with a line check, and across every storage method. </summary>
+        static std::string checkBranch (const Case& test);
+
+        /// <summary> Compares every way of reading tiles from compressed storage with the raw tiles. </summary>
+        static std::string checkStorage (const Case& test);
+
+        /// <summary> Compares every bit of the masks, built in strips, with the traversability of each tile. </summary>
+        static std::string checkMasks (const Case& test);
+
+        /// <summary> Compares the region labels, built in strips and merged, with a flood fill of each movement class. </summary>
+        static std::string checkRegions (const Case& test);
+
+        /// <summary> Compares a level attached from shared memory with the level which published it. </summary>
+        static std::string checkShared (const Case& test);
+
+        /// <summary> Shrinks a failing case by cropping the map and clearing tiles for as long as it keeps failing. </summary>
+        /// <param name="check"> The check which failed. </param>
+        /// <param name="test"> The failing case. </param>
+        /// <returns> The smallest failing case found within the minimise budget. </returns>
+        Case minimise (const Check check, const Case& test) const;
+
+        /// <summary> Writes a case as a map and a case file which replay() can load. Throws an exception if writing fails. </summary>
+        static void writeCase (const std::string& file, const Check check, const std::string& failure, const Case& test);
+
+        /// <summary> Compares two levels tile by tile, including their masks and regions. </summary>
+        /// <returns> A description of the first difference, empty if they're identical. </returns>
+        static std::string compareLevels (const LevelData& expected, const LevelData& actual);
+
+        /// <summary> Gets the character used to write a tile to a map file. </summary>
+        static char getTileCharacter (const TileType tile);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::mt19937    m_random            { };        //!< Generates every case.
+        unsigned int    m_minimum           { 4 };      //!< The smallest width and height to generate.
+        unsigned int    m_maximum           { 160 };    //!< The largest width and height to generate.
+        unsigned int    m_minimiseBudget    { 2000 };   //!< The number of checks allowed whilst minimising a case.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,354 @@
+#include "JsonValue.hpp"
+
+
+// STL headers.
+#include <cstdlib>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+
+
+
+/////////////
+// Getters //
+/////////////
+
+bool JsonValue::getBoolean() const
+{
+    if (m_type != Type::Boolean)
+    {
+        throw std::runtime_error ("JsonValue::getBoolean(), the value isn't a boolean.");
+    }
+
+    return m_boolean;
+}
+
+
+double JsonValue::getNumber() const
+{
+    if (m_type != Type::Number)
+    {
+        throw std::runtime_error ("JsonValue::getNumber(), the value isn't a number.");
+    }
+
+    return m_number;
+}
+
+
+const std::string& JsonValue::getString() const
+{
+    if (m_type != Type::String)
+    {
+        throw std::runtime_error ("JsonValue::getString(), the value isn't a string.");
+    }
+
+    return m_string;
+}
+
+
+const std::vector<JsonValue>& JsonValue::getElements() const
+{
+    if (m_type != Type::Array)
+    {
+        throw std::runtime_error ("JsonValue::getElements(), the value isn't an array.");
+    }
+
+    return m_elements;
+}
+
+
+bool JsonValue::hasMember (const std::string& name) const
+{
+    if (m_type == Type::Object)
+    {
+        for (const auto& member : m_names)
+        {
+            if (member == name)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+const JsonValue& JsonValue::getMember (const std::string& name) const
+{
+    if (m_type != Type::Object)
+    {
+        throw std::runtime_error ("JsonValue::getMember(), the value isn't an object. \"" + name + "\".");
+    }
+
+    for (auto i = 0U; i < m_names.size(); ++i)
+    {
+        if (m_names[i] == name)
+        {
+            return m_elements[i];
+        }
+    }
+
+    throw std::runtime_error ("JsonValue::getMember(), the object doesn't have the member. \"" + name + "\".");
+}
+
+
+/////////////
+// Parsing //
+/////////////
+
+JsonValue JsonValue::parse (const std::string& text)
+{
+    auto position = size_t (0);
+    auto value    = parseValue (text, position, 0);
+
+    skipWhitespace (text, position);
+
+    if (position != text.size())
+    {
+        fail ("the end of the document", position);
+    }
+
+    return value;
+}
+
+
+void JsonValue::writeString (std::ostream& stream, const std::string& string)
+{
+    const char* const hex = "0123456789abcdef";
+
+    stream << '"';
+
+    for (const auto character : string)
+    {
+        switch (character)
+        {
+            case '"':   stream << "\\\""; break;
+            case '\\':  stream << "\\\\"; break;
+            case '\n':  stream << "\\n";  break;
+            case '\r':  stream << "\\r";  break;
+            case '\t':  stream << "\\t";  break;
+
+            default:
+                // Every other control character must be escaped, anything else including UTF-8 is written as it is.
+                if ((unsigned char) character < 0x20)
+                {
+                    stream << "\\u00" << hex[character >> 4] << hex[character & 15];
+                }
+
+                else
+                {
+                    stream << character;
+                }
+        }
+    }
+
+    stream << '"';
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+JsonValue JsonValue::parseValue (const std::string& text, size_t& position, const unsigned int depth)
+{
+    // Malicious nesting would otherwise overflow the stack.
+    const auto maximumDepth = 256U;
+
+    if (depth > maximumDepth)
+    {
+        fail ("less nesting", position);
+    }
+
+    skipWhitespace (text, position);
+
+    if (position >= text.size())
+    {
+        fail ("a value", position);
+    }
+
+    auto       value     = JsonValue { };
+    const auto character = text[position];
+
+    const auto matches = [&] (const char* const word)
+    {
+        return text.compare (position, std::strlen (word), word) == 0;
+    };
+
+    if (character == '{' || character == '[')
+    {
+        const auto object = character == '{';
+        const auto close  = object ? '}' : ']';
+
+        value.m_type = object ? Type::Object : Type::Array;
+        skipWhitespace (text, ++position);
+
+        if (position < text.size() && text[position] == close)
+        {
+            ++position;
+            return value;
+        }
+
+        while (true)
+        {
+            if (object)
+            {
+                skipWhitespace (text, position);
+                value.m_names.push_back (parseString (text, position));
+                skipWhitespace (text, position);
+
+                if (position >= text.size() || text[position] != ':')
+                {
+                    fail ("':'", position);
+                }
+
+                ++position;
+            }
+
+            value.m_elements.push_back (parseValue (text, position, depth + 1));
+            skipWhitespace (text, position);
+
+            if (position < text.size() && text[position] == ',')
+            {
+                ++position;
+            }
+
+            else if (position < text.size() && text[position] == close)
+            {
+                ++position;
+                return value;
+            }
+
+            else
+            {
+                fail (object ? "',' or '}'" : "',' or ']'", position);
+            }
+        }
+    }
+
+    if (character == '"')
+    {
+        value.m_type   = Type::String;
+        value.m_string = parseString (text, position);
+    }
+
+    else if (matches ("true") || matches ("false"))
+    {
+        value.m_type    = Type::Boolean;
+        value.m_boolean = character == 't';
+        position       += value.m_boolean ? 4 : 5;
+    }
+
+    else if (matches ("null"))
+    {
+        position += 4;
+    }
+
+    else
+    {
+        // Find the extent of the number ourselves so strtod() can't accept anything JSON doesn't, such as "inf".
+        const auto first = position;
+
+        while (position < text.size() && std::strchr ("+-0123456789.eE", text[position]) && text[position] != '\0')
+        {
+            ++position;
+        }
+
+        const auto number = text.substr (first, position - first);
+        char*      end    = nullptr;
+
+        value.m_type   = Type::Number;
+        value.m_number = std::strtod (number.c_str(), &end);
+
+        if (number.empty() || end != number.c_str() + number.size())
+        {
+            fail ("a value", first);
+        }
+    }
+
+    return value;
+}
+
+
+std::string JsonValue::parseString (const std::string& text, size_t& position)
+{
+    if (position >= text.size() || text[position] != '"')
+    {
+        fail ("'\"'", position);
+    }
+
+    auto string = std::string { };
+
+    for (++position; position < text.size(); ++position)
+    {
+        const auto character = text[position];
+
+        if (character == '"')
+        {
+            ++position;
+            return string;
+        }
+
+        if (character != '\\')
+        {
+            string.push_back (character);
+            continue;
+        }
+
+        if (++position >= text.size())
+        {
+            break;
+        }
+
+        switch (text[position])
+        {
+            case '"':   string.push_back ('"');  break;
+            case '\\':  string.push_back ('\\'); break;
+            case '/':   string.push_back ('/');  break;
+            case 'b':   string.push_back ('\b'); break;
+            case 'f':   string.push_back ('\f'); break;
+            case 'n':   string.push_back ('\n'); break;
+            case 'r':   string.push_back ('\r'); break;
+            case 't':   string.push_back ('\t'); break;
+
+            case 'u':
+            {
+                // Only ASCII is needed, which is all writeString() produces.
+                const auto digits = text.substr (position + 1, 4);
+                char*      end    = nullptr;
+                const auto code   = std::strtoul (digits.c_str(), &end, 16);
+
+                if (digits.size() != 4 || end != digits.c_str() + 4 || code > 0x7F)
+                {
+                    fail ("an ASCII \"\\u\" escape", position);
+                }
+
+                string.push_back ((char) code);
+                position += 4;
+                break;
+            }
+
+            default:
+                fail ("an escape character", position);
+        }
+    }
+
+    fail ("'\"'", position);
+    return string;
+}
+
+
+void JsonValue::skipWhitespace (const std::string& text, size_t& position)
+{
+    while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' || text[position] == '\r'))
+    {
+        ++position;
+    }
+}
+
+
+void JsonValue::fail (const std::string& expected, const size_t position)
+{
+    throw std::runtime_error ("JsonValue::parse(), expected " + expected + " at character " + std::to_string (position) + ".");
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#ifndef GEC_JSON_VALUE_HPP
+#define GEC_JSON_VALUE_HPP
+
+
+// STL headers.
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+
+/// <summary>
+/// A parsed JSON document. This only covers what the tools need to read back their own output: every value type is
+/// supported but numbers are always doubles and "\u" escapes outside of ASCII are rejected rather than converted.
+/// </summary>
+class JsonValue final
+{
+    public:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> The type of each JSON value. </summary>
+        enum class Type : char
+        {
+            Null,       //!< null.
+            Boolean,    //!< true or false.
+            Number,     //!< Any number.
+            String,     //!< A string.
+            Array,      //!< An ordered list of values.
+            Object      //!< Named values.
+        };
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        JsonValue()                                     = default;
+        JsonValue (JsonValue&& move)                    = default;
+        JsonValue& operator= (JsonValue&& move)         = default;
+        JsonValue (const JsonValue& copy)               = default;
+        JsonValue& operator= (const JsonValue& copy)    = default;
+        ~JsonValue()                                    = default;
+
+
+        /////////////
+        // Getters //
+        /////////////
+
+        /// <summary> Gets the type of the value. </summary>
+        Type getType() const                            { return m_type; }
+
+        /// <summary> Gets a boolean. Throws an exception if the value is another type. </summary>
+        bool getBoolean() const;
+
+        /// <summary> Gets a number. Throws an exception if the value is another type. </summary>
+        double getNumber() const;
+
+        /// <summary> Gets a string. Throws an exception if the value is another type. </summary>
+        const std::string& getString() const;
+
+        /// <summary> Gets the elements of an array. Throws an exception if the value is another type. </summary>
+        const std::vector<JsonValue>& getElements() const;
+
+        /// <summary> Checks whether an object has a member with the given name. </summary>
+        bool hasMember (const std::string& name) const;
+
+        /// <summary> Gets a member of an object. Throws an exception if the value isn't an object or lacks the member. </summary>
+        const JsonValue& getMember (const std::string& name) const;
+
+
+        /////////////
+        // Parsing //
+        /////////////
+
+        /// <summary> Parses a complete document. Throws an exception describing where the text is malformed. </summary>
+        static JsonValue parse (const std::string& text);
+
+        /// <summary> Writes a string with quotes and every character escaped as JSON requires. </summary>
+        static void writeString (std::ostream& stream, const std::string& string);
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Parses the value starting at the given position, leaving the position after it. </summary>
+        static JsonValue parseValue (const std::string& text, size_t& position, const unsigned int depth);
+
+        /// <summary> Parses a quoted string starting at the given position, leaving the position after the closing quote. </summary>
+        static std::string parseString (const std::string& text, size_t& position);
+
+        /// <summary> Moves the position past any whitespace. </summary>
+        static void skipWhitespace (const std::string& text, size_t& position);
+
+        /// <summary> Throws an exception describing what was expected at the given position. </summary>
+        static void fail (const std::string& expected, const size_t position);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        Type                        m_type      { Type::Null }; //!< The type of the value.
+        bool                        m_boolean   { false };      //!< The value of a boolean.
+        double                      m_number    { 0.0 };        //!< The value of a number.
+        std::string                 m_string    { };            //!< The value of a string.
+        std::vector<std::string>    m_names     { };            //!< The name of each member of an object.
+        std::vector<JsonValue>      m_elements  { };            //!< The elements of an array or the values of each member of an object.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,211 @@
+#include "MapCorpus.hpp"
+
+
+// STL headers.
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+
+
+//////////////////
+// Constructors //
+//////////////////
+
+MapCorpus::MapCorpus (const unsigned int seed)
+    : m_seed (seed)
+{
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+void MapCorpus::setSizes (const unsigned int minimum, const unsigned int maximum)
+{
+    if (minimum == 0 || minimum > maximum)
+    {
+        throw std::invalid_argument ("MapCorpus::setSizes(), the minimum size must be non-zero and no larger than the maximum.");
+    }
+
+    m_minimum = minimum;
+    m_maximum = maximum;
+}
+
+
+void MapCorpus::setDensities (const std::vector<float>& densities)
+{
+    for (const auto density : densities)
+    {
+        if (density < 0.f || density > 1.f)
+        {
+            throw std::invalid_argument ("MapCorpus::setDensities(), densities must be between zero and one.");
+        }
+    }
+
+    m_densities = densities;
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+std::string MapCorpus::generate (const std::string& directory) const
+{
+    // The manifest lets the benchmark find every map without needing to search the directory.
+    const auto manifestFile = directory + "/corpus.txt";
+    auto       manifest     = std::ofstream (manifestFile);
+
+    if (!manifest)
+    {
+        throw std::invalid_argument ("MapCorpus::generate(), unable to write to the directory given. \"" + directory + "\".");
+    }
+
+    for (auto size = m_minimum; size <= m_maximum && size != 0; size *= 2)
+    {
+        for (const auto density : m_densities)
+        {
+            const auto name = std::to_string (size) + "_" + std::to_string ((int) std::round (density * 100.f)) + ".map";
+
+            generateMap (directory + "/" + name, size, density);
+            manifest << "map " << name << std::endl;
+        }
+    }
+
+    // Malformed maps are listed separately because they're expected to fail.
+    for (const auto& file : generateMalformed (directory))
+    {
+        manifest << "malformed " << file.substr (directory.size() + 1) << std::endl;
+    }
+
+    return manifestFile;
+}
+
+
+void MapCorpus::generateMap (const std::string& file, const unsigned int size, const float density) const
+{
+    auto stream = std::ofstream (file, std::ios::binary);
+
+    if (!stream)
+    {
+        throw std::invalid_argument ("MapCorpus::generateMap(), file location given is invalid. \"" + file + "\".");
+    }
+
+    // Same header as the maps the demo loads.
+    stream << "type octile\nheight " << size << "\nwidth " << size << "\nmap\n";
+
+    // Write a row at a time so memory usage doesn't depend on the size of the map.
+    auto row = std::string (size + 1, '\n');
+
+    for (auto y = 0U; y < size; ++y)
+    {
+        for (auto x = 0U; x < size; ++x)
+        {
+            row[x] = determineTile (x, y, density);
+        }
+
+        stream.write (row.data(), row.size());
+    }
+
+    if (!stream)
+    {
+        throw std::runtime_error ("MapCorpus::generateMap(), an error occurred whilst writing. \"" + file + "\".");
+    }
+}
+
+
+std::vector<std::string> MapCorpus::generateMalformed (const std::string& directory) const
+{
+    // Each case is a name and the contents of the file.
+    const std::pair<std::string, std::string> cases[] =
+    {
+        { "empty",          "" },
+        { "no_height",      "type octile\nwidth 4\nmap\n....\n....\n....\n....\n" },
+        { "zero_width",     "type octile\nheight 4\nwidth 0\nmap\n" },
+        { "negative_size",  "type octile\nheight -4\nwidth -4\nmap\n" },
+        { "huge_size",      "type octile\nheight 4294967295\nwidth 4294967295\nmap\n....\n" },
+        { "too_few_tiles",  "type octile\nheight 4\nwidth 4\nmap\n....\n....\n....\n...\n" },
+        { "too_many_tiles", "type octile\nheight 4\nwidth 4\nmap\n....\n....\n....\n.....\n" },
+        { "invalid_tile",   "type octile\nheight 4\nwidth 4\nmap\n....\n.X..\n....\n....\n" },
+        { "binary",         std::string ("type octile\nheight 2\nwidth 2\nmap\n") + std::string ("\0\xff\n\x80\x01\n", 6) }
+    };
+
+    auto files = std::vector<std::string> { };
+
+    for (const auto& malformed : cases)
+    {
+        const auto file = directory + "/malformed_" + malformed.first + ".map";
+        auto stream     = std::ofstream (file, std::ios::binary);
+
+        if (!stream.write (malformed.second.data(), malformed.second.size()))
+        {
+            throw std::runtime_error ("MapCorpus::generateMalformed(), unable to write. \"" + file + "\".");
+        }
+
+        files.push_back (file);
+    }
+
+    return files;
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+float MapCorpus::noise (const unsigned int x, const unsigned int y, const unsigned int cell, const unsigned int salt) const
+{
+    // Pre-condition: Cells contain at least one tile.
+    assert (cell > 0);
+
+    // Bilinearly interpolate between the hashed corners of the cell, smoothstep hides the grid.
+    const auto cellX = x / cell,
+               cellY = y / cell;
+
+    const auto smooth = [] (const float t) { return t * t * (3.f - 2.f * t); };
+    const auto tx     = smooth ((x % cell) / (float) cell),
+               ty     = smooth ((y % cell) / (float) cell);
+
+    const auto top    = hash (cellX, cellY, salt)     * (1.f - tx) + hash (cellX + 1, cellY, salt)     * tx,
+               bottom = hash (cellX, cellY + 1, salt) * (1.f - tx) + hash (cellX + 1, cellY + 1, salt) * tx;
+
+    return top * (1.f - ty) + bottom * ty;
+}
+
+
+float MapCorpus::hash (const unsigned int x, const unsigned int y, const unsigned int salt) const
+{
+    // A cheap integer hash, good enough to make noise from.
+    auto value = x * 0x8da6b343U ^ y * 0xd8163841U ^ (salt + m_seed) * 0xcb1ab31fU;
+
+    value ^= value >> 16;
+    value *= 0x7feb352dU;
+    value ^= value >> 15;
+    value *= 0x846ca68bU;
+    value ^= value >> 16;
+
+    return (value & 0xFFFFFF) / (float) 0xFFFFFF;
+}
+
+
+char MapCorpus::determineTile (const unsigned int x, const unsigned int y, const float density) const
+{
+    // Large features with a little fine detail make maps look like the hand-made ones, with walls, forests and lakes.
+    const auto shape = noise (x, y, 64, 0) * 0.7f + noise (x, y, 8, 1) * 0.3f;
+
+    // Noise clusters around the middle so stretch it out before comparing it against the density.
+    const auto value = std::fmin (std::fmax ((shape - 0.5f) * 2.2f + 0.5f, 0.f), 1.f);
+
+    if (value < density)
+    {
+        // Pick the type of obstacle from a separate layer so each feature is mostly one type.
+        const auto kind = noise (x, y, 128, 2);
+        return kind < 0.35f ? '@' : kind < 0.7f ? 'T' : 'W';
+    }
+
+    // Swamps are passable so they're scattered about regardless of the density.
+    return noise (x, y, 16, 3) > 0.8f ? 'S' : '.';
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#ifndef GEC_MAP_CORPUS_HPP
+#define GEC_MAP_CORPUS_HPP
+
+
+// STL headers.
+#include <string>
+#include <vector>
+
+
+/// <summary>
+/// Generates a corpus of .map files for benchmarking and fuzzing LevelData and the RRT algorithm. Maps are written in
+/// the same format as the maps the demo loads, their sizes double from the minimum to the maximum and each size is
+/// generated at every obstacle density. Tiles are produced one row at a time so even huge maps use very little memory.
+/// </summary>
+class MapCorpus final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a corpus generator, the same seed always produces the same maps. </summary>
+        /// <param name="seed"> The seed used for the noise which shapes each map. </param>
+        MapCorpus (const unsigned int seed = 0U);
+
+        MapCorpus (MapCorpus&& move)                    = default;
+        MapCorpus& operator= (MapCorpus&& move)         = default;
+        MapCorpus (const MapCorpus& copy)               = default;
+        MapCorpus& operator= (const MapCorpus& copy)    = default;
+        ~MapCorpus()                                    = default;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Sets the range of map sizes to generate, each map is square and sizes double from the minimum. </summary>
+        /// <param name="minimum"> The width and height of the smallest map. </param>
+        /// <param name="maximum"> The largest width and height allowed. </param>
+        void setSizes (const unsigned int minimum, const unsigned int maximum);
+
+        /// <summary> Sets the obstacle densities to generate each map size at. </summary>
+        /// <param name="densities"> The fraction of tiles which should be impassable, each between zero and one. </param>
+        void setDensities (const std::vector<float>& densities);
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> 
+        /// Generates every map in the corpus along with a manifest named "corpus.txt" which lists each map, smallest
+        /// first. A set of malformed maps is also written to test that loading fails gracefully.
+        /// </summary>
+        /// <param name="directory"> An existing directory to write the corpus to. </param>
+        /// <returns> The location of the manifest. </returns>
+        std::string generate (const std::string& directory) const;
+
+        /// <summary> Generates a single map. Throws an exception if the file can't be written. </summary>
+        /// <param name="file"> The location to write the map to. </param>
+        /// <param name="size"> The width and height of the map. </param>
+        /// <param name="density"> The fraction of tiles which should be impassable. </param>
+        void generateMap (const std::string& file, const unsigned int size, const float density) const;
+
+        /// <summary> Writes maps with broken headers, invalid tiles and the wrong number of tiles. </summary>
+        /// <param name="directory"> An existing directory to write the malformed maps to. </param>
+        /// <returns> The location of each map that was written. </returns>
+        std::vector<std::string> generateMalformed (const std::string& directory) const;
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Calculates smooth value noise at the given position. </summary>
+        /// <param name="x"> The X co-ordinate of the tile. </param>
+        /// <param name="y"> The Y co-ordinate of the tile. </param>
+        /// <param name="cell"> The size of each noise cell in tiles, larger cells produce larger features. </param>
+        /// <param name="salt"> Differentiates separate layers of noise. </param>
+        /// <returns> A value between zero and one. </returns>
+        float noise (const unsigned int x, const unsigned int y, const unsigned int cell, const unsigned int salt) const;
+
+        /// <summary> Hashes a lattice point to a value between zero and one. </summary>
+        float hash (const unsigned int x, const unsigned int y, const unsigned int salt) const;
+
+        /// <summary> Determines the character of the tile at the given position. </summary>
+        /// <param name="x"> The X co-ordinate of the tile. </param>
+        /// <param name="y"> The Y co-ordinate of the tile. </param>
+        /// <param name="density"> The fraction of tiles which should be impassable. </param>
+        char determineTile (const unsigned int x, const unsigned int y, const float density) const;
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        unsigned int        m_seed      { 0 };                      //!< The seed used for the noise.
+        unsigned int        m_minimum   { 32 };                     //!< The width and height of the smallest map.
+        unsigned int        m_maximum   { 32768 };                  //!< The largest width and height of a map.
+        std::vector<float>  m_densities { 0.1f, 0.25f, 0.4f };      //!< The obstacle densities to generate.
+};
+
+#endif
\ No newline at end of file
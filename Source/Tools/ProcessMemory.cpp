@@ -0,0 +1,85 @@
+#include "ProcessMemory.hpp"
+
+
+// STL headers.
+#include <fstream>
+#include <string>
+
+
+// Platform headers.
+#if defined (_WIN32)
+    #define NOMINMAX
+    #include <Windows.h>
+    #include <Psapi.h>
+#endif
+
+
+
+/////////////
+// Queries //
+/////////////
+
+#if defined (_WIN32)
+
+size_t ProcessMemory::getResidentBytes()
+{
+    auto counters = PROCESS_MEMORY_COUNTERS { };
+    return GetProcessMemoryInfo (GetCurrentProcess(), &counters, sizeof (counters)) ? counters.WorkingSetSize : 0;
+}
+
+
+size_t ProcessMemory::getPeakBytes()
+{
+    auto counters = PROCESS_MEMORY_COUNTERS { };
+    return GetProcessMemoryInfo (GetCurrentProcess(), &counters, sizeof (counters)) ? counters.PeakWorkingSetSize : 0;
+}
+
+
+void ProcessMemory::resetPeak()
+{
+    // Windows doesn't allow the peak working set to be reset.
+}
+
+#else
+
+size_t ProcessMemory::getResidentBytes()
+{
+    return readStatus ("VmRSS:");
+}
+
+
+size_t ProcessMemory::getPeakBytes()
+{
+    return readStatus ("VmHWM:");
+}
+
+
+void ProcessMemory::resetPeak()
+{
+    // Writing 5 to clear_refs resets the peak resident set size.
+    auto stream = std::ofstream ("/proc/self/clear_refs");
+    stream << "5";
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+size_t ProcessMemory::readStatus (const std::string& field)
+{
+    auto stream = std::ifstream ("/proc/self/status");
+    auto line   = std::string { };
+
+    while (std::getline (stream, line))
+    {
+        if (line.compare (0, field.size(), field) == 0)
+        {
+            return std::stoull (line.substr (field.size())) * 1024;
+        }
+    }
+
+    return 0;
+}
+
+#endif
\ No newline at end of file
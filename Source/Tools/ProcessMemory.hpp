@@ -0,0 +1,45 @@
+#ifndef GEC_PROCESS_MEMORY_HPP
+#define GEC_PROCESS_MEMORY_HPP
+
+
+// STL headers.
+#include <cstddef>
+#include <string>
+
+
+/// <summary>
+/// Queries the operating system for how much physical memory the current process is using.
+/// </summary>
+class ProcessMemory final
+{
+    public:
+
+        ProcessMemory() = delete;
+
+
+        /////////////
+        // Queries //
+        /////////////
+
+        /// <summary> Gets the number of bytes currently resident in physical memory, zero if unavailable. </summary>
+        static size_t getResidentBytes();
+
+        /// <summary> Gets the largest number of bytes which have been resident at once, zero if unavailable. </summary>
+        static size_t getPeakBytes();
+
+        /// <summary> Resets the peak so each benchmark can measure its own. This only has an effect on Linux. </summary>
+        static void resetPeak();
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Reads a value in kilobytes from /proc/self/status on Linux. </summary>
+        /// <param name="field"> The name of the field including the colon, e.g. "VmRSS:". </param>
+        /// <returns> The value in bytes, zero if the field doesn't exist. </returns>
+        static size_t readStatus (const std::string& field);
+};
+
+#endif
\ No newline at end of file
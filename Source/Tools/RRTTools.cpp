@@ -0,0 +1,929 @@
+#include "RRTTools.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+
+// Application headers.
+#include <Level/LevelData.hpp>
+#include <Level/TileHeatmap.hpp>
+#include <RRT/CoarseToFine.hpp>
+#include <RRT/PartitionedRRT.hpp>
+#include <RRT/PlanScheduler.hpp>
+#include <RRT/PlanTrace.hpp>
+#include <RRT/RRT.hpp>
+#include <RRT/RRTTuning.hpp>
+#include <Tools/AutoTuner.hpp>
+#include <Tools/Benchmark.hpp>
+#include <Tools/BenchmarkComparator.hpp>
+#include <Tools/DifferentialTester.hpp>
+#include <Tools/MapCorpus.hpp>
+#include <Utility/HugePages.hpp>
+#include <Utility/MetricsServer.hpp>
+#include <Utility/SharedMemory.hpp>
+#include <Utility/ThreadPool.hpp>
+
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+int RRTTools::run (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    // The remaining arguments belong to the tool.
+    const auto& tool       = arguments.front();
+    const auto  parameters = std::vector<std::string> (arguments.cbegin() + 1, arguments.cend());
+
+    try
+    {
+        if (tool == "corpus")
+        {
+            return runCorpus (parameters);
+        }
+
+        if (tool == "benchmark")
+        {
+            return runBenchmark (parameters);
+        }
+
+        if (tool == "compare")
+        {
+            return runCompare (parameters);
+        }
+
+        if (tool == "tune")
+        {
+            return runTune (parameters);
+        }
+
+        if (tool == "share")
+        {
+            return runShare (parameters);
+        }
+
+        if (tool == "attach")
+        {
+            return runAttach (parameters);
+        }
+
+        if (tool == "diff")
+        {
+            return runDiff (parameters);
+        }
+
+        if (tool == "replay")
+        {
+            return runReplay (parameters);
+        }
+
+        if (tool == "serve")
+        {
+            return runServe (parameters);
+        }
+
+        if (tool == "heatmap")
+        {
+            return runHeatmap (parameters);
+        }
+
+        if (tool == "trace")
+        {
+            return runTrace (parameters);
+        }
+
+        if (tool == "retrace")
+        {
+            return runRetrace (parameters);
+        }
+
+        if (tool == "multiplex")
+        {
+            return runMultiplex (parameters);
+        }
+
+        if (tool == "planners")
+        {
+            return runPlanners (parameters);
+        }
+
+        printUsage();
+        return 1;
+    }
+
+    catch (const std::exception& error)
+    {
+        std::cerr << "An error was caught whilst running \"" << tool << "\": " << error.what() << std::endl;
+        return 2;
+    }
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+void RRTTools::printUsage() const
+{
+    std::cout   << "Usage: RRTTools <tool> [arguments]" << std::endl
+                << "  corpus <directory> [minimum size = 32] [maximum size = 32768] [seed = 0]" << std::endl
+                << "  benchmark <manifest> [queries = 8] [seconds per query = 0.5] [csv file or -] [pages = standard|huge|both] [json file]" << std::endl
+                << "  compare <baseline json[,json...]> <candidate json[,json...]> [threshold = 0.05] [significance = 0.05]" << std::endl
+                << "  tune <map> [tuning file = " << RRTTuning::defaultFile << "] [queries = 8] [seconds per query = 0.25] [query file]" << std::endl
+                << "  share <map> <name> [storage = raw|packed|runlength]" << std::endl
+                << "  attach <name>" << std::endl
+                << "  diff [cases = 200] [repro directory or - = .] [seed = 0] [maximum size = 160]" << std::endl
+                << "  replay <case file>" << std::endl
+                << "  serve <map> [port = " << MetricsServer::defaultPort << "] [seconds or 0 = forever] [seconds per query = 0.5]" << std::endl
+                << "  heatmap <map> [queries = 8] [seconds per query = 0.5] [output prefix = heatmap] [cell shift = 0]" << std::endl
+                << "  trace <map> [queries = 8] [seconds per query = 0.5] [trace file = plan.trace]" << std::endl
+                << "  retrace <trace file> <map> [storage = raw|packed|runlength|all] [pages = standard|huge|both]" << std::endl
+                << "  multiplex <map> [plans = 1000] [tick milliseconds = 4] [slice iterations = 64] [iteration limit = 20000]" << std::endl
+                << "  planners <map> [queries = 8] [iteration limit = 200000] [pyramid levels = 0]" << std::endl;
+}
+
+
+int RRTTools::runCorpus (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    auto corpus = MapCorpus (arguments.size() > 3 ? std::stoul (arguments[3]) : 0U);
+
+    corpus.setSizes (arguments.size() > 1 ? std::stoul (arguments[1]) : 32U, 
+                     arguments.size() > 2 ? std::stoul (arguments[2]) : 32768U);
+
+    const auto manifest = corpus.generate (arguments[0]);
+    std::cout << "Corpus written, manifest: " << manifest << std::endl;
+
+    return 0;
+}
+
+
+int RRTTools::runBenchmark (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    auto benchmark = Benchmark (arguments.size() > 1 ? std::stoul (arguments[1]) : 8U,
+                                arguments.size() > 2 ? std::stod (arguments[2]) : 0.5);
+
+    // Huge pages are compared against the normal heap by running each map under both policies.
+    const auto pages = arguments.size() > 4 ? arguments[4] : std::string ("standard");
+
+    if (pages == "huge")
+    {
+        benchmark.setPagePolicies ({ PagePolicy::Huge });
+    }
+
+    else if (pages == "both")
+    {
+        benchmark.setPagePolicies ({ PagePolicy::Standard, PagePolicy::Huge });
+    }
+
+    else if (pages != "standard")
+    {
+        throw std::invalid_argument ("RRTTools::runBenchmark(), unknown page policy. \"" + pages + "\".");
+    }
+
+    const auto results = benchmark.runManifest (arguments[0], std::cout);
+    Benchmark::writeReport (std::cout, results);
+
+    if (arguments.size() > 3 && arguments[3] != "-")
+    {
+        auto csv = std::ofstream (arguments[3]);
+
+        if (!csv)
+        {
+            throw std::invalid_argument ("RRTTools::runBenchmark(), unable to write the csv file. \"" + arguments[3] + "\".");
+        }
+
+        Benchmark::writeCsv (csv, results);
+    }
+
+    // JSON keeps every sample so the run can be compared against later runs, the trees don't depend on the map.
+    if (arguments.size() > 5)
+    {
+        auto run        = BenchmarkRun { };
+        run.environment = Benchmark::describeEnvironment();
+        run.series      = benchmark.runTree (1U << 16);
+
+        for (const auto& result : results)
+        {
+            run.series.insert (run.series.end(), result.series.cbegin(), result.series.cend());
+        }
+
+        auto json = std::ofstream (arguments[5]);
+
+        if (!json)
+        {
+            throw std::invalid_argument ("RRTTools::runBenchmark(), unable to write the json file. \"" + arguments[5] + "\".");
+        }
+
+        Benchmark::writeJson (json, run);
+    }
+
+    return 0;
+}
+
+
+int RRTTools::runCompare (const std::vector<std::string>& arguments)
+{
+    if (arguments.size() < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    // Samples taken back to back miss the drift between runs, so several runs can be pooled on each side, e.g. "a.json,b.json".
+    const auto load = [] (const std::string& files)
+    {
+        auto run   = BenchmarkRun { };
+        auto first = size_t (0);
+
+        while (first <= files.size())
+        {
+            const auto comma = std::min (files.find (',', first), files.size());
+            auto       next  = Benchmark::readJson (files.substr (first, comma - first));
+
+            run.environment = run.series.empty() ? next.environment : run.environment;
+            run.series.insert (run.series.end(), next.series.cbegin(), next.series.cend());
+            first = comma + 1;
+        }
+
+        return run;
+    };
+
+    const auto baseline  = load (arguments[0]),
+               candidate = load (arguments[1]);
+
+    const auto comparator  = BenchmarkComparator (arguments.size() > 2 ? std::stod (arguments[2]) : 0.05,
+                                                  arguments.size() > 3 ? std::stod (arguments[3]) : 0.05);
+    const auto comparisons = comparator.compare (baseline, candidate);
+
+    BenchmarkComparator::writeReport (std::cout, baseline, candidate, comparisons);
+
+    // Scripts can fail a build on a regression.
+    for (const auto& comparison : comparisons)
+    {
+        if (comparison.verdict == BenchmarkComparison::Verdict::Regressed)
+        {
+            return 3;
+        }
+    }
+
+    return 0;
+}
+
+
+int RRTTools::runTune (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto data = std::make_shared<LevelData> (arguments[0]);
+    const auto file = arguments.size() > 1 ? arguments[1] : std::string (RRTTuning::defaultFile);
+
+    auto tuner = AutoTuner (arguments.size() > 2 ? std::stoul (arguments[2]) : 8U,
+                            arguments.size() > 3 ? std::stod (arguments[3]) : 0.25);
+
+    if (arguments.size() > 4)
+    {
+        tuner.loadQueries (arguments[4]);
+    }
+
+    // Keep the maps which have already been tuned.
+    auto tuning = RRTTuning { };
+
+    if (std::ifstream (file))
+    {
+        tuning.loadFromFile (file);
+    }
+
+    const auto hash = data->calculateContentHash();
+    tuning.set (hash, tuner.tune (data, std::cout));
+    tuning.saveToFile (file);
+
+    std::cout << "Tuning for " << std::hex << hash << std::dec << " written to " << file << std::endl;
+
+    return 0;
+}
+
+
+int RRTTools::runShare (const std::vector<std::string>& arguments)
+{
+    if (arguments.size() < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto method  = arguments.size() > 2 ? arguments[2] : std::string ("raw");
+    auto       storage = TileStorage::Raw;
+
+    if (method == "packed")
+    {
+        storage = TileStorage::Packed;
+    }
+
+    else if (method == "runlength")
+    {
+        storage = TileStorage::RunLength;
+    }
+
+    else if (method != "raw")
+    {
+        throw std::invalid_argument ("RRTTools::runShare(), unknown storage method. \"" + method + "\".");
+    }
+
+    const auto data    = LevelData (arguments[0], storage);
+    const auto segment = data.publish (arguments[1]);
+
+    std::cout   << "Published " << data.getWidth() << "x" << data.getHeight() << " as \"" << segment->getName() << "\" using " 
+                << segment->getBytes() << " bytes, press enter to stop sharing." << std::endl;
+
+    // The segment is removed once we return, processes which have attached keep their copy.
+    std::cin.get();
+
+    return 0;
+}
+
+
+int RRTTools::runAttach (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    using Clock = std::chrono::high_resolution_clock;
+
+    const auto start   = Clock::now();
+    const auto segment = std::make_shared<const SharedMemory> (arguments[0]);
+    const auto data    = LevelData (segment);
+    const auto elapsed = std::chrono::duration<double> (Clock::now() - start).count();
+
+    std::cout   << "Attached to " << data.getWidth() << "x" << data.getHeight() << " from \"" << data.getFileLocation() << "\" in " 
+                << elapsed * 1000.0 << " ms, " << data.getRegionCount (MovementClass::Land) << " land regions, " 
+                << data.getRegionCount (MovementClass::Water) << " water regions, " << data.getStorageBytes() << " private bytes." << std::endl;
+
+    return 0;
+}
+
+
+int RRTTools::runDiff (const std::vector<std::string>& arguments)
+{
+    auto tester = DifferentialTester (arguments.size() > 2 ? std::stoul (arguments[2]) : 0U);
+
+    if (arguments.size() > 3)
+    {
+        tester.setSizes (4U, std::stoul (arguments[3]));
+    }
+
+    const auto cases     = arguments.size() > 0 ? std::stoul (arguments[0]) : 200U;
+    const auto directory = arguments.size() > 1 ? (arguments[1] == "-" ? std::string() : arguments[1]) : std::string (".");
+
+    // Failures get their own exit code so scripts can tell them apart from errors.
+    return tester.run (cases, directory, std::cout) == 0 ? 0 : 3;
+}
+
+
+int RRTTools::runReplay (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto failures = DifferentialTester().replay (arguments[0], std::cout);
+    std::cout << (failures == 0 ? "Every check passed." : std::to_string (failures) + " checks failed.") << std::endl;
+
+    return failures == 0 ? 0 : 3;
+}
+
+
+int RRTTools::runServe (const std::vector<std::string>& arguments)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto data         = std::make_shared<LevelData> (arguments[0]);
+    const auto seconds      = arguments.size() > 2 ? std::stod (arguments[2]) : 0.0;
+    const auto querySeconds = arguments.size() > 3 ? std::stod (arguments[3]) : 0.5;
+
+    auto rrt = RRT { };
+
+    rrt.setTuning (RRTTuning::loadDefault());
+
+    const MetricsServer server { arguments.size() > 1 ? (unsigned short) std::stoul (arguments[1]) : MetricsServer::defaultPort };
+    std::cout << "Serving metrics at http://localhost:" << server.getPort() << "/metrics" << std::endl;
+
+    // Plan between random reachable points until the time runs out, giving each query a fresh seed.
+    auto random = std::mt19937 (std::random_device()());
+
+    const auto serveStart = Clock::now();
+
+    while (seconds <= 0.0 || std::chrono::duration<double> (Clock::now() - serveStart).count() < seconds)
+    {
+        planRandomQuery (rrt, data, random, querySeconds);
+    }
+
+    std::cout << "Served the metrics " << server.getScrapeCount() << " times." << std::endl;
+
+    return 0;
+}
+
+
+int RRTTools::runHeatmap (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto data         = std::make_shared<LevelData> (arguments[0]);
+    const auto queries      = arguments.size() > 1 ? std::stoul (arguments[1]) : 8UL;
+    const auto querySeconds = arguments.size() > 2 ? std::stod (arguments[2]) : 0.5;
+    const auto prefix       = arguments.size() > 3 ? arguments[3] : std::string ("heatmap");
+    const auto cellShift    = arguments.size() > 4 ? (unsigned int) std::stoul (arguments[4]) : 0U;
+
+    if (cellShift >= 16)
+    {
+        throw std::invalid_argument ("RRTTools::runHeatmap(), the cell shift must be below 16. \"" + arguments[4] + "\".");
+    }
+
+    const auto heatmap = std::make_shared<TileHeatmap> (data->getWidth(), data->getHeight(), cellShift);
+    auto       rrt     = RRT { };
+
+    rrt.setTuning (RRTTuning::loadDefault());
+
+    rrt.setHeatmap (heatmap);
+
+    // Random points often land in unreachable regions, give up eventually rather than spinning on an island map.
+    auto random  = std::mt19937 (std::random_device()());
+    auto planned = 0UL;
+
+    for (auto attempts = 0UL; planned < queries && attempts < queries * 100; ++attempts)
+    {
+        planned += planRandomQuery (rrt, data, random, querySeconds) ? 1 : 0;
+    }
+
+    std::cout << "Planned " << planned << " queries on " << arguments[0] << "." << std::endl;
+
+    const auto counters = (unsigned int) HeatmapCounter::Count;
+
+    auto csv = std::ofstream (prefix + ".csv");
+
+    if (!csv)
+    {
+        throw std::runtime_error ("RRTTools::runHeatmap(), unable to open the CSV file. \"" + prefix + ".csv\".");
+    }
+
+    heatmap->writeCsv (csv);
+
+    for (auto counter = 0U; counter < counters; ++counter)
+    {
+        const auto file = prefix + "_" + TileHeatmap::getName ((HeatmapCounter) counter) + ".png";
+
+        if (!heatmap->createImage ((HeatmapCounter) counter).saveToFile (file))
+        {
+            throw std::runtime_error ("RRTTools::runHeatmap(), unable to save the image. \"" + file + "\".");
+        }
+    }
+
+    // Knowing which kind of tile the effort lands on shows whether it's being wasted, such as sampling out of bounds.
+    const TileType    types[]   = { TileType::Terrain, TileType::OutOfBounds, TileType::Tree, TileType::Swamp, TileType::Water };
+    const char* const names[]   = { "terrain", "out of bounds", "tree", "swamp", "water" };
+    const auto        typeCount = sizeof (types) / sizeof (types[0]);
+
+    for (auto counter = 0U; counter < counters; ++counter)
+    {
+        const auto total = heatmap->getTotal ((HeatmapCounter) counter);
+
+        std::cout << TileHeatmap::getName ((HeatmapCounter) counter) << ": " << total;
+
+        // Cells larger than a tile mix tile types together.
+        if (cellShift == 0 && total > 0)
+        {
+            std::uint64_t byType[typeCount] = { };
+
+            for (auto y = 0U; y < data->getHeight(); ++y)
+            {
+                for (auto x = 0U; x < data->getWidth(); ++x)
+                {
+                    const auto type = data->getTile (x, y);
+
+                    for (auto i = 0U; i < typeCount; ++i)
+                    {
+                        byType[i] += types[i] == type ? heatmap->getCount ((HeatmapCounter) counter, x, y) : 0;
+                    }
+                }
+            }
+
+            for (auto i = 0U; i < typeCount; ++i)
+            {
+                std::cout << (i == 0 ? " (" : ", ") << names[i] << " " << (100.0 * byType[i] / total) << "%";
+            }
+
+            std::cout << ")";
+        }
+
+        std::cout << std::endl;
+    }
+
+    std::cout << "Written " << prefix << ".csv and an image per counter." << std::endl;
+
+    return 0;
+}
+
+
+int RRTTools::runTrace (const std::vector<std::string>& arguments)
+{
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto data         = std::make_shared<LevelData> (arguments[0]);
+    const auto queries      = arguments.size() > 1 ? std::stoul (arguments[1]) : 8UL;
+    const auto querySeconds = arguments.size() > 2 ? std::stod (arguments[2]) : 0.5;
+    const auto file         = arguments.size() > 3 ? arguments[3] : std::string ("plan.trace");
+
+    auto rrt = RRT { };
+
+    rrt.setTuning (RRTTuning::loadDefault());
+
+    // The trace is destroyed before reporting so everything has been written by then.
+    auto records = 0ULL,
+         stalls  = 0ULL;
+
+    {
+        const auto trace = std::make_shared<PlanTrace> (file, *data);
+        rrt.setTrace (trace);
+
+        auto random  = std::mt19937 (std::random_device()());
+        auto planned = 0UL;
+
+        for (auto attempts = 0UL; planned < queries && attempts < queries * 100; ++attempts)
+        {
+            planned += planRandomQuery (rrt, data, random, querySeconds) ? 1 : 0;
+        }
+
+        rrt.setTrace (nullptr);
+        records = trace->getRecordCount();
+        stalls  = trace->getStallCount();
+    }
+
+    std::cout   << "Traced " << records << " records to " << file << ", recording waited for the writer " << stalls 
+                << " times." << std::endl;
+
+    return 0;
+}
+
+
+int RRTTools::runRetrace (const std::vector<std::string>& arguments)
+{
+    if (arguments.size() < 2)
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto trace   = PlanTrace::load (arguments[0]);
+    const auto method  = arguments.size() > 2 ? arguments[2] : std::string ("raw");
+    const auto pages   = arguments.size() > 3 ? arguments[3] : std::string ("standard");
+    auto       methods = std::vector<TileStorage> { };
+    auto       pagings = std::vector<PagePolicy> { };
+
+    if (method == "raw" || method == "all")
+    {
+        methods.push_back (TileStorage::Raw);
+    }
+
+    if (method == "packed" || method == "all")
+    {
+        methods.push_back (TileStorage::Packed);
+    }
+
+    if (method == "runlength" || method == "all")
+    {
+        methods.push_back (TileStorage::RunLength);
+    }
+
+    if (methods.empty())
+    {
+        throw std::invalid_argument ("RRTTools::runRetrace(), unknown storage method. \"" + method + "\".");
+    }
+
+    if (pages == "standard" || pages == "both")
+    {
+        pagings.push_back (PagePolicy::Standard);
+    }
+
+    if (pages == "huge" || pages == "both")
+    {
+        pagings.push_back (PagePolicy::Huge);
+    }
+
+    if (pagings.empty())
+    {
+        throw std::invalid_argument ("RRTTools::runRetrace(), unknown page policy. \"" + pages + "\".");
+    }
+
+    const char* const storageNames[] = { "raw", "packed", "runlength" };
+    const char* const policyNames[]  = { "standard", "huge" };
+    const auto        previous       = HugePages::getPolicy();
+
+    std::cout << "Replaying " << trace.records.size() << " records of " << arguments[0] << "." << std::endl;
+
+    const auto tuning = RRTTuning::loadDefault();
+
+    for (const auto storage : methods)
+    {
+        const auto data = std::make_shared<LevelData> (arguments[1], storage);
+
+        for (const auto policy : pagings)
+        {
+            // The node index takes its pages when the tree is prepared so a fresh planner is needed for each policy.
+            HugePages::setPolicy (policy);
+
+            auto rrt = RRT { };
+            rrt.setTuning (tuning);
+
+            const auto replay = PlanTrace::replay (trace, rrt, data);
+
+            std::cout   << storageNames[(size_t) storage] << "/" << policyNames[(size_t) policy] << ": " << replay.queries 
+                        << " queries, " << replay.iterations << " iterations in " << replay.replayedSeconds << "s against " 
+                        << replay.recordedSeconds << "s recorded (" << replay.replayedSeconds / std::max (replay.recordedSeconds, 1e-9) 
+                        << "x), " << replay.replayed[(size_t) BranchResult::Extended] << " extended";
+
+            // A different result means the planner isn't doing the recorded work, such as when the tuning has changed.
+            if (replay.mismatches > 0)
+            {
+                std::cout << ", " << replay.mismatches << " samples behaved differently";
+            }
+
+            std::cout << "." << std::endl;
+        }
+    }
+
+    HugePages::setPolicy (previous);
+
+    return 0;
+}
+
+
+int RRTTools::runMultiplex (const std::vector<std::string>& arguments)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto data            = std::make_shared<LevelData> (arguments[0]);
+    const auto plans           = arguments.size() > 1 ? std::stoul (arguments[1]) : 1000UL;
+    const auto tickSeconds     = arguments.size() > 2 ? std::stod (arguments[2]) / 1000.0 : 0.004;
+    const auto sliceIterations = arguments.size() > 3 ? (unsigned int) std::stoul (arguments[3]) : 64U;
+    const auto iterationLimit  = arguments.size() > 4 ? (unsigned int) std::stoul (arguments[4]) : 20000U;
+
+    if (sliceIterations == 0)
+    {
+        throw std::invalid_argument ("RRTTools::runMultiplex(), plans need at least one iteration per slice. \"" + arguments[3] + "\".");
+    }
+
+    const auto tuning = RRTTuning::loadDefault();
+
+    // Every plan counts its result and how many ticks it took to come back.
+    const auto statuses  = (size_t) PlanStatus::Cancelled + 1;
+    auto       finished  = std::vector<unsigned int> (statuses, 0U);
+    auto       ticks     = 0U;
+    auto       tickTotal = 0ULL;
+
+    PlanScheduler scheduler { sliceIterations };
+
+    const auto onFinished = [&] (const PlanTask& task)
+    {
+        ++finished[(size_t) task.getStatus()];
+        tickTotal += ticks;
+    };
+
+    auto random = std::mt19937 (std::random_device()());
+    auto pickX  = std::uniform_int_distribution<int> (0, (int) data->getWidth() - 1),
+         pickY  = std::uniform_int_distribution<int> (0, (int) data->getHeight() - 1);
+
+    for (auto i = 0UL; i < plans; ++i)
+    {
+        auto rrt = RRT { };
+        rrt.setTuning (tuning);
+        rrt.setSeed (random());
+
+        scheduler.submit (std::move (rrt), data, sf::Vector2i (pickX (random), pickY (random)), sf::Vector2i (pickX (random), pickY (random)), 
+                          iterationLimit, onFinished);
+    }
+
+    // Run ticks back to back as a simulation thread would, watching how far each one goes over its budget.
+    auto slices  = 0ULL;
+    auto longest = 0.0;
+    auto total   = 0.0;
+
+    while (scheduler.getPlanCount() > 0)
+    {
+        ++ticks;
+
+        const auto start = Clock::now();
+        slices          += scheduler.tick (tickSeconds);
+
+        const auto elapsed = std::chrono::duration<double> (Clock::now() - start).count();
+        longest            = std::max (longest, elapsed);
+        total             += elapsed;
+    }
+
+    std::cout   << "Multiplexed " << plans << " plans over " << ticks << " ticks of " << tickSeconds * 1000.0 << "ms using " 
+                << slices << " slices of " << sliceIterations << " iterations." << std::endl
+                << "Solved " << finished[(size_t) PlanStatus::Solved] << ", unreachable " << finished[(size_t) PlanStatus::Unreachable] 
+                << ", exhausted " << finished[(size_t) PlanStatus::Exhausted] << ", taking " << (double) tickTotal / std::max (plans, 1UL) 
+                << " ticks on average." << std::endl
+                << "Ticks averaged " << total / std::max (ticks, 1U) * 1000.0 << "ms, the longest took " << longest * 1000.0 << "ms." << std::endl;
+
+    return 0;
+}
+
+
+int RRTTools::runPlanners (const std::vector<std::string>& arguments)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    if (arguments.empty())
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto data           = std::make_shared<LevelData> (arguments[0]);
+    const auto queries        = arguments.size() > 1 ? std::stoul (arguments[1]) : 8UL;
+    const auto iterationLimit = arguments.size() > 2 ? (unsigned int) std::stoul (arguments[2]) : 200000U;
+    const auto levels         = arguments.size() > 3 ? (unsigned int) std::stoul (arguments[3]) : 0U;
+
+    const auto pathLength = [] (const std::vector<sf::Vector2i>& path)
+    {
+        auto length = 0.0;
+
+        for (auto i = size_t (1); i < path.size(); ++i)
+        {
+            const auto difference = sf::Vector2f (path[i] - path[i - 1]);
+            length               += std::sqrt (difference.x * difference.x + difference.y * difference.y);
+        }
+
+        return length;
+    };
+
+    auto rrt = RRT { };
+
+    rrt.setTuning (RRTTuning::loadDefault());
+
+    // Building the pyramid is a one-off cost per level so it isn't counted against any query.
+    auto coarse = CoarseToFine (data, levels);
+    coarse.setIterationLimit (iterationLimit);
+
+    // Every local tree grows for a round at a time, so the round limit gives each tree the same iterations as the single tree.
+    const auto roundLength = 256U;
+    auto       partitioned = PartitionedRRT (std::make_shared<ThreadPool>());
+
+    partitioned.setRoundLength (roundLength);
+    partitioned.setRoundLimit (std::max (1U, iterationLimit / roundLength));
+
+    std::cout << "Planning " << queries << " queries on " << arguments[0] << " with " << coarse.getPyramid().getLevelCount() << " pyramid levels." << std::endl;
+
+    auto random  = std::mt19937 (std::random_device()());
+    auto pickX   = std::uniform_int_distribution<int> (0, (int) data->getWidth() - 1),
+         pickY   = std::uniform_int_distribution<int> (0, (int) data->getHeight() - 1);
+    auto planned = 0UL;
+
+    for (auto attempts = 0UL; planned < queries && attempts < queries * 100; ++attempts)
+    {
+        const auto start = sf::Vector2i (pickX (random), pickY (random)),
+                   end   = sf::Vector2i (pickX (random), pickY (random));
+
+        if (start == end || !data->sameRegion (start.x + start.y * data->getWidth(), end.x + end.y * data->getWidth(), MovementClass::Land))
+        {
+            continue;
+        }
+
+        ++planned;
+
+        // A single tree grown across the whole level.
+        const auto rrtStart = Clock::now();
+        auto       rrtSteps = 0U;
+
+        rrt.setSeed (random());
+        rrt.prepareTree (data, start, end);
+
+        while (!rrt.hasFinished() && rrtSteps < iterationLimit)
+        {
+            rrt.generateBranch();
+            ++rrtSteps;
+        }
+
+        const auto rrtSeconds = std::chrono::duration<double> (Clock::now() - rrtStart).count();
+
+        // The coarse-to-fine planner on the same query.
+        const auto coarseStart   = Clock::now();
+        const auto coarseSolved  = coarse.plan (start, end);
+        const auto coarseSeconds = std::chrono::duration<double> (Clock::now() - coarseStart).count();
+
+        // The partitioned planner gives up once it's exhausted its rounds.
+        const auto partitionedStart = Clock::now();
+
+        partitioned.setSeed (random());
+        partitioned.prepareTree (data, start, end);
+
+        while (!partitioned.hasFinished() && !partitioned.isExhausted())
+        {
+            partitioned.generateRound();
+        }
+
+        const auto partitionedSeconds = std::chrono::duration<double> (Clock::now() - partitionedStart).count();
+
+        std::cout   << "(" << start.x << ", " << start.y << ") to (" << end.x << ", " << end.y << ")" << std::endl
+                    << "  rrt:            " << (rrt.hasFinished() ? "solved" : "failed") << " in " << rrtSteps << " iterations, " 
+                    << rrtSeconds * 1000.0 << "ms, length " << pathLength (rrt.getPath()) << std::endl
+                    << "  coarse-to-fine: " << (coarseSolved ? "solved" : "failed") << " in " << coarse.getIterations() 
+                    << " iterations from level " << coarse.getCoarseLevel() << ", " << coarseSeconds * 1000.0 << "ms, length " 
+                    << pathLength (coarse.getPath()) << std::endl
+                    << "  partitioned:    " << (partitioned.hasFinished() ? "solved" : "failed") << " in " << partitioned.getRounds() 
+                    << " rounds with " << partitioned.getTreeCount() << " trees, " << partitionedSeconds * 1000.0 << "ms, length " 
+                    << pathLength (partitioned.getPath()) << std::endl;
+    }
+
+    return 0;
+}
+
+
+bool RRTTools::planRandomQuery (RRT& rrt, const std::shared_ptr<LevelData>& data, std::mt19937& random, const double querySeconds)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    auto pickX = std::uniform_int_distribution<int> (0, (int) data->getWidth() - 1),
+         pickY = std::uniform_int_distribution<int> (0, (int) data->getHeight() - 1);
+
+    const auto start = sf::Vector2i (pickX (random), pickY (random)),
+               end   = sf::Vector2i (pickX (random), pickY (random));
+
+    if (start == end || !data->sameRegion (start.x + start.y * data->getWidth(), end.x + end.y * data->getWidth(), MovementClass::Land))
+    {
+        return false;
+    }
+
+    rrt.setSeed (random());
+    rrt.prepareTree (data, start, end);
+
+    const auto queryStart = Clock::now();
+    auto       iterations = 0U;
+
+    while (!rrt.hasFinished() && rrt.isReachable())
+    {
+        rrt.generateBranch();
+
+        // Checking the clock every iteration would skew the metrics.
+        if ((++iterations & 63) == 0 && std::chrono::duration<double> (Clock::now() - queryStart).count() >= querySeconds)
+        {
+            break;
+        }
+    }
+
+    return true;
+}
\ No newline at end of file
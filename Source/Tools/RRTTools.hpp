@@ -0,0 +1,115 @@
+#ifndef GEC_RRT_TOOLS_HPP
+#define GEC_RRT_TOOLS_HPP
+
+
+// STL headers.
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// Forward declarations.
+class LevelData;
+class RRT;
+
+
+/// <summary>
+/// A command line application containing the development tools for the RRT algorithm, such as the map corpus
+/// generator, the benchmark runner and comparator, the parameter tuner, map sharing, the differential tester, a metrics server, an effort heatmap, plan tracing, a plan scheduler and a planner comparison. The first argument selects the tool to run.
+/// </summary>
+class RRTTools final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        RRTTools()                                      = default;
+        ~RRTTools()                                     = default;
+
+        RRTTools (RRTTools&& move)                      = default;
+        RRTTools& operator= (RRTTools&& move)           = default;
+        RRTTools (const RRTTools& copy)                 = default;
+        RRTTools& operator= (const RRTTools& copy)      = default;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Runs the tool selected by the given arguments. </summary>
+        /// <param name="arguments"> The command line arguments, excluding the program name. </param>
+        /// <returns> The exit code. </returns>
+        int run (const std::vector<std::string>& arguments);
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Writes the usage of each tool to the console. </summary>
+        void printUsage() const;
+
+        /// <summary> Generates a corpus of maps. Usage: corpus directory [minimum size] [maximum size] [seed]. </summary>
+        int runCorpus (const std::vector<std::string>& arguments);
+
+        /// <summary> Benchmarks a corpus of maps. Usage: benchmark manifest [queries] [seconds per query] [csv file or -] [standard|huge|both] [json file]. </summary>
+        int runBenchmark (const std::vector<std::string>& arguments);
+
+        /// <summary> Compares two benchmark runs written as JSON, returning 3 on a regression. Usage: compare baseline candidate [threshold] [significance]. </summary>
+        int runCompare (const std::vector<std::string>& arguments);
+
+        /// <summary> Tunes the RRT parameters for a map. Usage: tune map [tuning file] [queries] [seconds per query] [query file]. </summary>
+        int runTune (const std::vector<std::string>& arguments);
+
+        /// <summary> Publishes a map into shared memory until enter is pressed. Usage: share map name [raw|packed|runlength]. </summary>
+        int runShare (const std::vector<std::string>& arguments);
+
+        /// <summary> Attaches to a shared map and reports what it contains. Usage: attach name. </summary>
+        int runAttach (const std::vector<std::string>& arguments);
+
+        /// <summary> Checks optimised code against its references on random cases. Usage: diff [cases] [repro directory or -] [seed] [maximum size]. </summary>
+        int runDiff (const std::vector<std::string>& arguments);
+
+        /// <summary> Runs every differential check on a repro written by diff. Usage: replay case. </summary>
+        int runReplay (const std::vector<std::string>& arguments);
+
+        /// <summary> Plans random queries on a map whilst serving metrics for Prometheus. Usage: serve map [port] [seconds or 0] [seconds per query]. </summary>
+        int runServe (const std::vector<std::string>& arguments);
+
+        /// <summary> Plans random queries on a map and exports where the effort went. Usage: heatmap map [queries] [seconds per query] [output prefix] [cell shift]. </summary>
+        int runHeatmap (const std::vector<std::string>& arguments);
+
+        /// <summary> Plans random queries on a map whilst recording a trace. Usage: trace map [queries] [seconds per query] [trace file]. </summary>
+        int runTrace (const std::vector<std::string>& arguments);
+
+        /// <summary> Replays a trace on each requested backend and compares the timings. Usage: retrace trace map [storage|all] [standard|huge|both]. </summary>
+        int runRetrace (const std::vector<std::string>& arguments);
+
+        /// <summary> Multiplexes random plans on one thread under a per-tick budget. Usage: multiplex map [plans] [tick milliseconds] [slice iterations] [iteration limit]. </summary>
+        int runMultiplex (const std::vector<std::string>& arguments);
+
+        /// <summary> Compares the planners on the same random queries. Usage: planners map [queries] [iteration limit] [pyramid levels]. </summary>
+        int runPlanners (const std::vector<std::string>& arguments);
+
+        /// <summary> Plans between two random points which share a region, returning false if the points weren't usable. </summary>
+        static bool planRandomQuery (RRT& rrt, const std::shared_ptr<LevelData>& data, std::mt19937& random, const double querySeconds);
+};
+
+
+/// <summary> 
+/// The main function which starts the application. 
+/// </summary>
+/// <returns> The exit code of the application. </returns>
+int main (int argc, char** argv)
+{
+    // Skip the program name.
+    const auto arguments = std::vector<std::string> (argv + 1, argv + argc);
+
+    return RRTTools().run (arguments);
+}
+
+#endif
\ No newline at end of file
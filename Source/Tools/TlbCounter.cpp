@@ -0,0 +1,112 @@
+#include "TlbCounter.hpp"
+
+
+// Platform headers.
+#if defined (__linux__)
+    #include <cstring>
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+#if defined (__linux__)
+
+TlbCounter::TlbCounter()
+{
+    auto attributes = perf_event_attr { };
+    std::memset (&attributes, 0, sizeof (attributes));
+
+    // Data TLB misses on reads, only counted in user space so no extra privileges are needed.
+    attributes.type           = PERF_TYPE_HW_CACHE;
+    attributes.size           = sizeof (attributes);
+    attributes.config         = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attributes.disabled       = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv     = 1;
+
+    m_descriptor = (int) syscall (__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+
+TlbCounter::~TlbCounter()
+{
+    if (m_descriptor >= 0)
+    {
+        close (m_descriptor);
+    }
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void TlbCounter::start()
+{
+    if (m_descriptor >= 0)
+    {
+        ioctl (m_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+
+void TlbCounter::stop()
+{
+    if (m_descriptor >= 0)
+    {
+        ioctl (m_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+    }
+}
+
+
+unsigned long long TlbCounter::getMisses() const
+{
+    auto misses = 0ULL;
+
+    if (m_descriptor < 0 || read (m_descriptor, &misses, sizeof (misses)) != sizeof (misses))
+    {
+        return 0;
+    }
+
+    return misses;
+}
+
+#else
+
+TlbCounter::TlbCounter()
+{
+}
+
+
+TlbCounter::~TlbCounter()
+{
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void TlbCounter::start()
+{
+}
+
+
+void TlbCounter::stop()
+{
+}
+
+
+unsigned long long TlbCounter::getMisses() const
+{
+    return 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#ifndef GEC_TLB_COUNTER_HPP
+#define GEC_TLB_COUNTER_HPP
+
+
+/// <summary>
+/// Counts the data TLB misses of the calling thread using the hardware performance counters. On Linux this uses
+/// perf_event_open() which needs kernel.perf_event_paranoid to be 2 or lower, virtual machines often don't expose the
+/// counter at all. Other platforms don't offer an unprivileged counter so it's reported as unavailable.
+/// </summary>
+class TlbCounter final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Opens the counter, it starts off stopped. </summary>
+        TlbCounter();
+
+        /// <summary> Closes the counter. </summary>
+        ~TlbCounter();
+
+        TlbCounter (TlbCounter&& move)                  = delete;
+        TlbCounter& operator= (TlbCounter&& move)       = delete;
+        TlbCounter (const TlbCounter& copy)             = delete;
+        TlbCounter& operator= (const TlbCounter& copy)  = delete;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Checks whether the counter could be opened, if not every count is zero. </summary>
+        bool isAvailable() const    { return m_descriptor >= 0; }
+
+        /// <summary> Starts counting, misses are added to those already counted. </summary>
+        void start();
+
+        /// <summary> Stops counting. </summary>
+        void stop();
+
+        /// <summary> Gets the misses counted whilst the counter was running. </summary>
+        unsigned long long getMisses() const;
+
+    private:
+
+        int m_descriptor    { -1 }; //!< The file descriptor of the perf event, negative if unavailable.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "HugePages.hpp"
+
+
+// STL headers.
+#include <cstdint>
+
+
+// Platform headers.
+#if defined (_WIN32)
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+
+
+std::atomic<PagePolicy> HugePages::policy      { PagePolicy::Standard };
+std::atomic<size_t>     HugePages::mappedBytes { 0 };
+
+
+////////////
+// Policy //
+////////////
+
+PagePolicy HugePages::getPolicy()
+{
+    return policy;
+}
+
+
+void HugePages::setPolicy (const PagePolicy value)
+{
+    policy = value;
+}
+
+
+size_t HugePages::getPageSize()
+{
+    #if defined (_WIN32)
+        const auto size = GetLargePageMinimum();
+        return size != 0 ? size : defaultPageSize;
+    #else
+        return defaultPageSize;
+    #endif
+}
+
+
+size_t HugePages::getMappedBytes()
+{
+    return mappedBytes;
+}
+
+
+////////////////
+// Allocation //
+////////////////
+
+void* HugePages::allocate (const size_t bytes)
+{
+    const auto pageSize = getPageSize();
+    const auto total    = bytes + headerSize;
+
+    // Small allocations would waste most of a huge page.
+    if (policy == PagePolicy::Huge && total >= pageSize)
+    {
+        const auto rounded = (total + pageSize - 1) / pageSize * pageSize;
+        const auto memory  = mapHuge (rounded);
+
+        if (memory)
+        {
+            mappedBytes += rounded;
+
+            const auto header = new (memory) Header();
+            header->mapped    = rounded;
+
+            return static_cast<char*> (memory) + headerSize;
+        }
+    }
+
+    // The heap only promises alignment for the largest fundamental type so over-allocate and align the header ourselves.
+    const auto block   = ::operator new (total + headerSize);
+    const auto start   = reinterpret_cast<std::uintptr_t> (block);
+    const auto aligned = reinterpret_cast<char*> ((start + headerSize - 1) / headerSize * headerSize);
+
+    const auto header = new (aligned) Header();
+    header->block     = block;
+
+    return aligned + headerSize;
+}
+
+
+void HugePages::deallocate (void* const memory)
+{
+    if (!memory)
+    {
+        return;
+    }
+
+    const auto base   = static_cast<char*> (memory) - headerSize;
+    const auto header = reinterpret_cast<Header*> (base);
+    const auto size   = header->mapped;
+    const auto block  = header->block;
+
+    header->~Header();
+
+    if (size != 0)
+    {
+        mappedBytes -= size;
+        unmapHuge (base, size);
+    }
+
+    else
+    {
+        ::operator delete (block);
+    }
+}
+
+
+#if defined (_WIN32)
+
+void* HugePages::mapHuge (const size_t bytes)
+{
+    // This fails unless the user has been granted SeLockMemoryPrivilege and the process has enabled it.
+    return VirtualAlloc (nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+}
+
+
+void HugePages::unmapHuge (void* const memory, const size_t)
+{
+    VirtualFree (memory, 0, MEM_RELEASE);
+}
+
+#else
+
+void* HugePages::mapHuge (const size_t bytes)
+{
+    // Transparent huge pages are only used for 2 MB aligned ranges so over-allocate by a page and trim either side.
+    const auto pageSize = getPageSize();
+    const auto reserved = bytes + pageSize;
+    const auto memory   = mmap (nullptr, reserved, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    const auto start   = reinterpret_cast<std::uintptr_t> (memory);
+    const auto aligned = (start + pageSize - 1) / pageSize * pageSize;
+    const auto before  = aligned - start;
+    const auto after   = reserved - before - bytes;
+
+    if (before != 0)
+    {
+        munmap (memory, before);
+    }
+
+    if (after != 0)
+    {
+        munmap (reinterpret_cast<void*> (aligned + bytes), after);
+    }
+
+    // Without transparent huge page support this fails harmlessly and the mapping uses normal pages.
+    const auto result = reinterpret_cast<void*> (aligned);
+
+    #if defined (MADV_HUGEPAGE)
+        madvise (result, bytes, MADV_HUGEPAGE);
+    #endif
+
+    return result;
+}
+
+
+void HugePages::unmapHuge (void* const memory, const size_t bytes)
+{
+    munmap (memory, bytes);
+}
+
+#endif
\ No newline at end of file
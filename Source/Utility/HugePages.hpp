@@ -0,0 +1,162 @@
+#ifndef GEC_HUGE_PAGES_HPP
+#define GEC_HUGE_PAGES_HPP
+
+
+// STL headers.
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+
+// Application headers.
+#include <Utility/MemoryTracker.hpp>
+
+
+/// <summary>
+/// How large arrays such as the tiles of a level and the node index of a tree should be allocated.
+/// </summary>
+enum class PagePolicy : char
+{
+    Standard,       //!< Use the normal heap.
+    Huge            //!< Back large allocations with huge pages where the operating system allows it.
+};
+
+
+/// <summary>
+/// Allocates memory which is backed by huge pages when the policy asks for it. Randomly indexing a large array touches
+/// a different page almost every time, so with 4 KB pages most accesses miss the TLB. A 2 MB page covers 512 times as
+/// much memory per TLB entry. On Linux the memory is mapped at a 2 MB boundary and marked with MADV_HUGEPAGE so that
+/// transparent huge pages back it, on Windows large pages are requested which needs the "Lock pages in memory" privilege.
+/// Whenever huge pages are unavailable, or the allocation is smaller than a huge page, the normal heap is used instead.
+/// </summary>
+class HugePages final
+{
+    public:
+
+        HugePages() = delete;
+
+
+        ////////////
+        // Policy //
+        ////////////
+
+        /// <summary> Gets the policy used by new allocations. </summary>
+        static PagePolicy getPolicy();
+
+        /// <summary> Sets the policy used by new allocations, existing allocations keep their pages. </summary>
+        static void setPolicy (const PagePolicy value);
+
+        /// <summary> Gets the size of a huge page in bytes. </summary>
+        static size_t getPageSize();
+
+        /// <summary> Gets the largest allocation which fits in a single huge page. </summary>
+        static size_t getPageCapacity()     { return getPageSize() - headerSize; }
+
+        /// <summary> Gets the number of bytes currently allocated through huge page mappings, useful to check the fallback wasn't used. </summary>
+        static size_t getMappedBytes();
+
+
+        ////////////////
+        // Allocation //
+        ////////////////
+
+        /// <summary> Allocates memory according to the current policy, throws std::bad_alloc on failure. </summary>
+        /// <param name="bytes"> The number of bytes required. </param>
+        /// <returns> Memory aligned to at least 64 bytes. </returns>
+        static void* allocate (const size_t bytes);
+
+        /// <summary> Frees memory returned by allocate(), regardless of the policy it was allocated with. </summary>
+        static void deallocate (void* const memory);
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> Sits in front of every allocation so it can be freed without knowing how it was made. </summary>
+        struct Header final
+        {
+            size_t  mapped  { 0 };          //!< The size of the huge page mapping, zero if the normal heap was used.
+            void*   block   { nullptr };    //!< The memory given by the normal heap, which may start before the header.
+        };
+
+        /// <summary> The space reserved for the header, which is also the alignment of the header and the memory after it. </summary>
+        static const size_t headerSize = 64;
+
+        /// <summary> The size of a huge page on x86-64, Windows may report a different size. </summary>
+        static const size_t defaultPageSize = 2 * 1024 * 1024;
+
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Maps memory backed by huge pages, nullptr if that isn't possible. </summary>
+        /// <param name="bytes"> The number of bytes required, this has already been rounded up to a whole number of huge pages. </param>
+        static void* mapHuge (const size_t bytes);
+
+        /// <summary> Releases memory returned by mapHuge(). </summary>
+        static void unmapHuge (void* const memory, const size_t bytes);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        static std::atomic<PagePolicy>  policy;         //!< The policy used by new allocations.
+        static std::atomic<size_t>      mappedBytes;    //!< The bytes currently allocated as huge pages.
+};
+
+
+/// <summary>
+/// A standard allocator which allocates through HugePages, so containers follow the page policy. Every allocation is
+/// counted against the given subsystem by MemoryTracker. This can't be final because containers derive from their
+/// allocator to take advantage of the empty base optimisation.
+/// </summary>
+template <typename T, MemorySubsystem Subsystem> class HugePageAllocator
+{
+    public:
+
+        using value_type = T;
+
+        template <typename U> struct rebind final
+        {
+            using other = HugePageAllocator<U, Subsystem>;
+        };
+
+        HugePageAllocator() {}
+        template <typename U> HugePageAllocator (const HugePageAllocator<U, Subsystem>&) {}
+
+        /// <summary> Allocates storage for the given number of objects. </summary>
+        T* allocate (const size_t count)
+        {
+            const auto memory = static_cast<T*> (HugePages::allocate (count * sizeof (T)));
+            MemoryTracker::allocate (Subsystem, count * sizeof (T));
+
+            return memory;
+        }
+
+        /// <summary> Frees storage returned by allocate(). </summary>
+        void deallocate (T* const memory, const size_t count)
+        {
+            MemoryTracker::deallocate (Subsystem, count * sizeof (T));
+            HugePages::deallocate (memory);
+        }
+};
+
+
+template <typename T, typename U, MemorySubsystem Subsystem>
+bool operator== (const HugePageAllocator<T, Subsystem>&, const HugePageAllocator<U, Subsystem>&)
+{
+    return true;
+}
+
+
+template <typename T, typename U, MemorySubsystem Subsystem>
+bool operator!= (const HugePageAllocator<T, Subsystem>&, const HugePageAllocator<U, Subsystem>&)
+{
+    return false;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "MemoryTracker.hpp"
+
+
+// STL headers.
+#include <cassert>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+
+
+
+std::array<MemoryTracker::Counters, (size_t) MemorySubsystem::Count> MemoryTracker::counters { };
+
+
+//////////////
+// Counting //
+//////////////
+
+void MemoryTracker::allocate (const MemorySubsystem subsystem, const size_t bytes)
+{
+    // Pre-condition: The subsystem is valid.
+    assert (subsystem < MemorySubsystem::Count);
+
+    auto& counter = counters[(size_t) subsystem];
+
+    const auto current = counter.current.fetch_add (bytes, std::memory_order_relaxed) + bytes;
+    counter.allocations.fetch_add (1, std::memory_order_relaxed);
+
+    // Only raise the peak, another thread may have raised it further in the meantime.
+    auto peak = counter.peak.load (std::memory_order_relaxed);
+
+    while (current > peak && !counter.peak.compare_exchange_weak (peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
+
+void MemoryTracker::deallocate (const MemorySubsystem subsystem, const size_t bytes)
+{
+    // Pre-condition: The subsystem is valid.
+    assert (subsystem < MemorySubsystem::Count);
+
+    counters[(size_t) subsystem].current.fetch_sub (bytes, std::memory_order_relaxed);
+}
+
+
+///////////////
+// Reporting //
+///////////////
+
+MemoryUsage MemoryTracker::getUsage (const MemorySubsystem subsystem)
+{
+    // Pre-condition: The subsystem is valid.
+    assert (subsystem < MemorySubsystem::Count);
+
+    const auto& counter = counters[(size_t) subsystem];
+
+    auto usage        = MemoryUsage { };
+    usage.current     = counter.current.load (std::memory_order_relaxed);
+    usage.peak        = counter.peak.load (std::memory_order_relaxed);
+    usage.allocations = counter.allocations.load (std::memory_order_relaxed);
+
+    return usage;
+}
+
+
+MemoryUsage MemoryTracker::getTotal()
+{
+    auto total = MemoryUsage { };
+
+    for (auto i = 0U; i < counters.size(); ++i)
+    {
+        const auto usage   = getUsage ((MemorySubsystem) i);
+        total.current     += usage.current;
+        total.peak        += usage.peak;
+        total.allocations += usage.allocations;
+    }
+
+    return total;
+}
+
+
+void MemoryTracker::resetPeaks()
+{
+    for (auto& counter : counters)
+    {
+        counter.peak.store (counter.current.load (std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+
+const char* MemoryTracker::getName (const MemorySubsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case MemorySubsystem::LevelTiles:       return "level_tiles";
+        case MemorySubsystem::LevelProducts:    return "level_products";
+        case MemorySubsystem::RRTIndex:         return "rrt_index";
+        case MemorySubsystem::TreeNodes:        return "tree_nodes";
+        case MemorySubsystem::TreeBranches:     return "tree_branches";
+        case MemorySubsystem::ViewerTextures:   return "viewer_textures";
+        case MemorySubsystem::Heatmap:          return "heatmap";
+        case MemorySubsystem::Traces:           return "plan_traces";
+        default:                                return "unknown";
+    }
+}
+
+
+void MemoryTracker::writeReport (std::ostream& stream)
+{
+    const auto megabytes = 1024.0 * 1024.0;
+
+    stream  << std::left << std::setw (18) << "subsystem" << std::right
+            << std::setw (14) << "current MB" << std::setw (14) << "peak MB" << std::setw (14) << "allocations" << std::endl;
+
+    const auto row = [&] (const char* const name, const MemoryUsage& usage)
+    {
+        stream  << std::left << std::setw (18) << name << std::right << std::fixed << std::setprecision (2)
+                << std::setw (14) << usage.current / megabytes
+                << std::setw (14) << usage.peak / megabytes
+                << std::setw (14) << usage.allocations << std::endl;
+    };
+
+    for (auto i = 0U; i < counters.size(); ++i)
+    {
+        row (getName ((MemorySubsystem) i), getUsage ((MemorySubsystem) i));
+    }
+
+    row ("total", getTotal());
+}
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+TrackedMemory::TrackedMemory (const MemorySubsystem subsystem)
+    : m_subsystem (subsystem)
+{
+}
+
+
+TrackedMemory::TrackedMemory (TrackedMemory&& move)
+{
+    *this = std::move (move);
+}
+
+
+TrackedMemory& TrackedMemory::operator= (TrackedMemory&& move)
+{
+    if (this != &move)
+    {
+        // Stop counting our own memory before taking over theirs.
+        setBytes (0);
+
+        m_subsystem  = move.m_subsystem;
+        m_bytes      = move.m_bytes;
+        move.m_bytes = 0;
+    }
+
+    return *this;
+}
+
+
+TrackedMemory::TrackedMemory (const TrackedMemory& copy)
+{
+    *this = copy;
+}
+
+
+TrackedMemory& TrackedMemory::operator= (const TrackedMemory& copy)
+{
+    if (this != &copy)
+    {
+        setBytes (0);
+
+        m_subsystem = copy.m_subsystem;
+        setBytes (copy.m_bytes);
+    }
+
+    return *this;
+}
+
+
+TrackedMemory::~TrackedMemory()
+{
+    setBytes (0);
+}
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+void TrackedMemory::setBytes (const size_t bytes)
+{
+    if (bytes > m_bytes)
+    {
+        MemoryTracker::allocate (m_subsystem, bytes - m_bytes);
+    }
+
+    else if (bytes < m_bytes)
+    {
+        MemoryTracker::deallocate (m_subsystem, m_bytes - bytes);
+    }
+
+    m_bytes = bytes;
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#ifndef GEC_MEMORY_TRACKER_HPP
+#define GEC_MEMORY_TRACKER_HPP
+
+
+// STL headers.
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <new>
+
+
+/// <summary>
+/// The parts of the project whose memory is accounted for separately.
+/// </summary>
+enum class MemorySubsystem : char
+{
+    LevelTiles,     //!< The tiles of each LevelData, in whichever storage method is used.
+    LevelProducts,  //!< The traversability masks and region labels derived from the tiles.
+    RRTIndex,       //!< The node index and coverage grid which RRT keeps over its window.
+    TreeNodes,      //!< Tree nodes, both pooled chunks and nodes allocated individually.
+    TreeBranches,   //!< The vector of child pointers held by every Tree node.
+    ViewerTextures, //!< The textures created by LevelViewer.
+    Heatmap,        //!< The counters of a TileHeatmap profiling the planner.
+    Traces,         //!< The ring buffers of PlanTrace recordings waiting to be written.
+    Count           //!< The number of subsystems.
+};
+
+
+/// <summary>
+/// A snapshot of the memory used by a single subsystem.
+/// </summary>
+struct MemoryUsage final
+{
+    size_t              current     { 0 };  //!< The bytes currently allocated.
+    size_t              peak        { 0 };  //!< The most bytes allocated at once since the peaks were last reset.
+    unsigned long long  allocations { 0 };  //!< The total number of allocations ever made.
+};
+
+
+/// <summary>
+/// Counts the memory used by each subsystem so the cost of a map can be broken down for capacity planning. Containers
+/// are counted through TrackedAllocator or HugePageAllocator, other memory such as textures is counted explicitly
+/// through TrackedMemory. Counters are atomic since products are built on worker threads, they only ever use relaxed
+/// ordering so counting costs a single uncontended atomic addition per allocation.
+/// </summary>
+class MemoryTracker final
+{
+    public:
+
+        MemoryTracker() = delete;
+
+
+        //////////////
+        // Counting //
+        //////////////
+
+        /// <summary> Records an allocation made by a subsystem. </summary>
+        static void allocate (const MemorySubsystem subsystem, const size_t bytes);
+
+        /// <summary> Records memory being freed by a subsystem. </summary>
+        static void deallocate (const MemorySubsystem subsystem, const size_t bytes);
+
+
+        ///////////////
+        // Reporting //
+        ///////////////
+
+        /// <summary> Gets the current usage of a subsystem. </summary>
+        static MemoryUsage getUsage (const MemorySubsystem subsystem);
+
+        /// <summary> Gets the usage of every subsystem combined, the peak is the sum of each subsystem's peak. </summary>
+        static MemoryUsage getTotal();
+
+        /// <summary> Sets the peak of every subsystem to its current usage, so the next peak only covers what follows. </summary>
+        static void resetPeaks();
+
+        /// <summary> Gets the name of a subsystem as used in reports and column names. </summary>
+        static const char* getName (const MemorySubsystem subsystem);
+
+        /// <summary> Writes a table of the current usage, peak and allocation count of every subsystem. </summary>
+        static void writeReport (std::ostream& stream);
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> The counters of a single subsystem. </summary>
+        struct Counters final
+        {
+            std::atomic<size_t>             current;        //!< The bytes currently allocated.
+            std::atomic<size_t>             peak;           //!< The most bytes allocated at once.
+            std::atomic<unsigned long long> allocations;    //!< The number of allocations made.
+        };
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        static std::array<Counters, (size_t) MemorySubsystem::Count> counters;  //!< The counters of each subsystem.
+};
+
+
+/// <summary>
+/// A standard allocator which uses the normal heap and counts every allocation against a subsystem. This can't be
+/// final because containers derive from their allocator to take advantage of the empty base optimisation.
+/// </summary>
+template <typename T, MemorySubsystem Subsystem> class TrackedAllocator
+{
+    public:
+
+        using value_type = T;
+
+        template <typename U> struct rebind final
+        {
+            using other = TrackedAllocator<U, Subsystem>;
+        };
+
+        TrackedAllocator() {}
+        template <typename U> TrackedAllocator (const TrackedAllocator<U, Subsystem>&) {}
+
+        /// <summary> Allocates storage for the given number of objects. </summary>
+        T* allocate (const size_t count)
+        {
+            const auto memory = static_cast<T*> (::operator new (count * sizeof (T)));
+            MemoryTracker::allocate (Subsystem, count * sizeof (T));
+
+            return memory;
+        }
+
+        /// <summary> Frees storage returned by allocate(). </summary>
+        void deallocate (T* const memory, const size_t count)
+        {
+            MemoryTracker::deallocate (Subsystem, count * sizeof (T));
+            ::operator delete (memory);
+        }
+};
+
+
+template <typename T, typename U, MemorySubsystem Subsystem>
+bool operator== (const TrackedAllocator<T, Subsystem>&, const TrackedAllocator<U, Subsystem>&)
+{
+    return true;
+}
+
+
+template <typename T, typename U, MemorySubsystem Subsystem>
+bool operator!= (const TrackedAllocator<T, Subsystem>&, const TrackedAllocator<U, Subsystem>&)
+{
+    return false;
+}
+
+
+/// <summary>
+/// Counts memory which isn't allocated through a container, such as a texture, against a subsystem for as long as
+/// the object lives. Copies count the memory again, moves hand the count over.
+/// </summary>
+class TrackedMemory final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Starts counting against a subsystem, nothing is counted until the size is set. </summary>
+        TrackedMemory (const MemorySubsystem subsystem);
+
+        TrackedMemory (TrackedMemory&& move);
+        TrackedMemory& operator= (TrackedMemory&& move);
+        TrackedMemory (const TrackedMemory& copy);
+        TrackedMemory& operator= (const TrackedMemory& copy);
+
+        /// <summary> Stops counting the memory. </summary>
+        ~TrackedMemory();
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the number of bytes being counted. </summary>
+        size_t getBytes() const     { return m_bytes; }
+
+        /// <summary> Replaces the number of bytes being counted, growing counts as an allocation. </summary>
+        void setBytes (const size_t bytes);
+
+    private:
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        MemorySubsystem m_subsystem { MemorySubsystem::Count }; //!< The subsystem the memory belongs to.
+        size_t          m_bytes     { 0 };                      //!< The bytes being counted.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include "Metrics.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+
+// Application headers.
+#include <Utility/MemoryTracker.hpp>
+
+
+
+GEC_THREAD_LOCAL Metrics::Shard* Metrics::localShard = nullptr;
+
+const std::vector<MetricGauge> Metrics::memoryGauges = Metrics::addMemoryGauges();
+
+
+//////////////////
+// Registration //
+//////////////////
+
+MetricCounter Metrics::addCounter (const std::string& name, const std::string& help)
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock { registry.mutex };
+
+    return MetricCounter (addFamily (registry, name, help, MetricType::Counter, 1).first);
+}
+
+
+MetricHistogram Metrics::addHistogram (const std::string& name, const std::string& help, std::vector<double> bounds)
+{
+    // Pre-condition: The bounds are ascending.
+    assert (std::is_sorted (bounds.cbegin(), bounds.cend()));
+
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock { registry.mutex };
+
+    // Each bucket, the +Inf bucket and the sum.
+    auto& family  = addFamily (registry, name, help, MetricType::Histogram, (unsigned int) bounds.size() + 2);
+    family.bounds = bounds;
+
+    return MetricHistogram (family.first, std::move (bounds));
+}
+
+
+MetricGauge Metrics::addGauge (const std::string& name, const std::string& help, const std::string& labels, std::function<double()> sample)
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock { registry.mutex };
+
+    // Series with different labels belong to the same family.
+    for (auto& family : registry.families)
+    {
+        if (family.name == name)
+        {
+            if (family.type != MetricType::Gauge)
+            {
+                throw std::invalid_argument ("Metrics::addGauge(), a different kind of metric has the same name. \"" + name + "\".");
+            }
+
+            family.labels.push_back (labels);
+            family.samples.push_back (sample);
+
+            return MetricGauge (std::move (sample));
+        }
+    }
+
+    auto& family = addFamily (registry, name, help, MetricType::Gauge, 0);
+    family.labels.push_back (labels);
+    family.samples.push_back (sample);
+
+    return MetricGauge (std::move (sample));
+}
+
+
+///////////////
+// Recording //
+///////////////
+
+void Metrics::addReal (const unsigned int slot, const double amount)
+{
+    // Only the calling thread writes to its shard so the bits can be read, added to and written back.
+    auto& value = obtainShard().slots[slot];
+    auto  bits  = value.load (std::memory_order_relaxed);
+    auto  real  = 0.0;
+
+    std::memcpy (&real, &bits, sizeof (real));
+    real += amount;
+    std::memcpy (&bits, &real, sizeof (bits));
+
+    value.store (bits, std::memory_order_relaxed);
+}
+
+
+//////////////
+// Scraping //
+//////////////
+
+std::uint64_t Metrics::getTotal (const unsigned int slot)
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock { registry.mutex };
+
+    return sumSlot (registry, slot);
+}
+
+
+double Metrics::getRealTotal (const unsigned int slot)
+{
+    auto& registry = getRegistry();
+    auto  total    = 0.0;
+
+    std::lock_guard<std::mutex> lock { registry.mutex };
+
+    for (const auto& shard : registry.shards)
+    {
+        const auto bits = shard->slots[slot].load (std::memory_order_relaxed);
+        auto       real = 0.0;
+
+        std::memcpy (&real, &bits, sizeof (real));
+        total += real;
+    }
+
+    return total;
+}
+
+
+void Metrics::writeText (std::ostream& stream)
+{
+    auto& registry = getRegistry();
+
+    // Gauges are sampled without the lock held, a sample may well read a counter.
+    auto families = std::vector<Family> { };
+    auto totals   = std::vector<std::vector<double>> { };
+
+    {
+        std::lock_guard<std::mutex> lock { registry.mutex };
+        families = registry.families;
+
+        for (const auto& family : families)
+        {
+            auto values = std::vector<double> { };
+
+            if (family.type == MetricType::Counter)
+            {
+                values.push_back ((double) sumSlot (registry, family.first));
+            }
+
+            else if (family.type == MetricType::Histogram)
+            {
+                // Buckets are stored individually but written cumulatively.
+                auto cumulative = std::uint64_t (0);
+
+                for (auto bucket = 0U; bucket <= family.bounds.size(); ++bucket)
+                {
+                    cumulative += sumSlot (registry, family.first + bucket);
+                    values.push_back ((double) cumulative);
+                }
+            }
+
+            totals.push_back (std::move (values));
+        }
+    }
+
+    const auto escape = [] (const std::string& help)
+    {
+        auto escaped = std::string { };
+
+        for (const auto character : help)
+        {
+            if (character == '\\')
+            {
+                escaped += "\\\\";
+            }
+
+            else if (character == '\n')
+            {
+                escaped += "\\n";
+            }
+
+            else
+            {
+                escaped.push_back (character);
+            }
+        }
+
+        return escaped;
+    };
+
+    const char* const types[] = { "counter", "gauge", "histogram" };
+
+    for (auto i = 0U; i < families.size(); ++i)
+    {
+        const auto& family = families[i];
+        const auto& values = totals[i];
+
+        stream << "# HELP " << family.name << " " << escape (family.help) << "\n";
+        stream << "# TYPE " << family.name << " " << types[(size_t) family.type] << "\n";
+
+        if (family.type == MetricType::Counter)
+        {
+            stream << family.name << " ";
+            writeValue (stream, values.front());
+            stream << "\n";
+        }
+
+        else if (family.type == MetricType::Gauge)
+        {
+            for (auto series = 0U; series < family.samples.size(); ++series)
+            {
+                stream << family.name;
+
+                if (!family.labels[series].empty())
+                {
+                    stream << "{" << family.labels[series] << "}";
+                }
+
+                stream << " ";
+                writeValue (stream, family.samples[series]());
+                stream << "\n";
+            }
+        }
+
+        else
+        {
+            for (auto bucket = 0U; bucket < family.bounds.size(); ++bucket)
+            {
+                stream << family.name << "_bucket{le=\"";
+                writeValue (stream, family.bounds[bucket]);
+                stream << "\"} ";
+                writeValue (stream, values[bucket]);
+                stream << "\n";
+            }
+
+            stream << family.name << "_bucket{le=\"+Inf\"} ";
+            writeValue (stream, values.back());
+            stream << "\n" << family.name << "_sum ";
+            writeValue (stream, getRealTotal (family.first + (unsigned int) family.bounds.size() + 1));
+            stream << "\n" << family.name << "_count ";
+            writeValue (stream, values.back());
+            stream << "\n";
+        }
+    }
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+Metrics::Shard::Shard()
+{
+    for (auto& slot : slots)
+    {
+        slot.store (0, std::memory_order_relaxed);
+    }
+}
+
+
+Metrics::Registry& Metrics::getRegistry()
+{
+    // Metrics are registered by static handles, before any other thread could be started.
+    static Registry registry { };
+
+    return registry;
+}
+
+
+Metrics::Shard& Metrics::createShard()
+{
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lock { registry.mutex };
+
+    registry.shards.push_back (std::make_unique<Shard>());
+    localShard = registry.shards.back().get();
+
+    return *localShard;
+}
+
+
+Metrics::Family& Metrics::addFamily (Registry& registry, const std::string& name, const std::string& help, const MetricType type, const unsigned int slots)
+{
+    // Pre-condition: The name is valid in the text format.
+    assert (!name.empty() && name.find_first_not_of ("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_:") == std::string::npos);
+
+    for (const auto& family : registry.families)
+    {
+        if (family.name == name)
+        {
+            throw std::invalid_argument ("Metrics::addFamily(), a metric with the same name already exists. \"" + name + "\".");
+        }
+    }
+
+    if (registry.nextSlot + slots > slotCount)
+    {
+        throw std::length_error ("Metrics::addFamily(), every slot has been reserved. \"" + name + "\".");
+    }
+
+    auto family  = Family { };
+    family.name  = name;
+    family.help  = help;
+    family.type  = type;
+    family.first = registry.nextSlot;
+
+    registry.nextSlot += slots;
+    registry.families.push_back (std::move (family));
+
+    return registry.families.back();
+}
+
+
+std::uint64_t Metrics::sumSlot (const Registry& registry, const unsigned int slot)
+{
+    auto total = std::uint64_t (0);
+
+    for (const auto& shard : registry.shards)
+    {
+        total += shard->slots[slot].load (std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+
+void Metrics::writeValue (std::ostream& stream, const double value)
+{
+    if (std::isnan (value))
+    {
+        stream << "NaN";
+    }
+
+    else if (std::isinf (value))
+    {
+        stream << (value > 0.0 ? "+Inf" : "-Inf");
+    }
+
+    else
+    {
+        // Counts are exact up to this many digits, bounds such as 0.0005 stay readable.
+        const auto precision = stream.precision (std::numeric_limits<double>::digits10);
+        stream << value;
+        stream.precision (precision);
+    }
+}
+
+
+std::vector<MetricGauge> Metrics::addMemoryGauges()
+{
+    auto gauges = std::vector<MetricGauge> { };
+
+    for (auto i = 0U; i < (unsigned int) MemorySubsystem::Count; ++i)
+    {
+        const auto subsystem = (MemorySubsystem) i;
+        const auto labels    = std::string ("subsystem=\"") + MemoryTracker::getName (subsystem) + "\"";
+
+        gauges.push_back (addGauge ("memory_bytes", "The bytes currently allocated by each subsystem.", labels,
+                                    [=] { return (double) MemoryTracker::getUsage (subsystem).current; }));
+
+        gauges.push_back (addGauge ("memory_peak_bytes", "The most bytes allocated at once by each subsystem since the peaks were last reset.", labels,
+                                    [=] { return (double) MemoryTracker::getUsage (subsystem).peak; }));
+    }
+
+    return gauges;
+}
+
+
+/////////////////////
+// MetricHistogram //
+/////////////////////
+
+std::uint64_t MetricHistogram::getCount() const
+{
+    auto count = std::uint64_t (0);
+
+    for (auto bucket = 0U; bucket <= m_bounds.size(); ++bucket)
+    {
+        count += Metrics::getTotal (m_first + bucket);
+    }
+
+    return count;
+}
\ No newline at end of file
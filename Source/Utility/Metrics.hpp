@@ -0,0 +1,257 @@
+#ifndef GEC_METRICS_HPP
+#define GEC_METRICS_HPP
+
+
+// STL headers.
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Thread-local storage, Visual Studio 2013 only supports it through its own keyword.
+#if defined (_MSC_VER) && _MSC_VER < 1900
+    #define GEC_THREAD_LOCAL __declspec (thread)
+#else
+    #define GEC_THREAD_LOCAL thread_local
+#endif
+
+
+// Forward declarations.
+class MetricCounter;
+class MetricGauge;
+class MetricHistogram;
+
+
+/// <summary>
+/// The kinds of metric which can be registered, named as they are in the Prometheus text format.
+/// </summary>
+enum class MetricType : char
+{
+    Counter,    //!< A total which only ever increases.
+    Gauge,      //!< A value sampled when scraped, which can go up and down.
+    Histogram   //!< Observations counted into buckets, along with their sum and count.
+};
+
+
+/// <summary>
+/// A process-wide registry of metrics for monitoring long-running planners. Each thread records into its own shard of
+/// slots, a slot only ever has a single writer so recording is a relaxed load and store with no locking and no shared
+/// cache lines. Scraping sums the slot across every shard, it only locks against registration and new threads so the
+/// hot path never waits for a scrape. Shards are kept when their thread exits so totals never go backwards.
+/// </summary>
+class Metrics final
+{
+    public:
+
+        Metrics() = delete;
+
+        /// <summary> The number of slots in every shard, each counter takes one and each histogram two more than its buckets. </summary>
+        static const unsigned int slotCount = 512;
+
+
+        //////////////////
+        // Registration //
+        //////////////////
+
+        /// <summary> Registers a counter, this is usually done once when a static handle is initialised. </summary>
+        /// <param name="name"> The name of the metric, counters should end in "_total". </param>
+        /// <param name="help"> A description of the metric. </param>
+        static MetricCounter addCounter (const std::string& name, const std::string& help);
+
+        /// <summary> Registers a histogram with the given upper bucket bounds, a final +Inf bucket is added. </summary>
+        /// <param name="bounds"> The inclusive upper bound of each bucket in ascending order. </param>
+        static MetricHistogram addHistogram (const std::string& name, const std::string& help, std::vector<double> bounds);
+
+        /// <summary> Registers a gauge which is sampled whenever the metrics are scraped. </summary>
+        /// <param name="labels"> The labels of this series such as subsystem="tree_nodes", gauges sharing a name must differ in labels. </param>
+        /// <param name="sample"> Called on the scraping thread to obtain the value, it must be safe to call at any time. </param>
+        static MetricGauge addGauge (const std::string& name, const std::string& help, const std::string& labels, std::function<double()> sample);
+
+
+        ///////////////
+        // Recording //
+        ///////////////
+
+        /// <summary> Adds to a slot of the calling thread's shard. </summary>
+        static void add (const unsigned int slot, const std::uint64_t amount)
+        {
+            auto& value = obtainShard().slots[slot];
+            value.store (value.load (std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        /// <summary> Adds to a slot of the calling thread's shard which holds the bits of a double. </summary>
+        static void addReal (const unsigned int slot, const double amount);
+
+
+        //////////////
+        // Scraping //
+        //////////////
+
+        /// <summary> Sums a slot across every shard. </summary>
+        static std::uint64_t getTotal (const unsigned int slot);
+
+        /// <summary> Sums a slot holding the bits of a double across every shard. </summary>
+        static double getRealTotal (const unsigned int slot);
+
+        /// <summary> Writes every metric in the Prometheus text exposition format. </summary>
+        static void writeText (std::ostream& stream);
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> The slots written by a single thread, padded so neighbouring shards never share a cache line. </summary>
+        struct Shard final
+        {
+            Shard();
+
+            std::array<std::uint64_t, 8>                        before; //!< Padding before the slots.
+            std::array<std::atomic<std::uint64_t>, slotCount>   slots;  //!< The value of each slot.
+            std::array<std::uint64_t, 8>                        after;  //!< Padding after the slots.
+        };
+
+        /// <summary> A metric as it appears in the text format, gauges sharing a name are a single family. </summary>
+        struct Family final
+        {
+            std::string                             name    { };    //!< The name of the metric.
+            std::string                             help    { };    //!< A description of the metric.
+            MetricType                              type    { };    //!< The kind of metric.
+            unsigned int                            first   { 0 };  //!< The first slot used by a counter or histogram.
+            std::vector<double>                     bounds  { };    //!< The upper bound of each histogram bucket, excluding +Inf.
+            std::vector<std::string>                labels  { };    //!< The labels of each gauge series.
+            std::vector<std::function<double()>>    samples { };    //!< Obtains the value of each gauge series.
+        };
+
+        /// <summary> Everything which is shared between threads, guarded by the mutex. </summary>
+        struct Registry final
+        {
+            std::mutex                          mutex       { };    //!< Guards the rest of the registry.
+            std::vector<std::unique_ptr<Shard>> shards      { };    //!< The shard of every thread which has recorded a metric.
+            std::vector<Family>                 families    { };    //!< Every registered metric in registration order.
+            unsigned int                        nextSlot    { 0 };  //!< The first slot which hasn't been reserved.
+        };
+
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Gets the registry, it's created on first use so metrics can be registered during static initialisation. </summary>
+        static Registry& getRegistry();
+
+        /// <summary> Gets the shard of the calling thread, creating it on the first call from each thread. </summary>
+        static Shard& obtainShard()                 { return localShard ? *localShard : createShard(); }
+
+        /// <summary> Creates and registers a shard for the calling thread. </summary>
+        static Shard& createShard();
+
+        /// <summary> Adds a family, reserving the given number of slots for it. The registry must already be locked. </summary>
+        static Family& addFamily (Registry& registry, const std::string& name, const std::string& help, const MetricType type, const unsigned int slots);
+
+        /// <summary> Sums a slot across every shard. The registry must already be locked. </summary>
+        static std::uint64_t sumSlot (const Registry& registry, const unsigned int slot);
+
+        /// <summary> Writes a value as the text format expects, including infinities and NaN. </summary>
+        static void writeValue (std::ostream& stream, const double value);
+
+        /// <summary> Registers the current and peak usage of every MemoryTracker subsystem as gauges. </summary>
+        static std::vector<MetricGauge> addMemoryGauges();
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        static GEC_THREAD_LOCAL Shard*          localShard;     //!< The shard of the calling thread, nullptr until it records a metric.
+        static const std::vector<MetricGauge>   memoryGauges;   //!< The gauges reporting the memory of each subsystem.
+};
+
+
+/// <summary>
+/// A handle to a registered counter. Handles are cheap to copy and are usually kept as static members of the class
+/// being measured.
+/// </summary>
+class MetricCounter final
+{
+    public:
+
+        MetricCounter (const unsigned int slot)
+            : m_slot (slot) {}
+
+        /// <summary> Increases the counter on the calling thread. </summary>
+        void increment (const std::uint64_t amount = 1) const  { Metrics::add (m_slot, amount); }
+
+        /// <summary> Gets the total across every thread. </summary>
+        std::uint64_t getTotal() const                          { return Metrics::getTotal (m_slot); }
+
+    private:
+
+        unsigned int m_slot { 0 };  //!< The slot holding the counter.
+};
+
+
+/// <summary>
+/// A handle to a registered gauge, the value is only ever sampled so there is nothing to record.
+/// </summary>
+class MetricGauge final
+{
+    public:
+
+        MetricGauge (std::function<double()> sample)
+            : m_sample (std::move (sample)) {}
+
+        /// <summary> Samples the gauge. </summary>
+        double getValue() const { return m_sample(); }
+
+    private:
+
+        std::function<double()> m_sample { };   //!< Obtains the value of the gauge.
+};
+
+
+/// <summary>
+/// A handle to a registered histogram. Buckets are searched linearly since histograms only have a handful of them.
+/// </summary>
+class MetricHistogram final
+{
+    public:
+
+        MetricHistogram (const unsigned int first, std::vector<double> bounds)
+            : m_first (first), m_bounds (std::move (bounds)) {}
+
+        /// <summary> Records an observation on the calling thread. </summary>
+        void observe (const double value) const
+        {
+            auto bucket = 0U;
+
+            while (bucket < m_bounds.size() && value > m_bounds[bucket])
+            {
+                ++bucket;
+            }
+
+            Metrics::add (m_first + bucket, 1);
+            Metrics::addReal (m_first + (unsigned int) m_bounds.size() + 1, value);
+        }
+
+        /// <summary> Gets the number of observations across every thread. </summary>
+        std::uint64_t getCount() const;
+
+        /// <summary> Gets the sum of every observation across every thread. </summary>
+        double getSum() const   { return Metrics::getRealTotal (m_first + (unsigned int) m_bounds.size() + 1); }
+
+    private:
+
+        unsigned int        m_first     { 0 };  //!< The slot of the first bucket, the sum follows the +Inf bucket.
+        std::vector<double> m_bounds    { };    //!< The upper bound of each bucket, excluding +Inf.
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "MetricsServer.hpp"
+
+
+// STL headers.
+#include <sstream>
+#include <stdexcept>
+
+
+// Application headers.
+#include <Utility/Metrics.hpp>
+
+
+// Platform headers.
+#if defined (_WIN32)
+    #define NOMINMAX
+    #include <WinSock2.h>
+    #include <WS2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <netinet/in.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+MetricsServer::MetricsServer (const unsigned short port)
+{
+    #if defined (_WIN32)
+        auto startup = WSADATA { };
+
+        if (WSAStartup (MAKEWORD (2, 2), &startup) != 0)
+        {
+            throw std::runtime_error ("MetricsServer::MetricsServer(), unable to start Windows Sockets. \"" + std::to_string (port) + "\".");
+        }
+    #endif
+
+    const auto listener = socket (AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+    #if !defined (_WIN32)
+        // Restarting straight after a scrape would otherwise find the port still held by the closed connection.
+        const auto reuse = 1;
+        setsockopt (listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof (reuse));
+    #endif
+
+    m_listener = (std::intptr_t) listener;
+
+    // Binding to the loopback interface keeps every other machine out without having to check each connection.
+    auto address            = sockaddr_in { };
+    address.sin_family      = AF_INET;
+    address.sin_port        = htons (port);
+    address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+    auto length = (socklen_t) sizeof (address);
+
+    if (m_listener == invalidSocket || 
+        bind (listener, reinterpret_cast<const sockaddr*> (&address), sizeof (address)) != 0 ||
+        listen (listener, SOMAXCONN) != 0 ||
+        getsockname (listener, reinterpret_cast<sockaddr*> (&address), &length) != 0)
+    {
+        closeSocket (m_listener);
+
+        #if defined (_WIN32)
+            WSACleanup();
+        #endif
+
+        throw std::runtime_error ("MetricsServer::MetricsServer(), unable to listen on the port. \"" + std::to_string (port) + "\".");
+    }
+
+    m_port   = ntohs (address.sin_port);
+    m_thread = std::thread (&MetricsServer::serve, this);
+}
+
+
+MetricsServer::~MetricsServer()
+{
+    // The serving thread notices within one wait for a connection.
+    m_stopping = true;
+    m_thread.join();
+    closeSocket (m_listener);
+
+    #if defined (_WIN32)
+        WSACleanup();
+    #endif
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+void MetricsServer::serve()
+{
+    while (!m_stopping)
+    {
+        // Waiting with a timeout lets the destructor stop the thread without closing the socket underneath it.
+        if (waitForData (m_listener, 100))
+        {
+            const auto client = acceptClient (m_listener);
+
+            if (client != invalidSocket)
+            {
+                respond (client);
+                closeSocket (client);
+            }
+        }
+    }
+}
+
+
+void MetricsServer::respond (const std::intptr_t client)
+{
+    // Read until the end of the headers, nothing after the request line matters and there is never a body.
+    const auto maximumSize = 8192U;
+    const auto timeout     = 2000U;
+
+    auto request = std::string { };
+    char buffer[1024];
+
+    while (request.find ("\r\n\r\n") == std::string::npos && request.find ("\n\n") == std::string::npos)
+    {
+        // A client which stalls or floods us is dropped rather than holding up the next scrape.
+        const auto received = request.size() <= maximumSize && waitForData (client, timeout) ? receive (client, buffer, sizeof (buffer)) : 0;
+
+        if (received == 0)
+        {
+            return;
+        }
+
+        request.append (buffer, received);
+    }
+
+    // Only the request line is needed, such as "GET /metrics HTTP/1.1".
+    auto line   = std::istringstream (request.substr (0, request.find_first_of ("\r\n")));
+    auto method = std::string { },
+         target = std::string { };
+
+    line >> method >> target;
+
+    // Any query string is ignored.
+    target = target.substr (0, target.find ('?'));
+
+    if (method != "GET")
+    {
+        sendResponse (client, "405 Method Not Allowed", "Only GET is supported.\n");
+    }
+
+    else if (target != "/metrics" && target != "/")
+    {
+        sendResponse (client, "404 Not Found", "Metrics are served at /metrics.\n");
+    }
+
+    else
+    {
+        auto body = std::ostringstream { };
+        Metrics::writeText (body);
+
+        sendResponse (client, "200 OK", body.str());
+        ++m_scrapes;
+    }
+}
+
+
+void MetricsServer::sendResponse (const std::intptr_t client, const std::string& status, const std::string& body)
+{
+    auto response = std::ostringstream { };
+
+    response    << "HTTP/1.1 " << status << "\r\n"
+                << "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                << "Content-Length: " << body.size() << "\r\n"
+                << "Connection: close\r\n\r\n"
+                << body;
+
+    // A client which has gone away doesn't need telling.
+    send (client, response.str());
+}
+
+
+/////////////
+// Sockets //
+/////////////
+
+bool MetricsServer::waitForData (const std::intptr_t socket, const unsigned int milliseconds)
+{
+    auto set = fd_set { };
+    FD_ZERO (&set);
+    FD_SET (socket, &set);
+
+    auto timeout    = timeval { };
+    timeout.tv_sec  = (long) (milliseconds / 1000);
+    timeout.tv_usec = (long) (milliseconds % 1000) * 1000;
+
+    // Windows ignores the first parameter, everywhere else it's one more than the highest descriptor.
+    return select ((int) socket + 1, &set, nullptr, nullptr, &timeout) > 0;
+}
+
+
+#if defined (_WIN32)
+
+std::intptr_t MetricsServer::acceptClient (const std::intptr_t listener)
+{
+    const auto client = accept ((SOCKET) listener, nullptr, nullptr);
+    return client == INVALID_SOCKET ? invalidSocket : (std::intptr_t) client;
+}
+
+
+size_t MetricsServer::receive (const std::intptr_t socket, char* buffer, const size_t size)
+{
+    const auto received = recv ((SOCKET) socket, buffer, (int) size, 0);
+    return received > 0 ? (size_t) received : 0;
+}
+
+
+void MetricsServer::send (const std::intptr_t socket, const std::string& text)
+{
+    for (auto sent = size_t (0); sent < text.size();)
+    {
+        const auto result = ::send ((SOCKET) socket, text.data() + sent, (int) (text.size() - sent), 0);
+
+        if (result <= 0)
+        {
+            return;
+        }
+
+        sent += (size_t) result;
+    }
+}
+
+
+void MetricsServer::closeSocket (const std::intptr_t socket)
+{
+    if (socket != invalidSocket)
+    {
+        closesocket ((SOCKET) socket);
+    }
+}
+
+#else
+
+std::intptr_t MetricsServer::acceptClient (const std::intptr_t listener)
+{
+    const auto client = accept ((int) listener, nullptr, nullptr);
+    return client < 0 ? invalidSocket : (std::intptr_t) client;
+}
+
+
+size_t MetricsServer::receive (const std::intptr_t socket, char* buffer, const size_t size)
+{
+    const auto received = recv ((int) socket, buffer, size, 0);
+    return received > 0 ? (size_t) received : 0;
+}
+
+
+void MetricsServer::send (const std::intptr_t socket, const std::string& text)
+{
+    for (auto sent = size_t (0); sent < text.size();)
+    {
+        // A client which hangs up mustn't raise SIGPIPE and take the planner down with it.
+        const auto result = ::send ((int) socket, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+
+        if (result <= 0)
+        {
+            return;
+        }
+
+        sent += (size_t) result;
+    }
+}
+
+
+void MetricsServer::closeSocket (const std::intptr_t socket)
+{
+    if (socket != invalidSocket)
+    {
+        close ((int) socket);
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+#ifndef GEC_METRICS_SERVER_HPP
+#define GEC_METRICS_SERVER_HPP
+
+
+// STL headers.
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+
+/// <summary>
+/// Serves the Metrics registry over HTTP so Prometheus can scrape a running planner. The server runs on its own thread
+/// and answers one request at a time, each scrape only sums the shards of the registry so planning threads carry on
+/// undisturbed. Only the loopback interface is listened on so nothing outside of the local machine can connect. The
+/// sockets of the platform are used directly as it's the only networking the planner needs.
+/// </summary>
+class MetricsServer final
+{
+    public:
+
+        /// <summary> The port registered for this kind of exporter. </summary>
+        static const unsigned short defaultPort = 9464;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Starts listening on the given port of the loopback interface and starts the serving thread. </summary>
+        /// <param name="port"> The port to listen on, zero lets the system choose one. </param>
+        MetricsServer (const unsigned short port = defaultPort);
+
+        /// <summary> Stops listening and waits for the serving thread to finish. </summary>
+        ~MetricsServer();
+
+        MetricsServer (MetricsServer&& move)                    = delete;
+        MetricsServer& operator= (MetricsServer&& move)         = delete;
+        MetricsServer (const MetricsServer& copy)               = delete;
+        MetricsServer& operator= (const MetricsServer& copy)    = delete;
+
+
+        /////////////
+        // Getters //
+        /////////////
+
+        /// <summary> Gets the port being listened on. </summary>
+        unsigned short getPort() const                  { return m_port; }
+
+        /// <summary> Gets how many times the metrics have been served. </summary>
+        unsigned long long getScrapeCount() const       { return m_scrapes.load(); }
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Accepts connections until the server is stopped. </summary>
+        void serve();
+
+        /// <summary> Reads a single request from a client and sends the response. </summary>
+        void respond (const std::intptr_t client);
+
+        /// <summary> Sends a complete HTTP response, the connection is closed afterwards. </summary>
+        static void sendResponse (const std::intptr_t client, const std::string& status, const std::string& body);
+
+
+        /////////////
+        // Sockets //
+        /////////////
+
+        /// <summary> Waits for a socket to have data to read, or a connection to accept. </summary>
+        /// <returns> Whether the socket is ready before the timeout. </returns>
+        static bool waitForData (const std::intptr_t socket, const unsigned int milliseconds);
+
+        /// <summary> Accepts a waiting connection. </summary>
+        /// <returns> The connected socket, or invalidSocket if the connection failed. </returns>
+        static std::intptr_t acceptClient (const std::intptr_t listener);
+
+        /// <summary> Reads whatever data has arrived on a socket. </summary>
+        /// <returns> The number of bytes read, zero once the connection has closed or failed. </returns>
+        static size_t receive (const std::intptr_t socket, char* buffer, const size_t size);
+
+        /// <summary> Sends every byte of the given text, giving up if the connection fails. </summary>
+        static void send (const std::intptr_t socket, const std::string& text);
+
+        /// <summary> Closes a socket if it's valid. </summary>
+        static void closeSocket (const std::intptr_t socket);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        /// <summary> INVALID_SOCKET on Windows and an invalid descriptor elsewhere. </summary>
+        static const std::intptr_t invalidSocket = -1;
+
+        std::intptr_t                   m_listener  { invalidSocket };  //!< Listens for scrapes, a SOCKET on Windows or a descriptor elsewhere.
+        unsigned short                  m_port      { 0 };              //!< The port being listened on.
+        std::atomic<bool>               m_stopping  { false };          //!< Whether the serving thread should exit.
+        std::atomic<unsigned long long> m_scrapes   { 0 };              //!< How many times the metrics have been served.
+        std::thread                     m_thread    { };                //!< Runs serve().
+};
+
+#endif
\ No newline at end of file
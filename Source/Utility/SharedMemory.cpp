@@ -0,0 +1,234 @@
+#include "SharedMemory.hpp"
+
+
+// STL headers.
+#include <cassert>
+#include <stdexcept>
+
+
+// Platform headers.
+#if defined (_WIN32)
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+#if defined (_WIN32)
+
+SharedMemory::SharedMemory (const std::string& name, const size_t bytes)
+    : m_name (name), m_bytes (bytes), m_owner (true)
+{
+    const auto system = determineSystemName (name);
+    const auto size   = (unsigned long long) bytes;
+
+    m_handle = CreateFileMappingA (INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, (DWORD) (size >> 32), (DWORD) size, system.c_str());
+
+    // Windows removes a mapping once every handle is closed, so an existing one is still in use and can't be replaced.
+    if (!m_handle || GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        if (m_handle)
+        {
+            CloseHandle (m_handle);
+        }
+
+        throw std::runtime_error ("SharedMemory::SharedMemory(), unable to create the segment. \"" + name + "\".");
+    }
+
+    m_memory = MapViewOfFile (m_handle, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+
+    if (!m_memory)
+    {
+        CloseHandle (m_handle);
+        throw std::runtime_error ("SharedMemory::SharedMemory(), unable to map the segment. \"" + name + "\".");
+    }
+}
+
+
+SharedMemory::SharedMemory (const std::string& name)
+    : m_name (name)
+{
+    const auto system = determineSystemName (name);
+
+    m_handle = OpenFileMappingA (FILE_MAP_READ, FALSE, system.c_str());
+
+    if (!m_handle)
+    {
+        throw std::runtime_error ("SharedMemory::SharedMemory(), the segment doesn't exist. \"" + name + "\".");
+    }
+
+    m_memory = MapViewOfFile (m_handle, FILE_MAP_READ, 0, 0, 0);
+
+    if (!m_memory)
+    {
+        CloseHandle (m_handle);
+        throw std::runtime_error ("SharedMemory::SharedMemory(), unable to map the segment. \"" + name + "\".");
+    }
+
+    // The size of the mapping isn't stored so use the size of the region we were given.
+    auto information = MEMORY_BASIC_INFORMATION { };
+    VirtualQuery (m_memory, &information, sizeof (information));
+    m_bytes = information.RegionSize;
+}
+
+
+SharedMemory::~SharedMemory()
+{
+    UnmapViewOfFile (m_memory);
+    CloseHandle (m_handle);
+}
+
+#else
+
+SharedMemory::SharedMemory (const std::string& name, const size_t bytes)
+    : m_name (name), m_bytes (bytes), m_owner (true)
+{
+    const auto system = determineSystemName (name);
+
+    // An existing segment can't be told apart from one left behind by a publisher which crashed, so it's never replaced
+    // as that would pull the name out from under a live publisher. This matches Windows.
+    const auto descriptor = shm_open (system.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+
+    if (descriptor < 0 && errno == EEXIST)
+    {
+        throw std::runtime_error ("SharedMemory::SharedMemory(), a segment with this name already exists, remove it if its publisher has exited. \"" + name + "\".");
+    }
+
+    if (descriptor < 0)
+    {
+        throw std::runtime_error ("SharedMemory::SharedMemory(), unable to create the segment. \"" + name + "\".");
+    }
+
+    // Remember which object we created so the destructor never removes a segment which replaced ours.
+    struct stat status;
+
+    if (fstat (descriptor, &status) == 0)
+    {
+        m_device = (unsigned long long) status.st_dev;
+        m_inode  = (unsigned long long) status.st_ino;
+    }
+
+    if (ftruncate (descriptor, (off_t) bytes) != 0)
+    {
+        close (descriptor);
+        shm_unlink (system.c_str());
+        throw std::runtime_error ("SharedMemory::SharedMemory(), unable to size the segment. \"" + name + "\".");
+    }
+
+    // The mapping remains valid once the descriptor is closed.
+    const auto memory = mmap (nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+    close (descriptor);
+
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink (system.c_str());
+        throw std::runtime_error ("SharedMemory::SharedMemory(), unable to map the segment. \"" + name + "\".");
+    }
+
+    m_memory = memory;
+}
+
+
+SharedMemory::SharedMemory (const std::string& name)
+    : m_name (name)
+{
+    const auto system     = determineSystemName (name);
+    const auto descriptor = shm_open (system.c_str(), O_RDONLY, 0);
+
+    if (descriptor < 0)
+    {
+        throw std::runtime_error ("SharedMemory::SharedMemory(), the segment doesn't exist. \"" + name + "\".");
+    }
+
+    struct stat status;
+
+    if (fstat (descriptor, &status) != 0 || status.st_size <= 0)
+    {
+        close (descriptor);
+        throw std::runtime_error ("SharedMemory::SharedMemory(), the segment is empty. \"" + name + "\".");
+    }
+
+    m_bytes = (size_t) status.st_size;
+
+    const auto memory = mmap (nullptr, m_bytes, PROT_READ, MAP_SHARED, descriptor, 0);
+    close (descriptor);
+
+    if (memory == MAP_FAILED)
+    {
+        throw std::runtime_error ("SharedMemory::SharedMemory(), unable to map the segment. \"" + name + "\".");
+    }
+
+    m_memory = memory;
+}
+
+
+SharedMemory::~SharedMemory()
+{
+    munmap (m_memory, m_bytes);
+
+    if (m_owner)
+    {
+        // The name may have been removed and used again by someone else, only our own object is unlinked.
+        const auto system     = determineSystemName (m_name);
+        const auto descriptor = shm_open (system.c_str(), O_RDONLY, 0);
+
+        if (descriptor >= 0)
+        {
+            struct stat status;
+            const auto  ours = fstat (descriptor, &status) == 0 && 
+                               (unsigned long long) status.st_dev == m_device && (unsigned long long) status.st_ino == m_inode;
+
+            close (descriptor);
+
+            if (ours)
+            {
+                shm_unlink (system.c_str());
+            }
+        }
+    }
+}
+
+#endif
+
+
+/////////////////////////
+// Getters and setters //
+/////////////////////////
+
+void* SharedMemory::getData()
+{
+    // Pre-condition: Only the owner mapped the segment as writable.
+    assert (m_owner);
+
+    return m_memory;
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+std::string SharedMemory::determineSystemName (const std::string& name)
+{
+    // Slashes would be treated as directories, or a namespace on Windows.
+    if (name.empty() || name.find_first_of ("/\\") != std::string::npos)
+    {
+        throw std::invalid_argument ("SharedMemory::determineSystemName(), segment names can't be empty or contain slashes. \"" + name + "\".");
+    }
+
+    #if defined (_WIN32)
+        return "Local\\" + name;
+    #else
+        return "/" + name;
+    #endif
+}
\ No newline at end of file
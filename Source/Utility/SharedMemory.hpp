@@ -0,0 +1,84 @@
+#ifndef GEC_SHARED_MEMORY_HPP
+#define GEC_SHARED_MEMORY_HPP
+
+
+// STL headers.
+#include <cstddef>
+#include <string>
+
+
+/// <summary>
+/// A named block of memory which can be mapped by several processes at once. The process which creates the segment
+/// owns the name and removes it when the segment is destroyed, processes which have already opened it keep their
+/// mapping until they destroy their own segment. On Linux this is a POSIX shared memory object, on Windows it is a
+/// file mapping backed by the page file.
+/// </summary>
+class SharedMemory final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates a writable segment, an exception is thrown if the name is already in use or it can't be created. </summary>
+        /// <param name="name"> The name of the segment, this must not contain any slashes. </param>
+        /// <param name="bytes"> The size of the segment, it starts off zeroed. </param>
+        SharedMemory (const std::string& name, const size_t bytes);
+
+        /// <summary> Opens an existing segment read-only. Exceptions can be thrown. </summary>
+        /// <param name="name"> The name the segment was created with. </param>
+        explicit SharedMemory (const std::string& name);
+
+        /// <summary> Unmaps the segment, removing its name if we created it and it still refers to our segment. </summary>
+        ~SharedMemory();
+
+        SharedMemory (SharedMemory&& move)                  = delete;
+        SharedMemory& operator= (SharedMemory&& move)       = delete;
+        SharedMemory (const SharedMemory& copy)             = delete;
+        SharedMemory& operator= (const SharedMemory& copy)  = delete;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the name of the segment. </summary>
+        const std::string& getName() const  { return m_name; }
+
+        /// <summary> Gets the size of the mapping in bytes, on Windows this is rounded up to a whole page when opened. </summary>
+        size_t getBytes() const             { return m_bytes; }
+
+        /// <summary> Checks whether this process created the segment and can therefore write to it. </summary>
+        bool isOwner() const                { return m_owner; }
+
+        /// <summary> Gets the start of the mapping, this is aligned to a page. </summary>
+        const void* getData() const         { return m_memory; }
+
+        /// <summary> Gets the start of the mapping for writing, only the owner may do this. </summary>
+        void* getData();
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Converts a segment name into the name the operating system expects. </summary>
+        static std::string determineSystemName (const std::string& name);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::string         m_name      { };            //!< The name of the segment.
+        void*               m_memory    { nullptr };    //!< The start of the mapping.
+        size_t              m_bytes     { 0 };          //!< The size of the mapping.
+        bool                m_owner     { false };      //!< Whether this process created the segment.
+        void*               m_handle    { nullptr };    //!< The file mapping handle on Windows, unused elsewhere.
+        unsigned long long  m_device    { 0 };          //!< The device of the object we created, unused on Windows.
+        unsigned long long  m_inode     { 0 };          //!< The inode of the object we created, unused on Windows.
+};
+
+#endif
\ No newline at end of file
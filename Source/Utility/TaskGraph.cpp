@@ -0,0 +1,204 @@
+#include "TaskGraph.hpp"
+
+
+// STL headers.
+#include <cassert>
+#include <utility>
+
+
+// Application headers.
+#include <Utility/ThreadPool.hpp>
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+TaskGraph::TaskGraph (ThreadPool* const pool)
+    : m_pool (pool)
+{
+}
+
+
+TaskGraph::~TaskGraph()
+{
+    // The pool may still be running our tasks.
+    awaitScheduled();
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+TaskGraph::Task TaskGraph::addTask (std::function<void()> work, const std::vector<Task>& dependencies)
+{
+    std::lock_guard<std::mutex> lock { m_mutex };
+
+    const auto task = (Task) m_nodes.size();
+
+    // Dependencies must already exist, this also guarantees the graph can't contain cycles.
+    for (const auto dependency : dependencies)
+    {
+        assert (dependency < task);
+        m_nodes[dependency].dependents.push_back (task);
+    }
+
+    m_nodes.emplace_back();
+    m_nodes.back().work         = std::move (work);
+    m_nodes.back().dependencies = dependencies;
+
+    return task;
+}
+
+
+void TaskGraph::schedule (const Task task)
+{
+    std::unique_lock<std::mutex> lock { m_mutex };
+    scheduleLocked (task, lock);
+}
+
+
+void TaskGraph::await (const Task task)
+{
+    std::unique_lock<std::mutex> lock { m_mutex };
+    scheduleLocked (task, lock);
+
+    m_finished.wait (lock, [&] () { return m_nodes[task].state == State::Finished; });
+
+    if (m_nodes[task].error)
+    {
+        std::rethrow_exception (m_nodes[task].error);
+    }
+}
+
+
+void TaskGraph::awaitScheduled()
+{
+    std::unique_lock<std::mutex> lock { m_mutex };
+    m_finished.wait (lock, [this] () { return m_active == 0; });
+}
+
+
+bool TaskGraph::isFinished (const Task task) const
+{
+    std::lock_guard<std::mutex> lock { m_mutex };
+    return m_nodes[task].state == State::Finished;
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+void TaskGraph::scheduleLocked (const Task task, std::unique_lock<std::mutex>& lock)
+{
+    // Pre-condition: The task exists.
+    assert (task < m_nodes.size());
+
+    if (m_nodes[task].state == State::Idle)
+    {
+        // Dependencies always have a lower index so scheduling them can never reach this task again. We stay idle
+        // whilst doing so because dependencies ran without a pool finish immediately and only release waiting tasks.
+        for (const auto dependency : m_nodes[task].dependencies)
+        {
+            scheduleLocked (dependency, lock);
+        }
+
+        // Only count the dependencies which are still outstanding, the rest will release us as they finish.
+        auto& node   = m_nodes[task];
+        node.state   = State::Waiting;
+        node.pending = 0;
+        ++m_active;
+
+        for (const auto dependency : node.dependencies)
+        {
+            if (m_nodes[dependency].state != State::Finished)
+            {
+                ++node.pending;
+            }
+
+            else if (m_nodes[dependency].error && !node.error)
+            {
+                node.error = m_nodes[dependency].error;
+            }
+        }
+
+        if (node.pending == 0)
+        {
+            start (task, lock);
+        }
+    }
+}
+
+
+void TaskGraph::start (const Task task, std::unique_lock<std::mutex>& lock)
+{
+    m_nodes[task].state = State::Running;
+
+    if (m_pool)
+    {
+        m_pool->push ([this, task] () { run (task); });
+    }
+
+    // Without a pool the caller does the work, we can't hold the lock whilst doing so.
+    else
+    {
+        lock.unlock();
+        run (task);
+        lock.lock();
+    }
+}
+
+
+void TaskGraph::run (const Task task)
+{
+    // The node collection never changes size once tasks are running so the work can be accessed without the lock.
+    auto error = std::exception_ptr { };
+
+    if (!m_nodes[task].error)
+    {
+        try
+        {
+            m_nodes[task].work();
+        }
+
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+    }
+
+    // Release any dependents which were waiting on us.
+    std::unique_lock<std::mutex> lock { m_mutex };
+    auto& node = m_nodes[task];
+
+    if (error)
+    {
+        node.error = error;
+    }
+
+    node.state = State::Finished;
+    --m_active;
+
+    for (const auto dependent : node.dependents)
+    {
+        auto& waiting = m_nodes[dependent];
+
+        if (waiting.state == State::Waiting)
+        {
+            if (node.error && !waiting.error)
+            {
+                waiting.error = node.error;
+            }
+
+            if (--waiting.pending == 0)
+            {
+                start (dependent, lock);
+            }
+        }
+    }
+
+    m_finished.notify_all();
+}
\ No newline at end of file
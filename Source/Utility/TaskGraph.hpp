@@ -0,0 +1,132 @@
+#ifndef GEC_TASK_GRAPH_HPP
+#define GEC_TASK_GRAPH_HPP
+
+
+// STL headers.
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+
+// Forward declarations.
+class ThreadPool;
+
+
+/// <summary>
+/// A small graph of tasks with dependencies between them. Tasks are only ran once they're scheduled and every task
+/// they depend on has finished, so only the work that is actually needed gets done.
+/// </summary>
+class TaskGraph final
+{
+    public:
+
+        ///////////// 
+        // Aliases //
+        /////////////
+
+        /// <summary> An identifier for a task in the graph. </summary>
+        using Task = unsigned int;
+
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Creates an empty graph which runs tasks on the given pool. </summary>
+        /// <param name="pool"> The pool to run tasks on, if this is nullptr tasks will be ran by whoever awaits them. </param>
+        TaskGraph (ThreadPool* const pool = nullptr);
+
+        /// <summary> Waits for every scheduled task to finish. </summary>
+        ~TaskGraph();
+
+        TaskGraph (TaskGraph&& move)                    = delete;
+        TaskGraph& operator= (TaskGraph&& move)         = delete;
+        TaskGraph (const TaskGraph& copy)               = delete;
+        TaskGraph& operator= (const TaskGraph& copy)    = delete;
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Adds a task to the graph, this won't run until it is scheduled. </summary>
+        /// <param name="work"> The work to perform. </param>
+        /// <param name="dependencies"> Every task which must finish before this task can start. </param>
+        /// <returns> The identifier of the new task. </returns>
+        Task addTask (std::function<void()> work, const std::vector<Task>& dependencies = { });
+
+        /// <summary> Schedules a task and everything it depends on, this returns immediately. </summary>
+        /// <param name="task"> The task to schedule. </param>
+        void schedule (const Task task);
+
+        /// <summary> Schedules a task if necessary and waits for it to finish. Exceptions thrown by the task are rethrown. </summary>
+        /// <param name="task"> The task to wait for. </param>
+        void await (const Task task);
+
+        /// <summary> Waits for every task which has been scheduled to finish. </summary>
+        void awaitScheduled();
+
+        /// <summary> Checks if the given task has finished running. </summary>
+        bool isFinished (const Task task) const;
+
+    private:
+
+        ///////////
+        // Types //
+        ///////////
+
+        /// <summary> The progress of a task. </summary>
+        enum class State : char
+        {
+            Idle,       //!< The task hasn't been scheduled.
+            Waiting,    //!< The task is waiting for its dependencies.
+            Running,    //!< The task has been queued or is running.
+            Finished    //!< The task is complete.
+        };
+
+        /// <summary> A task along with its position in the graph. </summary>
+        struct Node final
+        {
+            std::function<void()>  work            { };                //!< The work to perform.
+            std::vector<Task>       dependencies    { };                //!< The tasks which must finish first.
+            std::vector<Task>       dependents      { };                //!< The tasks which are waiting for this task.
+            unsigned int            pending         { 0 };              //!< The number of dependencies which haven't finished yet.
+            State                   state           { State::Idle };    //!< The progress of the task.
+            std::exception_ptr      error           { };                //!< An exception thrown by the task or one of its dependencies.
+        };
+
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> Marks a task and its dependencies as scheduled, running any that are ready. The mutex must be locked. </summary>
+        /// <param name="task"> The task to schedule. </param>
+        /// <param name="lock"> The lock on the mutex, this is released whilst tasks are ran without a pool. </param>
+        void scheduleLocked (const Task task, std::unique_lock<std::mutex>& lock);
+
+        /// <summary> Starts a task whose dependencies have all finished. The mutex must be locked. </summary>
+        /// <param name="task"> The task to start. </param>
+        /// <param name="lock"> The lock on the mutex, this is released whilst tasks are ran without a pool. </param>
+        void start (const Task task, std::unique_lock<std::mutex>& lock);
+
+        /// <summary> Runs the work of a task and then releases any dependents which are now ready. </summary>
+        /// <param name="task"> The task to run. </param>
+        void run (const Task task);
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        ThreadPool*                 m_pool      { nullptr };    //!< The pool to run tasks on.
+        std::vector<Node>           m_nodes     { };            //!< Every task in the graph.
+        unsigned int                m_active    { 0 };          //!< How many scheduled tasks haven't finished yet.
+
+        mutable std::mutex          m_mutex     { };            //!< Guards the state of every node.
+        std::condition_variable     m_finished  { };            //!< Signalled whenever a task finishes.
+};
+
+#endif
\ No newline at end of file
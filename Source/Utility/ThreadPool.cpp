@@ -0,0 +1,86 @@
+#include "ThreadPool.hpp"
+
+
+// STL headers.
+#include <algorithm>
+#include <utility>
+
+
+
+/////////////////////////////////
+// Constructors and destructor //
+/////////////////////////////////
+
+ThreadPool::ThreadPool (const unsigned int threads)
+{
+    // hardware_concurrency() is allowed to return zero so make sure we always have a worker.
+    const auto count = threads != 0 ? threads : std::max (1U, std::thread::hardware_concurrency());
+
+    m_workers.reserve (count);
+
+    for (auto i = 0U; i < count; ++i)
+    {
+        m_workers.emplace_back (&ThreadPool::work, this);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    // Tell each worker to exit once the queue has been drained.
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_stopping = true;
+    }
+
+    m_signal.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+
+//////////////////////
+// Public interface //
+//////////////////////
+
+void ThreadPool::push (std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock { m_mutex };
+        m_jobs.push_back (std::move (job));
+    }
+
+    m_signal.notify_one();
+}
+
+
+////////////////////
+// Implementation //
+////////////////////
+
+void ThreadPool::work()
+{
+    while (true)
+    {
+        auto job = std::function<void()> { };
+
+        // Wait for a job or for the pool to stop.
+        {
+            std::unique_lock<std::mutex> lock { m_mutex };
+            m_signal.wait (lock, [this] () { return m_stopping || !m_jobs.empty(); });
+
+            if (m_jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move (m_jobs.front());
+            m_jobs.pop_front();
+        }
+
+        job();
+    }
+}
\ No newline at end of file
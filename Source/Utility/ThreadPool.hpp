@@ -0,0 +1,76 @@
+#ifndef GEC_THREAD_POOL_HPP
+#define GEC_THREAD_POOL_HPP
+
+
+// STL headers.
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/// <summary>
+/// A fixed collection of worker threads which run queued jobs in the order they were pushed.
+/// </summary>
+class ThreadPool final
+{
+    public:
+
+        /////////////////////////////////
+        // Constructors and destructor //
+        /////////////////////////////////
+
+        /// <summary> Starts the given number of worker threads. </summary>
+        /// <param name="threads"> How many workers to start, zero will use the number of hardware threads. </param>
+        ThreadPool (const unsigned int threads = 0U);
+
+        /// <summary> Finishes every queued job then stops each worker thread. </summary>
+        ~ThreadPool();
+
+        ThreadPool (ThreadPool&& move)                  = delete;
+        ThreadPool& operator= (ThreadPool&& move)       = delete;
+        ThreadPool (const ThreadPool& copy)             = delete;
+        ThreadPool& operator= (const ThreadPool& copy)  = delete;
+
+
+        /////////////////////////
+        // Getters and setters //
+        /////////////////////////
+
+        /// <summary> Gets the number of worker threads in the pool. </summary>
+        unsigned int getThreadCount() const { return m_workers.size(); }
+
+
+        //////////////////////
+        // Public interface //
+        //////////////////////
+
+        /// <summary> Queues a job to be ran by the next available worker. Jobs must not throw exceptions. </summary>
+        /// <param name="job"> The job to run. </param>
+        void push (std::function<void()> job);
+
+    private:
+
+        ////////////////////
+        // Implementation //
+        ////////////////////
+
+        /// <summary> The loop ran by each worker thread, this runs jobs until the pool is destroyed. </summary>
+        void work();
+
+
+        ///////////////////
+        // Internal data //
+        ///////////////////
+
+        std::vector<std::thread>            m_workers   { };        //!< Each worker thread.
+        std::deque<std::function<void()>>   m_jobs      { };        //!< Jobs waiting to be ran.
+
+        std::mutex                          m_mutex     { };        //!< Guards the job queue and the stopping flag.
+        std::condition_variable             m_signal    { };        //!< Wakes workers when jobs are pushed or the pool stops.
+        bool                                m_stopping  { false };  //!< Whether the workers should exit once the queue is empty.
+};
+
+#endif
\ No newline at end of file